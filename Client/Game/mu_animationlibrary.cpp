@@ -0,0 +1,153 @@
+#include "stdafx.h"
+#include "mu_animationlibrary.h"
+#include "mu_hash.h"
+#include <mutex>
+
+namespace MUAnimationLibrary
+{
+	template<typename Type>
+	using NBlockTable = std::unordered_map<mu_uint64, std::vector<std::weak_ptr<const std::vector<Type>>>>;
+
+	std::mutex Mutex;
+	NBlockTable<NBoneInfo> BonesBlocks;
+	NBlockTable<NAnimationKey> KeysBlocks;
+	NStatistics Statistics;
+
+	NEXTMU_INLINE const mu_uint64 HashValue(const mu_float value, const mu_uint64 hash)
+	{
+		return MUHash::Calculate64(reinterpret_cast<const mu_uint8 *>(&value), sizeof(value), hash);
+	}
+
+	// Floats are compared by their bits, the same comparison used by the hash
+	NEXTMU_INLINE const mu_boolean IsSameValue(const mu_float a, const mu_float b)
+	{
+		return mu_memcmp(&a, &b, sizeof(mu_float)) == 0;
+	}
+
+	NEXTMU_INLINE const mu_boolean IsSameBone(const NBone &a, const NBone &b)
+	{
+		for (mu_uint32 n = 0; n < 3; ++n)
+		{
+			if (IsSameValue(a.Position[n], b.Position[n]) == false) return false;
+		}
+
+		for (mu_uint32 n = 0; n < 4; ++n)
+		{
+			if (IsSameValue(a.Rotation[n], b.Rotation[n]) == false) return false;
+		}
+
+		return true;
+	}
+
+	template<typename Type, typename EqualFunc>
+	NSharedBlock<Type> Share(NBlockTable<Type> &table, std::vector<Type> &&data, const mu_uint64 hash, const mu_uint64 bytes, EqualFunc equal)
+	{
+		if (data.empty()) return NSharedBlock<Type>();
+
+		std::lock_guard lock(Mutex);
+		auto &candidates = table[hash];
+		for (auto iter = candidates.begin(); iter != candidates.end();)
+		{
+			auto block = iter->lock();
+			if (!block)
+			{
+				iter = candidates.erase(iter);
+				continue;
+			}
+
+			if (equal(*block, data))
+			{
+				++Statistics.Shared;
+				Statistics.SharedBytes += bytes;
+				return NSharedBlock<Type>(std::move(block));
+			}
+
+			++iter;
+		}
+
+		auto block = std::make_shared<const std::vector<Type>>(std::move(data));
+		candidates.push_back(block);
+		++Statistics.Blocks;
+		Statistics.UniqueBytes += bytes;
+
+		return NSharedBlock<Type>(std::move(block));
+	}
+
+	NSharedBlock<NBoneInfo> ShareBones(std::vector<NBoneInfo> &&bones)
+	{
+		// Fields are hashed one by one, the padding of the struct isn't initialized
+		mu_uint64 hash = MUHash::InitialHash64;
+		for (const auto &bone : bones)
+		{
+			const mu_uint8 dummy = bone.Dummy ? 1u : 0u;
+			hash = MUHash::Calculate64(&dummy, sizeof(dummy), hash);
+			hash = MUHash::Calculate64(reinterpret_cast<const mu_uint8 *>(&bone.Parent), sizeof(bone.Parent), hash);
+		}
+
+		const mu_uint64 bytes = static_cast<mu_uint64>(bones.size()) * sizeof(NBoneInfo);
+		return Share(
+			BonesBlocks,
+			std::move(bones),
+			hash,
+			bytes,
+			[](const std::vector<NBoneInfo> &a, const std::vector<NBoneInfo> &b) -> mu_boolean {
+				if (a.size() != b.size()) return false;
+				for (mu_size n = 0; n < a.size(); ++n)
+				{
+					if (a[n].Dummy != b[n].Dummy || a[n].Parent != b[n].Parent) return false;
+				}
+				return true;
+			}
+		);
+	}
+
+	NSharedBlock<NAnimationKey> ShareKeys(std::vector<NAnimationKey> &&keys)
+	{
+		mu_uint64 hash = MUHash::InitialHash64;
+		mu_uint64 bytes = static_cast<mu_uint64>(keys.size()) * sizeof(NAnimationKey);
+		for (const auto &key : keys)
+		{
+			for (const auto &bone : key.Bones)
+			{
+				for (mu_uint32 n = 0; n < 3; ++n) hash = HashValue(bone.Position[n], hash);
+				for (mu_uint32 n = 0; n < 4; ++n) hash = HashValue(bone.Rotation[n], hash);
+			}
+			bytes += static_cast<mu_uint64>(key.Bones.size()) * sizeof(NBone);
+		}
+
+		return Share(
+			KeysBlocks,
+			std::move(keys),
+			hash,
+			bytes,
+			[](const std::vector<NAnimationKey> &a, const std::vector<NAnimationKey> &b) -> mu_boolean {
+				if (a.size() != b.size()) return false;
+				for (mu_size k = 0; k < a.size(); ++k)
+				{
+					const auto &bonesA = a[k].Bones;
+					const auto &bonesB = b[k].Bones;
+					if (bonesA.size() != bonesB.size()) return false;
+					for (mu_size n = 0; n < bonesA.size(); ++n)
+					{
+						if (IsSameBone(bonesA[n], bonesB[n]) == false) return false;
+					}
+				}
+				return true;
+			}
+		);
+	}
+
+	void Clear()
+	{
+		std::lock_guard lock(Mutex);
+		BonesBlocks.clear();
+		KeysBlocks.clear();
+		Statistics = NStatistics();
+	}
+
+	const NStatistics GetStatistics()
+	{
+		std::lock_guard lock(Mutex);
+		return Statistics;
+	}
+}
\ No newline at end of file
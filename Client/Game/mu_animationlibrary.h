@@ -0,0 +1,30 @@
+#ifndef __MU_ANIMATIONLIBRARY_H__
+#define __MU_ANIMATIONLIBRARY_H__
+
+#pragma once
+
+#include "mu_model_skeleton.h"
+
+/*
+	Player parts and monster variants carry the same bone hierarchy and animations, models hash these blocks when they are loaded
+	and receive the copy of the first model which loaded them. The library only keeps weak references, a block is released with
+	the last model which uses it. Blocks are shared from the model loaders, so it is thread safe.
+*/
+namespace MUAnimationLibrary
+{
+	struct NStatistics
+	{
+		mu_uint32 Blocks = 0; // Unique blocks created
+		mu_uint32 Shared = 0; // Blocks which reused an existing one
+		mu_uint64 UniqueBytes = 0;
+		mu_uint64 SharedBytes = 0; // Bytes the duplicated blocks would have used
+	};
+
+	NSharedBlock<NBoneInfo> ShareBones(std::vector<NBoneInfo> &&bones);
+	NSharedBlock<NAnimationKey> ShareKeys(std::vector<NAnimationKey> &&keys);
+
+	void Clear();
+	const NStatistics GetStatistics();
+}
+
+#endif
\ No newline at end of file
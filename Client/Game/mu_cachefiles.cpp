@@ -0,0 +1,86 @@
+#include "stdafx.h"
+#include "mu_cachefiles.h"
+#include <filesystem>
+
+namespace MUCacheFiles
+{
+	constexpr const mu_char *Directory = "cache/";
+	mu_atomic_uint32_t TemporaryIdGenerator = 0;
+
+	NEXTMU_INLINE const std::filesystem::path GetFullPath(const mu_utf8string &path)
+	{
+		return std::filesystem::path(ConvertToUnicodeString(CachePathUTF8 + path));
+	}
+
+	const mu_utf8string GetPath(const mu_utf8string &source, const mu_char *extension)
+	{
+		// Drive, root and parent components are dropped so every cache file stays inside the cache directory
+		mu_utf8string path = Directory;
+		mu_size begin = 0;
+		while (begin <= source.size())
+		{
+			mu_size end = source.find_first_of("/\\", begin);
+			if (end == mu_utf8string::npos) end = source.size();
+
+			const mu_utf8string component = source.substr(begin, end - begin);
+			if (component.empty() == false && component != "." && component != ".." && component.back() != ':')
+			{
+				if (end < source.size())
+				{
+					path += component + '/';
+				}
+				else
+				{
+					path += component;
+				}
+			}
+
+			begin = end + 1;
+		}
+
+		return path + extension;
+	}
+
+	// The cache is an optimization, every failure leaves the previous file untouched and the data is generated again next time
+	const mu_boolean Write(const mu_utf8string &path, std::initializer_list<NCacheBlock> blocks)
+	{
+		std::error_code ec;
+		std::filesystem::create_directories(GetFullPath(path).parent_path(), ec);
+
+		const mu_utf8string temporaryPath = fmt::format("{}.{}.tmp", path, TemporaryIdGenerator++);
+		SDL_RWops *fp = nullptr;
+		if (mu_rwfromfile<EGameDirectoryType::eCache>(&fp, temporaryPath, "wb") == false)
+		{
+			return false;
+		}
+
+		mu_boolean written = true;
+		for (const auto &block : blocks)
+		{
+			if (block.Size > 0 && SDL_RWwrite(fp, block.Data, block.Size, 1) != 1)
+			{
+				written = false;
+				break;
+			}
+		}
+
+		if (SDL_RWclose(fp) != 0)
+		{
+			written = false;
+		}
+
+		// Concurrent writers of the same source produce the same data, the last rename wins
+		if (written == true)
+		{
+			std::filesystem::rename(GetFullPath(temporaryPath), GetFullPath(path), ec);
+			written = !ec;
+		}
+
+		if (written == false)
+		{
+			std::filesystem::remove(GetFullPath(temporaryPath), ec);
+		}
+
+		return written;
+	}
+}
\ No newline at end of file
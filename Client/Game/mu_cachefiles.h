@@ -0,0 +1,22 @@
+#ifndef __MU_CACHEFILES_H__
+#define __MU_CACHEFILES_H__
+
+#pragma once
+
+/*
+	Generated data (compressed textures, baked models) is stored under the cache directory keeping the path of its source,
+	files are written to a temporary name and renamed when complete so loaders running on other threads never read a partial file.
+*/
+struct NCacheBlock
+{
+	const void *Data;
+	mu_size Size;
+};
+
+namespace MUCacheFiles
+{
+	const mu_utf8string GetPath(const mu_utf8string &source, const mu_char *extension);
+	const mu_boolean Write(const mu_utf8string &path, std::initializer_list<NCacheBlock> blocks);
+}
+
+#endif
\ No newline at end of file
@@ -5,6 +5,9 @@
 namespace MUCapabilities
 {
 	mu_boolean HomogeneousDepth = false;
+	mu_boolean ComputeShaderSupported = false;
+	mu_boolean RawBufferSupported = false;
+	mu_boolean TextureCompressionBCSupported = false;
 
 	const mu_boolean Configure()
 	{
@@ -12,6 +15,9 @@ namespace MUCapabilities
 		const auto &deviceInfo = device->GetDeviceInfo();
 
 		HomogeneousDepth = deviceInfo.IsGLDevice();
+		ComputeShaderSupported = deviceInfo.Features.ComputeShaders == Diligent::DEVICE_FEATURE_STATE_ENABLED;
+		RawBufferSupported = deviceInfo.IsGLDevice() == false; // HLSL byte address buffers aren't converted by our OpenGL backend
+		TextureCompressionBCSupported = deviceInfo.Features.TextureCompressionBC == Diligent::DEVICE_FEATURE_STATE_ENABLED;
 
 		return true;
 	}
@@ -20,4 +26,19 @@ namespace MUCapabilities
 	{
 		return HomogeneousDepth;
 	}
+
+	const mu_boolean IsComputeShaderSupported()
+	{
+		return ComputeShaderSupported;
+	}
+
+	const mu_boolean IsRawBufferSupported()
+	{
+		return RawBufferSupported;
+	}
+
+	const mu_boolean IsTextureCompressionBCSupported()
+	{
+		return TextureCompressionBCSupported;
+	}
 }
\ No newline at end of file
@@ -8,6 +8,9 @@ namespace MUCapabilities
 	const mu_boolean Configure();
 
 	const mu_boolean IsHomogeneousDepth();
+	const mu_boolean IsComputeShaderSupported();
+	const mu_boolean IsRawBufferSupported();
+	const mu_boolean IsTextureCompressionBCSupported();
 }
 
 #endif
\ No newline at end of file
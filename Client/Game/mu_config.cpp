@@ -21,6 +21,16 @@ namespace MUConfig
 	mu_boolean Antialiasing = false;
 	mu_boolean VerticalSync = false;
 
+	mu_boolean HalfPrecisionBones = false;
+	mu_boolean ComputeSkinning = false;
+	mu_boolean GPUParticles = false;
+	mu_boolean TextureCompression = true;
+	// Megabytes of streamed textures kept resident, zero loads every texture at startup
+	mu_uint32 TextureStreamingBudget = 0u;
+
+	// Zero means the seed is taken from the clock, any other value reproduces the same effects
+	mu_uint64 RandomSeed = 0ull;
+
 	mu_float MusicVolume = 1.0f;
 	mu_float SoundVolume = 1.0f;
 
@@ -145,6 +155,36 @@ namespace MUConfig
 			VerticalSync = document["VerticalSync"].get<mu_boolean>();
 		}
 
+		if (document.contains("HalfPrecisionBones") == true)
+		{
+			HalfPrecisionBones = document["HalfPrecisionBones"].get<mu_boolean>();
+		}
+
+		if (document.contains("ComputeSkinning") == true)
+		{
+			ComputeSkinning = document["ComputeSkinning"].get<mu_boolean>();
+		}
+
+		if (document.contains("GPUParticles") == true)
+		{
+			GPUParticles = document["GPUParticles"].get<mu_boolean>();
+		}
+
+		if (document.contains("TextureCompression") == true)
+		{
+			TextureCompression = document["TextureCompression"].get<mu_boolean>();
+		}
+
+		if (document.contains("TextureStreamingBudget") == true)
+		{
+			TextureStreamingBudget = document["TextureStreamingBudget"].get<mu_uint32>();
+		}
+
+		if (document.contains("RandomSeed") == true)
+		{
+			RandomSeed = document["RandomSeed"].get<mu_uint64>();
+		}
+
 		if (document.contains("MusicVolume") == true)
 		{
 			MusicVolume = document["MusicVolume"].get<mu_float>();
@@ -242,4 +282,34 @@ namespace MUConfig
 	{
 		return VerticalSync;
 	}
+
+	const mu_boolean GetHalfPrecisionBones()
+	{
+		return HalfPrecisionBones;
+	}
+
+	const mu_boolean GetComputeSkinning()
+	{
+		return ComputeSkinning;
+	}
+
+	const mu_boolean GetGPUParticles()
+	{
+		return GPUParticles;
+	}
+
+	const mu_boolean GetTextureCompression()
+	{
+		return TextureCompression;
+	}
+
+	const mu_uint32 GetTextureStreamingBudget()
+	{
+		return TextureStreamingBudget;
+	}
+
+	const mu_uint64 GetRandomSeed()
+	{
+		return RandomSeed;
+	}
 };
\ No newline at end of file
@@ -27,6 +27,14 @@ namespace MUConfig
 
 	const mu_boolean GetAntialiasing();
 	const mu_boolean GetVerticalSync();
+
+	const mu_boolean GetHalfPrecisionBones();
+	const mu_boolean GetComputeSkinning();
+	const mu_boolean GetGPUParticles();
+	const mu_boolean GetTextureCompression();
+	const mu_uint32 GetTextureStreamingBudget();
+
+	const mu_uint64 GetRandomSeed();
 };
 
 #endif
\ No newline at end of file
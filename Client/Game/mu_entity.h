@@ -159,6 +159,16 @@ namespace NEntity
 		mu_uint16 PriorAction = 0u;
 		mu_float CurrentFrame = 0.0f;
 		mu_float PriorFrame = 0.0f;
+
+		// Action played over the upper body bones while the base action keeps running (attacking while moving)
+		struct
+		{
+			mu_boolean Enabled = false;
+			mu_uint16 CurrentAction = 0u;
+			mu_uint16 PriorAction = 0u;
+			mu_float CurrentFrame = 0.0f;
+			mu_float PriorFrame = 0.0f;
+		} UpperBody;
 	};
 
 	struct NModifiers
@@ -186,6 +196,7 @@ namespace NEntity
 	struct NAction
 	{
 		NAnimationType Type = NAnimationType::Stop;
+		NAnimationType UpperBody = NAnimationType::Max; // Max when the upper body follows the base action
 	};
 
 	struct NLinkAnimation
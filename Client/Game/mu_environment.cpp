@@ -9,6 +9,9 @@
 #include "mu_graphics.h"
 #include "mu_config.h"
 #include "mu_capabilities.h"
+#include "mu_skeletonmanager.h"
+#include "mu_skinningmanager.h"
+#include "mu_gpuparticles.h"
 #include "mu_input.h"
 #include <algorithm>
 #include <execution>
@@ -222,6 +225,7 @@ void NEnvironment::Update()
 	Characters->PreRender(RenderSettings);
 	Controller->PreRender();
 	Objects->PreRender(RenderSettings);
+	MUSkeletonManager::RunJobs();
 
 	Particles->Update();
 	Particles->Propagate();
@@ -266,6 +270,8 @@ void NEnvironment::Render()
 			Particles->Render();
 			Joints->Render();
 
+			MUSkinningManager::Dispatch(immediateContext);
+			MUGPUParticles::Dispatch(immediateContext);
 			MUGraphics::GetRenderManager()->Execute(immediateContext);
 			MUBBoxRenderer::Reset();
 			MUModelRenderer::Reset();
@@ -322,6 +328,7 @@ void NEnvironment::Render()
 				Objects->Render(RenderSettings);
 				Characters->Render(RenderSettings);
 
+				MUSkinningManager::Dispatch(immediateContext);
 				MUGraphics::GetRenderManager()->Execute(immediateContext);
 				MUBBoxRenderer::Reset();
 				MUModelRenderer::Reset();
@@ -7,6 +7,7 @@
 #include "mu_state.h"
 #include "mu_renderstate.h"
 #include "mu_threadsmanager.h"
+#include "mu_skeletonmanager.h"
 #include "mu_resourcesmanager.h"
 #include "mu_animationsmanager.h"
 #include "mu_charactersmanager.h"
@@ -85,6 +86,7 @@ void NCharacters::PreRender(const NRenderSettings &renderSettings)
 					>(entity);
 
 					characters->SetCharacterAnimation(action.Type, position, animationsMapping, animation, attachment);
+					characters->PlayUpperBodyAnimation(entity, action, position, animationsMapping, animation, attachment, skeleton.Instance, updateTime);
 
 					skeleton.Instance.SetParent(
 						position.Angle,
@@ -100,7 +102,11 @@ void NCharacters::PreRender(const NRenderSettings &renderSettings)
 					);
 
 					const auto model = attachment.Base;
-					model->PlayAnimation(animation.CurrentAction, animation.PriorAction, animation.CurrentFrame, animation.PriorFrame, model->GetPlaySpeed(animation.CurrentAction) * characters->GetAnimationModifier(entity, animation.ModifierType) * updateTime);
+					const mu_boolean playing = model->PlayAnimation(animation.CurrentAction, animation.PriorAction, animation.CurrentFrame, animation.PriorFrame, model->GetPlaySpeed(animation.CurrentAction) * characters->GetAnimationModifier(entity, animation.ModifierType) * updateTime);
+					if (playing == false && action.Type == NAnimationType::Attack)
+					{
+						action.Type = NAnimationType::Stop;
+					}
 					
 					auto &obb = boundingBox.OBB.Calculated;
 					if (model->HasMeshes() && model->HasGlobalBBox())
@@ -197,23 +203,23 @@ void NCharacters::PreRender(const NRenderSettings &renderSettings)
 
 					environment->CalculateLight(position, light, renderState);
 
-					/* If we have parts to be processed then we animate the skeleton before checking if the object is visible */
-					if (attachment.Parts.size() == 0)
-					{
-						skeleton.Instance.Animate(
-							model,
-							{
+					/* Bodies with parts were already animated to calculate the bounding box so they only require the upload */
+					MUSkeletonManager::QueueJob(
+						NSkeletonJob{
+							.Instance = &skeleton.Instance,
+							.Model = model,
+							.Current = {
 								.Action = animation.CurrentAction,
 								.Frame = animation.CurrentFrame,
 							},
-							{
+							.Prior = {
 								.Action = animation.PriorAction,
 								.Frame = animation.PriorFrame,
 							},
-							glm::vec3(0.0f, 0.0f, 0.0f)
-							);
-					}
-					skeleton.SkeletonOffset = skeleton.Instance.Upload();
+							.SkeletonOffset = &skeleton.SkeletonOffset,
+							.Animate = attachment.Parts.size() == 0,
+						}
+					);
 
 					for (auto &[type, part] : attachment.Parts)
 					{
@@ -233,19 +239,21 @@ void NCharacters::PreRender(const NRenderSettings &renderSettings)
 						MixBones(boneMatrix, transformMatrix);
 
 						partSkeleton.SetParent(transformMatrix);
-						partSkeleton.Animate(
-							model,
-							{
-								.Action = animation.CurrentAction,
-								.Frame = animation.CurrentFrame,
-							},
-							{
-								.Action = animation.PriorAction,
-								.Frame = animation.PriorFrame,
-							},
-							glm::vec3(0.0f, 0.0f, 0.0f)
-							);
-						link.SkeletonOffset = partSkeleton.Upload();
+						MUSkeletonManager::QueueJob(
+							NSkeletonJob{
+								.Instance = &partSkeleton,
+								.Model = model,
+								.Current = {
+									.Action = animation.CurrentAction,
+									.Frame = animation.CurrentFrame,
+								},
+								.Prior = {
+									.Action = animation.PriorAction,
+									.Frame = animation.PriorFrame,
+								},
+								.SkeletonOffset = &link.SkeletonOffset,
+							}
+						);
 					}
 				}
 			)
@@ -709,11 +717,19 @@ void NCharacters::ConfigureAnimationsMapping(const entt::entity entity)
 
 void NCharacters::SetCharacterAction(const entt::entity entity, NAnimationType type)
 {
-	auto &action = Registry.get<NEntity::NAction>(entity);
+	auto [action, movement] = Registry.get<NEntity::NAction, NEntity::NMovement>(entity);
+
+	// Attacks don't stop the movement, the upper body plays them while the legs keep walking
+	if (type == NAnimationType::Attack && movement.Moving)
+	{
+		action.UpperBody = type;
+		return;
+	}
+
 	action.Type = type;
 }
 
-void NCharacters::SetCharacterAnimation(NAnimationType type, NEntity::NPosition& position, NEntity::NAnimationsMapping &animationsMapping, NEntity::NAnimation &animation, NEntity::NAttachment &attachment)
+const mu_uint32 NCharacters::GetCharacterAnimation(NAnimationType type, const NEntity::NPosition &position, const NEntity::NAnimationsMapping &animationsMapping) const
 {
 	const auto terrain = Environment->GetTerrain();
 	const auto attribute = terrain->GetAttribute(GetPositionFromFloat(position.Position.x), GetPositionFromFloat(position.Position.y));
@@ -721,9 +737,15 @@ void NCharacters::SetCharacterAnimation(NAnimationType type, NEntity::NPosition&
 
 	const auto &mapping = (safezone ? animationsMapping.Safezone : animationsMapping.Normal);
 	const auto iter = mapping.find(type);
-	if (iter == mapping.end()) return;
+	if (iter == mapping.end()) return NInvalidUInt32;
 
-	const auto action = iter->second;
+	return iter->second;
+}
+
+void NCharacters::SetCharacterAnimation(NAnimationType type, NEntity::NPosition& position, NEntity::NAnimationsMapping &animationsMapping, NEntity::NAnimation &animation, NEntity::NAttachment &attachment)
+{
+	const auto action = GetCharacterAnimation(type, position, animationsMapping);
+	if (action == NInvalidUInt32) return;
 	if (animation.CurrentAction == action) return;
 
 	animation.ModifierType = attachment.Base->GetAnimationModifierType(action);
@@ -753,6 +775,63 @@ void NCharacters::SetCharacterAnimation(NAnimationType type, NEntity::NPosition&
 	}
 }
 
+/*
+	Models without an upper body mask, or without the requested action, play nothing over the base action.
+	The layer is released once its action ends, non-looped actions end when they wrap.
+*/
+void NCharacters::PlayUpperBodyAnimation(const entt::entity entity, NEntity::NAction &action, const NEntity::NPosition &position, const NEntity::NAnimationsMapping &animationsMapping, NEntity::NAnimation &animation, const NEntity::NAttachment &attachment, NSkeletonInstance &skeleton, const mu_float updateTime)
+{
+	const NModel *model = attachment.Base;
+	auto &layer = animation.UpperBody;
+
+	const mu_uint32 index = (
+		action.UpperBody != NAnimationType::Max && model->HasBoneMasks()
+		? GetCharacterAnimation(action.UpperBody, position, animationsMapping)
+		: NInvalidUInt32
+	);
+	if (index == NInvalidUInt32)
+	{
+		action.UpperBody = NAnimationType::Max;
+		layer.Enabled = false;
+		skeleton.ClearLayer(NBoneMaskType::UpperBody);
+		return;
+	}
+
+	if (layer.Enabled == false || layer.CurrentAction != index)
+	{
+		layer.Enabled = true;
+		layer.CurrentAction = static_cast<mu_uint16>(index);
+		layer.PriorAction = static_cast<mu_uint16>(index);
+		layer.CurrentFrame = 0.0f;
+		layer.PriorFrame = 0.0f;
+	}
+
+	const mu_float playSpeed = model->GetPlaySpeed(layer.CurrentAction) * GetAnimationModifier(entity, model->GetAnimationModifierType(layer.CurrentAction)) * updateTime;
+	if (model->PlayAnimation(layer.CurrentAction, layer.PriorAction, layer.CurrentFrame, layer.PriorFrame, playSpeed) == false)
+	{
+		action.UpperBody = NAnimationType::Max;
+		layer.Enabled = false;
+		skeleton.ClearLayer(NBoneMaskType::UpperBody);
+		return;
+	}
+
+	skeleton.SetLayer(
+		NBoneMaskType::UpperBody,
+		NAnimationLayer{
+			.Enabled = true,
+			.Blend = NAnimationLayerBlend::Override,
+			.Current = {
+				.Action = layer.CurrentAction,
+				.Frame = layer.CurrentFrame,
+			},
+			.Prior = {
+				.Action = layer.PriorAction,
+				.Frame = layer.PriorFrame,
+			},
+		}
+	);
+}
+
 const mu_float NCharacters::GetAnimationModifier(const entt::entity entity, NAnimationModifierType type) const
 {
 	auto &modifiers = Registry.get<NEntity::NModifiers>(entity);
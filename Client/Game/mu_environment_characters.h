@@ -35,9 +35,11 @@ public:
 
 	void SetCharacterAction(const entt::entity entity, NAnimationType type);
 	void SetCharacterAnimation(NAnimationType type, NEntity::NPosition &position, NEntity::NAnimationsMapping &animationsMapping, NEntity::NAnimation &animation, NEntity::NAttachment &attachment);
+	void PlayUpperBodyAnimation(const entt::entity entity, NEntity::NAction &action, const NEntity::NPosition &position, const NEntity::NAnimationsMapping &animationsMapping, NEntity::NAnimation &animation, const NEntity::NAttachment &attachment, NSkeletonInstance &skeleton, const mu_float updateTime);
 	const mu_float GetAnimationModifier(const entt::entity entity, NAnimationModifierType type) const;
 
 private:
+	const mu_uint32 GetCharacterAnimation(NAnimationType type, const NEntity::NPosition &position, const NEntity::NAnimationsMapping &animationsMapping) const;
 	void MoveCharacter(const entt::entity);
 	mu_boolean MovePath(NEntity::NPosition &position, NEntity::NMovement &movement, NEntity::NMoveSpeed &moveSpeed, const NEntity::NModifiers &modifiers);
 
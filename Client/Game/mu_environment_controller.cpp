@@ -140,6 +140,11 @@ void NController::Update()
 					);
 				}
 			}
+			else if (MUInput::IsShiftPressing() == true && MUInput::IsMousePressing(MOUSE_BUTTON_LEFT) == true)
+			{
+				// A moving character keeps walking and attacks with its upper body
+				Environment->GetCharacters()->SetCharacterAction(Character, NAnimationType::Attack);
+			}
 		}
 	}
 }
@@ -29,7 +29,7 @@ const mu_boolean NJoints::Initialize()
 		Diligent::BufferDesc bufferDesc;
 		bufferDesc.Usage = Diligent::USAGE_DEFAULT;
 		bufferDesc.BindFlags = Diligent::BIND_VERTEX_BUFFER;
-		bufferDesc.Size = sizeof(NJointVertex) * TJoint::MaxRenderCount * 4;
+		bufferDesc.Size = sizeof(NJointVertex) * TJoint::MaxRenderVertices;
 
 		Diligent::RefCntAutoPtr<Diligent::IBuffer> buffer;
 		device->CreateBuffer(bufferDesc, nullptr, &buffer);
@@ -46,7 +46,7 @@ const mu_boolean NJoints::Initialize()
 		Diligent::BufferDesc bufferDesc;
 		bufferDesc.Usage = Diligent::USAGE_DEFAULT;
 		bufferDesc.BindFlags = Diligent::BIND_INDEX_BUFFER;
-		bufferDesc.Size = sizeof(mu_uint32) * TJoint::MaxRenderCount * 6;
+		bufferDesc.Size = sizeof(TJoint::IndexType) * TJoint::MaxRenderCount * 6;
 
 		Diligent::RefCntAutoPtr<Diligent::IBuffer> buffer;
 		device->CreateBuffer(bufferDesc, nullptr, &buffer);
@@ -79,13 +79,35 @@ const mu_boolean NJoints::Initialize()
 	const auto immediateContext = MUGraphics::GetImmediateContext();
 	Diligent::StateTransitionDesc updateBarriers[2] = {
 		Diligent::StateTransitionDesc(RenderBuffer.VertexBuffer, Diligent::RESOURCE_STATE_UNDEFINED, Diligent::RESOURCE_STATE_VERTEX_BUFFER, Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE),
-		Diligent::StateTransitionDesc(RenderBuffer.IndexBuffer, Diligent::RESOURCE_STATE_UNDEFINED, Diligent::RESOURCE_STATE_INDEX_BUFFER, Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE)
+		Diligent::StateTransitionDesc(RenderBuffer.IndexBuffer, Diligent::RESOURCE_STATE_UNDEFINED, Diligent::RESOURCE_STATE_INDEX_BUFFER, Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE),
 	};
 	immediateContext->TransitionResourceStates(mu_countof(updateBarriers), updateBarriers);
 
 	RenderBuffer.Groups.reserve(100);
 	TJoint::Initialize();
 
+	// Pipelines and bindings of every template are resolved once here instead of on every group
+	RenderBuffer.Batcher.Initialize(JointTypesCount, "JointSettings");
+	for (mu_uint32 type = 0; type < JointTypesCount; ++type)
+	{
+		auto *_template = TJoint::GetTemplate(static_cast<JointType>(type));
+		if (_template == nullptr) continue;
+
+		const auto &descriptor = _template->GetRenderDescriptor();
+		RenderBuffer.Batcher.SetDescriptor(
+			type,
+			descriptor,
+			NJointSettings{
+				.IsPremultipliedAlpha = static_cast<mu_float>(descriptor.IsPremultipliedAlpha),
+			}
+		);
+	}
+
+	if (RenderBuffer.Batcher.Prepare(RenderBuffer.FixedPipelineState, RenderBuffer.SettingsUniform) == false)
+	{
+		return false;
+	}
+
 	return true;
 }
 
@@ -94,6 +116,7 @@ void NJoints::Destroy()
 	RenderBuffer.Program = NInvalidShader;
 	RenderBuffer.VertexBuffer.Release();
 	RenderBuffer.IndexBuffer.Release();
+	RenderBuffer.Batcher.Destroy();
 	RenderBuffer.SettingsUniform.Release();
 }
 
@@ -283,6 +306,7 @@ void NJoints::Render()
 
 	//auto startTimer = std::chrono::high_resolution_clock::now();
 	auto &groups = RenderBuffer.Groups;
+	mu_uint32 verticesCount = 0;
 
 	// Calculate
 	{
@@ -290,7 +314,7 @@ void NJoints::Render()
 		mu_int32 group = -1;
 
 		mu_uint32 index = 0;
-		auto view = Registry.view<Entity::Info, Entity::RenderGroup, Entity::RenderIndex, Entity::RenderCount>();
+		auto view = Registry.view<Entity::Info, Entity::RenderGroup, Entity::RenderIndex, Entity::RenderCount, Entity::RenderVertexIndex, Entity::RenderVertexCount>();
 		for (auto iter = view.begin(); iter != view.end(); ++iter)
 		{
 			const auto entity = *iter;
@@ -298,15 +322,19 @@ void NJoints::Render()
 				info,
 				renderGroup,
 				renderIndex,
-				renderCount
+				renderCount,
+				renderVertexIndex,
+				renderVertexCount
 			] = view.get<
 				Entity::Info,
 				Entity::RenderGroup,
 				Entity::RenderIndex,
-				Entity::RenderCount
+				Entity::RenderCount,
+				Entity::RenderVertexIndex,
+				Entity::RenderVertexCount
 			>(entity);
 
-			if (index + renderCount > MaxRenderCount) {
+			if (index + renderCount > MaxRenderCount || verticesCount + renderVertexCount > MaxRenderVertices) {
 				renderGroup = NInvalidUInt32;
 				continue;
 			}
@@ -329,7 +357,9 @@ void NJoints::Render()
 
 			renderGroup = group;
 			renderIndex = index;
+			renderVertexIndex = verticesCount;
 			index += renderCount;
+			verticesCount += renderVertexCount;
 		}
 	}
 
@@ -397,34 +427,62 @@ void NJoints::Render()
 	fixedState.RTVFormat = renderTargetDesc.ColorFormat;
 	fixedState.DSVFormat = renderTargetDesc.DepthStencilFormat;
 
-	// Render Groups
+	// Vertices and indices of every group are uploaded at once
+	if (groups.empty() == false)
 	{
-		JointType type = JointType::Invalid;
-		TJoint::Template *_template = nullptr;
-		for (const auto renderGroup : RenderBuffer.Groups)
+		const auto &lastGroup = groups.back();
+		const mu_uint32 indicesCount = (lastGroup.Index + lastGroup.Count) * 6;
+		const auto immediateContext = MUGraphics::GetImmediateContext();
+
+		Diligent::StateTransitionDesc copyBarriers[2] = {
+			Diligent::StateTransitionDesc(RenderBuffer.VertexBuffer, Diligent::RESOURCE_STATE_VERTEX_BUFFER, Diligent::RESOURCE_STATE_COPY_DEST, Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE),
+			Diligent::StateTransitionDesc(RenderBuffer.IndexBuffer, Diligent::RESOURCE_STATE_INDEX_BUFFER, Diligent::RESOURCE_STATE_COPY_DEST, Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE),
+		};
+		immediateContext->TransitionResourceStates(mu_countof(copyBarriers), copyBarriers);
+
+		immediateContext->UpdateBuffer(
+			RenderBuffer.VertexBuffer,
+			0,
+			sizeof(NJointVertex) * verticesCount,
+			RenderBuffer.Vertices.data(),
+			Diligent::RESOURCE_STATE_TRANSITION_MODE_NONE
+		);
+
+		immediateContext->UpdateBuffer(
+			RenderBuffer.IndexBuffer,
+			0,
+			sizeof(TJoint::IndexType) * indicesCount,
+			RenderBuffer.Indices.data(),
+			Diligent::RESOURCE_STATE_TRANSITION_MODE_NONE
+		);
+
+		Diligent::StateTransitionDesc vertexBarriers[2] = {
+			Diligent::StateTransitionDesc(RenderBuffer.VertexBuffer, Diligent::RESOURCE_STATE_COPY_DEST, Diligent::RESOURCE_STATE_VERTEX_BUFFER, Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE),
+			Diligent::StateTransitionDesc(RenderBuffer.IndexBuffer, Diligent::RESOURCE_STATE_COPY_DEST, Diligent::RESOURCE_STATE_INDEX_BUFFER, Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE),
+		};
+		immediateContext->TransitionResourceStates(mu_countof(vertexBarriers), vertexBarriers);
+	}
+
+	// Render Groups, adjacent groups which share the same state are merged into a single draw
+	{
+		auto &batcher = RenderBuffer.Batcher;
+		if (batcher.Prepare(fixedState, RenderBuffer.SettingsUniform) == true)
 		{
-			if (renderGroup.Count == 0) continue;
-			if (renderGroup.Type != type)
+			for (const auto &renderGroup : RenderBuffer.Groups)
 			{
-				type = renderGroup.Type;
-				_template = TJoint::GetTemplate(type);
+				batcher.Push(static_cast<mu_uint32>(renderGroup.Type), renderGroup.Index, renderGroup.Count);
 			}
-			if (_template == nullptr) {
-				continue;
-			}
-			_template->RenderGroup(renderGroup, RenderBuffer);
 		}
-	}
 
-	if (RenderBuffer.RequireTransition == true)
-	{
-		const auto immediateContext = MUGraphics::GetImmediateContext();
-		Diligent::StateTransitionDesc updateBarriers[2] = {
-			Diligent::StateTransitionDesc(RenderBuffer.VertexBuffer, Diligent::RESOURCE_STATE_COPY_DEST, Diligent::RESOURCE_STATE_VERTEX_BUFFER, Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE),
-			Diligent::StateTransitionDesc(RenderBuffer.IndexBuffer, Diligent::RESOURCE_STATE_COPY_DEST, Diligent::RESOURCE_STATE_INDEX_BUFFER, Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE)
-		};
-		immediateContext->TransitionResourceStates(mu_countof(updateBarriers), updateBarriers);
-		RenderBuffer.RequireTransition = false;
+		batcher.Flush(
+			NBatchBuffers{
+				.VertexBuffer = RenderBuffer.VertexBuffer,
+				.IndexBuffer = RenderBuffer.IndexBuffer,
+				.IndexType = TJoint::IndexValueType,
+				.StreamedIndices = true,
+			},
+			RenderBuffer.SettingsUniform
+		);
 	}
 
 	//auto endTimer = std::chrono::high_resolution_clock::now();
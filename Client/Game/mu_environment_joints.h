@@ -18,6 +18,12 @@ public:
 	void Propagate();
 	void Render();
 
+public:
+	NEXTMU_INLINE const NBatchStatistics &GetRenderStatistics() const
+	{
+		return RenderBuffer.Batcher.GetStatistics();
+	}
+
 private:
 	entt::registry Registry;
 	TJoint::NRenderBuffer RenderBuffer;
@@ -8,6 +8,7 @@
 #include "mu_state.h"
 #include "mu_renderstate.h"
 #include "mu_threadsmanager.h"
+#include "mu_skeletonmanager.h"
 #include "res_renders.h"
 
 NObjects::NObjects(const NEnvironment *environment) : Environment(environment)
@@ -213,23 +214,23 @@ void NObjects::PreRender(const NRenderSettings &renderSettings)
 
 						environment->CalculateLight(position, light, renderState);
 
-						/* If we have parts to be processed then we animate the skeleton before checking if the object is visible */
-						if (attachment.Parts.size() == 0)
-						{
-							skeleton.Instance.Animate(
-								model,
-								{
+						/* Bodies with parts were already animated to calculate the bounding box so they only require the upload */
+						MUSkeletonManager::QueueJob(
+							NSkeletonJob{
+								.Instance = &skeleton.Instance,
+								.Model = model,
+								.Current = {
 									.Action = animation.CurrentAction,
 									.Frame = animation.CurrentFrame,
 								},
-							{
-								.Action = animation.PriorAction,
-								.Frame = animation.PriorFrame,
-							},
-							glm::vec3(0.0f, 0.0f, 0.0f)
-							);
-						}
-						skeleton.SkeletonOffset = skeleton.Instance.Upload();
+								.Prior = {
+									.Action = animation.PriorAction,
+									.Frame = animation.PriorFrame,
+								},
+								.SkeletonOffset = &skeleton.SkeletonOffset,
+								.Animate = attachment.Parts.size() == 0,
+							}
+						);
 
 						for (auto &[type, part] : attachment.Parts)
 						{
@@ -249,19 +250,21 @@ void NObjects::PreRender(const NRenderSettings &renderSettings)
 							MixBones(boneMatrix, transformMatrix);
 
 							partSkeleton.SetParent(transformMatrix);
-							partSkeleton.Animate(
-								model,
-								{
-									.Action = animation.CurrentAction,
-									.Frame = animation.CurrentFrame,
-								},
-							{
-								.Action = animation.PriorAction,
-								.Frame = animation.PriorFrame,
-							},
-							glm::vec3(0.0f, 0.0f, 0.0f)
+							MUSkeletonManager::QueueJob(
+								NSkeletonJob{
+									.Instance = &partSkeleton,
+									.Model = model,
+									.Current = {
+										.Action = animation.CurrentAction,
+										.Frame = animation.CurrentFrame,
+									},
+									.Prior = {
+										.Action = animation.PriorAction,
+										.Frame = animation.PriorFrame,
+									},
+									.SkeletonOffset = &link.SkeletonOffset,
+								}
 							);
-							link.SkeletonOffset = partSkeleton.Upload();
 						}
 
 						if (renderState.Fading.Group != nullptr && distanceToCharacter > 0.0f)
@@ -4,12 +4,19 @@
 #include "mu_threadsmanager.h"
 #include "mu_graphics.h"
 #include "mu_renderstate.h"
+#include "mu_camera.h"
+#include "mu_gpuparticles.h"
 #include "t_particle_base.h"
-#include "t_particle_entity.h"
 #include "mu_state.h"
 
 using namespace TParticle;
 
+constexpr mu_uint32 UpdateChunkSize = 1024u;
+constexpr mu_uint32 RenderChunkSize = 256u;
+constexpr mu_float LodNearDistance = 1500.0f;
+constexpr mu_float LodFarDistance = 4000.0f;
+constexpr mu_float LodMinimumEmission = 0.25f;
+
 const mu_boolean NParticles::Initialize()
 {
 	const auto device = MUGraphics::GetDevice();
@@ -44,13 +51,7 @@ const mu_boolean NParticles::Initialize()
 
 	// Index Buffer
 	{
-		Diligent::BufferDesc bufferDesc;
-		bufferDesc.Usage = Diligent::USAGE_DEFAULT;
-		bufferDesc.BindFlags = Diligent::BIND_INDEX_BUFFER;
-		bufferDesc.Size = sizeof(mu_uint32) * TParticle::MaxRenderCount * 6;
-
-		Diligent::RefCntAutoPtr<Diligent::IBuffer> buffer;
-		device->CreateBuffer(bufferDesc, nullptr, &buffer);
+		auto buffer = CreateQuadIndexBuffer<TParticle::MaxRenderCount>();
 		if (buffer == nullptr)
 		{
 			return false;
@@ -78,15 +79,58 @@ const mu_boolean NParticles::Initialize()
 	}
 
 	const auto immediateContext = MUGraphics::GetImmediateContext();
-	Diligent::StateTransitionDesc updateBarriers[2] = {
+	Diligent::StateTransitionDesc updateBarriers[1] = {
 		Diligent::StateTransitionDesc(RenderBuffer.VertexBuffer, Diligent::RESOURCE_STATE_UNDEFINED, Diligent::RESOURCE_STATE_VERTEX_BUFFER, Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE),
-		Diligent::StateTransitionDesc(RenderBuffer.IndexBuffer, Diligent::RESOURCE_STATE_UNDEFINED, Diligent::RESOURCE_STATE_INDEX_BUFFER, Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE)
 	};
 	immediateContext->TransitionResourceStates(mu_countof(updateBarriers), updateBarriers);
 
 	RenderBuffer.Groups.reserve(100);
 	TParticle::Initialize();
 
+	// Pipelines and bindings of every template are resolved once here instead of on every group
+	RenderBuffer.Batcher.Initialize(ParticleTypesCount, "ParticleSettings");
+	for (mu_uint32 type = 0; type < ParticleTypesCount; ++type)
+	{
+		auto *_template = TParticle::GetTemplate(static_cast<ParticleType>(type));
+		if (_template == nullptr) continue;
+
+		const auto &descriptor = _template->GetRenderDescriptor();
+		if (descriptor.Texture != nullptr)
+		{
+			CullingRadius[type] = static_cast<mu_float>(glm::max(descriptor.Texture->GetWidth(), descriptor.Texture->GetHeight()));
+		}
+
+		RenderBuffer.Batcher.SetDescriptor(
+			type,
+			descriptor,
+			NParticleSettings{
+				.IsPremultipliedAlpha = static_cast<mu_float>(descriptor.IsPremultipliedAlpha),
+				.IsLinear = static_cast<mu_float>(descriptor.IsLinear),
+			}
+		);
+	}
+
+	if (RenderBuffer.Batcher.Prepare(RenderBuffer.FixedPipelineState, RenderBuffer.SettingsUniform) == false)
+	{
+		return false;
+	}
+
+	for (auto &pool : Pools)
+	{
+		pool.Initialize(MaxParticlesPerType);
+	}
+
+	// Compatible templates are moved to the GPU backend when it is enabled, their spawns are staged in a single pool
+	if (MUGPUParticles::Configure() == false)
+	{
+		return false;
+	}
+
+	if (MUGPUParticles::IsEnabled())
+	{
+		GPUSpawnPool.Initialize(MUGPUParticles::MaxParticlesPerType);
+	}
+
 	return true;
 }
 
@@ -95,187 +139,181 @@ void NParticles::Destroy()
 	RenderBuffer.Program = NInvalidShader;
 	RenderBuffer.VertexBuffer.Release();
 	RenderBuffer.IndexBuffer.Release();
+	RenderBuffer.Batcher.Destroy();
 	RenderBuffer.SettingsUniform.Release();
+
+	for (auto &pool : Pools)
+	{
+		pool.Clear();
+	}
+
+	GPUSpawnPool.Clear();
+	MUGPUParticles::Clear();
 }
 
 void NParticles::Create(const NParticleData &data)
 {
+	++RequestedCount;
+
+#if ENABLE_PARTICLE_EMISSION_LOD == 1
+	const mu_uint32 type = static_cast<mu_uint32>(data.Type);
+	const NCamera *camera = MURenderState::GetCamera();
+	if (camera != nullptr && type < ParticleTypesCount)
+	{
+		// Far emitters keep a fraction of their particles, the kept ones are scaled up to cover a similar area
+		const mu_float distance = glm::distance(camera->GetEye(), data.Position);
+		if (distance > LodNearDistance)
+		{
+			const mu_float factor = glm::clamp((distance - LodNearDistance) / (LodFarDistance - LodNearDistance), 0.0f, 1.0f);
+			const mu_float emission = glm::mix(1.0f, LodMinimumEmission, factor);
+
+			auto &accumulator = EmissionAccumulator[type];
+			accumulator += emission;
+			if (accumulator < 1.0f) return;
+			accumulator -= 1.0f;
+
+			NParticleData lodData = data;
+			lodData.LodScale = 1.0f / glm::sqrt(emission);
+			PendingToCreate.push_back(lodData);
+			return;
+		}
+	}
+#endif
+
 	PendingToCreate.push_back(data);
 }
 
 void NParticles::Update()
 {
 	const auto updateCount = MUState::GetUpdateCount();
+	MUGPUParticles::Update(updateCount);
 
-	auto &registry = Registry;
 	for (mu_uint32 n = 0; n < updateCount; ++n)
 	{
 		using namespace TParticle;
 
 		// Life Time check
+		for (auto &pool : Pools)
 		{
-			const auto view = registry.view<
-				Entity::LifeTime
-			>();
-
-			for (auto [entity, lifetime] : view.each())
+			for (mu_uint32 index = 0; index < pool.Count;)
 			{
-				if (--lifetime > 0) continue;
-				registry.destroy(entity);
+				if (--pool.LifeTime[index] > 0)
+				{
+					++index;
+					continue;
+				}
+
+				pool.Remove(index);
 			}
 		}
 
-		auto view = registry.view<TParticle::Entity::Info>();
-		//auto startTimer = std::chrono::high_resolution_clock::now();
-
-#if ENABLE_PARTICLE_UPDATE_MULTITHREAD == 1
-		{
-			MUThreadsManager::Run(
-				std::unique_ptr<NThreadExecutorBase>(
-					new (std::nothrow) NThreadExecutorRangeIterator(
-						view.begin(), view.end(),
-						[&registry, &view](TParticle::EnttIterator begin, TParticle::EnttIterator end) {
-							ParticleType type = ParticleType::Invalid;
-							TParticle::Template *_template = nullptr;
-							for (auto iter = begin; iter != end;)
-							{
-								const auto &entity = *iter;
-								const auto &info = view.get<Entity::Info>(entity);
-								if (info.Type != type)
-								{
-									type = info.Type;
-									_template = TParticle::GetTemplate(type);
-								}
-								if (_template == nullptr) {
-									++iter;
-									continue;
-								}
-
-								iter = _template->Move(registry, view, iter, end);
-							}
-						}
-					)
-				)
-			);
-
-			MUThreadsManager::Run(
-				std::unique_ptr<NThreadExecutorBase>(
-					new (std::nothrow) NThreadExecutorRangeIterator(
-						view.begin(), view.end(),
-						[&registry, &view](TParticle::EnttIterator begin, TParticle::EnttIterator end) {
-							ParticleType type = ParticleType::Invalid;
-							TParticle::Template *_template = nullptr;
-							for (auto iter = begin; iter != end;)
-							{
-								const auto entity = *iter;
-								const auto &info = view.get<Entity::Info>(entity);
-								if (info.Type != type)
-								{
-									type = info.Type;
-									_template = TParticle::GetTemplate(type);
-								}
-								if (_template == nullptr) {
-									++iter;
-									continue;
-								}
-
-								iter = _template->Action(registry, view, iter, end);
-							}
-						}
-					)
-				)
-			);
-		}
-#else
+		auto &ranges = UpdateRanges;
+		ranges.clear();
+		for (mu_uint32 type = 0; type < ParticleTypesCount; ++type)
 		{
-			// Move
+			const auto &pool = Pools[type];
+			for (mu_uint32 begin = 0; begin < pool.Count; begin += UpdateChunkSize)
 			{
-				ParticleType type = ParticleType::Invalid;
-				TParticle::Template *_template = nullptr;
-
-				for (auto iter = view.begin(), last = view.end(); iter != last;)
-				{
-					const auto &entity = *iter;
-					const auto &info = view.get<Entity::Info>(entity);
-					if (info.Type != type)
-					{
-						type = info.Type;
-						_template = TParticle::GetTemplate(type);
+				ranges.push_back(
+					NParticleRange{
+						.Type = static_cast<ParticleType>(type),
+						.Layer = 0,
+						.Begin = begin,
+						.End = std::min(begin + UpdateChunkSize, pool.Count),
 					}
-					if (_template == nullptr) {
-						++iter;
-						continue;
-					}
-
-					iter = _template->Move(registry, view, iter, last);
-				}
+				);
 			}
+		}
 
-			// Action
-			{
-				ParticleType type = ParticleType::Invalid;
-				TParticle::Template *_template = nullptr;
+		//auto startTimer = std::chrono::high_resolution_clock::now();
 
-				for (auto iter = view.begin(), last = view.end(); iter != last;)
-				{
-					const auto &entity = *iter;
-					const auto &info = view.get<Entity::Info>(entity);
-					if (info.Type != type)
-					{
-						type = info.Type;
-						_template = TParticle::GetTemplate(type);
-					}
-					if (_template == nullptr) {
-						++iter;
-						continue;
-					}
+		auto &pools = Pools;
+		const auto updateRange = [&pools](const NParticleRange &range) {
+			auto *_template = TParticle::GetTemplate(range.Type);
+			if (_template == nullptr) return;
 
-					iter = _template->Action(registry, view, iter, last);
-				}
-			}
+			auto &pool = pools[static_cast<mu_uint32>(range.Type)];
+			_template->Move(pool, range.Begin, range.End);
+			Simulate(_template->GetBehavior(), pool, range.Begin, range.End);
+		};
+
+#if ENABLE_PARTICLE_UPDATE_MULTITHREAD == 1
+		MUThreadsManager::Run(
+			std::unique_ptr<NThreadExecutorBase>(
+				new (std::nothrow) NThreadExecutorIterator(
+					ranges.begin(), ranges.end(),
+					updateRange
+				)
+			)
+		);
+#else
+		for (const auto &range : ranges)
+		{
+			updateRange(range);
 		}
 #endif
 
 		//auto endTimer = std::chrono::high_resolution_clock::now();
 		//auto diff = std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(endTimer - startTimer);
-		//mu_info("[DEBUG] Particles Move : {}ms with {} elements", diff.count(), registry.size());
+		//mu_info("[DEBUG] Particles Move : {}ms with {} ranges", diff.count(), ranges.size());
 	}
 }
 
 void NParticles::Propagate()
 {
-	ParticleType type = ParticleType::Invalid;
-	TParticle::Template *_template = nullptr;
+	const mu_uint32 pendingCount = static_cast<mu_uint32>(PendingToCreate.size());
+	Statistics.Requested = RequestedCount;
+	Statistics.Emitted = pendingCount;
+	Statistics.Simulated = 0;
+	RequestedCount = 0;
+	if (pendingCount == 0) return;
+
+	// Counting sort by type, every template receives its whole batch at once
+	std::array<mu_uint32, ParticleTypesCount + 1> offsets = {};
+	for (const auto &data : PendingToCreate)
+	{
+		const mu_uint32 type = static_cast<mu_uint32>(data.Type);
+		if (type >= ParticleTypesCount) continue;
+		++offsets[type + 1];
+	}
 
-	std::sort(
-		PendingToCreate.begin(),
-		PendingToCreate.end(),
-		[](const NParticleData &lhs, const NParticleData &rhs) -> bool { return lhs.Type < rhs.Type; }
-	);
+	for (mu_uint32 type = 0; type < ParticleTypesCount; ++type)
+	{
+		offsets[type + 1] += offsets[type];
+	}
 
-	for (const auto &data : PendingToCreate)
+	SortedToCreate.resize(pendingCount);
 	{
-		if (data.Type != type)
+		auto writeOffsets = offsets;
+		for (const auto &data : PendingToCreate)
 		{
-			type = data.Type;
-			_template = TParticle::GetTemplate(type);
+			const mu_uint32 type = static_cast<mu_uint32>(data.Type);
+			if (type >= ParticleTypesCount) continue;
+			SortedToCreate[writeOffsets[type]++] = data;
 		}
-		if (_template == nullptr) continue;
-
-		_template->Create(Registry, data);
 	}
 
-	if (PendingToCreate.size() > 0)
+	for (mu_uint32 type = 0; type < ParticleTypesCount; ++type)
 	{
-		PendingToCreate.clear();
+		const mu_uint32 count = offsets[type + 1] - offsets[type];
+		if (count == 0) continue;
 
-		using namespace TParticle;
-		Registry.sort<Entity::Info>(
-			[](const Entity::Info &lhs, const Entity::Info &rhs) -> bool {
-				return Entity::GetSort(lhs) < Entity::GetSort(rhs);
-			}
-		);
+		auto *_template = TParticle::GetTemplate(static_cast<ParticleType>(type));
+		if (_template == nullptr) continue;
+
+		if (MUGPUParticles::IsSimulated(static_cast<ParticleType>(type)))
+		{
+			_template->Spawn(GPUSpawnPool, SortedToCreate.data() + offsets[type], count);
+			MUGPUParticles::Spawn(static_cast<ParticleType>(type), GPUSpawnPool);
+			Statistics.Simulated += GPUSpawnPool.Count;
+			GPUSpawnPool.Clear();
+			continue;
+		}
+
+		_template->Spawn(Pools[type], SortedToCreate.data() + offsets[type], count);
 	}
+
+	PendingToCreate.clear();
 }
 
 void NParticles::Render()
@@ -284,112 +322,169 @@ void NParticles::Render()
 
 	//auto startTimer = std::chrono::high_resolution_clock::now();
 	auto &groups = RenderBuffer.Groups;
+	auto &ranges = RenderRanges;
 
 	// Calculate
 	{
-		ParticleType type = ParticleType::Invalid;
-		mu_int32 group = -1;
-
-		mu_uint32 index = 0;
-		auto view = Registry.view<Entity::Info, Entity::RenderGroup, Entity::RenderIndex, Entity::RenderCount>();
-		for (auto iter = view.begin(); iter != view.end(); ++iter)
+		mu_uint32 layersCount = 0;
+		for (const auto &pool : Pools)
 		{
-			const auto entity = *iter;
-			auto [
-				info,
-				renderGroup,
-				renderIndex,
-				renderCount
-			] = view.get<
-				Entity::Info,
-				Entity::RenderGroup,
-				Entity::RenderIndex,
-				Entity::RenderCount
-			>(entity);
-
-			if (index + renderCount > MaxRenderCount) {
-				renderGroup = NInvalidUInt32;
-				continue;
-			}
+			layersCount = std::max(layersCount, pool.GetLayersCount());
+		}
 
-			if (type != info.Type)
+		// Layer buckets are already contiguous, iterating them by layer and then by type gives the render order,
+		// big buckets are split in chunks so the culling and render jobs are balanced between threads
+		ranges.clear();
+		mu_uint32 visibleOffset = 0;
+		for (mu_uint32 layer = 0; layer < layersCount; ++layer)
+		{
+			for (mu_uint32 type = 0; type < ParticleTypesCount; ++type)
 			{
-				groups.push_back(
-					NRenderGroup{
-						.Type = info.Type,
-						.Index = index,
-						.Count = 0,
-					}
-				);
-				++group;
-				type = info.Type;
-			}
-
-			auto &rgroup = groups[group];
-			rgroup.Count += renderCount;
+				const auto &pool = Pools[type];
+				const mu_uint32 begin = pool.GetLayerBegin(layer);
+				const mu_uint32 end = pool.GetLayerEnd(layer);
 
-			renderGroup = group;
-			renderIndex = index;
-			index += renderCount;
+				for (mu_uint32 chunk = begin; chunk < end; chunk += RenderChunkSize)
+				{
+					const mu_uint32 chunkEnd = std::min(chunk + RenderChunkSize, end);
+					ranges.push_back(
+						NParticleRange{
+							.Type = static_cast<ParticleType>(type),
+							.Layer = static_cast<mu_uint8>(layer),
+							.Begin = chunk,
+							.End = chunkEnd,
+							.VisibleOffset = visibleOffset,
+						}
+					);
+					visibleOffset += chunkEnd - chunk;
+				}
+			}
 		}
+
+		VisibleIndices.resize(visibleOffset);
 	}
 
-#if ENABLE_PARTICLE_RENDER_MULTITHREAD == 1
+	// Culling, only the particles which survive it generate vertices
 	{
-		auto &registry = Registry;
-		auto view = registry.view<Entity::Info>();
-		auto &renderBuffer = RenderBuffer;
+		const NCamera *camera = MURenderState::GetCamera();
+		auto &pools = Pools;
+		auto &cullingRadius = CullingRadius;
+		auto *visibleIndices = VisibleIndices.data();
+		const auto cullRange = [&pools, &cullingRadius, visibleIndices, camera](NParticleRange &range) {
+			const auto &pool = pools[static_cast<mu_uint32>(range.Type)];
+			auto *indices = visibleIndices + range.VisibleOffset;
+			mu_uint32 count = 0;
+
+#if ENABLE_PARTICLE_CULLING == 1
+			if (camera != nullptr)
+			{
+				const auto &frustum = *camera->GetFrustum();
+				const mu_float radius = cullingRadius[static_cast<mu_uint32>(range.Type)];
+				for (mu_uint32 index = range.Begin; index < range.End; ++index)
+				{
+					const auto &position = pool.Position[index];
+					const mu_float extent = radius * glm::max(pool.Scale[index], 1.0f);
+					const mu_boolean isVisible = Diligent::GetBoxVisibility(
+						frustum,
+						Diligent::BoundBox{
+							.Min = Diligent::float3(position.x - extent, position.z - extent, position.y - extent),
+							.Max = Diligent::float3(position.x + extent, position.z + extent, position.y + extent),
+						}
+					) != Diligent::BoxVisibility::Invisible;
+					if (isVisible == false) continue;
+					indices[count++] = index;
+				}
+
+				range.VisibleCount = count;
+				return;
+			}
+#endif
+
+			for (mu_uint32 index = range.Begin; index < range.End; ++index)
+			{
+				indices[count++] = index;
+			}
+			range.VisibleCount = count;
+		};
 
+#if ENABLE_PARTICLE_RENDER_MULTITHREAD == 1
 		MUThreadsManager::Run(
 			std::unique_ptr<NThreadExecutorBase>(
-				new (std::nothrow) NThreadExecutorRangeIterator(
-					view.begin(), view.end(),
-					[&registry, &view, &renderBuffer](TParticle::EnttIterator begin, TParticle::EnttIterator end) {
-						ParticleType type = ParticleType::Invalid;
-						TParticle::Template *_template = nullptr;
-						for (auto iter = begin; iter != end;)
-						{
-							const auto entity = *iter;
-							const auto &info = view.get<Entity::Info>(entity);
-							if (info.Type != type)
-							{
-								type = info.Type;
-								_template = TParticle::GetTemplate(type);
-							}
-							if (_template == nullptr) {
-								++iter;
-								continue;
-							}
-
-							iter = _template->Render(registry, view, iter, end, renderBuffer);
-						}
-					}
+				new (std::nothrow) NThreadExecutorIterator(
+					ranges.begin(), ranges.end(),
+					cullRange
 				)
 			)
 		);
-	}
 #else
-	{
-		auto view = Registry.view<Entity::Info>();
-		ParticleType type = ParticleType::Invalid;
-		TParticle::Template *_template = nullptr;
+		for (auto &range : ranges)
+		{
+			cullRange(range);
+		}
+#endif
+	}
 
-		for (auto iter = view.begin(), last = view.end(); iter != last;)
+	// Render indices are assigned in order once the visible count of every range is known
+	{
+		mu_uint32 index = 0;
+		mu_uint32 culledCount = 0;
+		for (auto &range : ranges)
 		{
-			const auto &entity = *iter;
-			const auto &info = view.get<Entity::Info>(entity);
-			if (info.Type != type)
+			culledCount += (range.End - range.Begin) - range.VisibleCount;
+			range.VisibleCount = std::min(range.VisibleCount, MaxRenderCount - index);
+			if (range.VisibleCount == 0) continue;
+
+			if (groups.empty() || groups.back().Type != range.Type)
 			{
-				type = info.Type;
-				_template = TParticle::GetTemplate(type);
-			}
-			if (_template == nullptr) {
-				++iter;
-				continue;
+				groups.push_back(
+					NRenderGroup{
+						.Type = range.Type,
+						.Index = index,
+						.Count = 0,
+					}
+				);
 			}
 
-			iter = _template->Render(Registry, view, iter, last, RenderBuffer);
+			groups.back().Count += range.VisibleCount;
+			range.RenderIndex = index;
+			index += range.VisibleCount;
 		}
+
+		Statistics.Rendered = index;
+		Statistics.Culled = culledCount;
+	}
+
+	auto &pools = Pools;
+	auto &renderBuffer = RenderBuffer;
+	const auto *visibleIndices = VisibleIndices.data();
+	const auto renderRange = [&pools, &renderBuffer, visibleIndices](const NParticleRange &range) {
+		if (range.VisibleCount == 0) return;
+
+		auto *_template = TParticle::GetTemplate(range.Type);
+		if (_template == nullptr) return;
+
+		_template->Render(pools[static_cast<mu_uint32>(range.Type)], visibleIndices + range.VisibleOffset, range.VisibleCount, range.RenderIndex, renderBuffer);
+
+		const auto texture = _template->GetRenderDescriptor().Texture;
+		if (texture != nullptr && texture->IsRegion())
+		{
+			TParticle::RemapUVs(renderBuffer, range.RenderIndex, range.VisibleCount, texture->GetUVRect());
+		}
+	};
+
+#if ENABLE_PARTICLE_RENDER_MULTITHREAD == 1
+	MUThreadsManager::Run(
+		std::unique_ptr<NThreadExecutorBase>(
+			new (std::nothrow) NThreadExecutorIterator(
+				ranges.begin(), ranges.end(),
+				renderRange
+			)
+		)
+	);
+#else
+	for (const auto &range : ranges)
+	{
+		renderRange(range);
 	}
 #endif
 
@@ -398,39 +493,58 @@ void NParticles::Render()
 	fixedState.RTVFormat = renderTargetDesc.ColorFormat;
 	fixedState.DSVFormat = renderTargetDesc.DepthStencilFormat;
 
-	// Render Groups
+	// Vertices of every group are uploaded at once, indices never change
+	if (groups.empty() == false)
+	{
+		const auto &lastGroup = groups.back();
+		const mu_uint32 verticesCount = (lastGroup.Index + lastGroup.Count) * 4;
+		const auto immediateContext = MUGraphics::GetImmediateContext();
+
+		Diligent::StateTransitionDesc copyBarriers[1] = {
+			Diligent::StateTransitionDesc(RenderBuffer.VertexBuffer, Diligent::RESOURCE_STATE_VERTEX_BUFFER, Diligent::RESOURCE_STATE_COPY_DEST, Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE),
+		};
+		immediateContext->TransitionResourceStates(mu_countof(copyBarriers), copyBarriers);
+
+		immediateContext->UpdateBuffer(
+			RenderBuffer.VertexBuffer,
+			0,
+			sizeof(NParticleVertex) * verticesCount,
+			RenderBuffer.Vertices.data(),
+			Diligent::RESOURCE_STATE_TRANSITION_MODE_NONE
+		);
+
+		Diligent::StateTransitionDesc vertexBarriers[1] = {
+			Diligent::StateTransitionDesc(RenderBuffer.VertexBuffer, Diligent::RESOURCE_STATE_COPY_DEST, Diligent::RESOURCE_STATE_VERTEX_BUFFER, Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE),
+		};
+		immediateContext->TransitionResourceStates(mu_countof(vertexBarriers), vertexBarriers);
+	}
+
+	// Render Groups, adjacent groups which share the same state are merged into a single draw
 	{
-		ParticleType type = ParticleType::Invalid;
-		TParticle::Template *_template = nullptr;
-		for (const auto renderGroup : RenderBuffer.Groups)
+		auto &batcher = RenderBuffer.Batcher;
+		if (batcher.Prepare(fixedState, RenderBuffer.SettingsUniform) == true)
 		{
-			if (renderGroup.Count == 0) continue;
-			if (renderGroup.Type != type)
+			for (const auto &renderGroup : RenderBuffer.Groups)
 			{
-				type = renderGroup.Type;
-				_template = TParticle::GetTemplate(type);
+				batcher.Push(static_cast<mu_uint32>(renderGroup.Type), renderGroup.Index, renderGroup.Count);
 			}
-			if (_template == nullptr) {
-				continue;
-			}
-			_template->RenderGroup(renderGroup, RenderBuffer);
 		}
-	}
 
-	if (RenderBuffer.RequireTransition == true)
-	{
-		const auto immediateContext = MUGraphics::GetImmediateContext();
-		Diligent::StateTransitionDesc updateBarriers[2] = {
-			Diligent::StateTransitionDesc(RenderBuffer.VertexBuffer, Diligent::RESOURCE_STATE_COPY_DEST, Diligent::RESOURCE_STATE_VERTEX_BUFFER, Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE),
-			Diligent::StateTransitionDesc(RenderBuffer.IndexBuffer, Diligent::RESOURCE_STATE_COPY_DEST, Diligent::RESOURCE_STATE_INDEX_BUFFER, Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE)
-		};
-		immediateContext->TransitionResourceStates(mu_countof(updateBarriers), updateBarriers);
-		RenderBuffer.RequireTransition = false;
+		batcher.Flush(
+			NBatchBuffers{
+				.VertexBuffer = RenderBuffer.VertexBuffer,
+				.IndexBuffer = RenderBuffer.IndexBuffer,
+				.IndexType = TParticle::QuadIndices::ValueType,
+			},
+			RenderBuffer.SettingsUniform
+		);
 	}
 
+	MUGPUParticles::Render();
+
 	//auto endTimer = std::chrono::high_resolution_clock::now();
 	//auto diff = std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(endTimer - startTimer);
-	//mu_info("[DEBUG] Particles Render : {}ms with {} elements", diff.count(), Registry.size());
+	//mu_info("[DEBUG] Particles Render : {}ms with {} ranges", diff.count(), ranges.size());
 
 	RenderBuffer.Groups.clear();
 }
\ No newline at end of file
@@ -5,6 +5,16 @@
 
 #include "t_particle_create.h"
 #include "t_particle_render.h"
+#include "t_particle_pool.h"
+
+struct NParticleStatistics
+{
+	mu_uint32 Requested = 0; // Particles requested since the previous propagation
+	mu_uint32 Emitted = 0; // Particles which passed the emission LOD
+	mu_uint32 Simulated = 0; // Emitted particles handed to the GPU backend
+	mu_uint32 Rendered = 0;
+	mu_uint32 Culled = 0;
+};
 
 class NParticles
 {
@@ -17,10 +27,30 @@ public:
 	void Propagate();
 	void Render();
 
+public:
+	NEXTMU_INLINE const NBatchStatistics &GetRenderStatistics() const
+	{
+		return RenderBuffer.Batcher.GetStatistics();
+	}
+
+	NEXTMU_INLINE const NParticleStatistics &GetStatistics() const
+	{
+		return Statistics;
+	}
+
 private:
-	entt::registry Registry;
+	std::array<TParticle::NParticlePool, ParticleTypesCount> Pools;
+	TParticle::NParticlePool GPUSpawnPool;
+	std::vector<TParticle::NParticleRange> UpdateRanges;
+	std::vector<TParticle::NParticleRange> RenderRanges;
+	std::vector<mu_uint32> VisibleIndices;
+	std::array<mu_float, ParticleTypesCount> CullingRadius = {};
+	std::array<mu_float, ParticleTypesCount> EmissionAccumulator = {};
 	TParticle::NRenderBuffer RenderBuffer;
 	std::vector<NParticleData> PendingToCreate;
+	std::vector<NParticleData> SortedToCreate;
+	mu_uint32 RequestedCount = 0;
+	NParticleStatistics Statistics;
 };
 
 #endif
\ No newline at end of file
@@ -37,6 +37,15 @@ const mu_boolean NEnvironment::LoadTerrain(mu_utf8string path)
 	auto terrain = std::make_unique<NTerrain>();
 	terrain->Id = document["id"].get<mu_utf8string>();
 
+	// Streamed textures used by the map are requested now so they are resident when the map is drawn
+	if (document.contains("prefetch_textures"))
+	{
+		for (const auto &textureId : document["prefetch_textures"])
+		{
+			MUResourcesManager::PrefetchTexture(textureId.get<mu_utf8string>());
+		}
+	}
+
 	const auto programId = document["program"].get<mu_utf8string>();
 	terrain->TerrainProgram = MUResourcesManager::GetProgram(programId);
 	if (terrain->TerrainProgram == NInvalidShader)
@@ -0,0 +1,791 @@
+#include "stdafx.h"
+#include "mu_gpuparticles.h"
+#include "mu_capabilities.h"
+#include "mu_config.h"
+#include "mu_graphics.h"
+#include "mu_renderstate.h"
+#include "mu_texturestreaming.h"
+#include "t_graphics_quadindices.h"
+#include "t_particle_base.h"
+#include <MapHelper.hpp>
+#include <ShaderMacroHelper.hpp>
+
+using namespace TParticle;
+
+#pragma pack(4)
+struct NGPUParticle
+{
+	glm::vec3 Position;
+	mu_float Scale;
+	glm::vec4 Light;
+	glm::vec3 Velocity;
+	mu_float Rotation;
+	mu_float Gravity;
+	mu_uint32 LifeTime; // Dead when zero
+	mu_uint32 Padding[2];
+};
+
+struct NGPUBehavior
+{
+	mu_float GravityAcceleration;
+	mu_uint32 ApplyGravity;
+	mu_float ScaleGrowth;
+	mu_uint32 ClampScale;
+	glm::vec3 VelocityDamping;
+	mu_float RotationMin;
+	mu_float RotationMax;
+	mu_uint32 LightMode;
+	mu_uint32 LightThreshold;
+	mu_float LightFactor;
+	mu_float LightFadeFactor;
+	mu_float LightDivisor;
+	mu_uint32 LightAlpha;
+	mu_uint32 Mode;
+	glm::vec2 HalfSize; // Billboard size when the scale is one
+	glm::vec4 UVRect; // Region of the texture when it is packed in an atlas
+	mu_uint32 Padding[2];
+};
+
+struct NGPUSimulationSettings
+{
+	mu_uint32 Ticks;
+	mu_uint32 Seed;
+	mu_uint32 ParticlesCount;
+	mu_uint32 Padding;
+};
+
+struct NGPUCameraSettings
+{
+	glm::mat4 View;
+	glm::mat4 Projection;
+};
+
+struct NGPUDrawSettings
+{
+	mu_uint32 Slot;
+	mu_float IsPremultipliedAlpha;
+	mu_uint32 Padding[2];
+};
+
+// Same layout as the arguments expected by DrawIndexedIndirect
+struct NGPUDrawArgs
+{
+	mu_uint32 IndicesCount;
+	mu_uint32 InstancesCount;
+	mu_uint32 FirstIndex;
+	mu_uint32 BaseVertex;
+	mu_uint32 FirstInstance;
+};
+#pragma pack()
+
+static_assert(sizeof(NGPUParticle) == 64);
+static_assert(sizeof(NGPUBehavior) == 96);
+static_assert(sizeof(NGPUDrawArgs) == 20);
+
+typedef NQuadIndices<MUGPUParticles::MaxParticlesPerType> GPUQuadIndices;
+constexpr mu_uint32 MaxPendingTicks = 32u;
+
+struct NGPUSimulatedType
+{
+	ParticleType Type;
+	NBatchDescriptor Descriptor;
+	NGPUDrawSettings DrawSettings;
+	mu_uint32 Cursor = 0; // Next ring slot written by a spawn
+	mu_boolean Active = false;
+};
+
+struct NGPUUpload
+{
+	mu_uint32 Offset;
+	mu_uint32 Count;
+	mu_uint32 StagingOffset;
+};
+
+/*
+	Executes the behavior kernels of t_particle_simulation.cpp over every ring, particles are simulated once per
+	update tick. Collect appends the alive particles of every ring with atomics, the first argument of every ring
+	draw is the indices count so the draws don't require any readback.
+*/
+static const mu_char *SimulationShaderSource = R"(
+cbuffer SimulationSettings
+{
+	uint Ticks;
+	uint Seed;
+	uint ParticlesCount;
+	uint Padding;
+};
+
+RWByteAddressBuffer g_Particles;
+ByteAddressBuffer g_Behaviors;
+RWByteAddressBuffer g_AliveIndices;
+RWByteAddressBuffer g_DrawArgs;
+
+uint Hash(uint value)
+{
+	value ^= value >> 16;
+	value *= 0x7FEB352Du;
+	value ^= value >> 15;
+	value *= 0x846CA68Bu;
+	value ^= value >> 16;
+	return value;
+}
+
+float Random(inout uint state)
+{
+	state = Hash(state);
+	return float(state & 0xFFFFFFu) / 16777216.0;
+}
+
+[numthreads(PARTICLES_THREADS_COUNT, 1, 1)]
+void Simulate(uint3 id : SV_DispatchThreadID)
+{
+	if (id.x >= ParticlesCount) return;
+
+	uint address = id.x * PARTICLE_STRIDE;
+	uint lifeTime = g_Particles.Load(address + 52);
+	if (lifeTime == 0) return;
+
+	uint behavior = (id.x / PARTICLES_PER_TYPE) * BEHAVIOR_STRIDE;
+	float gravityAcceleration = asfloat(g_Behaviors.Load(behavior));
+	uint applyGravity = g_Behaviors.Load(behavior + 4);
+	float scaleGrowth = asfloat(g_Behaviors.Load(behavior + 8));
+	uint clampScale = g_Behaviors.Load(behavior + 12);
+	float3 velocityDamping = asfloat(g_Behaviors.Load3(behavior + 16));
+	float2 rotationRange = asfloat(g_Behaviors.Load2(behavior + 28));
+	uint lightMode = g_Behaviors.Load(behavior + 36);
+	uint lightThreshold = g_Behaviors.Load(behavior + 40);
+	float3 lightFactors = asfloat(g_Behaviors.Load3(behavior + 44)); // Factor, fade factor and divisor
+	uint lightAlpha = g_Behaviors.Load(behavior + 56);
+
+	float4 positionScale = asfloat(g_Particles.Load4(address));
+	float4 light = asfloat(g_Particles.Load4(address + 16));
+	float4 velocityRotation = asfloat(g_Particles.Load4(address + 32));
+	float gravity = asfloat(g_Particles.Load(address + 48));
+	uint random = Hash(id.x ^ Seed);
+
+	for (uint tick = 0; tick < Ticks; ++tick)
+	{
+		if (--lifeTime == 0) break;
+
+		gravity += gravityAcceleration;
+		if (applyGravity != 0) positionScale.z += gravity;
+
+		velocityRotation.xyz *= velocityDamping;
+
+		positionScale.w += scaleGrowth;
+		if (clampScale != 0) positionScale.w = max(positionScale.w, 0.0);
+
+		velocityRotation.w += lerp(rotationRange.x, rotationRange.y, Random(random));
+
+		if (lightMode == LIGHT_MODE_MULTIPLY)
+		{
+			light *= lightFactors.x;
+		}
+		else if (lightMode == LIGHT_MODE_PULSE)
+		{
+			light *= lifeTime >= lightThreshold ? lightFactors.x : lightFactors.y;
+		}
+		else if (lightMode == LIGHT_MODE_LIFETIME)
+		{
+			float luminosity = float(lifeTime) * lightFactors.z;
+			light = lightAlpha != 0 ? luminosity.xxxx : float4(luminosity, luminosity, luminosity, 1.0);
+		}
+	}
+
+	g_Particles.Store4(address, asuint(positionScale));
+	g_Particles.Store4(address + 16, asuint(light));
+	g_Particles.Store4(address + 32, asuint(velocityRotation));
+	g_Particles.Store(address + 48, asuint(gravity));
+	g_Particles.Store(address + 52, lifeTime);
+}
+
+[numthreads(PARTICLES_THREADS_COUNT, 1, 1)]
+void Collect(uint3 id : SV_DispatchThreadID)
+{
+	if (id.x >= ParticlesCount) return;
+	if (g_Particles.Load(id.x * PARTICLE_STRIDE + 52) == 0) return;
+
+	uint slot = id.x / PARTICLES_PER_TYPE;
+	uint indicesCount;
+	g_DrawArgs.InterlockedAdd(slot * DRAW_ARGS_STRIDE, 6, indicesCount);
+	g_AliveIndices.Store((slot * PARTICLES_PER_TYPE + indicesCount / 6) * 4, id.x);
+}
+)";
+
+/*
+	Billboards are expanded from the vertex id, every quad reads its particle from the alive indices of the ring,
+	the result matches RenderBillboardSprite and RenderBillboardSpriteWithRotation.
+*/
+static const mu_char *ParticleVertexShaderSource = R"(
+cbuffer GPUParticlesCamera
+{
+	float4x4 View;
+	float4x4 Projection;
+};
+
+cbuffer GPUParticlesDraw
+{
+	uint Slot;
+	float IsPremultipliedAlpha;
+	uint2 Padding;
+};
+
+ByteAddressBuffer g_Particles;
+ByteAddressBuffer g_AliveIndices;
+ByteAddressBuffer g_Behaviors;
+
+struct VSOutput
+{
+	float4 Position : SV_POSITION;
+	float4 Color : COLOR0;
+	float2 UV : TEXCOORD0;
+};
+
+void main(in uint vertexId : SV_VertexID, out VSOutput output)
+{
+	uint corner = vertexId & 3;
+	uint index = g_AliveIndices.Load((Slot * PARTICLES_PER_TYPE + (vertexId >> 2)) * 4);
+	uint address = index * PARTICLE_STRIDE;
+	uint behavior = Slot * BEHAVIOR_STRIDE;
+
+	float4 positionScale = asfloat(g_Particles.Load4(address));
+	float4 light = asfloat(g_Particles.Load4(address + 16));
+	float rotation = asfloat(g_Particles.Load(address + 44));
+
+	float2 uv = float2(corner == 1 || corner == 2 ? 1.0 : 0.0, corner >= 2 ? 1.0 : 0.0);
+	float2 offset = (uv * 2.0 - 1.0) * asfloat(g_Behaviors.Load2(behavior + 64)) * positionScale.w;
+	if (g_Behaviors.Load(behavior + 60) == GPU_MODE_ROTATED_BILLBOARD)
+	{
+		float s, c;
+		sincos(radians(rotation), s, c);
+		offset = float2(offset.x * c + offset.y * s, offset.y * c - offset.x * s);
+	}
+
+	float4 viewPosition = mul(View, float4(positionScale.xzy, 1.0));
+	viewPosition.xy += offset;
+
+	output.Position = mul(Projection, viewPosition);
+	output.Color = light;
+	float4 uvRect = asfloat(g_Behaviors.Load4(behavior + 72));
+	output.UV = lerp(uvRect.xy, uvRect.zw, uv);
+}
+)";
+
+static const mu_char *ParticlePixelShaderSource = R"(
+cbuffer GPUParticlesDraw
+{
+	uint Slot;
+	float IsPremultipliedAlpha;
+	uint2 Padding;
+};
+
+Texture2D g_Texture;
+SamplerState g_Texture_sampler;
+
+struct PSInput
+{
+	float4 Position : SV_POSITION;
+	float4 Color : COLOR0;
+	float2 UV : TEXCOORD0;
+};
+
+float4 main(in PSInput input) : SV_TARGET
+{
+	float4 color = g_Texture.Sample(g_Texture_sampler, input.UV) * input.Color;
+	if (IsPremultipliedAlpha > 0.0) color.rgb *= color.a;
+	return color;
+}
+)";
+
+namespace MUGPUParticles
+{
+	mu_boolean Enabled = false;
+	mu_shader Program = NInvalidShader;
+	Diligent::RefCntAutoPtr<Diligent::IBuffer> ParticlesBuffer;
+	Diligent::RefCntAutoPtr<Diligent::IBuffer> BehaviorsBuffer;
+	Diligent::RefCntAutoPtr<Diligent::IBuffer> AliveBuffer;
+	Diligent::RefCntAutoPtr<Diligent::IBuffer> DrawArgsBuffer;
+	Diligent::RefCntAutoPtr<Diligent::IBuffer> IndexBuffer;
+	Diligent::RefCntAutoPtr<Diligent::IBuffer> SimulationUniform;
+	Diligent::RefCntAutoPtr<Diligent::IBuffer> CameraUniform;
+	Diligent::RefCntAutoPtr<Diligent::IBuffer> DrawUniform;
+	Diligent::RefCntAutoPtr<Diligent::IPipelineState> SimulatePipeline;
+	Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding> SimulateBinding;
+	Diligent::RefCntAutoPtr<Diligent::IPipelineState> CollectPipeline;
+	Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding> CollectBinding;
+
+	std::vector<NGPUSimulatedType> SimulatedTypes;
+	std::array<mu_uint32, ParticleTypesCount> SlotByType;
+	std::array<NGPUDrawArgs, MaxSimulatedTypes> DrawArgs;
+	std::vector<NGPUParticle> Staging;
+	std::vector<NGPUUpload> Uploads;
+	mu_uint32 PendingTicks = 0;
+	mu_uint32 Seed = 0;
+
+	void ConfigureMacros(Diligent::ShaderMacroHelper &macros)
+	{
+		macros.AddShaderMacro("PARTICLES_THREADS_COUNT", ParticlesThreadsCount);
+		macros.AddShaderMacro("PARTICLES_PER_TYPE", MaxParticlesPerType);
+		macros.AddShaderMacro("PARTICLE_STRIDE", static_cast<mu_uint32>(sizeof(NGPUParticle)));
+		macros.AddShaderMacro("BEHAVIOR_STRIDE", static_cast<mu_uint32>(sizeof(NGPUBehavior)));
+		macros.AddShaderMacro("DRAW_ARGS_STRIDE", static_cast<mu_uint32>(sizeof(NGPUDrawArgs)));
+		macros.AddShaderMacro("LIGHT_MODE_MULTIPLY", static_cast<mu_uint32>(NParticleLightMode::Multiply));
+		macros.AddShaderMacro("LIGHT_MODE_PULSE", static_cast<mu_uint32>(NParticleLightMode::Pulse));
+		macros.AddShaderMacro("LIGHT_MODE_LIFETIME", static_cast<mu_uint32>(NParticleLightMode::LifeTime));
+		macros.AddShaderMacro("GPU_MODE_ROTATED_BILLBOARD", static_cast<mu_uint32>(NParticleGPUMode::RotatedBillboard));
+	}
+
+	Diligent::RefCntAutoPtr<Diligent::IShader> CreateShader(const mu_char *name, const Diligent::SHADER_TYPE type, const mu_char *entryPoint, const mu_char *source, Diligent::ShaderMacroHelper &macros)
+	{
+		Diligent::ShaderCreateInfo createInfo;
+#if NEXTMU_COMPILE_DEBUG == 1
+		createInfo.Desc.Name = name;
+#endif
+		createInfo.SourceLanguage = Diligent::SHADER_SOURCE_LANGUAGE_HLSL;
+		createInfo.Desc.ShaderType = type;
+		createInfo.Desc.UseCombinedTextureSamplers = true;
+		createInfo.EntryPoint = entryPoint;
+		createInfo.Source = source;
+		createInfo.Macros = macros;
+
+		Diligent::RefCntAutoPtr<Diligent::IShader> shader;
+		MUGraphics::GetDevice()->CreateShader(createInfo, &shader);
+		return shader;
+	}
+
+	Diligent::RefCntAutoPtr<Diligent::IBuffer> CreateBuffer(const mu_char *name, const Diligent::USAGE usage, const Diligent::BIND_FLAGS bindFlags, const Diligent::BUFFER_MODE mode, const mu_uint64 size)
+	{
+		Diligent::BufferDesc bufferDesc;
+#if NEXTMU_COMPILE_DEBUG == 1
+		bufferDesc.Name = name;
+#endif
+		bufferDesc.Usage = usage;
+		bufferDesc.BindFlags = bindFlags;
+		bufferDesc.Mode = mode;
+		bufferDesc.Size = size;
+		if (usage == Diligent::USAGE_DYNAMIC)
+		{
+			bufferDesc.CPUAccessFlags = Diligent::CPU_ACCESS_WRITE;
+		}
+
+		Diligent::RefCntAutoPtr<Diligent::IBuffer> buffer;
+		MUGraphics::GetDevice()->CreateBuffer(bufferDesc, nullptr, &buffer);
+		return buffer;
+	}
+
+	const mu_boolean CreateComputePipeline(const mu_char *name, Diligent::IShader *shader, Diligent::RefCntAutoPtr<Diligent::IPipelineState> &pipeline, Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding> &binding)
+	{
+		Diligent::ComputePipelineStateCreateInfo pipelineInfo;
+#if NEXTMU_COMPILE_DEBUG == 1
+		pipelineInfo.PSODesc.Name = name;
+#endif
+		pipelineInfo.PSODesc.PipelineType = Diligent::PIPELINE_TYPE_COMPUTE;
+		pipelineInfo.PSODesc.ResourceLayout.DefaultVariableType = Diligent::SHADER_RESOURCE_VARIABLE_TYPE_STATIC;
+		pipelineInfo.pCS = shader;
+
+		MUGraphics::GetDevice()->CreateComputePipelineState(pipelineInfo, &pipeline);
+		if (pipeline == nullptr)
+		{
+			return false;
+		}
+
+		// Every entry point only references part of the resources
+		const auto setVariable = [&pipeline](const mu_char *variableName, Diligent::IDeviceObject *object) {
+			auto variable = pipeline->GetStaticVariableByName(Diligent::SHADER_TYPE_COMPUTE, variableName);
+			if (variable) variable->Set(object);
+		};
+		setVariable("SimulationSettings", SimulationUniform);
+		setVariable("g_Particles", ParticlesBuffer->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS));
+		setVariable("g_Behaviors", BehaviorsBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE));
+		setVariable("g_AliveIndices", AliveBuffer->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS));
+		setVariable("g_DrawArgs", DrawArgsBuffer->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS));
+
+		pipeline->CreateShaderResourceBinding(&binding, true);
+		return binding != nullptr;
+	}
+
+	const mu_boolean Initialize()
+	{
+		/*
+			GPU particles use the same raw buffers as the skinning cache, they aren't available with our OpenGL backend.
+		*/
+		Enabled = (
+			MUConfig::GetGPUParticles() &&
+			MUCapabilities::IsComputeShaderSupported() &&
+			MUCapabilities::IsRawBufferSupported()
+		);
+		SlotByType.fill(NInvalidUInt32);
+		if (Enabled == false) return true;
+
+		constexpr mu_uint32 MaxParticles = MaxSimulatedTypes * MaxParticlesPerType;
+		ParticlesBuffer = CreateBuffer("GPU Particles Buffer", Diligent::USAGE_DEFAULT, Diligent::BIND_SHADER_RESOURCE | Diligent::BIND_UNORDERED_ACCESS, Diligent::BUFFER_MODE_RAW, MaxParticles * sizeof(NGPUParticle));
+		BehaviorsBuffer = CreateBuffer("GPU Particles Behaviors", Diligent::USAGE_DEFAULT, Diligent::BIND_SHADER_RESOURCE, Diligent::BUFFER_MODE_RAW, MaxSimulatedTypes * sizeof(NGPUBehavior));
+		AliveBuffer = CreateBuffer("GPU Particles Alive Indices", Diligent::USAGE_DEFAULT, Diligent::BIND_SHADER_RESOURCE | Diligent::BIND_UNORDERED_ACCESS, Diligent::BUFFER_MODE_RAW, MaxParticles * sizeof(mu_uint32));
+		DrawArgsBuffer = CreateBuffer("GPU Particles Draw Arguments", Diligent::USAGE_DEFAULT, Diligent::BIND_UNORDERED_ACCESS | Diligent::BIND_INDIRECT_DRAW_ARGS, Diligent::BUFFER_MODE_RAW, MaxSimulatedTypes * sizeof(NGPUDrawArgs));
+		SimulationUniform = CreateBuffer("GPU Particles Simulation Settings", Diligent::USAGE_DYNAMIC, Diligent::BIND_UNIFORM_BUFFER, Diligent::BUFFER_MODE_UNDEFINED, sizeof(NGPUSimulationSettings));
+		CameraUniform = CreateBuffer("GPU Particles Camera Settings", Diligent::USAGE_DYNAMIC, Diligent::BIND_UNIFORM_BUFFER, Diligent::BUFFER_MODE_UNDEFINED, sizeof(NGPUCameraSettings));
+		DrawUniform = CreateBuffer("GPU Particles Draw Settings", Diligent::USAGE_DYNAMIC, Diligent::BIND_UNIFORM_BUFFER, Diligent::BUFFER_MODE_UNDEFINED, sizeof(NGPUDrawSettings));
+		IndexBuffer = CreateQuadIndexBuffer<MaxParticlesPerType>();
+		if (
+			ParticlesBuffer == nullptr ||
+			BehaviorsBuffer == nullptr ||
+			AliveBuffer == nullptr ||
+			DrawArgsBuffer == nullptr ||
+			SimulationUniform == nullptr ||
+			CameraUniform == nullptr ||
+			DrawUniform == nullptr ||
+			IndexBuffer == nullptr
+		)
+		{
+			return false;
+		}
+
+		Diligent::ShaderMacroHelper macros;
+		ConfigureMacros(macros);
+
+		// Simulation
+		{
+			auto simulateShader = CreateShader("GPU Particles Simulate Shader", Diligent::SHADER_TYPE_COMPUTE, "Simulate", SimulationShaderSource, macros);
+			auto collectShader = CreateShader("GPU Particles Collect Shader", Diligent::SHADER_TYPE_COMPUTE, "Collect", SimulationShaderSource, macros);
+			if (simulateShader == nullptr || collectShader == nullptr)
+			{
+				return false;
+			}
+
+			if (
+				CreateComputePipeline("GPU Particles Simulate Pipeline", simulateShader, SimulatePipeline, SimulateBinding) == false ||
+				CreateComputePipeline("GPU Particles Collect Pipeline", collectShader, CollectPipeline, CollectBinding) == false
+			)
+			{
+				return false;
+			}
+		}
+
+		// Render Program, pipelines are created by the pipeline cache with the dynamic state of every template
+		{
+			auto vertexShader = CreateShader("GPU Particles Vertex Shader", Diligent::SHADER_TYPE_VERTEX, "main", ParticleVertexShaderSource, macros);
+			auto pixelShader = CreateShader("GPU Particles Pixel Shader", Diligent::SHADER_TYPE_PIXEL, "main", ParticlePixelShaderSource, macros);
+			if (vertexShader == nullptr || pixelShader == nullptr)
+			{
+				return false;
+			}
+
+			NCombinedShader shader;
+			shader.Vertex = vertexShader;
+			shader.Pixel = pixelShader;
+			shader.Resource = GetPipelineResource("gpuparticle");
+			Program = RegisterShader(shader);
+		}
+
+		return true;
+	}
+
+	void Destroy()
+	{
+		Clear();
+		CollectBinding.Release();
+		CollectPipeline.Release();
+		SimulateBinding.Release();
+		SimulatePipeline.Release();
+		DrawUniform.Release();
+		CameraUniform.Release();
+		SimulationUniform.Release();
+		IndexBuffer.Release();
+		DrawArgsBuffer.Release();
+		AliveBuffer.Release();
+		BehaviorsBuffer.Release();
+		ParticlesBuffer.Release();
+		Program = NInvalidShader;
+	}
+
+	const mu_boolean IsEnabled()
+	{
+		return Enabled;
+	}
+
+	const mu_boolean Configure()
+	{
+		Clear();
+		if (Enabled == false) return true;
+
+		std::vector<NGPUBehavior> behaviors;
+		for (mu_uint32 type = 0; type < ParticleTypesCount && SimulatedTypes.size() < MaxSimulatedTypes; ++type)
+		{
+			auto *_template = TParticle::GetTemplate(static_cast<ParticleType>(type));
+			if (_template == nullptr || _template->GetGPUMode() == NParticleGPUMode::None) continue;
+
+			// Terrain and frames kernels aren't implemented by the simulation shader
+			const auto &behavior = _template->GetBehavior();
+			const auto &descriptor = _template->GetRenderDescriptor();
+			if (descriptor.Texture == nullptr || descriptor.IsLinear || behavior.FollowTerrain || behavior.FramesCount > 0) continue;
+
+			const mu_uint32 slot = static_cast<mu_uint32>(SimulatedTypes.size());
+			SlotByType[type] = slot;
+			SimulatedTypes.push_back(
+				NGPUSimulatedType{
+					.Type = static_cast<ParticleType>(type),
+					.Descriptor = descriptor,
+					.DrawSettings = NGPUDrawSettings{
+						.Slot = slot,
+						.IsPremultipliedAlpha = static_cast<mu_float>(descriptor.IsPremultipliedAlpha),
+					},
+				}
+			);
+
+			behaviors.push_back(
+				NGPUBehavior{
+					.GravityAcceleration = behavior.GravityAcceleration,
+					.ApplyGravity = behavior.ApplyGravity,
+					.ScaleGrowth = behavior.ScaleGrowth,
+					.ClampScale = behavior.ClampScale,
+					.VelocityDamping = behavior.VelocityDamping,
+					.RotationMin = behavior.RotationMin,
+					.RotationMax = behavior.RotationMax,
+					.LightMode = static_cast<mu_uint32>(behavior.LightMode),
+					.LightThreshold = behavior.LightThreshold,
+					.LightFactor = behavior.LightFactor,
+					.LightFadeFactor = behavior.LightFadeFactor,
+					.LightDivisor = behavior.LightDivisor,
+					.LightAlpha = behavior.LightAlpha,
+					.Mode = static_cast<mu_uint32>(_template->GetGPUMode()),
+					.HalfSize = glm::vec2(
+						static_cast<mu_float>(descriptor.Texture->GetWidth()) * 0.5f,
+						static_cast<mu_float>(descriptor.Texture->GetHeight()) * 0.5f
+					),
+					.UVRect = descriptor.Texture->GetUVRect(),
+				}
+			);
+		}
+
+		if (SimulatedTypes.empty()) return true;
+
+		// Rings of a previous environment are killed by resetting their life time
+		const auto immediateContext = MUGraphics::GetImmediateContext();
+		const std::vector<NGPUParticle> deadParticles(SimulatedTypes.size() * MaxParticlesPerType, NGPUParticle{});
+		immediateContext->UpdateBuffer(ParticlesBuffer, 0, sizeof(NGPUParticle) * deadParticles.size(), deadParticles.data(), Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+		immediateContext->UpdateBuffer(BehaviorsBuffer, 0, sizeof(NGPUBehavior) * behaviors.size(), behaviors.data(), Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+		return true;
+	}
+
+	void Clear()
+	{
+		SimulatedTypes.clear();
+		SlotByType.fill(NInvalidUInt32);
+		Staging.clear();
+		Uploads.clear();
+		PendingTicks = 0;
+	}
+
+	const mu_boolean IsSimulated(const ParticleType type)
+	{
+		const mu_uint32 index = static_cast<mu_uint32>(type);
+		return index < ParticleTypesCount && SlotByType[index] != NInvalidUInt32;
+	}
+
+	void Spawn(const ParticleType type, const NParticlePool &pool)
+	{
+		const mu_uint32 slot = SlotByType[static_cast<mu_uint32>(type)];
+		auto &simulatedType = SimulatedTypes[slot];
+		const mu_uint32 count = pool.Count;
+
+		// Only the last ring worth of particles survives a bigger batch
+		mu_uint32 index = count > MaxParticlesPerType ? count - MaxParticlesPerType : 0u;
+		simulatedType.Active = simulatedType.Active || count > 0;
+
+		while (index < count)
+		{
+			const mu_uint32 cursor = simulatedType.Cursor;
+			const mu_uint32 chunk = std::min(count - index, MaxParticlesPerType - cursor);
+
+			Uploads.push_back(
+				NGPUUpload{
+					.Offset = slot * MaxParticlesPerType + cursor,
+					.Count = chunk,
+					.StagingOffset = static_cast<mu_uint32>(Staging.size()),
+				}
+			);
+
+			for (mu_uint32 end = index + chunk; index < end; ++index)
+			{
+				Staging.push_back(
+					NGPUParticle{
+						.Position = pool.Position[index],
+						.Scale = pool.Scale[index],
+						.Light = pool.Light[index],
+						.Velocity = pool.Velocity[index],
+						.Rotation = pool.Rotation[index],
+						.Gravity = pool.Gravity[index],
+						.LifeTime = pool.LifeTime[index],
+					}
+				);
+			}
+
+			simulatedType.Cursor = (cursor + chunk) % MaxParticlesPerType;
+		}
+	}
+
+	void Update(const mu_uint32 ticks)
+	{
+		PendingTicks = std::min(PendingTicks + ticks, MaxPendingTicks);
+	}
+
+	void Render()
+	{
+		if (SimulatedTypes.empty()) return;
+
+		const auto renderManager = MUGraphics::GetRenderManager();
+		const auto &renderTargetDesc = MUGraphics::GetRenderTargetDesc();
+		const NFixedPipelineState fixedState = {
+			.CombinedShader = Program,
+			.RTVFormat = renderTargetDesc.ColorFormat,
+			.DSVFormat = renderTargetDesc.DepthStencilFormat,
+		};
+
+		for (auto &simulatedType : SimulatedTypes)
+		{
+			if (simulatedType.Active == false) continue;
+
+			const auto &descriptor = simulatedType.Descriptor;
+			auto pipelineState = GetPipelineState(fixedState, descriptor.DynamicPipelineState);
+			if (pipelineState == nullptr) continue;
+
+			if (pipelineState->StaticInitialized == false)
+			{
+				auto pipeline = pipelineState->Pipeline;
+				pipeline->GetStaticVariableByName(Diligent::SHADER_TYPE_VERTEX, "GPUParticlesCamera")->Set(CameraUniform);
+				pipeline->GetStaticVariableByName(Diligent::SHADER_TYPE_VERTEX, "GPUParticlesDraw")->Set(DrawUniform);
+				pipeline->GetStaticVariableByName(Diligent::SHADER_TYPE_PIXEL, "GPUParticlesDraw")->Set(DrawUniform);
+				pipeline->GetStaticVariableByName(Diligent::SHADER_TYPE_VERTEX, "g_Particles")->Set(ParticlesBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE));
+				pipeline->GetStaticVariableByName(Diligent::SHADER_TYPE_VERTEX, "g_AliveIndices")->Set(AliveBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE));
+				pipeline->GetStaticVariableByName(Diligent::SHADER_TYPE_VERTEX, "g_Behaviors")->Set(BehaviorsBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE));
+				pipelineState->StaticInitialized = true;
+			}
+
+			auto texture = descriptor.Texture;
+			MUTextureStreaming::Touch(texture);
+			NResourceId resourceIds[1] = { texture->GetId() };
+			auto binding = ShaderResourcesBindingManager.GetShaderBinding(pipelineState->Id, pipelineState->Pipeline, mu_countof(resourceIds), resourceIds);
+			if (binding == nullptr) continue;
+
+			if (binding->Initialized == false)
+			{
+				binding->Binding->GetVariableByName(Diligent::SHADER_TYPE_PIXEL, "g_Texture")->Set(texture->GetTexture()->GetDefaultView(Diligent::TEXTURE_VIEW_SHADER_RESOURCE));
+				binding->Initialized = true;
+			}
+
+			renderManager->UpdateBufferWithMap(
+				RUpdateBufferWithMap{
+					.ShouldReleaseMemory = false,
+					.Buffer = DrawUniform,
+					.Data = &simulatedType.DrawSettings,
+					.Size = sizeof(NGPUDrawSettings),
+					.MapType = Diligent::MAP_WRITE,
+					.MapFlags = Diligent::MAP_FLAG_DISCARD,
+				}
+			);
+
+			renderManager->SetPipelineState(pipelineState);
+			renderManager->SetIndexBuffer(
+				RSetIndexBuffer{
+					.IndexBuffer = IndexBuffer,
+					.ByteOffset = 0,
+					.StateTransitionMode = Diligent::RESOURCE_STATE_TRANSITION_MODE_VERIFY,
+				}
+			);
+			renderManager->CommitShaderResources(
+				RCommitShaderResources{
+					.ShaderResourceBinding = binding,
+				}
+			);
+
+			Diligent::DrawIndexedIndirectAttribs attribs;
+			attribs.pAttribsBuffer = DrawArgsBuffer;
+			attribs.DrawArgsOffset = sizeof(NGPUDrawArgs) * simulatedType.DrawSettings.Slot;
+			attribs.IndexType = GPUQuadIndices::ValueType;
+			attribs.Flags = Diligent::DRAW_FLAG_VERIFY_ALL;
+			attribs.AttribsBufferStateTransitionMode = Diligent::RESOURCE_STATE_TRANSITION_MODE_VERIFY;
+
+			renderManager->DrawIndexedIndirect(
+				RDrawIndexedIndirect{
+					.Attribs = attribs,
+				},
+				RCommandListInfo{
+					.Type = NDrawOrderType::Classifier,
+					.Classify = descriptor.Classify,
+					.View = 0,
+					.Index = descriptor.ListIndex,
+				}
+			);
+		}
+	}
+
+	void Dispatch(Diligent::IDeviceContext *immediateContext)
+	{
+		if (SimulatedTypes.empty()) return;
+
+		const mu_uint32 particlesCount = static_cast<mu_uint32>(SimulatedTypes.size()) * MaxParticlesPerType;
+		const mu_uint32 groupsCount = (particlesCount + ParticlesThreadsCount - 1) / ParticlesThreadsCount;
+
+		// Dynamic buffers have to be mapped every frame they are used
+		{
+			Diligent::MapHelper<NGPUSimulationSettings> uniform(immediateContext, SimulationUniform, Diligent::MAP_WRITE, Diligent::MAP_FLAG_DISCARD);
+			uniform->Ticks = PendingTicks;
+			uniform->Seed = Seed++;
+			uniform->ParticlesCount = particlesCount;
+			uniform->Padding = 0;
+		}
+
+		{
+			Diligent::MapHelper<NGPUCameraSettings> uniform(immediateContext, CameraUniform, Diligent::MAP_WRITE, Diligent::MAP_FLAG_DISCARD);
+			uniform->View = MURenderState::GetView();
+			uniform->Projection = MURenderState::GetProjection();
+		}
+
+		// Particles spawned this frame aren't simulated until the next update, same as the CPU particles
+		if (PendingTicks > 0)
+		{
+			immediateContext->SetPipelineState(SimulatePipeline);
+			immediateContext->CommitShaderResources(SimulateBinding, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+			immediateContext->DispatchCompute(Diligent::DispatchComputeAttribs(groupsCount, 1, 1));
+			PendingTicks = 0;
+		}
+
+		for (const auto &upload : Uploads)
+		{
+			immediateContext->UpdateBuffer(
+				ParticlesBuffer,
+				sizeof(NGPUParticle) * upload.Offset,
+				sizeof(NGPUParticle) * upload.Count,
+				Staging.data() + upload.StagingOffset,
+				Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION
+			);
+		}
+		Uploads.clear();
+		Staging.clear();
+
+		// Indices count of every ring starts at zero and is increased by the collect pass
+		for (mu_uint32 n = 0; n < static_cast<mu_uint32>(SimulatedTypes.size()); ++n)
+		{
+			DrawArgs[n] = NGPUDrawArgs{ .IndicesCount = 0, .InstancesCount = 1, .FirstIndex = 0, .BaseVertex = 0, .FirstInstance = 0 };
+		}
+		immediateContext->UpdateBuffer(DrawArgsBuffer, 0, sizeof(NGPUDrawArgs) * SimulatedTypes.size(), DrawArgs.data(), Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+		// Collect reads the particles written by the simulation
+		Diligent::StateTransitionDesc uavBarriers[1] = {
+			Diligent::StateTransitionDesc(ParticlesBuffer, Diligent::RESOURCE_STATE_UNKNOWN, Diligent::RESOURCE_STATE_UNORDERED_ACCESS, Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE),
+		};
+		immediateContext->TransitionResourceStates(mu_countof(uavBarriers), uavBarriers);
+
+		immediateContext->SetPipelineState(CollectPipeline);
+		immediateContext->CommitShaderResources(CollectBinding, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+		immediateContext->DispatchCompute(Diligent::DispatchComputeAttribs(groupsCount, 1, 1));
+
+		Diligent::StateTransitionDesc renderBarriers[3] = {
+			Diligent::StateTransitionDesc(ParticlesBuffer, Diligent::RESOURCE_STATE_UNKNOWN, Diligent::RESOURCE_STATE_SHADER_RESOURCE, Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE),
+			Diligent::StateTransitionDesc(AliveBuffer, Diligent::RESOURCE_STATE_UNKNOWN, Diligent::RESOURCE_STATE_SHADER_RESOURCE, Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE),
+			Diligent::StateTransitionDesc(DrawArgsBuffer, Diligent::RESOURCE_STATE_UNKNOWN, Diligent::RESOURCE_STATE_INDIRECT_ARGUMENT, Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE),
+		};
+		immediateContext->TransitionResourceStates(mu_countof(renderBarriers), renderBarriers);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#ifndef __MU_GPUPARTICLES_H__
+#define __MU_GPUPARTICLES_H__
+
+#pragma once
+
+#include "t_particle_enum.h"
+
+namespace TParticle
+{
+	class NParticlePool;
+}
+
+namespace MUGPUParticles
+{
+	/*
+		Particles of every GPU compatible template live in a ring of MaxParticlesPerType slots, when the ring is
+		full the oldest particles are overwritten. 16 rings of 16K particles consume around 17MB of video memory.
+	*/
+	constexpr mu_uint32 MaxParticlesPerType = 16384u;
+	constexpr mu_uint32 MaxSimulatedTypes = 16u;
+	constexpr mu_uint32 ParticlesThreadsCount = 64u;
+
+	const mu_boolean Initialize();
+	void Destroy();
+
+	const mu_boolean IsEnabled();
+
+	// Assigns a ring to every GPU compatible template and uploads their behaviors, templates must be initialized
+	const mu_boolean Configure();
+	void Clear();
+
+	const mu_boolean IsSimulated(const ParticleType type);
+	// Queues the upload of the pool particles, the pool is used as a staging area for the template Create
+	void Spawn(const ParticleType type, const TParticle::NParticlePool &pool);
+	void Update(const mu_uint32 ticks);
+	void Render();
+	void Dispatch(Diligent::IDeviceContext *immediateContext);
+}
+
+#endif
\ No newline at end of file
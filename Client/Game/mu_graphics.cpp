@@ -355,6 +355,16 @@ namespace MUGraphics
         }
     }
 
+    const mu_boolean InitializeResources()
+    {
+        RenderManager.reset(new (std::nothrow) NRenderManager());
+        CreateInputLayouts();
+        CreatePipelineResources();
+        FreeImage_Initialise(true);
+
+        return true;
+    }
+
     const mu_boolean Initialize()
     {
         auto *sdlWindow = MUWindow::GetWindow();
@@ -430,12 +440,44 @@ namespace MUGraphics
             swapchainDesc.ColorBufferFormat == Diligent::TEX_FORMAT_BGRA8_UNORM_SRGB
         );
 
-        RenderManager.reset(new (std::nothrow) NRenderManager());
-        CreateInputLayouts();
-        CreatePipelineResources();
-        FreeImage_Initialise(true);
+        return InitializeResources();
+    }
 
-        return true;
+    const mu_boolean InitializeHeadless()
+    {
+        // Diligent has no null device, the software adapter (WARP) is the closest one available on every machine
+        AdapterType = Diligent::ADAPTER_TYPE_SOFTWARE;
+
+        const Diligent::RENDER_DEVICE_TYPE deviceTypes[] = {
+#if NEXTMU_OPERATING_SYSTEM == NEXTMU_OS_WINDOWS
+            Diligent::RENDER_DEVICE_TYPE_D3D12,
+            Diligent::RENDER_DEVICE_TYPE_D3D11,
+#endif
+#if NEXTMU_OPERATING_SYSTEM == NEXTMU_OS_WINDOWS || NEXTMU_OPERATING_SYSTEM == NEXTMU_OS_LINUX || NEXTMU_OPERATING_SYSTEM == NEXTMU_OS_ANDROID
+            Diligent::RENDER_DEVICE_TYPE_VULKAN,
+#endif
+        };
+        mu_boolean initialized = false;
+        for (mu_uint32 n = 0; n < mu_countof(deviceTypes); ++n)
+        {
+            DeviceType = deviceTypes[n];
+            if (InitializeEngine(nullptr) == true)
+            {
+                initialized = true;
+                break;
+            }
+        }
+        if (initialized == false)
+        {
+            return false;
+        }
+
+        // There isn't a swap chain, the programs are created for the formats the swap chain would use
+        RenderTargetDesc.ColorFormat = DesiredColorFormat;
+        RenderTargetDesc.DepthStencilFormat = Diligent::TEX_FORMAT_D32_FLOAT_S8X24_UINT;
+        SwapchainsRGB = true;
+
+        return InitializeResources();
     }
 
     void Destroy()
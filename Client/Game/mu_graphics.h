@@ -8,6 +8,8 @@
 namespace MUGraphics
 {
 	const mu_boolean Initialize();
+	// Creates a device on the software adapter without a window or a swap chain, used to benchmark the resources loading
+	const mu_boolean InitializeHeadless();
 	void Destroy();
 
 	NRenderTargetDesc &GetRenderTargetDesc();
@@ -0,0 +1,22 @@
+#ifndef __MU_HASH_H__
+#define __MU_HASH_H__
+
+#pragma once
+
+namespace MUHash
+{
+	constexpr mu_uint64 InitialHash64 = 0xCBF29CE484222325ull;
+
+	// FNV-1a, only used to detect changes of source files and duplicated data, the hash of a previous block continues it
+	NEXTMU_INLINE const mu_uint64 Calculate64(const mu_uint8 *data, const mu_size size, mu_uint64 hash = InitialHash64)
+	{
+		for (mu_size n = 0; n < size; ++n)
+		{
+			hash ^= static_cast<mu_uint64>(data[n]);
+			hash *= 0x100000001B3ull;
+		}
+		return hash;
+	}
+}
+
+#endif
\ No newline at end of file
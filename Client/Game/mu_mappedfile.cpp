@@ -0,0 +1,115 @@
+#include "stdafx.h"
+#include "mu_mappedfile.h"
+
+#if NEXTMU_OPERATING_SYSTEM == NEXTMU_OS_LINUX || NEXTMU_OPERATING_SYSTEM == NEXTMU_OS_MACOS
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+NMappedFile::~NMappedFile()
+{
+	Close();
+}
+
+const mu_boolean NMappedFile::Open(const mu_utf8string &path)
+{
+	Close();
+
+#if NEXTMU_OPERATING_SYSTEM == NEXTMU_OS_WINDOWS
+	const mu_unicodestring widePath = ConvertToUnicodeString(path);
+	File = CreateFileW(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (File != INVALID_HANDLE_VALUE)
+	{
+		LARGE_INTEGER fileSize;
+		if (GetFileSizeEx(File, &fileSize) == TRUE && fileSize.QuadPart > 0)
+		{
+			Mapping = CreateFileMappingW(File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (Mapping != nullptr)
+			{
+				Data = static_cast<const mu_uint8 *>(MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0));
+				if (Data != nullptr)
+				{
+					Size = static_cast<mu_size>(fileSize.QuadPart);
+					return true;
+				}
+			}
+		}
+
+		Close();
+	}
+#elif NEXTMU_OPERATING_SYSTEM == NEXTMU_OS_LINUX || NEXTMU_OPERATING_SYSTEM == NEXTMU_OS_MACOS
+	const mu_int32 fd = open(path.c_str(), O_RDONLY);
+	if (fd >= 0)
+	{
+		struct stat fileStat;
+		if (fstat(fd, &fileStat) == 0 && fileStat.st_size > 0)
+		{
+			void *mapped = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+			if (mapped != MAP_FAILED)
+			{
+				Mapped = mapped;
+				Data = static_cast<const mu_uint8 *>(mapped);
+				Size = static_cast<mu_size>(fileStat.st_size);
+			}
+		}
+		close(fd); // The mapping keeps its own reference to the file
+
+		if (Data != nullptr)
+		{
+			return true;
+		}
+	}
+#endif
+
+	return ReadFallback(path);
+}
+
+void NMappedFile::Close()
+{
+#if NEXTMU_OPERATING_SYSTEM == NEXTMU_OS_WINDOWS
+	if (Data != nullptr && !Buffer) UnmapViewOfFile(Data);
+	if (Mapping != nullptr) CloseHandle(Mapping);
+	if (File != INVALID_HANDLE_VALUE) CloseHandle(File);
+	Mapping = nullptr;
+	File = INVALID_HANDLE_VALUE;
+#elif NEXTMU_OPERATING_SYSTEM == NEXTMU_OS_LINUX || NEXTMU_OPERATING_SYSTEM == NEXTMU_OS_MACOS
+	if (Mapped != nullptr) munmap(Mapped, Size);
+	Mapped = nullptr;
+#endif
+
+	Buffer.reset();
+	Data = nullptr;
+	Size = 0;
+}
+
+const mu_boolean NMappedFile::ReadFallback(const mu_utf8string &path)
+{
+	SDL_RWops *fp = nullptr;
+	if (mu_rwfromfile<EGameDirectoryType::eSupport>(&fp, path, "rb") == false)
+	{
+		return false;
+	}
+
+	const mu_isize fileLength = static_cast<mu_isize>(SDL_RWsize(fp));
+	if (fileLength <= 0)
+	{
+		SDL_RWclose(fp);
+		return false;
+	}
+
+	Buffer.reset(new_nothrow mu_uint8[fileLength]);
+	if (!Buffer || SDL_RWread(fp, Buffer.get(), fileLength, 1) != 1)
+	{
+		SDL_RWclose(fp);
+		Buffer.reset();
+		return false;
+	}
+	SDL_RWclose(fp);
+
+	Data = Buffer.get();
+	Size = static_cast<mu_size>(fileLength);
+
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#ifndef __MU_MAPPEDFILE_H__
+#define __MU_MAPPEDFILE_H__
+
+#pragma once
+
+/*
+	Read-only view of a game data file, desktop systems map the file in memory so the data is only paged in when used,
+	mobile systems read it with SDL because the game data can live inside the application package.
+*/
+class NMappedFile
+{
+public:
+	NMappedFile() = default;
+	NMappedFile(const NMappedFile &) = delete;
+	NMappedFile &operator=(const NMappedFile &) = delete;
+	~NMappedFile();
+
+	const mu_boolean Open(const mu_utf8string &path);
+	void Close();
+
+	NEXTMU_INLINE const mu_uint8 *GetData() const
+	{
+		return Data;
+	}
+
+	NEXTMU_INLINE const mu_size GetSize() const
+	{
+		return Size;
+	}
+
+private:
+	const mu_boolean ReadFallback(const mu_utf8string &path);
+
+private:
+	const mu_uint8 *Data = nullptr;
+	mu_size Size = 0;
+	std::unique_ptr<mu_uint8[]> Buffer;
+#if NEXTMU_OPERATING_SYSTEM == NEXTMU_OS_WINDOWS
+	HANDLE File = INVALID_HANDLE_VALUE;
+	HANDLE Mapping = nullptr;
+#elif NEXTMU_OPERATING_SYSTEM == NEXTMU_OS_LINUX || NEXTMU_OPERATING_SYSTEM == NEXTMU_OS_MACOS
+	void *Mapped = nullptr;
+#endif
+};
+
+#endif
\ No newline at end of file
@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <glm/gtc/packing.hpp>
+
 /*
 	Instead of use a Matrix (4x4) we will use a simple Position, Scale + Quaternion Rotation structure.
 	This might impact a little the CPU however will benefit a lot the GPU and will provide us the chance
@@ -28,8 +30,44 @@ struct NCompressedMatrix
 		Position = position;
 		Scale = scale;
 	}
+
+	void SetIdentity()
+	{
+		Rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+		Position = glm::vec3(0.0f);
+		Scale = 1.0f;
+	}
 };
 
+/*
+	Half precision version of NCompressedMatrix, it uses 16 bytes per bone instead of 32 bytes.
+	Bones are uploaded in model space (parent position is applied through BodyOrigin), so position
+	values stay small enough to be stored as half floats without noticeable precision loss.
+
+	WARNING!
+	Keep the same components order than NCompressedMatrix, shaders read both formats the same way.
+*/
+struct NHalfCompressedMatrix
+{
+	glm::u16vec4 Rotation;
+	glm::u16vec4 PositionScale;
+};
+
+NEXTMU_INLINE void EncodeHalfMatrix(const NCompressedMatrix &in, NHalfCompressedMatrix &out)
+{
+	out.Rotation = glm::packHalf(glm::vec4(in.Rotation.w, in.Rotation.x, in.Rotation.y, in.Rotation.z));
+	out.PositionScale = glm::packHalf(glm::vec4(in.Position, in.Scale));
+}
+
+NEXTMU_INLINE void DecodeHalfMatrix(const NHalfCompressedMatrix &in, NCompressedMatrix &out)
+{
+	const glm::vec4 rotation = glm::unpackHalf(in.Rotation);
+	const glm::vec4 positionScale = glm::unpackHalf(in.PositionScale);
+	out.Rotation = glm::normalize(glm::quat(rotation[0], rotation[1], rotation[2], rotation[3]));
+	out.Position = glm::vec3(positionScale);
+	out.Scale = positionScale[3];
+}
+
 NEXTMU_INLINE const glm::quat AngleToQuaternion(const glm::vec3 v)
 {
 	return glm::quat(glm::radians(v));
@@ -1,11 +1,13 @@
 #include "stdafx.h"
 #include "mu_model.h"
+#include "mu_animationlibrary.h"
 #include "mu_crypt.h"
 #include "shared_binaryreader.h"
 #include "mu_textures.h"
 #include "mu_resourcesmanager.h"
 #include "mu_textureattachments.h"
 #include "mu_graphics.h"
+#include "mu_skinningmanager.h"
 #include <glm/gtc/type_ptr.hpp>
 
 std::map<mu_utf8string, Diligent::COMPARISON_FUNCTION> DepthTestMap = {
@@ -120,6 +122,13 @@ const mu_utf8string ProgramDefault = "mesh_normal";
 
 NModel::~NModel()
 {
+	if (Pending)
+	{
+		for (auto &texture : Pending->Textures)
+		{
+			if (texture.Bitmap != nullptr) FreeImage_Unload(texture.Bitmap);
+		}
+	}
 }
 
 const NDynamicPipelineState CalculateStateFromObject(const nlohmann::json &object)
@@ -189,9 +198,20 @@ const NDynamicPipelineState CalculateStateFromObject(const nlohmann::json &objec
 }
 
 const mu_boolean NModel::Load(const mu_utf8string id, mu_utf8string path)
+{
+	if (Prepare(id, path) == false)
+	{
+		return false;
+	}
+
+	return Upload();
+}
+
+const mu_boolean NModel::Prepare(const mu_utf8string id, mu_utf8string path)
 {
 	Id = id;
 	NormalizePath<true>(path);
+	Pending.reset(new_nothrow NModelPendingUpload());
 
 	const mu_utf8string filename = path + "model.json";
 	SDL_RWops *fp = nullptr;
@@ -216,7 +236,8 @@ const mu_boolean NModel::Load(const mu_utf8string id, mu_utf8string path)
 	}
 
 	const auto model = document["model"].get<mu_utf8string>();
-	if (LoadModel(path + model) == false)
+	NBakedModelSource bakedSource;
+	if (LoadModel(path + model, bakedSource) == false)
 	{
 		mu_error("failed to load model ({})", filename);
 		return false;
@@ -240,6 +261,11 @@ const mu_boolean NModel::Load(const mu_utf8string id, mu_utf8string path)
 		BoneHead = document["bone_head"].get<mu_int16>();
 	}
 
+	if (document.contains("bone_upper_body"))
+	{
+		BoneUpperBody = document["bone_upper_body"].get<mu_int16>();
+	}
+
 	if (document.contains("body_height"))
 	{
 		BodyHeight = document["body_height"].get<mu_float>();
@@ -587,16 +613,58 @@ continue_mesh_light_conditions:
 		}
 	}
 
-	if (GenerateBuffers() == false)
+	if (DecodeTextures() == false)
 	{
-		mu_error("failed to generate model buffers ({})", filename);
+		mu_error("failed to load model textures ({})", filename);
 		return false;
 	}
 
+	GenerateTimelines();
+	GenerateBoneMasks();
+
+	// Baked models already filled their buffers
+	if (bakedSource.Loaded == false)
+	{
+		GenerateBuffers(bakedSource);
+	}
+
+	return true;
+}
+
+const mu_boolean NModel::Upload()
+{
+	if (!Pending) return true;
+
+	for (auto &pendingTexture : Pending->Textures)
+	{
+		auto texture = MUTextures::Create(pendingTexture.Path, pendingTexture.Bitmap, pendingTexture.Info, pendingTexture.Sampler);
+		pendingTexture.Bitmap = nullptr;
+		if (!texture)
+		{
+			mu_error("failed to create texture ({})", pendingTexture.Path);
+			return false;
+		}
+
+		Textures[pendingTexture.Mesh].Texture = std::move(texture);
+	}
+
+	const mu_uint32 verticesCount = static_cast<mu_uint32>(Pending->Vertices.size());
+	const mu_uint32 indicesCount = Pending->IndicesCount;
+	if (
+		verticesCount > 0 && indicesCount > 0 &&
+		CreateBuffers(Pending->Vertices.data(), verticesCount, Pending->Indices.data(), indicesCount, Pending->IndexType) == false
+	)
+	{
+		mu_error("failed to generate model buffers ({})", Id);
+		return false;
+	}
+
+	Pending.reset();
+
 	return true;
 }
 
-const mu_boolean NModel::LoadModel(mu_utf8string path)
+const mu_boolean NModel::LoadModel(mu_utf8string path, NBakedModelSource &bakedSource)
 {
 	NormalizePath(path);
 
@@ -615,6 +683,23 @@ const mu_boolean NModel::LoadModel(mu_utf8string path)
 	SDL_RWread(fp, buffer.get(), fileLength, 1);
 	SDL_RWclose(fp);
 
+	const auto program = MUResourcesManager::GetProgram(ProgramDefault);
+	const auto shadowProgram = MUResourcesManager::GetProgram(ProgramDefault + "_shadow");
+
+	bakedSource.Path = NBakedModel::GetPath(path);
+	bakedSource.Hash = MUHash::Calculate64(buffer.get(), static_cast<mu_size>(fileLength));
+	if (LoadBakedModel(bakedSource) == true)
+	{
+		for (auto &mesh : Meshes)
+		{
+			mesh.Settings.Program = program;
+			mesh.Settings.ShadowProgram = shadowProgram;
+		}
+
+		bakedSource.Loaded = true;
+		return true;
+	}
+
 	NBinaryReader reader(buffer.get(), static_cast<mu_uint32>(fileLength));
 
 	reader.Skip(3); // BMD bytes
@@ -651,13 +736,9 @@ const mu_boolean NModel::LoadModel(mu_utf8string path)
 
 	Meshes.resize(numMeshes);
 	BoneName.resize(numBones);
-	BoneInfo.resize(numBones);
 	Animations.resize(numActions);
 	BoundingBoxes.resize(numBones);
 
-	const auto program = MUResourcesManager::GetProgram(ProgramDefault);
-	const auto shadowProgram = MUResourcesManager::GetProgram(ProgramDefault + "_shadow");
-
 	mu_char filename[32 + 1] = {};
 	for (mu_uint32 m = 0; m < numMeshes; ++m)
 	{
@@ -755,9 +836,12 @@ const mu_boolean NModel::LoadModel(mu_utf8string path)
 		}
 	}
 
+	// Filled here and shared with the models which loaded the same data once complete
+	std::vector<NBoneInfo> boneInfo(numBones);
+	std::vector<std::vector<NAnimationKey>> keys(numActions);
 	for (mu_uint32 b = 0; b < numBones; ++b)
 	{
-		auto &info = BoneInfo[b];
+		auto &info = boneInfo[b];
 		info.Dummy = reader.Read<mu_boolean>();
 		if (info.Dummy) continue;
 
@@ -768,10 +852,10 @@ const mu_boolean NModel::LoadModel(mu_utf8string path)
 
 		for (mu_uint32 a = 0; a < numActions; ++a)
 		{
-			auto &animation = Animations[a];
+			auto &actionKeys = keys[a];
 
 			const mu_uint32 numKeys = AnimationKeys[a];
-			animation.Keys.resize(numKeys);
+			actionKeys.resize(numKeys);
 
 			/*
 				Why I decided to structure it this way?
@@ -780,19 +864,19 @@ const mu_boolean NModel::LoadModel(mu_utf8string path)
 			*/
 			for (mu_uint32 k = 0; k < numKeys; ++k)
 			{
-				auto &animationKey = animation.Keys[k];
+				auto &animationKey = actionKeys[k];
 				animationKey.Bones.resize(numBones);
 			}
 
 			for (mu_uint32 k = 0; k < numKeys; ++k)
 			{
-				auto &animationKey = animation.Keys[k];
+				auto &animationKey = actionKeys[k];
 				reader.ReadLine(&animationKey.Bones[b].Position, sizeof(glm::vec3));
 			}
 
 			for (mu_uint32 k = 0; k < numKeys; ++k)
 			{
-				auto &animationKey = animation.Keys[k];
+				auto &animationKey = actionKeys[k];
 				glm::vec3 rotation;
 				reader.ReadLine(&rotation, sizeof(glm::vec3));
 				animationKey.Bones[b].Rotation = glm::quat(rotation);
@@ -800,6 +884,12 @@ const mu_boolean NModel::LoadModel(mu_utf8string path)
 		}
 	}
 
+	BoneInfo = MUAnimationLibrary::ShareBones(std::move(boneInfo));
+	for (mu_uint32 a = 0; a < numActions; ++a)
+	{
+		Animations[a].Keys = MUAnimationLibrary::ShareKeys(std::move(keys[a]));
+	}
+
 	CalculateBoundingBoxes();
 
 	return true;
@@ -1019,19 +1109,16 @@ const mu_boolean NModel::LoadTextures(const mu_utf8string path, const nlohmann::
 			}
 
 			filename = path + subPath + filename;
-			std::unique_ptr<NGraphicsTexture> texture = MUTextures::Load(
-				filename,
-				MUTextures::CalculateSamplerFlags(filter, wrap)
-			);
-			if (!texture)
-			{
-				mu_error("texture not found ({})", filename);
-				return false;
-			}
+
+			// Decoded by DecodeTextures once the mesh settings are known, the texture is created by Upload
+			NModelPendingTexture pendingTexture;
+			pendingTexture.Mesh = m;
+			pendingTexture.Path = filename;
+			pendingTexture.Sampler = MUTextures::CalculateSamplerFlags(filter, wrap);
+			Pending->Textures.push_back(std::move(pendingTexture));
 
 			Textures[m] = {
 				.Type = MUTextureAttachments::GetAttachmentTypeFromString("normal"),
-				.Texture = std::move(texture),
 			};
 		}
 	}
@@ -1039,32 +1126,79 @@ const mu_boolean NModel::LoadTextures(const mu_utf8string path, const nlohmann::
 	return true;
 }
 
-const mu_boolean NModel::GenerateBuffers()
+const mu_boolean NModel::DecodeTextures()
 {
-	mu_uint32 verticesCount = 0;
-	for (auto &mesh : Meshes)
+	for (auto &pendingTexture : Pending->Textures)
 	{
-		mesh.VertexBuffer.Offset = verticesCount;
-		mesh.VertexBuffer.Count = static_cast<mu_uint32>(mesh.Triangles.size()) * 3u;
-		verticesCount += mesh.VertexBuffer.Count;
+		// Blended meshes aren't alpha tested, scaling their alpha to keep the coverage would change how they blend
+		const auto &settings = Meshes[pendingTexture.Mesh].Settings;
+		const auto &renderState = settings.RenderState[ModelRenderMode::Normal];
+		const mu_boolean blended = (
+			renderState.SrcBlend != Diligent::BLEND_FACTOR_UNDEFINED &&
+			renderState.DestBlend != Diligent::BLEND_FACTOR_UNDEFINED
+		);
+		const mu_float alphaReference = blended ? 0.0f : settings.AlphaTest;
+
+		if (MUTextures::Decode(pendingTexture.Path, &pendingTexture.Bitmap, pendingTexture.Info, true, alphaReference) == false)
+		{
+			mu_error("texture not found ({})", pendingTexture.Path);
+			return false;
+		}
 	}
 
-	if (verticesCount == 0) return true;
+	return true;
+}
 
-	const mu_size memorySize = verticesCount * sizeof(NMeshVertex);
-	std::unique_ptr<mu_uint8[]> memory(new (std::nothrow) mu_uint8[memorySize]);
-	NMeshVertex *dest = reinterpret_cast<NMeshVertex *>(memory.get());
+struct NMeshVertexHash
+{
+	std::size_t operator()(const NMeshVertex &vertex) const
+	{
+		return std::hash<std::string_view>()(std::string_view(reinterpret_cast<const char *>(&vertex), sizeof(NMeshVertex)));
+	}
+};
 
-	for (const auto &mesh : Meshes)
+struct NMeshVertexEqual
+{
+	const bool operator()(const NMeshVertex &lhs, const NMeshVertex &rhs) const
 	{
+		return mu_memcmp(&lhs, &rhs, sizeof(NMeshVertex)) == 0;
+	}
+};
+
+/*
+	Triangles corners are welded into unique vertices (every skinned vertex costs a bone fetch), then the triangles
+	are reordered for the post-transform cache and the vertices are reordered by first use for the pre-transform cache.
+	Indices are relative to the mesh, the draw applies the mesh vertices offset as base vertex.
+*/
+void NModel::GenerateBuffers(const NBakedModelSource &source)
+{
+	MUModelOptimizer::NStatistics statistics;
+	std::vector<NMeshVertex> vertices;
+	std::vector<mu_uint32> indices;
+	mu_uint32 maxMeshVertices = 0;
+
+	for (auto &mesh : Meshes)
+	{
+		const mu_uint32 cornersCount = static_cast<mu_uint32>(mesh.Triangles.size()) * 3u;
+		std::vector<NMeshVertex> meshVertices;
+		std::vector<mu_uint32> meshIndices;
+		std::unordered_map<NMeshVertex, mu_uint32, NMeshVertexHash, NMeshVertexEqual> welded;
+		meshVertices.reserve(cornersCount);
+		meshIndices.reserve(cornersCount);
+		welded.reserve(cornersCount);
+
 		for (const auto &triangle : mesh.Triangles)
 		{
+			mu_uint32 triangleIndices[3];
 			for (mu_uint32 n = 0; n < 3; ++n)
 			{
 				const auto &vertex = mesh.Vertices[triangle.Vertices[n]];
 				const auto &normal = mesh.Normals[triangle.Normals[n]];
 				const auto &texCoord = mesh.TexCoords[triangle.TexCoords[n]];
 
+				NMeshVertex source;
+				mu_zeromem(&source, sizeof(source));
+				NMeshVertex *dest = &source;
 				dest->Position = vertex.Position;
 
 #if NEXTMU_COMPRESSED_MESHS
@@ -1082,33 +1216,152 @@ const mu_boolean NModel::GenerateBuffers()
 				dest->Bone[1] = static_cast<mu_uint8>(normal.Node);
 				dest->Vertex = static_cast<mu_uint16>(triangle.Vertices[n]);
 
-				++dest;
+				auto [iter, inserted] = welded.try_emplace(source, static_cast<mu_uint32>(meshVertices.size()));
+				if (inserted) meshVertices.push_back(source);
+				triangleIndices[n] = iter->second;
+			}
+
+			// Triangles which reference the same vertex twice don't generate any pixel
+			if (
+				triangleIndices[0] == triangleIndices[1] ||
+				triangleIndices[1] == triangleIndices[2] ||
+				triangleIndices[0] == triangleIndices[2]
+			)
+			{
+				continue;
 			}
+
+			meshIndices.insert(meshIndices.end(), triangleIndices, triangleIndices + 3);
+		}
+
+		const mu_uint32 meshVerticesCount = static_cast<mu_uint32>(meshVertices.size());
+		const mu_uint32 meshIndicesCount = static_cast<mu_uint32>(meshIndices.size());
+
+		statistics.Meshes += 1;
+		statistics.Triangles += meshIndicesCount / 3;
+		statistics.SourceVertices += cornersCount;
+		statistics.SourceMisses += MUModelOptimizer::CountCacheMisses(meshIndices.data(), meshIndicesCount, meshVerticesCount);
+
+		MUModelOptimizer::OptimizeVertexCache(meshIndices.data(), meshIndicesCount, meshVerticesCount);
+		const auto remap = MUModelOptimizer::OptimizeVertexFetch(meshIndices.data(), meshIndicesCount, meshVerticesCount);
+
+		mu_uint32 usedVertices = 0;
+		for (mu_uint32 v = 0; v < meshVerticesCount; ++v)
+		{
+			if (remap[v] != NInvalidUInt32) ++usedVertices;
+		}
+
+		mesh.VertexBuffer.Offset = static_cast<mu_uint32>(vertices.size());
+		mesh.VertexBuffer.Count = usedVertices;
+		mesh.IndexBuffer.Offset = static_cast<mu_uint32>(indices.size());
+		mesh.IndexBuffer.Count = meshIndicesCount;
+
+		vertices.resize(vertices.size() + usedVertices);
+		NMeshVertex *dest = vertices.data() + mesh.VertexBuffer.Offset;
+		for (mu_uint32 v = 0; v < meshVerticesCount; ++v)
+		{
+			if (remap[v] == NInvalidUInt32) continue;
+			dest[remap[v]] = meshVertices[v];
 		}
+		indices.insert(indices.end(), meshIndices.begin(), meshIndices.end());
+
+		statistics.WeldedVertices += usedVertices;
+		statistics.OptimizedMisses += MUModelOptimizer::CountCacheMisses(meshIndices.data(), meshIndicesCount, usedVertices);
+		maxMeshVertices = glm::max(maxMeshVertices, usedVertices);
+	}
+
+	MUModelOptimizer::AccumulateStatistics(statistics);
+	//mu_info("[DEBUG] Model {} : {} vertices welded into {}, ACMR {:.3f} optimized to {:.3f}", Id, statistics.SourceVertices, statistics.WeldedVertices, statistics.GetSourceACMR(), statistics.GetOptimizedACMR());
+
+	const mu_uint32 verticesCount = static_cast<mu_uint32>(vertices.size());
+	const mu_uint32 indicesCount = static_cast<mu_uint32>(indices.size());
+
+	// 16 bits indices are enough when every mesh can be addressed with them
+	std::vector<mu_uint16> indices16;
+	const void *indicesData = indices.data();
+	Diligent::VALUE_TYPE indexType = Diligent::VT_UINT32;
+	if (maxMeshVertices <= 65536u)
+	{
+		indices16.assign(indices.begin(), indices.end());
+		indicesData = indices16.data();
+		indexType = Diligent::VT_UINT16;
 	}
 
+	SaveBakedModel(source, statistics, vertices.data(), indicesData, indexType);
+
+	const mu_uint8 *indicesBytes = reinterpret_cast<const mu_uint8 *>(indicesData);
+	const mu_size indexSize = indexType == Diligent::VT_UINT16 ? sizeof(mu_uint16) : sizeof(mu_uint32);
+	Pending->Vertices = std::move(vertices);
+	Pending->Indices.assign(indicesBytes, indicesBytes + indicesCount * indexSize);
+	Pending->IndicesCount = indicesCount;
+	Pending->IndexType = indexType;
+}
+
+const mu_boolean NModel::CreateBuffers(const NMeshVertex *vertices, const mu_uint32 verticesCount, const void *indices, const mu_uint32 indicesCount, const Diligent::VALUE_TYPE indexType)
+{
 	const auto device = MUGraphics::GetDevice();
 
-	Diligent::BufferDesc bufferDesc;
-	bufferDesc.Usage = Diligent::USAGE_IMMUTABLE;
-	bufferDesc.BindFlags = Diligent::BIND_VERTEX_BUFFER;
-	bufferDesc.Size = memorySize;
+	// Vertex Buffer
+	{
+		const mu_size memorySize = verticesCount * sizeof(NMeshVertex);
+
+		Diligent::BufferDesc bufferDesc;
+		bufferDesc.Usage = Diligent::USAGE_IMMUTABLE;
+		bufferDesc.BindFlags = Diligent::BIND_VERTEX_BUFFER;
+		bufferDesc.Size = memorySize;
+
+		// Skinning cache reads the vertices from a compute shader
+		if (MUSkinningManager::IsEnabled())
+		{
+			bufferDesc.BindFlags |= Diligent::BIND_SHADER_RESOURCE;
+			bufferDesc.Mode = Diligent::BUFFER_MODE_RAW;
+		}
+
+		Diligent::BufferData bufferData;
+		bufferData.pData = vertices;
+		bufferData.DataSize = memorySize;
 
-	Diligent::BufferData bufferData;
-	bufferData.pData = memory.get();
-	bufferData.DataSize = memorySize;
+		Diligent::RefCntAutoPtr<Diligent::IBuffer> buffer;
+		device->CreateBuffer(bufferDesc, &bufferData, &buffer);
+		if (buffer == nullptr)
+		{
+			return false;
+		}
 
-	Diligent::RefCntAutoPtr<Diligent::IBuffer> buffer;
-	device->CreateBuffer(bufferDesc, &bufferData, &buffer);
-	if (buffer == nullptr)
+		VertexBuffer = buffer;
+	}
+
+	// Index Buffer
 	{
-		return false;
+		const mu_size memorySize = indicesCount * (indexType == Diligent::VT_UINT16 ? sizeof(mu_uint16) : sizeof(mu_uint32));
+
+		Diligent::BufferDesc bufferDesc;
+		bufferDesc.Usage = Diligent::USAGE_IMMUTABLE;
+		bufferDesc.BindFlags = Diligent::BIND_INDEX_BUFFER;
+		bufferDesc.Size = memorySize;
+
+		Diligent::BufferData bufferData;
+		bufferData.pData = indices;
+		bufferData.DataSize = memorySize;
+
+		Diligent::RefCntAutoPtr<Diligent::IBuffer> buffer;
+		device->CreateBuffer(bufferDesc, &bufferData, &buffer);
+		if (buffer == nullptr)
+		{
+			return false;
+		}
+
+		IndexBuffer = buffer;
 	}
 
 	const auto immediateContext = MUGraphics::GetImmediateContext();
-	Diligent::StateTransitionDesc barrier(buffer, Diligent::RESOURCE_STATE_COPY_DEST, Diligent::RESOURCE_STATE_VERTEX_BUFFER, Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE);
-	immediateContext->TransitionResourceStates(1, &barrier);
-	VertexBuffer = buffer;
+	Diligent::StateTransitionDesc barriers[2] = {
+		Diligent::StateTransitionDesc(VertexBuffer, Diligent::RESOURCE_STATE_COPY_DEST, Diligent::RESOURCE_STATE_VERTEX_BUFFER, Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE),
+		Diligent::StateTransitionDesc(IndexBuffer, Diligent::RESOURCE_STATE_COPY_DEST, Diligent::RESOURCE_STATE_INDEX_BUFFER, Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE),
+	};
+	immediateContext->TransitionResourceStates(mu_countof(barriers), barriers);
+	VerticesCount = verticesCount;
+	IndexType = indexType;
 
 	return true;
 }
@@ -1138,6 +1391,48 @@ void NModel::CalculateBoundingBoxes()
 	}
 }
 
+void NModel::GenerateTimelines()
+{
+	for (auto &animation : Animations)
+	{
+		auto &timeline = animation.Timeline;
+		const mu_uint32 framesCount = static_cast<mu_uint32>(animation.Keys.size());
+
+		timeline.FramesCount = framesCount;
+		timeline.MaxFrames = framesCount - static_cast<mu_uint32>(!!animation.LockPositions && framesCount > 0);
+		timeline.WrapFrames = static_cast<mu_float>(timeline.MaxFrames);
+		timeline.ClampFrame = static_cast<mu_float>(framesCount) - 0.01f;
+	}
+}
+
+void NModel::GenerateBoneMasks()
+{
+	for (auto &mask : BoneMasks) mask.Bones.clear();
+
+	const mu_uint32 numBones = static_cast<mu_uint32>(BoneInfo.size());
+	if (BoneUpperBody < 0 || BoneUpperBody >= static_cast<mu_int16>(numBones))
+	{
+		BoneUpperBody = NInvalidInt16;
+		return;
+	}
+
+	// Bones are sorted (parents before children) so the parent region is always resolved first
+	std::vector<mu_boolean> upperBody(numBones, false);
+	for (mu_uint32 b = 0; b < numBones; ++b)
+	{
+		const auto &info = BoneInfo[b];
+		if (info.Dummy) continue;
+
+		upperBody[b] = (
+			b == static_cast<mu_uint32>(BoneUpperBody) ||
+			(info.Parent >= 0 && info.Parent < static_cast<mu_int16>(b) && upperBody[info.Parent])
+		);
+
+		const auto type = upperBody[b] ? NBoneMaskType::UpperBody : NBoneMaskType::LowerBody;
+		BoneMasks[static_cast<mu_uint32>(type)].Bones.push_back(static_cast<mu_uint16>(b));
+	}
+}
+
 const mu_boolean NModel::PlayAnimation(
 	mu_uint16 &CurrentAction,
 	mu_uint16 &PriorAction,
@@ -1153,8 +1448,8 @@ const mu_boolean NModel::PlayAnimation(
 	if (CurrentAction >= numAnimations) return true;
 
 	const auto &currentAnimation = this->Animations[CurrentAction];
-	const auto &currentFramesCount = static_cast<mu_uint32>(currentAnimation.Keys.size());
-	if (currentFramesCount <= 1) return true;
+	const auto &timeline = currentAnimation.Timeline;
+	if (timeline.FramesCount <= 1) return true;
 
 	const mu_float tmpFrame = CurrentFrame;
 	const mu_uint32 lastFrame = static_cast<mu_uint32>(glm::floor(CurrentFrame));
@@ -1170,18 +1465,17 @@ const mu_boolean NModel::PlayAnimation(
 	mu_boolean loop = true;
 	if (currentAnimation.Loop)
 	{
-		if (newFrame >= currentFramesCount)
+		if (newFrame >= timeline.FramesCount)
 		{
-			CurrentFrame = static_cast<mu_float>(currentFramesCount) - 0.01f;
+			CurrentFrame = timeline.ClampFrame;
 			loop = false;
 		}
 	}
 	else
 	{
-		const auto maxFrames = currentFramesCount - static_cast<mu_uint32>(!!currentAnimation.LockPositions);
-		if (newFrame >= maxFrames)
+		if (newFrame >= timeline.MaxFrames)
 		{
-			CurrentFrame = glm::mod(CurrentFrame, static_cast<mu_float>(maxFrames));
+			CurrentFrame = glm::mod(CurrentFrame, timeline.WrapFrames);
 			loop = false;
 		}
 	}
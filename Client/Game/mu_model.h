@@ -5,6 +5,9 @@
 
 #include "mu_model_mesh.h"
 #include "mu_model_skeleton.h"
+#include "mu_model_baked.h"
+#include "mu_model_optimizer.h"
+#include "mu_textures.h"
 #include "t_textureattachments.h"
 
 class NGraphicsTexture;
@@ -20,6 +23,27 @@ struct NModelTexture
 	std::unique_ptr<NGraphicsTexture> Texture;
 };
 
+struct NModelPendingTexture
+{
+	mu_uint32 Mesh = 0;
+	mu_utf8string Path;
+	FIBITMAP *Bitmap = nullptr;
+	TextureInfo Info;
+	Diligent::SamplerDesc Sampler;
+};
+
+/*
+	Data generated by NModel::Prepare which requires the device, it is kept until NModel::Upload creates the device objects.
+*/
+struct NModelPendingUpload
+{
+	std::vector<NModelPendingTexture> Textures;
+	std::vector<NMeshVertex> Vertices;
+	std::vector<mu_uint8> Indices;
+	mu_uint32 IndicesCount = 0;
+	Diligent::VALUE_TYPE IndexType = Diligent::VT_UINT32;
+};
+
 class NModel
 {
 public:
@@ -27,15 +51,29 @@ public:
 
 	const mu_boolean Load(const mu_utf8string id, mu_utf8string path);
 
+	// Prepare only does CPU work so it can run in worker threads, Upload creates the device objects and must run in the main thread
+	const mu_boolean Prepare(const mu_utf8string id, mu_utf8string path);
+	const mu_boolean Upload();
+
 private:
-	const mu_boolean LoadModel(mu_utf8string path);
+	const mu_boolean LoadModel(mu_utf8string path, NBakedModelSource &bakedSource);
 	void LoadBoundingBoxes(mu_utf8string path);
 	const mu_boolean LoadTextures(const mu_utf8string path, const nlohmann::json &document);
-	const mu_boolean GenerateBuffers();
+	// Decodes the pending textures once the mesh settings are loaded, alpha tested meshes keep their coverage in the mip chain
+	const mu_boolean DecodeTextures();
+	void GenerateBuffers(const NBakedModelSource &source);
+	const mu_boolean CreateBuffers(const NMeshVertex *vertices, const mu_uint32 verticesCount, const void *indices, const mu_uint32 indicesCount, const Diligent::VALUE_TYPE indexType);
+
+	const mu_boolean LoadBakedModel(const NBakedModelSource &source);
+	void SaveBakedModel(const NBakedModelSource &source, const MUModelOptimizer::NStatistics &statistics, const NMeshVertex *vertices, const void *indices, const Diligent::VALUE_TYPE indexType);
 
 	void CalculateBoundingBoxes();
+	void GenerateBoneMasks();
 
 public:
+	// Called once the keys and the settings of the animations are loaded
+	void GenerateTimelines();
+
 	const mu_boolean PlayAnimation(
 		mu_uint16 &CurrentAction,
 		mu_uint16 &PriorAction,
@@ -97,19 +135,33 @@ public:
 		return Animations[index].Modifier;
 	}
 
+	NEXTMU_INLINE const mu_boolean HasBoneMasks() const
+	{
+		return BoneUpperBody != NInvalidInt16;
+	}
+
+	NEXTMU_INLINE const NBoneMask &GetBoneMask(const NBoneMaskType type) const
+	{
+		return BoneMasks[static_cast<mu_uint32>(type)];
+	}
+
 public:
 	friend class NSkeletonInstance;
 	friend class MUModelRenderer;
 
 	Diligent::RefCntAutoPtr<Diligent::IBuffer> VertexBuffer;
+	Diligent::RefCntAutoPtr<Diligent::IBuffer> IndexBuffer;
+	Diligent::VALUE_TYPE IndexType = Diligent::VT_UINT32;
+	mu_uint32 VerticesCount = 0;
 	std::vector<NModelTexture> Textures;
 
 	NVirtualMeshVector VirtualMeshes;
 	std::vector<NMesh> Meshes;
 	std::vector<mu_utf8string> BoneName; // Per Bone (separated for better cache ratio)
-	std::vector<NBoneInfo> BoneInfo; // Per Bone (separated for better cache ratio)
+	NSharedBlock<NBoneInfo> BoneInfo; // Per Bone (separated for better cache ratio)
 	std::vector<NAnimation> Animations; // Per Animation (Action) (structured like this to get a better cache ratio)
 	std::vector<NBoundingBoxWithValidation> BoundingBoxes; // Per Bone
+	std::array<NBoneMask, NBoneMaskTypeCount> BoneMasks;
 	NModelBoundingBoxes BBoxes;
 
 	std::map<mu_utf8string, mu_uint32> BonesById;
@@ -118,7 +170,10 @@ public:
 	mu_utf8string Id;
 	mu_boolean HideBody = true;
 	mu_int16 BoneHead = NInvalidInt16;
+	mu_int16 BoneUpperBody = NInvalidInt16; // Root bone of the upper body mask, the remaining bones belong to the lower body mask
 	mu_float BodyHeight = 0.0f;
+
+	std::unique_ptr<NModelPendingUpload> Pending;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,280 @@
+#include "stdafx.h"
+#include "mu_model.h"
+#include "mu_animationlibrary.h"
+
+template<typename T>
+NEXTMU_INLINE const T *GetBakedSection(const mu_uint8 *buffer, const mu_uint32 fileSize, const mu_uint32 offset, const mu_uint32 count)
+{
+	if (offset % NBakedModel::SectionAlignment != 0) return nullptr;
+	if (static_cast<mu_uint64>(offset) + static_cast<mu_uint64>(count) * sizeof(T) > fileSize) return nullptr;
+	return reinterpret_cast<const T *>(buffer + offset);
+}
+
+NEXTMU_INLINE void CopyBakedName(mu_char *dest, const mu_utf8string &source)
+{
+	mu_zeromem(dest, NBakedModel::NameLength);
+	mu_memcpy(dest, source.c_str(), glm::min(static_cast<mu_uint32>(source.size()), NBakedModel::NameLength - 1u));
+}
+
+NEXTMU_INLINE const mu_size GetIndexSize(const Diligent::VALUE_TYPE indexType)
+{
+	return indexType == Diligent::VT_UINT16 ? sizeof(mu_uint16) : sizeof(mu_uint32);
+}
+
+const mu_boolean NModel::LoadBakedModel(const NBakedModelSource &source)
+{
+	SDL_RWops *fp = nullptr;
+	if (mu_rwfromfile<EGameDirectoryType::eCache>(&fp, source.Path, "rb") == false)
+	{
+		return false;
+	}
+
+	const mu_isize fileLength = static_cast<mu_isize>(SDL_RWsize(fp));
+	if (fileLength < static_cast<mu_isize>(sizeof(NBakedModel::NHeader)))
+	{
+		SDL_RWclose(fp);
+		return false;
+	}
+
+	std::unique_ptr<mu_uint8[]> buffer(new_nothrow mu_uint8[fileLength]);
+	if (!buffer || SDL_RWread(fp, buffer.get(), fileLength, 1) != 1)
+	{
+		SDL_RWclose(fp);
+		return false;
+	}
+	SDL_RWclose(fp);
+
+	const mu_uint8 *data = buffer.get();
+	const auto &header = *reinterpret_cast<const NBakedModel::NHeader *>(data);
+	if (
+		header.Magic != NBakedModel::Magic ||
+		header.Version != NBakedModel::Version ||
+		header.SourceHash != source.Hash ||
+		header.VertexStride != sizeof(NMeshVertex) ||
+		header.KeyStride != sizeof(::NBone) ||
+		header.FileSize != static_cast<mu_uint32>(fileLength) ||
+		header.BonesCount >= MaxBones ||
+		(header.IndexType != Diligent::VT_UINT16 && header.IndexType != Diligent::VT_UINT32)
+	)
+	{
+		return false;
+	}
+
+	const mu_uint32 fileSize = header.FileSize;
+	const auto indexType = static_cast<Diligent::VALUE_TYPE>(header.IndexType);
+	const auto *meshes = GetBakedSection<NBakedModel::NMeshEntry>(data, fileSize, header.MeshesOffset, header.MeshesCount);
+	const auto *bones = GetBakedSection<NBakedModel::NBoneEntry>(data, fileSize, header.BonesOffset, header.BonesCount);
+	const auto *animations = GetBakedSection<NBakedModel::NAnimationEntry>(data, fileSize, header.AnimationsOffset, header.AnimationsCount);
+	const auto *vertices = GetBakedSection<NMeshVertex>(data, fileSize, header.VerticesOffset, header.VerticesCount);
+	const mu_uint8 *indices = GetBakedSection<mu_uint8>(data, fileSize, header.IndicesOffset, header.IndicesCount * static_cast<mu_uint32>(GetIndexSize(indexType)));
+	if (meshes == nullptr || bones == nullptr || animations == nullptr || vertices == nullptr || indices == nullptr)
+	{
+		return false;
+	}
+
+	// Every key stores all the bones, the keys section is validated once the total keys are known
+	mu_uint32 keysCount = 0;
+	for (mu_uint32 a = 0; a < header.AnimationsCount; ++a)
+	{
+		const auto &entry = animations[a];
+		if (entry.KeysOffset != keysCount) return false;
+		keysCount += entry.KeysCount;
+	}
+
+	const auto *keys = GetBakedSection<::NBone>(data, fileSize, header.KeysOffset, keysCount * header.BonesCount);
+	if (keys == nullptr)
+	{
+		return false;
+	}
+
+	for (mu_uint32 m = 0; m < header.MeshesCount; ++m)
+	{
+		const auto &entry = meshes[m];
+		if (
+			static_cast<mu_uint64>(entry.VertexOffset) + entry.VertexCount > header.VerticesCount ||
+			static_cast<mu_uint64>(entry.IndexOffset) + entry.IndexCount > header.IndicesCount
+		)
+		{
+			return false;
+		}
+	}
+
+	Meshes.resize(header.MeshesCount);
+	BoneName.resize(header.BonesCount);
+	Animations.resize(header.AnimationsCount);
+	BoundingBoxes.resize(header.BonesCount);
+
+	for (mu_uint32 m = 0; m < header.MeshesCount; ++m)
+	{
+		const auto &entry = meshes[m];
+		auto &mesh = Meshes[m];
+		mesh.VertexBuffer.Offset = entry.VertexOffset;
+		mesh.VertexBuffer.Count = entry.VertexCount;
+		mesh.IndexBuffer.Offset = entry.IndexOffset;
+		mesh.IndexBuffer.Count = entry.IndexCount;
+		mesh.Texture.Filename = mu_utf8string(entry.Texture, strnlen(entry.Texture, NBakedModel::NameLength));
+	}
+
+	std::vector<NBoneInfo> boneInfo(header.BonesCount);
+	for (mu_uint32 b = 0; b < header.BonesCount; ++b)
+	{
+		const auto &entry = bones[b];
+		BoneName[b] = mu_utf8string(entry.Name, strnlen(entry.Name, NBakedModel::NameLength));
+
+		auto &info = boneInfo[b];
+		info.Dummy = entry.Dummy != 0;
+		info.Parent = entry.Parent;
+
+		auto &boundingBox = BoundingBoxes[b];
+		boundingBox.Min = entry.BoundingBoxMin;
+		boundingBox.Max = entry.BoundingBoxMax;
+		boundingBox.Valid = entry.BoundingBoxValid != 0;
+	}
+
+	for (mu_uint32 a = 0; a < header.AnimationsCount; ++a)
+	{
+		const auto &entry = animations[a];
+		auto &animation = Animations[a];
+		animation.Loop = false;
+		animation.LockPositions = entry.LockPositions != 0;
+
+		std::vector<NAnimationKey> animationKeys(entry.KeysCount);
+		const ::NBone *entryKeys = keys + static_cast<mu_size>(entry.KeysOffset) * header.BonesCount;
+		for (mu_uint32 k = 0; k < entry.KeysCount; ++k)
+		{
+			const ::NBone *keyBones = entryKeys + static_cast<mu_size>(k) * header.BonesCount;
+			animationKeys[k].Bones.assign(keyBones, keyBones + header.BonesCount);
+		}
+		animation.Keys = MUAnimationLibrary::ShareKeys(std::move(animationKeys));
+	}
+	BoneInfo = MUAnimationLibrary::ShareBones(std::move(boneInfo));
+
+	// Sections are stored with the runtime layout so the buffers are copied as they are
+	Pending->Vertices.assign(vertices, vertices + header.VerticesCount);
+	Pending->Indices.assign(indices, indices + header.IndicesCount * GetIndexSize(indexType));
+	Pending->IndicesCount = header.IndicesCount;
+	Pending->IndexType = indexType;
+
+	MUModelOptimizer::NStatistics statistics;
+	statistics.Meshes = header.MeshesCount;
+	statistics.Triangles = header.Triangles;
+	statistics.SourceVertices = header.SourceVertices;
+	statistics.WeldedVertices = header.VerticesCount;
+	statistics.SourceMisses = header.SourceMisses;
+	statistics.OptimizedMisses = header.OptimizedMisses;
+	MUModelOptimizer::AccumulateStatistics(statistics);
+
+	return true;
+}
+
+void NModel::SaveBakedModel(const NBakedModelSource &source, const MUModelOptimizer::NStatistics &statistics, const NMeshVertex *vertices, const void *indices, const Diligent::VALUE_TYPE indexType)
+{
+	const mu_uint32 meshesCount = static_cast<mu_uint32>(Meshes.size());
+	const mu_uint32 bonesCount = static_cast<mu_uint32>(BoneInfo.size());
+	const mu_uint32 animationsCount = static_cast<mu_uint32>(Animations.size());
+
+	mu_uint32 verticesCount = 0, indicesCount = 0, keysCount = 0;
+	for (const auto &mesh : Meshes)
+	{
+		verticesCount = glm::max(verticesCount, mesh.VertexBuffer.Offset + mesh.VertexBuffer.Count);
+		indicesCount = glm::max(indicesCount, mesh.IndexBuffer.Offset + mesh.IndexBuffer.Count);
+	}
+	for (const auto &animation : Animations)
+	{
+		keysCount += static_cast<mu_uint32>(animation.Keys.size());
+	}
+
+	NBakedModel::NHeader header = {};
+	header.Magic = NBakedModel::Magic;
+	header.Version = NBakedModel::Version;
+	header.SourceHash = source.Hash;
+	header.VertexStride = sizeof(NMeshVertex);
+	header.KeyStride = sizeof(::NBone);
+	header.IndexType = static_cast<mu_uint32>(indexType);
+	header.MeshesCount = meshesCount;
+	header.BonesCount = bonesCount;
+	header.AnimationsCount = animationsCount;
+	header.VerticesCount = verticesCount;
+	header.IndicesCount = indicesCount;
+	header.Triangles = statistics.Triangles;
+	header.SourceVertices = statistics.SourceVertices;
+	header.SourceMisses = statistics.SourceMisses;
+	header.OptimizedMisses = statistics.OptimizedMisses;
+
+	const mu_size indexSize = GetIndexSize(indexType);
+	mu_uint32 offset = NBakedModel::Align(sizeof(NBakedModel::NHeader));
+	header.MeshesOffset = offset; offset = NBakedModel::Align(offset + meshesCount * sizeof(NBakedModel::NMeshEntry));
+	header.BonesOffset = offset; offset = NBakedModel::Align(offset + bonesCount * sizeof(NBakedModel::NBoneEntry));
+	header.AnimationsOffset = offset; offset = NBakedModel::Align(offset + animationsCount * sizeof(NBakedModel::NAnimationEntry));
+	header.KeysOffset = offset; offset = NBakedModel::Align(offset + keysCount * bonesCount * sizeof(::NBone));
+	header.VerticesOffset = offset; offset = NBakedModel::Align(offset + verticesCount * sizeof(NMeshVertex));
+	header.IndicesOffset = offset; offset = NBakedModel::Align(offset + static_cast<mu_uint32>(indicesCount * indexSize));
+	header.FileSize = offset;
+
+	std::vector<mu_uint8> buffer(header.FileSize, 0u);
+	mu_memcpy(buffer.data(), &header, sizeof(header));
+
+	auto *meshes = reinterpret_cast<NBakedModel::NMeshEntry *>(buffer.data() + header.MeshesOffset);
+	for (mu_uint32 m = 0; m < meshesCount; ++m)
+	{
+		const auto &mesh = Meshes[m];
+		auto &entry = meshes[m];
+		entry.VertexOffset = mesh.VertexBuffer.Offset;
+		entry.VertexCount = mesh.VertexBuffer.Count;
+		entry.IndexOffset = mesh.IndexBuffer.Offset;
+		entry.IndexCount = mesh.IndexBuffer.Count;
+		CopyBakedName(entry.Texture, mesh.Texture.Filename);
+	}
+
+	auto *bones = reinterpret_cast<NBakedModel::NBoneEntry *>(buffer.data() + header.BonesOffset);
+	for (mu_uint32 b = 0; b < bonesCount; ++b)
+	{
+		const auto &info = BoneInfo[b];
+		const auto &boundingBox = BoundingBoxes[b];
+		auto &entry = bones[b];
+		CopyBakedName(entry.Name, BoneName[b]);
+		entry.Parent = info.Parent;
+		entry.Dummy = info.Dummy ? 1u : 0u;
+		entry.BoundingBoxValid = boundingBox.Valid ? 1u : 0u;
+		entry.BoundingBoxMin = boundingBox.Min;
+		entry.BoundingBoxMax = boundingBox.Max;
+	}
+
+	auto *animations = reinterpret_cast<NBakedModel::NAnimationEntry *>(buffer.data() + header.AnimationsOffset);
+	auto *keys = reinterpret_cast<::NBone *>(buffer.data() + header.KeysOffset);
+	mu_uint32 keysOffset = 0;
+	for (mu_uint32 a = 0; a < animationsCount; ++a)
+	{
+		const auto &animation = Animations[a];
+		const mu_uint32 animationKeysCount = static_cast<mu_uint32>(animation.Keys.size());
+		auto &entry = animations[a];
+		entry.KeysCount = animationKeysCount;
+		entry.LockPositions = animation.LockPositions ? 1u : 0u;
+		entry.KeysOffset = keysOffset;
+
+		for (mu_uint32 k = 0; k < animationKeysCount; ++k)
+		{
+			// Keys are only resized by the non-dummy bones, missing bones keep the default transform
+			const auto &keyBones = animation.Keys[k].Bones;
+			::NBone *dest = keys + static_cast<mu_size>(keysOffset + k) * bonesCount;
+			const mu_uint32 copyCount = glm::min(static_cast<mu_uint32>(keyBones.size()), bonesCount);
+			std::copy(keyBones.begin(), keyBones.begin() + copyCount, dest);
+			std::fill(dest + copyCount, dest + bonesCount, ::NBone());
+		}
+
+		keysOffset += animationKeysCount;
+	}
+
+	if (verticesCount > 0)
+	{
+		mu_memcpy(buffer.data() + header.VerticesOffset, vertices, verticesCount * sizeof(NMeshVertex));
+	}
+
+	if (indicesCount > 0)
+	{
+		mu_memcpy(buffer.data() + header.IndicesOffset, indices, indicesCount * indexSize);
+	}
+
+	// Baking is an optimization, when the cache isn't writable the BMD is parsed again next time
+	MUCacheFiles::Write(source.Path, { { buffer.data(), buffer.size() } });
+}
\ No newline at end of file
@@ -0,0 +1,105 @@
+#ifndef __MU_MODEL_BAKED_H__
+#define __MU_MODEL_BAKED_H__
+
+#pragma once
+
+#include "mu_hash.h"
+#include "mu_cachefiles.h"
+
+/*
+	Baked models store the final data generated from a BMD (welded vertices, optimized indices, bones, animation keys
+	and bounding boxes) so the BMD doesn't have to be decrypted and processed again. Sections are aligned and stored
+	with the runtime layout, the file is read with a single read and the buffers are uploaded straight from it.
+	The hash of the source BMD invalidates the baked model when the BMD changes.
+*/
+namespace NBakedModel
+{
+	constexpr mu_uint32 Magic = 0x4C444D4E; // NMDL
+	constexpr mu_uint32 Version = 1u;
+	constexpr mu_uint32 SectionAlignment = 16u;
+	constexpr mu_uint32 NameLength = 32u;
+	constexpr const mu_char *Extension = ".nmdl";
+
+#pragma pack(push, 4)
+	struct NHeader
+	{
+		mu_uint32 Magic;
+		mu_uint32 Version;
+		mu_uint64 SourceHash;
+
+		// Layout of the runtime structures, a client with another layout bakes the model again
+		mu_uint32 VertexStride;
+		mu_uint32 KeyStride;
+		mu_uint32 IndexType;
+
+		mu_uint32 MeshesCount;
+		mu_uint32 BonesCount;
+		mu_uint32 AnimationsCount;
+		mu_uint32 VerticesCount;
+		mu_uint32 IndicesCount;
+
+		mu_uint32 Triangles;
+		mu_uint32 SourceVertices;
+		mu_uint64 SourceMisses;
+		mu_uint64 OptimizedMisses;
+
+		mu_uint32 MeshesOffset;
+		mu_uint32 BonesOffset;
+		mu_uint32 AnimationsOffset;
+		mu_uint32 KeysOffset;
+		mu_uint32 VerticesOffset;
+		mu_uint32 IndicesOffset;
+		mu_uint32 FileSize;
+	};
+
+	struct NMeshEntry
+	{
+		mu_uint32 VertexOffset;
+		mu_uint32 VertexCount;
+		mu_uint32 IndexOffset;
+		mu_uint32 IndexCount;
+		mu_char Texture[NameLength];
+	};
+
+	struct NBoneEntry
+	{
+		mu_char Name[NameLength];
+		mu_int16 Parent;
+		mu_uint8 Dummy;
+		mu_uint8 BoundingBoxValid;
+		glm::vec3 BoundingBoxMin;
+		glm::vec3 BoundingBoxMax;
+	};
+
+	struct NAnimationEntry
+	{
+		mu_uint32 KeysCount;
+		mu_uint32 LockPositions;
+		mu_uint32 KeysOffset; // Index of the first key, every key stores BonesCount bones
+	};
+#pragma pack(pop)
+
+	NEXTMU_INLINE const mu_uint32 Align(const mu_uint32 offset)
+	{
+		return (offset + SectionAlignment - 1u) & ~(SectionAlignment - 1u);
+	}
+
+	NEXTMU_INLINE const mu_utf8string GetPath(mu_utf8string path)
+	{
+		const auto dotPos = path.find_last_of('.');
+		if (dotPos != mu_utf8string::npos)
+		{
+			path = path.substr(0, dotPos);
+		}
+		return MUCacheFiles::GetPath(path, Extension);
+	}
+}
+
+struct NBakedModelSource
+{
+	mu_utf8string Path;
+	mu_uint64 Hash = 0ull;
+	mu_boolean Loaded = false;
+};
+
+#endif
\ No newline at end of file
@@ -163,7 +163,7 @@ class NMesh
 public:
 	NMeshRenderSettings Settings;
 	NRenderInfo VertexBuffer;
-	//NRenderInfo IndexBuffer; // Not required for now, since we will use vertices only for the rendering
+	NRenderInfo IndexBuffer;
 	NTextureInfo Texture;
 	std::vector<NVertex> Vertices;
 	std::vector<NNormal> Normals;
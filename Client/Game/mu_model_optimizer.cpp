@@ -0,0 +1,249 @@
+#include "stdafx.h"
+#include "mu_model_optimizer.h"
+#include <mutex>
+
+namespace MUModelOptimizer
+{
+	constexpr mu_uint32 ScoreCacheSize = 32u;
+	constexpr mu_float CacheDecayPower = 1.5f;
+	constexpr mu_float LastTriangleScore = 0.75f;
+	constexpr mu_float ValenceBoostScale = 2.0f;
+	constexpr mu_float ValenceBoostPower = 0.5f;
+
+	std::mutex StatisticsMutex;
+	NStatistics Statistics;
+
+	NEXTMU_INLINE const mu_float CalculateVertexScore(const mu_int32 cachePosition, const mu_uint32 remainingTriangles)
+	{
+		if (remainingTriangles == 0) return -1.0f;
+
+		mu_float score = 0.0f;
+		if (cachePosition >= 0)
+		{
+			if (cachePosition < 3)
+			{
+				// Vertices of the last triangle get a fixed score so the next triangle doesn't prefer them over the rest of the cache
+				score = LastTriangleScore;
+			}
+			else
+			{
+				constexpr mu_float scaler = 1.0f / static_cast<mu_float>(ScoreCacheSize - 3);
+				score = glm::pow(1.0f - static_cast<mu_float>(cachePosition - 3) * scaler, CacheDecayPower);
+			}
+		}
+
+		// Vertices with few remaining triangles are boosted so they are finished and leave the cache
+		score += ValenceBoostScale * glm::pow(static_cast<mu_float>(remainingTriangles), -ValenceBoostPower);
+		return score;
+	}
+
+	void OptimizeVertexCache(mu_uint32 *indices, const mu_uint32 indicesCount, const mu_uint32 verticesCount)
+	{
+		const mu_uint32 trianglesCount = indicesCount / 3;
+		if (trianglesCount == 0 || verticesCount == 0) return;
+
+		// Triangles adjacency of every vertex
+		std::vector<mu_uint32> remaining(verticesCount, 0u);
+		for (mu_uint32 n = 0; n < indicesCount; ++n)
+		{
+			++remaining[indices[n]];
+		}
+
+		std::vector<mu_uint32> adjacencyOffset(verticesCount + 1, 0u);
+		for (mu_uint32 v = 0; v < verticesCount; ++v)
+		{
+			adjacencyOffset[v + 1] = adjacencyOffset[v] + remaining[v];
+		}
+
+		std::vector<mu_uint32> adjacency(indicesCount);
+		{
+			std::vector<mu_uint32> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+			for (mu_uint32 n = 0; n < indicesCount; ++n)
+			{
+				adjacency[fill[indices[n]]++] = n / 3;
+			}
+		}
+
+		std::vector<mu_int32> cachePosition(verticesCount, -1);
+		std::vector<mu_float> vertexScore(verticesCount);
+		for (mu_uint32 v = 0; v < verticesCount; ++v)
+		{
+			vertexScore[v] = CalculateVertexScore(-1, remaining[v]);
+		}
+
+		std::vector<mu_float> triangleScore(trianglesCount);
+		std::vector<mu_boolean> emitted(trianglesCount, false);
+		for (mu_uint32 t = 0; t < trianglesCount; ++t)
+		{
+			const mu_uint32 *triangle = indices + t * 3;
+			triangleScore[t] = vertexScore[triangle[0]] + vertexScore[triangle[1]] + vertexScore[triangle[2]];
+		}
+
+		std::vector<mu_uint32> output;
+		output.reserve(indicesCount);
+
+		std::array<mu_uint32, ScoreCacheSize + 3> cache;
+		std::array<mu_uint32, ScoreCacheSize + 3> newCache;
+		mu_uint32 cacheCount = 0;
+
+		mu_uint32 bestTriangle = NInvalidUInt32;
+		mu_uint32 scanCursor = 0;
+
+		for (mu_uint32 emittedCount = 0; emittedCount < trianglesCount; ++emittedCount)
+		{
+			// When the cache has no candidate the best remaining triangle is searched, the cursor keeps the scan linear
+			if (bestTriangle == NInvalidUInt32)
+			{
+				mu_float bestScore = -1.0f;
+				for (mu_uint32 t = scanCursor; t < trianglesCount; ++t)
+				{
+					if (emitted[t] == true)
+					{
+						if (t == scanCursor) ++scanCursor;
+						continue;
+					}
+
+					if (triangleScore[t] > bestScore)
+					{
+						bestScore = triangleScore[t];
+						bestTriangle = t;
+					}
+				}
+			}
+
+			const mu_uint32 *triangle = indices + bestTriangle * 3;
+			emitted[bestTriangle] = true;
+			output.push_back(triangle[0]);
+			output.push_back(triangle[1]);
+			output.push_back(triangle[2]);
+
+			// Remove the triangle from the adjacency of its vertices
+			for (mu_uint32 k = 0; k < 3; ++k)
+			{
+				const mu_uint32 v = triangle[k];
+				const mu_uint32 begin = adjacencyOffset[v];
+				const mu_uint32 end = begin + remaining[v];
+				for (mu_uint32 a = begin; a < end; ++a)
+				{
+					if (adjacency[a] == bestTriangle)
+					{
+						adjacency[a] = adjacency[end - 1];
+						break;
+					}
+				}
+				--remaining[v];
+			}
+
+			// Emitted vertices move to the front of the cache
+			mu_uint32 newCacheCount = 0;
+			for (mu_uint32 k = 0; k < 3; ++k)
+			{
+				newCache[newCacheCount++] = triangle[k];
+			}
+			for (mu_uint32 c = 0; c < cacheCount; ++c)
+			{
+				const mu_uint32 v = cache[c];
+				if (v == triangle[0] || v == triangle[1] || v == triangle[2]) continue;
+				newCache[newCacheCount++] = v;
+			}
+
+			// Vertices pushed out of the cache lose their cache score, so their triangles are scored again
+			for (mu_uint32 c = ScoreCacheSize; c < newCacheCount; ++c)
+			{
+				const mu_uint32 v = newCache[c];
+				cachePosition[v] = -1;
+				vertexScore[v] = CalculateVertexScore(-1, remaining[v]);
+
+				const mu_uint32 begin = adjacencyOffset[v];
+				const mu_uint32 end = begin + remaining[v];
+				for (mu_uint32 a = begin; a < end; ++a)
+				{
+					const mu_uint32 t = adjacency[a];
+					const mu_uint32 *adjacent = indices + t * 3;
+					triangleScore[t] = vertexScore[adjacent[0]] + vertexScore[adjacent[1]] + vertexScore[adjacent[2]];
+				}
+			}
+
+			cacheCount = glm::min(newCacheCount, ScoreCacheSize);
+			for (mu_uint32 c = 0; c < cacheCount; ++c)
+			{
+				const mu_uint32 v = newCache[c];
+				cache[c] = v;
+				cachePosition[v] = static_cast<mu_int32>(c);
+				vertexScore[v] = CalculateVertexScore(static_cast<mu_int32>(c), remaining[v]);
+			}
+
+			// Only the triangles of cached vertices changed their score, the best of them is the next triangle
+			bestTriangle = NInvalidUInt32;
+			mu_float bestScore = -1.0f;
+			for (mu_uint32 c = 0; c < cacheCount; ++c)
+			{
+				const mu_uint32 v = cache[c];
+				const mu_uint32 begin = adjacencyOffset[v];
+				const mu_uint32 end = begin + remaining[v];
+				for (mu_uint32 a = begin; a < end; ++a)
+				{
+					const mu_uint32 t = adjacency[a];
+					const mu_uint32 *adjacent = indices + t * 3;
+					const mu_float score = vertexScore[adjacent[0]] + vertexScore[adjacent[1]] + vertexScore[adjacent[2]];
+					triangleScore[t] = score;
+					if (score > bestScore)
+					{
+						bestScore = score;
+						bestTriangle = t;
+					}
+				}
+			}
+		}
+
+		std::copy(output.begin(), output.end(), indices);
+	}
+
+	std::vector<mu_uint32> OptimizeVertexFetch(mu_uint32 *indices, const mu_uint32 indicesCount, const mu_uint32 verticesCount)
+	{
+		std::vector<mu_uint32> remap(verticesCount, NInvalidUInt32);
+		mu_uint32 nextVertex = 0;
+		for (mu_uint32 n = 0; n < indicesCount; ++n)
+		{
+			auto &target = remap[indices[n]];
+			if (target == NInvalidUInt32) target = nextVertex++;
+			indices[n] = target;
+		}
+
+		return remap;
+	}
+
+	const mu_uint32 CountCacheMisses(const mu_uint32 *indices, const mu_uint32 indicesCount, const mu_uint32 verticesCount, const mu_uint32 cacheSize)
+	{
+		// A vertex stays in the FIFO cache until cacheSize misses happened after it was inserted, zero means never inserted
+		std::vector<mu_uint32> insertedAt(verticesCount, 0u);
+		mu_uint32 misses = 0;
+		for (mu_uint32 n = 0; n < indicesCount; ++n)
+		{
+			const mu_uint32 v = indices[n];
+			if (insertedAt[v] == 0u || misses - insertedAt[v] >= cacheSize)
+			{
+				insertedAt[v] = ++misses;
+			}
+		}
+
+		return misses;
+	}
+
+	void AccumulateStatistics(const NStatistics &statistics)
+	{
+		std::lock_guard lock(StatisticsMutex);
+		Statistics.Meshes += statistics.Meshes;
+		Statistics.Triangles += statistics.Triangles;
+		Statistics.SourceVertices += statistics.SourceVertices;
+		Statistics.WeldedVertices += statistics.WeldedVertices;
+		Statistics.SourceMisses += statistics.SourceMisses;
+		Statistics.OptimizedMisses += statistics.OptimizedMisses;
+	}
+
+	const NStatistics GetStatistics()
+	{
+		std::lock_guard lock(StatisticsMutex);
+		return Statistics;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#ifndef __MU_MODEL_OPTIMIZER_H__
+#define __MU_MODEL_OPTIMIZER_H__
+
+#pragma once
+
+namespace MUModelOptimizer
+{
+	// Post-transform cache size used to measure the average cache miss ratio (ACMR)
+	constexpr mu_uint32 MeasureCacheSize = 16u;
+
+	struct NStatistics
+	{
+		mu_uint32 Meshes = 0;
+		mu_uint32 Triangles = 0;
+		mu_uint32 SourceVertices = 0; // Vertices before welding (3 per triangle)
+		mu_uint32 WeldedVertices = 0;
+		mu_uint64 SourceMisses = 0; // Cache misses of the welded indices in their original order
+		mu_uint64 OptimizedMisses = 0;
+
+		NEXTMU_INLINE const mu_float GetSourceACMR() const
+		{
+			return Triangles > 0 ? static_cast<mu_float>(SourceMisses) / static_cast<mu_float>(Triangles) : 0.0f;
+		}
+
+		NEXTMU_INLINE const mu_float GetOptimizedACMR() const
+		{
+			return Triangles > 0 ? static_cast<mu_float>(OptimizedMisses) / static_cast<mu_float>(Triangles) : 0.0f;
+		}
+	};
+
+	// Reorders the triangles to maximize the post-transform cache hits (Tom Forsyth linear-speed algorithm)
+	void OptimizeVertexCache(mu_uint32 *indices, const mu_uint32 indicesCount, const mu_uint32 verticesCount);
+	// Reorders the vertices by first use, returns the remap table (old index to new index, NInvalidUInt32 if unused)
+	std::vector<mu_uint32> OptimizeVertexFetch(mu_uint32 *indices, const mu_uint32 indicesCount, const mu_uint32 verticesCount);
+	// Simulates a FIFO post-transform cache and returns the amount of transformed vertices
+	const mu_uint32 CountCacheMisses(const mu_uint32 *indices, const mu_uint32 indicesCount, const mu_uint32 verticesCount, const mu_uint32 cacheSize = MeasureCacheSize);
+
+	// Accumulates the statistics of every optimized model, used to report the vertices and ACMR gains
+	void AccumulateStatistics(const NStatistics &statistics);
+	const NStatistics GetStatistics();
+}
+
+#endif
\ No newline at end of file
@@ -7,6 +7,46 @@
 #include "mu_math_obb.h"
 #include "t_model_enums.h"
 
+/*
+	Immutable data shared by every model which loaded the same content, see MUAnimationLibrary.
+	It exposes the read-only part of a vector so the code which reads it doesn't depend on the sharing.
+*/
+template<typename Type>
+class NSharedBlock
+{
+public:
+	NSharedBlock() = default;
+	explicit NSharedBlock(std::shared_ptr<const std::vector<Type>> data) : Data(std::move(data)) {}
+
+	NEXTMU_INLINE const mu_size size() const
+	{
+		return Data ? Data->size() : 0;
+	}
+
+	NEXTMU_INLINE const mu_boolean empty() const
+	{
+		return size() == 0;
+	}
+
+	NEXTMU_INLINE const Type &operator[](const mu_size index) const
+	{
+		return (*Data)[index];
+	}
+
+	NEXTMU_INLINE const Type *begin() const
+	{
+		return Data ? Data->data() : nullptr;
+	}
+
+	NEXTMU_INLINE const Type *end() const
+	{
+		return Data ? Data->data() + Data->size() : nullptr;
+	}
+
+private:
+	std::shared_ptr<const std::vector<Type>> Data;
+};
+
 class NBone
 {
 public:
@@ -20,6 +60,18 @@ public:
 	std::vector<NBone> Bones; // Per Bone
 };
 
+/*
+	Precomputed when the model is loaded so PlayAnimation doesn't have to derive it every call.
+*/
+class NAnimationTimeline
+{
+public:
+	mu_uint32 FramesCount = 0;
+	mu_uint32 MaxFrames = 0; // Frames available before wrapping (LockPositions animations don't wrap into the last frame)
+	mu_float WrapFrames = 0.0f;
+	mu_float ClampFrame = 0.0f; // Last frame used by clamped animations
+};
+
 class NAnimation
 {
 public:
@@ -28,7 +80,8 @@ public:
 	mu_boolean LockPositions = false;
 	NAnimationModifierType Modifier = NAnimationModifierType::None;
 	mu_float PlaySpeed = 1.0f;
-	std::vector<NAnimationKey> Keys; // Per Animation Frame
+	NSharedBlock<NAnimationKey> Keys; // Per Animation Frame
+	NAnimationTimeline Timeline;
 };
 
 class NBoneInfo
@@ -38,6 +91,15 @@ public:
 	mu_int16 Parent = NInvalidInt16;
 };
 
+/*
+	Non-dummy bones of a body region sorted by index so parents are always evaluated before their children.
+*/
+class NBoneMask
+{
+public:
+	std::vector<mu_uint16> Bones;
+};
+
 class NBoundingBoxWithValidation : public NBoundingBoxWithDefault
 {
 public:
@@ -1,12 +1,14 @@
 #include "stdafx.h"
 #include "mu_modelrenderer.h"
 #include "mu_skeletonmanager.h"
+#include "mu_skinningmanager.h"
 #include "mu_skeletoninstance.h"
 #include "mu_config.h"
 #include "mu_graphics.h"
 #include "mu_state.h"
 #include "mu_renderstate.h"
 #include "mu_resourcesmanager.h"
+#include "mu_texturestreaming.h"
 #include "mu_resizablequeue.h"
 #include <glm/gtc/type_ptr.hpp>
 #include <MapHelper.hpp>
@@ -107,7 +109,7 @@ void MUModelRenderer::RenderMesh(
 )
 {
 	const auto &mesh = model->Meshes[meshIndex];
-	if (mesh.VertexBuffer.Count == 0) return;
+	if (mesh.IndexBuffer.Count == 0) return;
 
 	auto terrain = MURenderState::GetTerrain();
 	if (terrain == nullptr) return;
@@ -120,6 +122,8 @@ void MUModelRenderer::RenderMesh(
 	if (texture == nullptr)
 		texture = textureInfo.Texture.get();
 	if (texture == nullptr || texture->IsValid() == false) return;
+	MUTextureStreaming::Touch(texture);
+	if (settings->VertexTexture != nullptr) MUTextureStreaming::Touch(settings->VertexTexture);
 
 	glm::vec3 bodyLight = glm::vec3(config.BodyLight);
 
@@ -185,8 +189,13 @@ void MUModelRenderer::RenderMesh(
 	const auto &renderTargetDesc = MUGraphics::GetRenderTargetDesc();
 
 	const auto renderMode = MURenderState::GetRenderMode();
+	mu_shader program = renderMode == NRenderMode::Normal ? settings->Program : settings->ShadowProgram;
+	const mu_shader preskinnedProgram = config.SkinningOffset != NInvalidUInt32 ? MUResourcesManager::GetPreskinnedProgram(program) : NInvalidShader;
+	const mu_boolean isPreskinned = preskinnedProgram != NInvalidShader;
+	if (isPreskinned) program = preskinnedProgram;
+
 	NFixedPipelineState fixedState = {
-		.CombinedShader = renderMode == NRenderMode::Normal ? settings->Program : settings->ShadowProgram,
+		.CombinedShader = program,
 		.RTVFormat = renderTargetDesc.ColorFormat,
 		.DSVFormat = renderTargetDesc.DepthStencilFormat,
 	};
@@ -335,21 +344,35 @@ void MUModelRenderer::RenderMesh(
 	renderManager->SetVertexBuffer(
 		RSetVertexBuffer{
 			.StartSlot = 0,
-			.Buffer = model->VertexBuffer.RawPtr(),
+			.Buffer = isPreskinned ? MUSkinningManager::GetVertexBuffer() : model->VertexBuffer.RawPtr(),
 			.Offset = 0,
 			.StateTransitionMode = Diligent::RESOURCE_STATE_TRANSITION_MODE_VERIFY,
 			.Flags = Diligent::SET_VERTEX_BUFFERS_FLAG_NONE,
 		}
 	);
+	renderManager->SetIndexBuffer(
+		RSetIndexBuffer{
+			.IndexBuffer = model->IndexBuffer.RawPtr(),
+			.ByteOffset = 0,
+			.StateTransitionMode = Diligent::RESOURCE_STATE_TRANSITION_MODE_VERIFY,
+		}
+	);
 	renderManager->CommitShaderResources(
 		RCommitShaderResources{
 			.ShaderResourceBinding = binding,
 		}
 	);
 
-	renderManager->Draw(
-		RDraw{
-			.Attribs = Diligent::DrawAttribs(mesh.VertexBuffer.Count, Diligent::DRAW_FLAG_VERIFY_ALL, 1, mesh.VertexBuffer.Offset)
+	renderManager->DrawIndexed(
+		RDrawIndexed{
+			.Attribs = Diligent::DrawIndexedAttribs(
+				mesh.IndexBuffer.Count,
+				model->IndexType,
+				Diligent::DRAW_FLAG_VERIFY_ALL,
+				1,
+				mesh.IndexBuffer.Offset,
+				isPreskinned ? config.SkinningOffset + mesh.VertexBuffer.Offset : mesh.VertexBuffer.Offset
+			)
 		},
 		RCommandListInfo{
 			.Type = NDrawOrderType::Classifier,
@@ -378,6 +401,10 @@ void MUModelRenderer::RenderBody(
 		config.BodyOrigin
 	));
 
+	// Every pass which renders this model with the same skeleton shares the skinned vertices, nothing reads them without preskinned programs
+	NRenderConfig meshConfig = config;
+	meshConfig.SkinningOffset = MUResourcesManager::HasPreskinnedPrograms() ? MUSkinningManager::RequestSkinning(model, config.BoneOffset) : NInvalidUInt32;
+
 	if (model->VirtualMeshes.size() > 0)
 	{
 		const auto &virtualMeshes = model->VirtualMeshes;
@@ -390,14 +417,14 @@ void MUModelRenderer::RenderBody(
 			{
 				if (!toggles[index]) continue;
 				const auto &virtualMesh = virtualMeshes[index];
-				RenderMesh(model, virtualMesh.Mesh, config, modelMatrix, &virtualMesh.Settings, virtualMeshLights);
+				RenderMesh(model, virtualMesh.Mesh, meshConfig, modelMatrix, &virtualMesh.Settings, virtualMeshLights);
 			}
 		}
 		else
 		{
 			for (const auto &virtualMesh : virtualMeshes)
 			{
-				RenderMesh(model, virtualMesh.Mesh, config, modelMatrix, &virtualMesh.Settings, virtualMeshLights);
+				RenderMesh(model, virtualMesh.Mesh, meshConfig, modelMatrix, &virtualMesh.Settings, virtualMeshLights);
 			}
 		}
 	}
@@ -406,7 +433,7 @@ void MUModelRenderer::RenderBody(
 		const mu_uint32 numMeshes = static_cast<mu_uint32>(model->Meshes.size());
 		for (mu_uint32 m = 0; m < numMeshes; ++m)
 		{
-			RenderMesh(model, m, config, modelMatrix);
+			RenderMesh(model, m, meshConfig, modelMatrix);
 		}
 	}
 }
\ No newline at end of file
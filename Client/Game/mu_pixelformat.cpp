@@ -0,0 +1,252 @@
+#include "stdafx.h"
+#include "mu_pixelformat.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define NEXTMU_PIXELFORMAT_SSSE3 1
+#include <tmmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define NEXTMU_TARGET_SSSE3
+#else
+#define NEXTMU_TARGET_SSSE3 __attribute__((target("ssse3")))
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define NEXTMU_PIXELFORMAT_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace MUPixelFormat
+{
+	constexpr mu_uint32 DestBytes = 4u;
+
+	NEXTMU_INLINE const mu_uint32 GetSourceBytes(const EPixelLayout layout)
+	{
+		return layout == EPixelLayout::BGR8 || layout == EPixelLayout::RGB8 ? 3u : 4u;
+	}
+
+	NEXTMU_INLINE const mu_boolean IsSwapped(const EPixelLayout layout)
+	{
+		return layout == EPixelLayout::BGR8 || layout == EPixelLayout::BGRA8;
+	}
+
+	// round(value * alpha / 255) without a division, every SIMD path uses the same formula
+	NEXTMU_INLINE const mu_uint8 PremultiplyChannel(const mu_uint32 value, const mu_uint32 alpha)
+	{
+		const mu_uint32 t = value * alpha + 128u;
+		return static_cast<mu_uint8>((t + (t >> 8)) >> 8);
+	}
+
+	// Every channel is read before writing the pixel so it works in place
+	void ConvertRowScalar(const mu_uint8 *source, mu_uint8 *dest, const mu_uint32 count, const mu_uint32 sourceBytes, const mu_boolean swap, const mu_boolean premultiply)
+	{
+		const mu_uint32 red = swap ? 2u : 0u;
+		const mu_uint32 blue = swap ? 0u : 2u;
+		for (mu_uint32 x = 0; x < count; ++x, source += sourceBytes, dest += DestBytes)
+		{
+			mu_uint8 r = source[red];
+			mu_uint8 g = source[1];
+			mu_uint8 b = source[blue];
+			const mu_uint8 a = sourceBytes == 4u ? source[3] : 255u;
+
+			if (premultiply)
+			{
+				r = PremultiplyChannel(r, a);
+				g = PremultiplyChannel(g, a);
+				b = PremultiplyChannel(b, a);
+			}
+
+			dest[0] = r;
+			dest[1] = g;
+			dest[2] = b;
+			dest[3] = a;
+		}
+	}
+
+#if NEXTMU_PIXELFORMAT_SSSE3 == 1
+	const mu_boolean DetectSSSE3()
+	{
+#if defined(_MSC_VER)
+		mu_int32 registers[4];
+		__cpuid(registers, 1);
+		return (registers[2] & (1 << 9)) != 0;
+#else
+		return __builtin_cpu_supports("ssse3") != 0;
+#endif
+	}
+
+	const mu_boolean HasSSSE3 = DetectSSSE3();
+
+	NEXTMU_TARGET_SSSE3 NEXTMU_INLINE __m128i PremultiplySSSE3(const __m128i pixels, const __m128i alphaMask)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i bias = _mm_set1_epi16(128);
+		const __m128i alphaShuffle = _mm_setr_epi8(3, 3, 3, 3, 7, 7, 7, 7, 11, 11, 11, 11, 15, 15, 15, 15);
+		const __m128i alpha = _mm_shuffle_epi8(pixels, alphaShuffle);
+
+		__m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(pixels, zero), _mm_unpacklo_epi8(alpha, zero)), bias);
+		__m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(pixels, zero), _mm_unpackhi_epi8(alpha, zero)), bias);
+		lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+		hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+
+		const __m128i premultiplied = _mm_packus_epi16(lo, hi);
+		return _mm_or_si128(_mm_andnot_si128(alphaMask, premultiplied), _mm_and_si128(alphaMask, pixels));
+	}
+
+	// Converts 4 pixels per iteration, returns the pixels converted
+	NEXTMU_TARGET_SSSE3 const mu_uint32 ConvertRowSSSE3(const mu_uint8 *source, mu_uint8 *dest, const mu_uint32 width, const mu_uint32 sourceBytes, const mu_boolean swap, const mu_boolean premultiply)
+	{
+		const __m128i alphaMask = _mm_set1_epi32(static_cast<mu_int32>(0xFF000000u));
+		const __m128i shuffle = sourceBytes == 4u
+			? (swap ? _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15) : _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15))
+			: (swap ? _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1) : _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1));
+
+		// 3 bytes sources load 16 bytes to use 12, the last pixels are left to the scalar path to stay inside the row
+		const mu_uint32 reserved = sourceBytes == 4u ? 4u : 6u;
+
+		mu_uint32 x = 0;
+		for (; x + reserved <= width; x += 4u)
+		{
+			__m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + x * sourceBytes));
+			pixels = _mm_shuffle_epi8(pixels, shuffle);
+			if (sourceBytes == 3u) pixels = _mm_or_si128(pixels, alphaMask);
+			if (premultiply) pixels = PremultiplySSSE3(pixels, alphaMask);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(dest + x * DestBytes), pixels);
+		}
+
+		return x;
+	}
+#elif NEXTMU_PIXELFORMAT_NEON == 1
+	NEXTMU_INLINE uint8x16_t PremultiplyNEON(const uint8x16_t value, const uint8x16_t alpha)
+	{
+		const uint16x8_t lo = vmull_u8(vget_low_u8(value), vget_low_u8(alpha));
+		const uint16x8_t hi = vmull_u8(vget_high_u8(value), vget_high_u8(alpha));
+		return vcombine_u8(vraddhn_u16(lo, vrshrq_n_u16(lo, 8)), vraddhn_u16(hi, vrshrq_n_u16(hi, 8)));
+	}
+
+	// Converts 16 pixels per iteration with interleaved loads, returns the pixels converted
+	const mu_uint32 ConvertRowNEON(const mu_uint8 *source, mu_uint8 *dest, const mu_uint32 width, const mu_uint32 sourceBytes, const mu_boolean swap, const mu_boolean premultiply)
+	{
+		const mu_uint32 red = swap ? 2u : 0u;
+		const mu_uint32 blue = swap ? 0u : 2u;
+
+		mu_uint32 x = 0;
+		for (; x + 16u <= width; x += 16u)
+		{
+			uint8x16x4_t pixels;
+			if (sourceBytes == 4u)
+			{
+				const uint8x16x4_t input = vld4q_u8(source + x * 4u);
+				pixels.val[0] = input.val[red];
+				pixels.val[1] = input.val[1];
+				pixels.val[2] = input.val[blue];
+				pixels.val[3] = input.val[3];
+			}
+			else
+			{
+				const uint8x16x3_t input = vld3q_u8(source + x * 3u);
+				pixels.val[0] = input.val[red];
+				pixels.val[1] = input.val[1];
+				pixels.val[2] = input.val[blue];
+				pixels.val[3] = vdupq_n_u8(255);
+			}
+
+			if (premultiply)
+			{
+				pixels.val[0] = PremultiplyNEON(pixels.val[0], pixels.val[3]);
+				pixels.val[1] = PremultiplyNEON(pixels.val[1], pixels.val[3]);
+				pixels.val[2] = PremultiplyNEON(pixels.val[2], pixels.val[3]);
+			}
+
+			vst4q_u8(dest + x * DestBytes, pixels);
+		}
+
+		return x;
+	}
+#endif
+
+	void ConvertRows(
+		const mu_uint8 *source, const mu_uint32 sourcePitch, const EPixelLayout layout,
+		mu_uint8 *dest, const mu_uint32 destPitch,
+		const mu_uint32 width, const mu_uint32 height,
+		const mu_boolean premultiply
+	)
+	{
+		const mu_uint32 sourceBytes = GetSourceBytes(layout);
+		const mu_boolean swap = IsSwapped(layout);
+
+		for (mu_uint32 y = 0; y < height; ++y)
+		{
+			const mu_uint8 *sourceRow = source + static_cast<mu_size>(y) * sourcePitch;
+			mu_uint8 *destRow = dest + static_cast<mu_size>(y) * destPitch;
+
+			mu_uint32 converted = 0;
+#if NEXTMU_PIXELFORMAT_SSSE3 == 1
+			if (HasSSSE3) converted = ConvertRowSSSE3(sourceRow, destRow, width, sourceBytes, swap, premultiply);
+#elif NEXTMU_PIXELFORMAT_NEON == 1
+			converted = ConvertRowNEON(sourceRow, destRow, width, sourceBytes, swap, premultiply);
+#endif
+			ConvertRowScalar(sourceRow + converted * sourceBytes, destRow + converted * DestBytes, width - converted, sourceBytes, swap, premultiply);
+		}
+	}
+
+	FIBITMAP *ConvertBitmap(FIBITMAP *bitmap, const mu_boolean premultiply)
+	{
+#if FREEIMAGE_COLORORDER == FREEIMAGE_COLORORDER_BGR
+		constexpr EPixelLayout Layout24 = EPixelLayout::BGR8;
+		constexpr EPixelLayout Layout32 = EPixelLayout::BGRA8;
+#else
+		constexpr EPixelLayout Layout24 = EPixelLayout::RGB8;
+		constexpr EPixelLayout Layout32 = EPixelLayout::RGBA8;
+#endif
+
+		const mu_uint32 width = FreeImage_GetWidth(bitmap);
+		const mu_uint32 height = FreeImage_GetHeight(bitmap);
+		const mu_uint32 bpp = FreeImage_GetBPP(bitmap);
+
+		// 24 bits bitmaps are expanded while converting instead of converting them to 32 bits first
+		if (bpp == 24)
+		{
+			FIBITMAP *newBitmap = FreeImage_Allocate(width, height, 32);
+			if (newBitmap != nullptr)
+			{
+				ConvertRows(FreeImage_GetBits(bitmap), FreeImage_GetPitch(bitmap), Layout24, FreeImage_GetBits(newBitmap), FreeImage_GetPitch(newBitmap), width, height, false);
+			}
+
+			FreeImage_Unload(bitmap);
+			return newBitmap;
+		}
+
+		if (bpp != 32)
+		{
+			FIBITMAP *newBitmap = FreeImage_ConvertTo32Bits(bitmap);
+			FreeImage_Unload(bitmap);
+
+			if (newBitmap == nullptr)
+			{
+				return nullptr;
+			}
+
+			bitmap = newBitmap;
+		}
+
+		if (Layout32 != EPixelLayout::RGBA8 || premultiply)
+		{
+			mu_uint8 *bits = FreeImage_GetBits(bitmap);
+			const mu_uint32 pitch = FreeImage_GetPitch(bitmap);
+			ConvertRows(bits, pitch, Layout32, bits, pitch, width, height, premultiply);
+		}
+
+		return bitmap;
+	}
+
+	const mu_char *GetImplementationName()
+	{
+#if NEXTMU_PIXELFORMAT_SSSE3 == 1
+		return HasSSSE3 ? "SSSE3" : "Scalar";
+#elif NEXTMU_PIXELFORMAT_NEON == 1
+		return "NEON";
+#else
+		return "Scalar";
+#endif
+	}
+}
\ No newline at end of file
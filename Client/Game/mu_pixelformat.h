@@ -0,0 +1,39 @@
+#ifndef __MU_PIXELFORMAT_H__
+#define __MU_PIXELFORMAT_H__
+
+#pragma once
+
+// Byte order of the source pixels
+enum class EPixelLayout : mu_uint32
+{
+	BGR8,
+	BGRA8,
+	RGB8,
+	RGBA8,
+};
+
+/*
+	Conversion of 8 bits pixels to RGBA8, the swizzle, the alpha expansion and the alpha premultiplication
+	are done in a single pass over the rows. It uses SSSE3 (when the CPU supports it) or NEON, the borders of the rows are scalar.
+*/
+namespace MUPixelFormat
+{
+	/*
+		Source and destination can only be the same buffer with 4 bytes layouts.
+		Premultiplied channels are rounded to nearest, the alpha channel is kept.
+	*/
+	void ConvertRows(
+		const mu_uint8 *source, const mu_uint32 sourcePitch, const EPixelLayout layout,
+		mu_uint8 *dest, const mu_uint32 destPitch,
+		const mu_uint32 width, const mu_uint32 height,
+		const mu_boolean premultiply
+	);
+
+	// Converts a FIT_BITMAP to 32 bits with RGBA8 byte order, the source bitmap is released, null is returned if it fails
+	FIBITMAP *ConvertBitmap(FIBITMAP *bitmap, const mu_boolean premultiply);
+
+	// Name of the implementation selected for this CPU, used by the logs
+	const mu_char *GetImplementationName();
+}
+
+#endif
\ No newline at end of file
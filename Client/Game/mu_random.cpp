@@ -0,0 +1,101 @@
+#include "stdafx.h"
+#include "mu_random.h"
+
+namespace MURandom
+{
+	constexpr mu_uint32 MainThreadIndex = NInvalidUInt32;
+	constexpr mu_uint32 FillLanes = 8u;
+
+	std::atomic<mu_uint64> GlobalSeed(0x9E3779B97F4A7C15ull);
+	std::atomic<mu_uint32> SeedGeneration(1u);
+
+	struct NThreadGenerator
+	{
+		NGenerator Generator;
+		mu_uint32 Index = MainThreadIndex;
+		mu_uint32 Generation = 0u;
+	};
+	thread_local NThreadGenerator ThreadGenerator;
+
+	NEXTMU_INLINE const mu_uint64 SplitMix64(mu_uint64 &state)
+	{
+		mu_uint64 z = (state += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+
+	void NGenerator::Seed(const mu_uint64 seed)
+	{
+		// xoshiro state can't be zero, splitmix64 never returns two consecutive zeros
+		mu_uint64 state = seed;
+		const mu_uint64 low = SplitMix64(state);
+		const mu_uint64 high = SplitMix64(state);
+		State[0] = static_cast<mu_uint32>(low);
+		State[1] = static_cast<mu_uint32>(low >> 32);
+		State[2] = static_cast<mu_uint32>(high);
+		State[3] = static_cast<mu_uint32>(high >> 32);
+	}
+
+	void NGenerator::Fill(mu_float *values, const mu_uint32 count, const mu_float min, const mu_float max)
+	{
+		// Lanes are seeded from this generator, the states are laid out as a structure of arrays
+		mu_uint32 s0[FillLanes], s1[FillLanes], s2[FillLanes], s3[FillLanes];
+		for (mu_uint32 l = 0; l < FillLanes; ++l)
+		{
+			s0[l] = Next() | 1u;
+			s1[l] = Next();
+			s2[l] = Next();
+			s3[l] = Next();
+		}
+
+		const mu_float scale = (max - min) * (1.0f / 16777216.0f);
+		mu_uint32 n = 0;
+		for (; n + FillLanes <= count; n += FillLanes)
+		{
+			for (mu_uint32 l = 0; l < FillLanes; ++l)
+			{
+				const mu_uint32 result = Rotate(s1[l] * 5u, 7) * 9u;
+				const mu_uint32 t = s1[l] << 9;
+				s2[l] ^= s0[l];
+				s3[l] ^= s1[l];
+				s1[l] ^= s2[l];
+				s0[l] ^= s3[l];
+				s2[l] ^= t;
+				s3[l] = Rotate(s3[l], 11);
+				values[n + l] = min + static_cast<mu_float>(result >> 8) * scale;
+			}
+		}
+
+		for (; n < count; ++n)
+		{
+			values[n] = min + static_cast<mu_float>(Next() >> 8) * scale;
+		}
+	}
+
+	void SetSeed(const mu_uint64 seed)
+	{
+		GlobalSeed.store(seed, std::memory_order_relaxed);
+		SeedGeneration.fetch_add(1u, std::memory_order_release);
+	}
+
+	void SetThreadIndex(const mu_uint32 index)
+	{
+		ThreadGenerator.Index = index;
+		ThreadGenerator.Generation = 0u;
+	}
+
+	NGenerator &GetGenerator()
+	{
+		auto &thread = ThreadGenerator;
+		const mu_uint32 generation = SeedGeneration.load(std::memory_order_acquire);
+		if (thread.Generation != generation)
+		{
+			const mu_uint64 stream = static_cast<mu_uint64>(thread.Index) + 1ull;
+			thread.Generator.Seed(GlobalSeed.load(std::memory_order_relaxed) ^ (stream * 0xD1B54A32D192ED03ull));
+			thread.Generation = generation;
+		}
+
+		return thread.Generator;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,78 @@
+#ifndef __MU_RANDOM_H__
+#define __MU_RANDOM_H__
+
+#pragma once
+
+namespace MURandom
+{
+	/*
+		xoshiro128** generator, it is small enough to be owned by every thread so the particles and joints
+		templates can request random numbers from the workers without locks.
+	*/
+	class NGenerator
+	{
+	public:
+		void Seed(const mu_uint64 seed);
+
+		NEXTMU_INLINE const mu_uint32 Next()
+		{
+			const mu_uint32 result = Rotate(State[1] * 5u, 7) * 9u;
+			const mu_uint32 t = State[1] << 9;
+
+			State[2] ^= State[0];
+			State[3] ^= State[1];
+			State[1] ^= State[2];
+			State[0] ^= State[3];
+			State[2] ^= t;
+			State[3] = Rotate(State[3], 11);
+
+			return result;
+		}
+
+		// Uniform value in [0, 1), only the upper 24 bits are used so every value is exactly representable
+		NEXTMU_INLINE const mu_float NextFloat()
+		{
+			return static_cast<mu_float>(Next() >> 8) * (1.0f / 16777216.0f);
+		}
+
+		// Fills values with uniform values in [min, max), lanes are independent so the loop can be vectorized
+		void Fill(mu_float *values, const mu_uint32 count, const mu_float min, const mu_float max);
+
+	private:
+		static NEXTMU_INLINE const mu_uint32 Rotate(const mu_uint32 value, const mu_int32 bits)
+		{
+			return (value << bits) | (value >> (32 - bits));
+		}
+
+	private:
+		mu_uint32 State[4];
+	};
+
+	/*
+		Every thread uses its own stream derived from the seed and the worker index, threads manager workers always
+		receive the same ranges so the same seed and threads count reproduce the same effects.
+	*/
+	void SetSeed(const mu_uint64 seed);
+	void SetThreadIndex(const mu_uint32 index);
+	NGenerator &GetGenerator();
+
+	// Same ranges as glm::linearRand, floats are in [min, max) and integers in [min, max]
+	NEXTMU_INLINE const mu_float Linear(const mu_float min, const mu_float max)
+	{
+		return min + (max - min) * GetGenerator().NextFloat();
+	}
+
+	NEXTMU_INLINE const mu_int32 Linear(const mu_int32 min, const mu_int32 max)
+	{
+		const mu_uint64 range = static_cast<mu_uint64>(static_cast<mu_int64>(max) - static_cast<mu_int64>(min) + 1);
+		return min + static_cast<mu_int32>((static_cast<mu_uint64>(GetGenerator().Next()) * range) >> 32);
+	}
+
+	NEXTMU_INLINE const glm::vec3 Linear(const glm::vec3 &min, const glm::vec3 &max)
+	{
+		auto &generator = GetGenerator();
+		return min + (max - min) * glm::vec3(generator.NextFloat(), generator.NextFloat(), generator.NextFloat());
+	}
+}
+
+#endif
\ No newline at end of file
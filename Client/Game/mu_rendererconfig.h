@@ -10,6 +10,7 @@ struct NRenderConfig
 	mu_float BodyScale;
 	mu_boolean EnableLight;
 	glm::vec4 BodyLight;
+	mu_uint32 SkinningOffset = NInvalidUInt32; // Filled by RenderBody when the skinning cache is available
 };
 
 #endif
\ No newline at end of file
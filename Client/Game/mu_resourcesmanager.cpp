@@ -1,14 +1,24 @@
 #include "stdafx.h"
 #include "mu_resourcesmanager.h"
 #include "mu_skeletonmanager.h"
+#include "mu_skinningmanager.h"
 #include "mu_textureattachments.h"
 #include "mu_config.h"
 #include "mu_graphics.h"
 #include "mu_model.h"
+#include "mu_model_optimizer.h"
+#include "mu_animationlibrary.h"
 #include "mu_textures.h"
+#include "mu_textureatlas.h"
+#include "mu_texture_containers.h"
+#include "mu_pixelformat.h"
+#include "mu_texturestreaming.h"
+#include "mu_threadsmanager.h"
 #include "res_renders.h"
 #include "res_items.h"
+#include "t_joint_base.h"
 #include <boost/algorithm/string/replace.hpp>
+#include <chrono>
 
 template<const EGameDirectoryType dirType>
 NEXTMU_INLINE std::vector<mu_char> mu_readshader(mu_utf8string filename)
@@ -32,18 +42,92 @@ NEXTMU_INLINE std::vector<mu_char> mu_readshader(mu_utf8string filename)
 typedef std::unique_ptr<NModel> ModelPointer;
 typedef std::unique_ptr<NGraphicsTexture> TexturePointer;
 
+struct NTextureRequest
+{
+	mu_utf8string Id;
+	mu_utf8string Path;
+	Diligent::SamplerDesc Sampler;
+	mu_boolean Mipmaps = true; // UI textures opt-out with "mipmaps": false
+	mu_float AlphaReference = MUTextures::DefaultAlphaReference;
+	mu_utf8string Atlas; // Group of the atlas the texture is packed in, empty when it is loaded alone
+	FIBITMAP *Bitmap = nullptr;
+	TextureInfo Info;
+	mu_boolean Decoded = false;
+};
+
+struct NModelRequest
+{
+	mu_utf8string Id;
+	mu_utf8string Path;
+	ModelPointer Model;
+	mu_boolean Prepared = false;
+};
+
 namespace MUResourcesManager
 {
+	/*
+		Assets are decoded by the worker threads in batches, the main thread creates the device objects of a batch before
+		the next one is decoded, so the decoded data waiting for the upload is bounded by the batch size.
+	*/
+	constexpr mu_size UploadBatchSize = 64u;
+
 	std::map<mu_utf8string, mu_shader> Programs;
+	std::map<mu_shader, mu_shader> PreskinnedPrograms;
 	std::map<mu_utf8string, TexturePointer> Textures;
+	std::map<mu_utf8string, NGraphicsTexture *> StreamedTextures; // Owned by the texture streaming
 	std::map<mu_utf8string, ModelPointer> Models;
+	NLoadStatistics LoadStatistics;
+
+	NEXTMU_INLINE const mu_double GetElapsedMilliseconds(const std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<mu_double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	template<typename Request, typename DecodeFunc, typename UploadFunc>
+	const mu_boolean LoadStaged(std::vector<Request> &requests, DecodeFunc decode, UploadFunc upload, NLoadTimings &timings)
+	{
+		timings.Count = static_cast<mu_uint32>(requests.size());
+		for (mu_size first = 0; first < requests.size(); first += UploadBatchSize)
+		{
+			const auto begin = requests.begin() + first;
+			const auto end = requests.begin() + glm::min(first + UploadBatchSize, requests.size());
+
+			const auto decodeStart = std::chrono::steady_clock::now();
+			MUThreadsManager::Run(
+				std::unique_ptr<NThreadExecutorBase>(
+					new (std::nothrow) NThreadExecutorIterator(begin, end, decode)
+				)
+			);
+			timings.Decode += GetElapsedMilliseconds(decodeStart);
+
+			const auto uploadStart = std::chrono::steady_clock::now();
+			for (auto iter = begin; iter != end; ++iter)
+			{
+				if (upload(*iter) == false)
+				{
+					return false;
+				}
+			}
+			timings.Upload += GetElapsedMilliseconds(uploadStart);
+		}
+
+		return true;
+	}
+
+	NEXTMU_INLINE void LogTimings(const mu_char *type, const NLoadTimings &timings)
+	{
+		mu_info("[Resources] {} {} loaded in {:.2f}ms (decode {:.2f}ms, upload {:.2f}ms)", timings.Count, type, timings.Decode + timings.Upload, timings.Decode, timings.Upload);
+	}
 
 	const mu_boolean LoadPrograms(const mu_utf8string basePath, const nlohmann::json &programs);
-	const mu_boolean LoadTextures(const mu_utf8string basePath, const nlohmann::json &textures);
-	const mu_boolean LoadModels(const mu_utf8string basePath, const nlohmann::json &models);
+	const mu_boolean LoadTextures(const mu_utf8string basePath, const nlohmann::json &textures, NLoadTimings &timings);
+	const mu_boolean BuildAtlases(std::vector<NTextureRequest> &requests);
+	const mu_boolean LoadModels(const mu_utf8string basePath, const nlohmann::json &models, NLoadTimings &timings);
 
 	const mu_boolean Load()
 	{
+		LoadStatistics = NLoadStatistics();
+
 		const mu_utf8string path = "data/";
 		const mu_utf8string filename = path + "resources.json";
 
@@ -80,38 +164,98 @@ namespace MUResourcesManager
 		if (document.contains("shaders"))
 		{
 			const auto shaders = document["shaders"];
+			const auto programsStart = std::chrono::steady_clock::now();
 			if (LoadPrograms(path, shaders) == false)
 			{
 				return false;
 			}
+			LoadStatistics.Programs.Count = static_cast<mu_uint32>(Programs.size());
+			LoadStatistics.Programs.Upload = GetElapsedMilliseconds(programsStart);
+			mu_info("[Resources] {} programs loaded in {:.2f}ms", LoadStatistics.Programs.Count, LoadStatistics.Programs.Upload);
 		}
 
 		if (document.contains("textures"))
 		{
 			const auto textures = document["textures"];
-			if (LoadTextures(path, textures) == false)
+			auto &timings = LoadStatistics.Textures;
+			if (LoadTextures(path, textures, timings) == false)
 			{
 				return false;
 			}
+			LogTimings("textures", timings);
+
+			if (MUTextureStreaming::IsEnabled())
+			{
+				mu_info("[Resources] {} textures streamed with a budget of {}MB", StreamedTextures.size(), MUConfig::GetTextureStreamingBudget());
+			}
+
+			const auto atlasStatistics = MUTextureAtlas::GetStatistics();
+			if (atlasStatistics.Pages > 0)
+			{
+				mu_info("[Textures] {} textures packed into {} atlas pages, occupancy {:.1f}%", atlasStatistics.Regions, atlasStatistics.Pages, atlasStatistics.GetOccupancy() * 100.0);
+			}
 		}
 
 		if (document.contains("models"))
 		{
 			const auto models = document["models"];
-			if (LoadModels(path, models) == false)
+			auto &timings = LoadStatistics.Models;
+			if (LoadModels(path, models, timings) == false)
 			{
 				return false;
 			}
+			LogTimings("models", timings);
+
+			const auto statistics = MUModelOptimizer::GetStatistics();
+			mu_info(
+				"[Models] {} meshes, {} triangles, {} vertices welded into {}, ACMR {:.3f} optimized to {:.3f}",
+				statistics.Meshes,
+				statistics.Triangles,
+				statistics.SourceVertices,
+				statistics.WeldedVertices,
+				statistics.GetSourceACMR(),
+				statistics.GetOptimizedACMR()
+			);
+
+			const auto animationStatistics = MUAnimationLibrary::GetStatistics();
+			mu_info(
+				"[Models] {} skeleton and animation blocks ({:.2f}MB), {} duplicated blocks shared saving {:.2f}MB",
+				animationStatistics.Blocks,
+				static_cast<mu_double>(animationStatistics.UniqueBytes) / (1024.0 * 1024.0),
+				animationStatistics.Shared,
+				static_cast<mu_double>(animationStatistics.SharedBytes) / (1024.0 * 1024.0)
+			);
 		}
 
+		// Models textures are compressed too, so the statistics are reported once everything is loaded
+		const auto textureStatistics = MUTextureCompressor::GetStatistics();
+		mu_info(
+			"[Textures] {} compressed, {:.2f}MB compressed into {:.2f}MB, PSNR {:.2f}dB",
+			textureStatistics.Textures,
+			static_cast<mu_double>(textureStatistics.SourceBytes) / (1024.0 * 1024.0),
+			static_cast<mu_double>(textureStatistics.CompressedBytes) / (1024.0 * 1024.0),
+			textureStatistics.GetPSNR()
+		);
+		mu_info("[Textures] pixel conversion using {}", MUPixelFormat::GetImplementationName());
+
 		return true;
 	}
 
+	const NLoadStatistics &GetLoadStatistics()
+	{
+		return LoadStatistics;
+	}
+
 	void Destroy()
 	{
+		LoadStatistics = NLoadStatistics();
 		Programs.clear();
+		PreskinnedPrograms.clear();
 		Textures.clear();
+		StreamedTextures.clear();
+		MUTextureAtlas::ClearStatistics();
 		Models.clear();
+		MUAnimationLibrary::Clear();
 	}
 
 	const mu_utf8string FixShaderSourceByDeviceType(const Diligent::RENDER_DEVICE_TYPE deviceType, mu_utf8string source)
@@ -186,11 +330,12 @@ namespace MUResourcesManager
 		return true;
 	}
 
-	const mu_boolean LoadProgram(const mu_utf8string id, const mu_utf8string vertex, const mu_utf8string fragment, const mu_utf8string resourceId, const nlohmann::json &jmacros)
+	const mu_boolean LoadProgram(const mu_utf8string id, const mu_utf8string vertex, const mu_utf8string fragment, const mu_utf8string resourceId, const nlohmann::json &jmacros, const mu_boolean preskinned)
 	{
 		Diligent::ShaderMacroHelper macros;
 		macros.AddShaderMacro("SKELETON_TEXTURE_WIDTH", MUSkeletonManager::BonesTextureWidth);
 		macros.AddShaderMacro("SKELETON_TEXTURE_HEIGHT", MUSkeletonManager::BonesTextureHeight);
+		macros.AddShaderMacro("SKELETON_TEXTURE_HALF", MUSkeletonManager::IsHalfPrecision() ? 1 : 0);
 		macros.AddShaderMacro("USE_SHADOW", MUConfig::GetEnableShadows() ? 1 : 0);
 		macros.AddShaderMacro("SHADOW_MODE", static_cast<mu_int32>(MUConfig::GetShadowMode()));
 		macros.AddShaderMacro("SHADOW_FILTER_SIZE", static_cast<mu_int32>(MUConfig::GetShadowFilterSize()));
@@ -229,7 +374,43 @@ namespace MUResourcesManager
 		settings.InputLayout = GetInputLayout(resourceId);
 		settings.Resource = GetPipelineResource(resourceId);
 
-		return LoadProgram(id, vertex, fragment, settings);
+		if (LoadProgram(id, vertex, fragment, settings) == false)
+		{
+			return false;
+		}
+
+		/*
+			Mesh programs declared as preskinned get a variant which reads vertices already skinned by the skinning cache,
+			it uses the same input layout and the shader must skip the bones transformation when PRESKINNED is 1.
+			Programs which don't declare it keep skinning in the vertex shader with the original vertices.
+		*/
+		if (preskinned && MUSkinningManager::IsEnabled())
+		{
+			if (resourceId != "mesh")
+			{
+				mu_error("only mesh programs can be preskinned ({})", id);
+				return false;
+			}
+
+			Diligent::ShaderMacroHelper preskinnedMacros = macros;
+			preskinnedMacros.AddShaderMacro("PRESKINNED", 1);
+
+			NShaderSettings preskinnedSettings;
+			preskinnedSettings.VertexMacros = preskinnedMacros;
+			preskinnedSettings.PixelMacros = preskinnedMacros;
+			preskinnedSettings.InputLayout = GetInputLayout(resourceId);
+			preskinnedSettings.Resource = GetPipelineResource(resourceId);
+
+			const mu_utf8string preskinnedId = id + "_preskinned";
+			if (LoadProgram(preskinnedId, vertex, fragment, preskinnedSettings) == false)
+			{
+				return false;
+			}
+
+			PreskinnedPrograms.insert(std::pair(GetProgram(id), GetProgram(preskinnedId)));
+		}
+
+		return true;
 	}
 
 	const mu_boolean LoadPrograms(const mu_utf8string basePath, const nlohmann::json &programs)
@@ -242,8 +423,9 @@ namespace MUResourcesManager
 			const mu_utf8string fragment = p["fragment"].get<mu_utf8string>();
 			const mu_utf8string resourceId = p["resource_id"].get<mu_utf8string>();
 			const auto &macros = p.contains("macros") ? p["macros"] : dummyArray;
+			const mu_boolean preskinned = p.contains("preskinned") && p["preskinned"].get<mu_boolean>();
 
-			if (LoadProgram(id, basePath + vertex, basePath + fragment, resourceId, macros) == false)
+			if (LoadProgram(id, basePath + vertex, basePath + fragment, resourceId, macros, preskinned) == false)
 			{
 				return false;
 			}
@@ -252,8 +434,10 @@ namespace MUResourcesManager
 		return true;
 	}
 
-	const mu_boolean LoadTextures(const mu_utf8string basePath, const nlohmann::json &textures)
+	const mu_boolean LoadTextures(const mu_utf8string basePath, const nlohmann::json &textures, NLoadTimings &timings)
 	{
+		std::vector<NTextureRequest> requests;
+		requests.reserve(textures.size());
 		for (const auto &t : textures)
 		{
 			const mu_utf8string id = t["id"];
@@ -271,39 +455,176 @@ namespace MUResourcesManager
 				wrap = t["wrap"].get<mu_utf8string>();
 			}
 
-			auto texture = MUTextures::Load(basePath + path, MUTextures::CalculateSamplerFlags(filter, wrap));
-			if (!texture)
+			NTextureRequest request{
+				.Id = id,
+				.Path = basePath + path,
+				.Sampler = MUTextures::CalculateSamplerFlags(filter, wrap),
+			};
+
+			// UI textures are drawn at their size so they opt-out with "mipmaps": false
+			if (t.contains("mipmaps"))
 			{
-				mu_error("failed to load texture ({})", path);
-				return false;
+				request.Mipmaps = t["mipmaps"].get<mu_boolean>();
+			}
+
+			if (t.contains("alpha_test"))
+			{
+				request.AlphaReference = t["alpha_test"].get<mu_float>();
+			}
+
+			// Streamed textures are only loaded once they are drawn or prefetched by a map
+			if (MUTextureStreaming::IsEnabled() && t.contains("streaming") && t["streaming"].get<mu_boolean>() == true)
+			{
+				NGraphicsTexture *texture = MUTextureStreaming::Register(request.Path, request.Sampler, request.Mipmaps, request.AlphaReference);
+				if (texture == nullptr)
+				{
+					return false;
+				}
+
+				StreamedTextures.insert(std::pair(request.Id, texture));
+				continue;
+			}
+
+			// Effect textures share the pages of their atlas, so they are clamped to their region, containers keep their format
+			mu_utf8string ext = path.substr(path.find_last_of('.') + 1);
+			std::transform(ext.begin(), ext.end(), ext.begin(), mu_utf8tolower);
+			if (t.contains("atlas") && TJoint::IsTextureUsed(id))
+			{
+				// Joint ribbons scroll their coordinates beyond the texture, they require their own texture to repeat it
+				mu_info("texture {} is used by joints, it is loaded outside of its atlas", id);
+			}
+			else if (t.contains("atlas") && MUTextureContainers::IsContainerExtension(ext) == false)
+			{
+				request.Atlas = fmt::format("{}_{}", t["atlas"].get<mu_utf8string>(), filter);
+				request.Sampler = MUTextures::CalculateSamplerFlags(filter, "clamp");
 			}
 
-			Textures.insert(std::pair(id, std::move(texture)));
+			requests.push_back(std::move(request));
 		}
 
-		return true;
+		const mu_boolean loaded = LoadStaged(
+			requests,
+			[](NTextureRequest &request) -> void {
+				if (request.Atlas.empty() == false)
+				{
+					request.Decoded = MUTextures::LoadRaw(request.Path, &request.Bitmap, request.Info);
+					return;
+				}
+
+				request.Decoded = MUTextures::Decode(request.Path, &request.Bitmap, request.Info, request.Mipmaps, request.AlphaReference);
+			},
+			[](NTextureRequest &request) -> const mu_boolean {
+				if (request.Decoded == false)
+				{
+					mu_error("failed to load texture ({})", request.Path);
+					return false;
+				}
+
+				// Atlas textures are packed once every texture is decoded
+				if (request.Atlas.empty() == false)
+				{
+					if (request.Info.Width <= MUTextureAtlas::MaxRegionSize && request.Info.Height <= MUTextureAtlas::MaxRegionSize) return true;
+					request.Atlas.clear();
+					if (request.Mipmaps) MUTextures::GenerateMipmaps(request.Bitmap, request.Info, request.AlphaReference);
+				}
+
+				auto texture = MUTextures::Create(request.Path, request.Bitmap, request.Info, request.Sampler);
+				request.Bitmap = nullptr;
+				if (!texture)
+				{
+					mu_error("failed to load texture ({})", request.Path);
+					return false;
+				}
+
+				Textures.insert(std::pair(request.Id, std::move(texture)));
+				return true;
+			},
+			timings
+		);
+
+		const mu_boolean packed = loaded && BuildAtlases(requests);
+
+		// Bitmaps decoded after a failed upload are still pending
+		for (auto &request : requests)
+		{
+			if (request.Bitmap != nullptr) FreeImage_Unload(request.Bitmap);
+		}
+
+		return packed;
 	}
 
-	const mu_boolean LoadModels(const mu_utf8string basePath, const nlohmann::json &models)
+	const mu_boolean BuildAtlases(std::vector<NTextureRequest> &requests)
 	{
-		for (const auto &m : models)
+		std::map<mu_utf8string, std::vector<NTextureRequest *>> groups;
+		for (auto &request : requests)
 		{
-			const mu_utf8string id = m["id"];
-			const mu_utf8string path = m["path"];
+			if (request.Atlas.empty() == false) groups[request.Atlas].push_back(&request);
+		}
+
+		for (auto &[name, group] : groups)
+		{
+			std::vector<MUTextureAtlas::NAtlasTexture> textures(group.size());
+			for (mu_size index = 0; index < group.size(); ++index)
+			{
+				auto request = group[index];
+				textures[index].Path = request->Path;
+				textures[index].Bitmap = request->Bitmap;
+				textures[index].Info = std::move(request->Info);
+				request->Bitmap = nullptr;
+			}
 
-			std::unique_ptr<NModel> model(new_nothrow NModel());
-			if (model->Load(id, basePath + path) == false)
+			if (MUTextureAtlas::Build(name, textures, group[0]->Sampler) == false)
 			{
-				mu_error("failed to load model ({})", path);
+				mu_error("failed to build texture atlas ({})", name);
 				return false;
 			}
 
-			Models.insert(std::pair(id, std::move(model)));
+			for (mu_size index = 0; index < group.size(); ++index)
+			{
+				Textures.insert(std::pair(group[index]->Id, std::move(textures[index].Texture)));
+			}
 		}
 
 		return true;
 	}
 
+	const mu_boolean LoadModels(const mu_utf8string basePath, const nlohmann::json &models, NLoadTimings &timings)
+	{
+		std::vector<NModelRequest> requests;
+		requests.reserve(models.size());
+		for (const auto &m : models)
+		{
+			const mu_utf8string id = m["id"];
+			const mu_utf8string path = m["path"];
+
+			requests.push_back(
+				NModelRequest{
+					.Id = id,
+					.Path = basePath + path,
+					.Model = ModelPointer(new_nothrow NModel()),
+				}
+			);
+		}
+
+		return LoadStaged(
+			requests,
+			[](NModelRequest &request) -> void {
+				request.Prepared = request.Model->Prepare(request.Id, request.Path);
+			},
+			[](NModelRequest &request) -> const mu_boolean {
+				if (request.Prepared == false || request.Model->Upload() == false)
+				{
+					mu_error("failed to load model ({})", request.Path);
+					return false;
+				}
+
+				Models.insert(std::pair(request.Id, std::move(request.Model)));
+				return true;
+			},
+			timings
+		);
+	}
+
 	const mu_shader GetProgram(const mu_utf8string id)
 	{
 		auto iter = Programs.find(id);
@@ -311,11 +632,33 @@ namespace MUResourcesManager
 		return iter->second;
 	}
 
+	const mu_shader GetPreskinnedProgram(const mu_shader program)
+	{
+		auto iter = PreskinnedPrograms.find(program);
+		if (iter == PreskinnedPrograms.end()) return NInvalidShader;
+		return iter->second;
+	}
+
+	const mu_boolean HasPreskinnedPrograms()
+	{
+		return PreskinnedPrograms.empty() == false;
+	}
+
 	NGraphicsTexture *GetTexture(const mu_utf8string id)
 	{
 		auto iter = Textures.find(id);
-		if (iter == Textures.end()) return nullptr;
-		return iter->second.get();
+		if (iter != Textures.end()) return iter->second.get();
+
+		auto streamedIter = StreamedTextures.find(id);
+		if (streamedIter == StreamedTextures.end()) return nullptr;
+		return streamedIter->second;
+	}
+
+	void PrefetchTexture(const mu_utf8string id)
+	{
+		auto iter = StreamedTextures.find(id);
+		if (iter == StreamedTextures.end()) return;
+		MUTextureStreaming::Prefetch(iter->second);
 	}
 
 	NModel *GetModel(const mu_utf8string id)
@@ -19,16 +19,40 @@ struct NShaderSettings
 	std::vector<Diligent::IPipelineResourceSignature *> ResourceSignatures;
 };
 
+struct NLoadTimings
+{
+	mu_uint32 Count = 0;
+	mu_double Decode = 0.0; // Milliseconds spent by the workers
+	mu_double Upload = 0.0; // Milliseconds spent creating the device objects
+};
+
+struct NLoadStatistics
+{
+	NLoadTimings Programs; // Compiled on the main thread, so only Upload is used
+	NLoadTimings Textures;
+	NLoadTimings Models;
+};
+
 namespace MUResourcesManager
 {
 	const mu_boolean Load();
 	void Destroy();
+	// Timings of the last Load() per asset type
+	const NLoadStatistics &GetLoadStatistics();
 
 	const mu_boolean LoadProgram(const mu_utf8string id, const mu_utf8string vertex, const mu_utf8string fragment, NShaderSettings &settings);
-	const mu_boolean LoadProgram(const mu_utf8string id, const mu_utf8string vertex, const mu_utf8string fragment, const mu_utf8string resourceId, const nlohmann::json &jmacros);
+	/*
+		Programs declared with "preskinned": true promise to skip the bones transformation when PRESKINNED is 1,
+		only those get the variant which reads the vertices skinned by the skinning cache.
+	*/
+	const mu_boolean LoadProgram(const mu_utf8string id, const mu_utf8string vertex, const mu_utf8string fragment, const mu_utf8string resourceId, const nlohmann::json &jmacros, const mu_boolean preskinned = false);
 
 	const mu_shader GetProgram(const mu_utf8string id);
+	const mu_shader GetPreskinnedProgram(const mu_shader program);
+	const mu_boolean HasPreskinnedPrograms();
 	NGraphicsTexture *GetTexture(const mu_utf8string id);
+	// Streamed textures start loading before they are drawn, the others are always resident
+	void PrefetchTexture(const mu_utf8string id);
 	NModel *GetModel(const mu_utf8string id);
 };
 
@@ -15,9 +15,12 @@
 #include "mu_controllerstate.h"
 #include "mu_threadsmanager.h"
 #include "mu_resourcesmanager.h"
+#include "mu_texturestreaming.h"
 #include "mu_animationsmanager.h"
 #include "mu_skeletoninstance.h"
 #include "mu_skeletonmanager.h"
+#include "mu_skinningmanager.h"
+#include "mu_gpuparticles.h"
 #include "mu_charactersmanager.h"
 #include "mu_textureattachments.h"
 #include "mu_model.h"
@@ -26,12 +29,14 @@
 #include "res_renders.h"
 #include "res_items.h"
 #include "mu_math.h"
+#include "mu_random.h"
 
 #include "ui_noesisgui.h"
 
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtc/random.hpp>
+#include <chrono>
 
 constexpr mu_double GameCycleTime = 1000.0 / 25.0; // 25 FPS
 
@@ -121,6 +126,9 @@ namespace MURoot
 			return false;
 		}
 
+		const mu_uint64 randomSeed = MUConfig::GetRandomSeed();
+		MURandom::SetSeed(randomSeed != 0ull ? randomSeed : static_cast<mu_uint64>(std::chrono::steady_clock::now().time_since_epoch().count()));
+
 		if (MUThreadsManager::Initialize() == false)
 		{
 			mu_error("Failed to initialize threads.");
@@ -165,6 +173,24 @@ namespace MURoot
 			return false;
 		}
 
+		if (MUSkinningManager::Initialize() == false)
+		{
+			mu_error("Failed to initialize skinning manager.");
+			return false;
+		}
+
+		if (MUGPUParticles::Initialize() == false)
+		{
+			mu_error("Failed to initialize GPU particles.");
+			return false;
+		}
+
+		if (MUTextureStreaming::Initialize() == false)
+		{
+			mu_error("Failed to initialize texture streaming.");
+			return false;
+		}
+
 		if (MUResourcesManager::Load() == false)
 		{
 			mu_error("Failed to load resources.");
@@ -234,11 +260,14 @@ namespace MURoot
 		MURendersManager::Destroy();
 		MUBBoxRenderer::Destroy();
 		MUModelRenderer::Destroy();
+		MUGPUParticles::Destroy();
+		MUSkinningManager::Destroy();
 		MUSkeletonManager::Destroy();
 #if NEXTMU_UI_LIBRARY == NEXTMU_UI_NOESISGUI
 		UINoesis::Destroy();
 #endif
 		MUResourcesManager::Destroy();
+		MUTextureStreaming::Destroy();
 #if PHYSICS_ENABLED == 1
 		MUPhysics::Destroy();
 #endif
@@ -664,6 +693,7 @@ namespace MURoot
 			MUState::SetUpdate(updateTime, updateCount);
 			MURenderState::Reset();
 			MUSkeletonManager::Reset();
+			MUSkinningManager::Reset();
 
 			fpsCounterTime += elapsedTime;
 			++fpsCounterCount;
@@ -674,6 +704,19 @@ namespace MURoot
 				fpsCounterLastCount = fpsCounterCount;
 				fpsCounterCount = 0;
 				fpsCounterTime = 0.0;
+
+#if NEXTMU_COMPILE_DEBUG == 1
+				// Statistics of the last frame, the groups are the draws which would be issued without batching
+				const auto &particlesDraws = environment->GetParticles()->GetRenderStatistics();
+				const auto &particlesCulling = environment->GetParticles()->GetStatistics();
+				const auto &jointsDraws = environment->GetJoints()->GetRenderStatistics();
+				mu_info(
+					"[DEBUG] {:.2f}ms ({} frames) : particles {} groups merged into {} draws ({} rendered, {} culled), joints {} groups merged into {} draws",
+					fpsCounterLastValue, fpsCounterLastCount,
+					particlesDraws.Groups, particlesDraws.Draws, particlesCulling.Rendered, particlesCulling.Culled,
+					jointsDraws.Groups, jointsDraws.Draws
+				);
+#endif
 			}
 
 			if (updateCount > 0)
@@ -802,6 +845,7 @@ namespace MURoot
 			auto *pRTV = swapchain->GetCurrentBackBufferRTV();
 			auto *pDSV = swapchain->GetDepthBufferDSV();
 
+			MUTextureStreaming::Update();
 			MURenderState::AttachEnvironment(environment.get());
 			environment->Update();
 			MUSkeletonManager::Update();
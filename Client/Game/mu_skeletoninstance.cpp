@@ -3,122 +3,246 @@
 #include "mu_model.h"
 #include "mu_skeletonmanager.h"
 
-void NSkeletonInstance::Animate(
+/*
+	Keys and interpolation factors of an animation pair (current and prior action),
+	resolved once per Animate and shared by all the bones evaluated with it.
+*/
+struct NAnimationSampler
+{
+	const NAnimationKey *CurrentStart;
+	const NAnimationKey *Current1;
+	const NAnimationKey *Current2;
+	const NAnimationKey *Prior1;
+	const NAnimationKey *Prior2;
+	mu_float S1, S2;
+	mu_float PS1, PS2;
+	mu_boolean LockPosition;
+};
+
+NEXTMU_INLINE void ResolveFrames(
+	const NAnimation &animation,
+	const mu_float frame,
+	mu_uint32 &frame1,
+	mu_uint32 &frame2
+)
+{
+	const mu_uint32 framesCount = static_cast<mu_uint32>(animation.Keys.size());
+	frame1 = static_cast<mu_uint32>(glm::floor(frame));
+	frame2 = static_cast<mu_uint32>(glm::ceil(frame));
+
+	if (animation.Loop)
+	{
+		if (frame1 >= framesCount) frame1 = framesCount - 1;
+		if (frame2 >= framesCount) frame2 = framesCount - 1;
+	}
+	else
+	{
+		frame1 = frame1 % framesCount;
+		frame2 = frame2 % framesCount;
+	}
+}
+
+NEXTMU_INLINE void PrepareSampler(
 	const NModel *Model,
 	AnimationFrameInfo Current,
 	AnimationFrameInfo Prior,
-	const glm::vec3 HeadAngle
+	NAnimationSampler &sampler
 )
 {
 	const mu_uint32 numAnimations = static_cast<mu_uint32>(Model->Animations.size());
-	const mu_uint32 numBones = static_cast<mu_uint32>(Model->BoneInfo.size());
-
-	mu_assert(numAnimations > 0);
-	mu_assert(numBones > 0);
-
-	if (Bones.size() < numBones) Bones.resize(numBones);
 
 	if (Current.Action >= numAnimations) Current.Action = 0;
 	if (Current.Frame < 0.0f) Current.Frame = 0.0f;
 	if (Prior.Action >= numAnimations) Prior.Action = 0;
 	if (Prior.Frame < 0.0f) Prior.Frame = 0.0f;
 
-	mu_uint32 current = static_cast<mu_uint32>(glm::floor(Current.Frame));
-	mu_uint32 prior = static_cast<mu_uint32>(glm::floor(Prior.Frame));
-	mu_uint32 currentNext = static_cast<mu_uint32>(glm::ceil(Current.Frame));
-	mu_uint32 priorNext = static_cast<mu_uint32>(glm::ceil(Prior.Frame));
-
 	const auto &currentAnimation = Model->Animations[Current.Action];
 	const auto &priorAnimation = Model->Animations[Prior.Action];
-	const auto &currentFramesCount = static_cast<mu_uint32>(currentAnimation.Keys.size());
-	const auto &priorFramesCount = static_cast<mu_uint32>(priorAnimation.Keys.size());
 
-	if (currentAnimation.Loop)
-	{
-		if (current >= currentFramesCount) current = currentFramesCount - 1;
-		if (currentNext >= currentFramesCount) currentNext = currentFramesCount - 1;
-	}
-	else
+	mu_uint32 current, currentNext, prior, priorNext;
+	ResolveFrames(currentAnimation, Current.Frame, current, currentNext);
+	ResolveFrames(priorAnimation, Prior.Frame, prior, priorNext);
+
+	/*
+		Why I processed 4 frames instead of only 2 frames?
+		To provide a correct animation blending in high framerates.
+	*/
+	sampler.CurrentStart = &currentAnimation.Keys[0];
+	sampler.Current1 = &currentAnimation.Keys[current];
+	sampler.Current2 = &currentAnimation.Keys[currentNext];
+	sampler.Prior1 = &priorAnimation.Keys[prior];
+	sampler.Prior2 = &priorAnimation.Keys[priorNext];
+
+	sampler.S1 = Current.Frame - glm::floor(Current.Frame);
+	sampler.S2 = 1.0f - sampler.S1;
+	sampler.PS1 = Prior.Frame - glm::floor(Prior.Frame);
+	sampler.PS2 = 1.0f - sampler.PS1;
+
+	sampler.LockPosition = priorAnimation.LockPositions || currentAnimation.LockPositions;
+}
+
+NEXTMU_INLINE void SampleBone(
+	const NAnimationSampler &sampler,
+	const mu_uint32 b,
+	const mu_boolean isHead,
+	const glm::quat &headRotation,
+	const mu_float bodyHeight,
+	NCompressedMatrix &outBone
+)
+{
+	const auto &currentStartBone = sampler.CurrentStart->Bones[b];
+	const auto &currentBone1 = sampler.Current1->Bones[b];
+	const auto &currentBone2 = sampler.Current2->Bones[b];
+	const auto &priorBone1 = sampler.Prior1->Bones[b];
+	const auto &priorBone2 = sampler.Prior2->Bones[b];
+
+	glm::quat currentRotation = glm::slerp(currentBone1.Rotation, currentBone2.Rotation, sampler.S1);
+	glm::quat priorRotation = glm::slerp(priorBone1.Rotation, priorBone2.Rotation, sampler.PS1);
+
+	if (isHead)
 	{
-		current = current % currentFramesCount;
-		currentNext = currentNext % currentFramesCount;
+		currentRotation *= headRotation;
+		priorRotation *= headRotation;
 	}
 
-	if (priorAnimation.Loop)
+	const auto currentPosition = currentBone1.Position * sampler.S2 + currentBone2.Position * sampler.S1;
+	const auto priorPosition = priorBone1.Position * sampler.PS2 + priorBone2.Position * sampler.PS1;
+
+	outBone.Rotation = glm::slerp(priorRotation, currentRotation, sampler.S1);
+	outBone.Scale = 1.0f;
+
+	if (b == 0 && sampler.LockPosition)
 	{
-		if (prior >= priorFramesCount) prior = priorFramesCount - 1;
-		if (priorNext >= priorFramesCount) priorNext = priorFramesCount - 1;
+		outBone.Position[0] = currentStartBone.Position[0];
+		outBone.Position[1] = currentStartBone.Position[1];
+		outBone.Position[2] = priorPosition[2] * sampler.S2 + currentPosition[2] * sampler.S1 + bodyHeight;
 	}
 	else
 	{
-		prior = prior % priorFramesCount;
-		priorNext = priorNext % priorFramesCount;
+		outBone.Position = priorPosition * sampler.S2 + currentPosition * sampler.S1;
 	}
+}
 
-	/*
-		Why I processed 4 frames instead of only 2 frames?
-		To provide a correct animation blending in high framerates.
-	*/
-	const auto &currentStartFrame = currentAnimation.Keys[0];
-	const auto &currentFrame1 = currentAnimation.Keys[current];
-	const auto &currentFrame2 = currentAnimation.Keys[currentNext];
-	const auto &priorFrame1 = priorAnimation.Keys[prior];
-	const auto &priorFrame2 = priorAnimation.Keys[priorNext];
-	const auto boneHead = static_cast<mu_uint32>(Model->BoneHead);
+void NSkeletonInstance::Animate(
+	const NModel *Model,
+	AnimationFrameInfo Current,
+	AnimationFrameInfo Prior,
+	const glm::vec3 HeadAngle
+)
+{
+	const mu_uint32 numAnimations = static_cast<mu_uint32>(Model->Animations.size());
+	const mu_uint32 numBones = static_cast<mu_uint32>(Model->BoneInfo.size());
 
-	const mu_float s1 = Current.Frame - glm::floor(Current.Frame);
-	const mu_float s2 = 1.0f - s1;
-	const mu_float ps1 = Prior.Frame - glm::floor(Prior.Frame);
-	const mu_float ps2 = 1.0f - ps1;
+	mu_assert(numAnimations > 0);
+	mu_assert(numBones > 0);
 
-	const mu_boolean lockPosition = priorAnimation.LockPositions || currentAnimation.LockPositions;
+	Bones = MUSkeletonManager::AllocateBones(numBones);
+
+	const auto boneHead = static_cast<mu_uint32>(Model->BoneHead);
 	const glm::quat headRotation(glm::vec3(glm::radians(-HeadAngle[0]), 0.0f, glm::radians(-HeadAngle[1])));
-	for (mu_uint32 b = 0; b < numBones; ++b)
+
+	NAnimationSampler baseSampler;
+	PrepareSampler(Model, Current, Prior, baseSampler);
+
+	if (Model->HasBoneMasks() == false)
 	{
-		auto &info = Model->BoneInfo[b];
-		if (info.Dummy) continue;
+		for (mu_uint32 b = 0; b < numBones; ++b)
+		{
+			auto &info = Model->BoneInfo[b];
+			auto &outBone = Bones[b];
 
-		const auto &currentStartBone = currentStartFrame.Bones[b];
-		const auto &currentBone1 = currentFrame1.Bones[b];
-		const auto &currentBone2 = currentFrame2.Bones[b];
-		const auto &priorBone1 = priorFrame1.Bones[b];
-		const auto &priorBone2 = priorFrame2.Bones[b];
+			// The arena is reused every frame, dummy bones are still uploaded so they must not keep stale data
+			if (info.Dummy)
+			{
+				outBone.SetIdentity();
+				continue;
+			}
 
-		const auto &currentRotation1 = currentBone1.Rotation;
-		const auto &currentRotation2 = currentBone2.Rotation;
-		const auto &priorRotation1 = priorBone1.Rotation;
-		const auto &priorRotation2 = priorBone2.Rotation;
+			SampleBone(baseSampler, b, b == boneHead, headRotation, Model->BodyHeight, outBone);
 
-		glm::quat currentRotation = glm::slerp(currentRotation1, currentRotation2, s1);
-		glm::quat priorRotation = glm::slerp(priorRotation1, priorRotation2, ps1);
+			mu_assert(info.Parent == NInvalidInt16 || (info.Parent >= 0 && info.Parent < static_cast<mu_int16>(numBones)));
+			MixBones(
+				info.Parent == NInvalidInt16
+				? Parent
+				: Bones[info.Parent],
+				outBone
+			);
+		}
+
+		BonesCount = numBones;
+		return;
+	}
+
+	/*
+		Masked evaluation, the local pose of every mask is sampled from the base animation unless a fully weighted
+		override layer replaces it, then the layers are blended and finally the hierarchy is resolved.
+	*/
+	for (mu_uint32 m = 0; m < NBoneMaskTypeCount; ++m)
+	{
+		const auto &layer = Layers[m];
+		const auto &mask = Model->BoneMasks[m];
+		const mu_float weight = layer.Enabled ? glm::clamp(layer.Weight, 0.0f, 1.0f) : 0.0f;
+		const mu_boolean replaced = weight >= 1.0f && layer.Blend == NAnimationLayerBlend::Override;
 
-		if (b == boneHead)
+		if (replaced == false)
 		{
-			currentRotation *= headRotation;
-			priorRotation *= headRotation;
+			for (const auto b : mask.Bones)
+			{
+				SampleBone(baseSampler, b, b == boneHead, headRotation, Model->BodyHeight, Bones[b]);
+			}
 		}
 
-		const auto &currentPosition1 = currentBone1.Position;
-		const auto &currentPosition2 = currentBone2.Position;
-		const auto &priorPosition1 = priorBone1.Position;
-		const auto &priorPosition2 = priorBone2.Position;
-
-		const auto currentPosition = currentPosition1 * s2 + currentPosition2 * s1;
-		const auto priorPosition = priorPosition1 * ps2 + priorPosition2 * ps1;
+		if (weight <= 0.0f) continue;
 
-		auto &outBone = Bones[b];
-		outBone.Rotation = glm::slerp(priorRotation, currentRotation, s1);
-		outBone.Scale = 1.0f;
+		NAnimationSampler layerSampler;
+		PrepareSampler(Model, layer.Current, layer.Prior, layerSampler);
 
-		if (b == 0 && lockPosition)
+		if (replaced)
+		{
+			for (const auto b : mask.Bones)
+			{
+				SampleBone(layerSampler, b, b == boneHead, headRotation, Model->BodyHeight, Bones[b]);
+			}
+		}
+		else if (layer.Blend == NAnimationLayerBlend::Override)
 		{
-			outBone.Position[0] = currentStartBone.Position[0];
-			outBone.Position[1] = currentStartBone.Position[1];
-			outBone.Position[2] = priorPosition[2] * s2 + currentPosition[2] * s1 + Model->BodyHeight;
+			for (const auto b : mask.Bones)
+			{
+				NCompressedMatrix layerBone;
+				SampleBone(layerSampler, b, b == boneHead, headRotation, Model->BodyHeight, layerBone);
+
+				auto &outBone = Bones[b];
+				outBone.Rotation = glm::slerp(outBone.Rotation, layerBone.Rotation, weight);
+				outBone.Position = glm::mix(outBone.Position, layerBone.Position, weight);
+			}
 		}
 		else
 		{
-			outBone.Position = priorPosition * s2 + currentPosition * s1;
+			const glm::quat identity(1.0f, 0.0f, 0.0f, 0.0f);
+			const auto &referenceKey = *layerSampler.CurrentStart;
+			for (const auto b : mask.Bones)
+			{
+				NCompressedMatrix layerBone;
+				SampleBone(layerSampler, b, false, headRotation, Model->BodyHeight, layerBone);
+
+				const auto &referenceBone = referenceKey.Bones[b];
+				const glm::quat deltaRotation = glm::inverse(referenceBone.Rotation) * layerBone.Rotation;
+				const glm::vec3 deltaPosition = layerBone.Position - referenceBone.Position;
+
+				auto &outBone = Bones[b];
+				outBone.Rotation = outBone.Rotation * glm::slerp(identity, deltaRotation, weight);
+				outBone.Position += deltaPosition * weight;
+			}
+		}
+	}
+
+	for (mu_uint32 b = 0; b < numBones; ++b)
+	{
+		auto &info = Model->BoneInfo[b];
+		if (info.Dummy)
+		{
+			Bones[b].SetIdentity();
+			continue;
 		}
 
 		mu_assert(info.Parent == NInvalidInt16 || (info.Parent >= 0 && info.Parent < static_cast<mu_int16>(numBones)));
@@ -126,7 +250,7 @@ void NSkeletonInstance::Animate(
 			info.Parent == NInvalidInt16
 			? Parent
 			: Bones[info.Parent],
-			outBone
+			Bones[b]
 		);
 	}
 
@@ -136,5 +260,5 @@ void NSkeletonInstance::Animate(
 const mu_uint32 NSkeletonInstance::Upload()
 {
 	if (BonesCount == 0) return NInvalidUInt32;
-	return MUSkeletonManager::UploadBones(Bones.data(), BonesCount);
+	return MUSkeletonManager::UploadBones(Bones, BonesCount);
 }
\ No newline at end of file
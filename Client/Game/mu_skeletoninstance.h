@@ -26,6 +26,39 @@ struct AnimationFrameInfo
 	mu_float Frame;
 };
 
+enum class NAnimationLayerBlend : mu_uint8
+{
+	Override, // Replaces the base pose of the masked bones
+	Additive, // Adds the delta from the first frame of the layer animation to the base pose
+};
+
+struct NAnimationLayer
+{
+	mu_boolean Enabled = false;
+	NAnimationLayerBlend Blend = NAnimationLayerBlend::Override;
+	AnimationFrameInfo Current;
+	AnimationFrameInfo Prior;
+	mu_float Weight = 1.0f;
+};
+
+class NSkeletonInstance;
+
+/*
+	Flattened skeleton work queued during PreRender, bodies and linked parts are pushed into the same
+	list so the work is evenly distributed between the workers instead of one entity per iteration.
+	Jobs with Animate disabled were already animated during PreRender (bodies with linked parts).
+*/
+struct NSkeletonJob
+{
+	NSkeletonInstance *Instance = nullptr;
+	const NModel *Model = nullptr;
+	AnimationFrameInfo Current;
+	AnimationFrameInfo Prior;
+	glm::vec3 HeadAngle = glm::vec3(0.0f, 0.0f, 0.0f);
+	mu_uint32 *SkeletonOffset = nullptr;
+	mu_boolean Animate = true;
+};
+
 class NSkeletonInstance
 {
 public:
@@ -63,10 +96,29 @@ public:
 		return Bones[bone];
 	}
 
+	/*
+		Layers are only evaluated for the bones of their mask, models without masks ignore them.
+	*/
+	void SetLayer(const NBoneMaskType mask, const NAnimationLayer &layer)
+	{
+		Layers[static_cast<mu_uint32>(mask)] = layer;
+	}
+
+	void ClearLayer(const NBoneMaskType mask)
+	{
+		Layers[static_cast<mu_uint32>(mask)].Enabled = false;
+	}
+
+	const NAnimationLayer &GetLayer(const NBoneMaskType mask) const
+	{
+		return Layers[static_cast<mu_uint32>(mask)];
+	}
+
 private:
 	NCompressedMatrix Parent;
-	std::vector<NCompressedMatrix> Bones;
-	mu_uint32 BonesCount;
+	std::array<NAnimationLayer, NBoneMaskTypeCount> Layers;
+	NCompressedMatrix *Bones = nullptr; // Allocated from the skeleton manager per-frame arena
+	mu_uint32 BonesCount = 0;
 };
 
 #endif
\ No newline at end of file
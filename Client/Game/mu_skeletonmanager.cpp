@@ -3,15 +3,25 @@
 #include "mu_skeletoninstance.h"
 #include "mu_graphics.h"
 #include "mu_renderstate.h"
+#include "mu_config.h"
+#include "mu_threadsmanager.h"
 
 namespace MUSkeletonManager
 {
 	Diligent::RefCntAutoPtr<Diligent::ITexture> BonesTexture;
 	std::vector<NCompressedMatrix> BonesBuffer;
+	std::vector<NHalfCompressedMatrix> HalfBonesBuffer;
 	mu_atomic_uint32_t BonesCount = 0;
+	std::vector<NCompressedMatrix> BonesArena;
+	mu_atomic_uint32_t BonesArenaCount = 0;
+	std::vector<NSkeletonJob> Jobs;
+	mu_atomic_uint32_t JobsCount = 0;
+	mu_boolean HalfPrecision = false;
 
 	const mu_boolean Initialize()
 	{
+		HalfPrecision = MUConfig::GetHalfPrecisionBones();
+
 		const auto device = MUGraphics::GetDevice();
 		const auto immediateContext = MUGraphics::GetImmediateContext();
 
@@ -22,7 +32,7 @@ namespace MUSkeletonManager
 		textureDesc.Type = Diligent::RESOURCE_DIM_TEX_2D;
 		textureDesc.Width = BonesTextureWidth;
 		textureDesc.Height = BonesTextureHeight;
-		textureDesc.Format = Diligent::TEX_FORMAT_RGBA32_FLOAT;
+		textureDesc.Format = HalfPrecision ? Diligent::TEX_FORMAT_RGBA16_FLOAT : Diligent::TEX_FORMAT_RGBA32_FLOAT;
 		textureDesc.Usage = Diligent::USAGE_DEFAULT;
 		textureDesc.BindFlags = Diligent::BIND_SHADER_RESOURCE;
 
@@ -37,7 +47,16 @@ namespace MUSkeletonManager
 		immediateContext->TransitionResourceStates(1, &barrier);
 
 		BonesTexture = texture;
-		BonesBuffer.resize(MaxBonesCount);
+		if (HalfPrecision)
+		{
+			HalfBonesBuffer.resize(MaxBonesCount);
+		}
+		else
+		{
+			BonesBuffer.resize(MaxBonesCount);
+		}
+		BonesArena.resize(MaxBonesCount);
+		Jobs.resize(MaxSkeletonJobs);
 
 		return true;
 	}
@@ -45,6 +64,10 @@ namespace MUSkeletonManager
 	void Destroy()
 	{
 		BonesTexture.Release();
+		BonesBuffer.clear();
+		HalfBonesBuffer.clear();
+		BonesArena.clear();
+		Jobs.clear();
 	}
 
 	Diligent::ITexture *GetTexture()
@@ -52,9 +75,16 @@ namespace MUSkeletonManager
 		return BonesTexture.RawPtr();
 	}
 
+	const mu_boolean IsHalfPrecision()
+	{
+		return HalfPrecision;
+	}
+
 	void Reset()
 	{
 		BonesCount.store(0u, std::memory_order_relaxed);
+		BonesArenaCount.store(0u, std::memory_order_relaxed);
+		JobsCount.store(0u, std::memory_order_relaxed);
 	}
 
 	void Update()
@@ -75,7 +105,9 @@ namespace MUSkeletonManager
 			BonesTexture,
 			0, 0,
 			Diligent::Box(0, width, 0, height),
-			Diligent::TextureSubResData(BonesBuffer.data(), sizeof(glm::vec4) * width),
+			HalfPrecision
+			? Diligent::TextureSubResData(HalfBonesBuffer.data(), sizeof(glm::u16vec4) * width)
+			: Diligent::TextureSubResData(BonesBuffer.data(), sizeof(glm::vec4) * width),
 			Diligent::RESOURCE_STATE_TRANSITION_MODE_NONE,
 			Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION
 		);
@@ -94,7 +126,59 @@ namespace MUSkeletonManager
 	{
 		const mu_uint32 index = BonesCount.fetch_add(bonesCount);
 		mu_assert(index + bonesCount <= MaxBonesCount);
-		mu_memcpy(&BonesBuffer[index], bones, sizeof(NCompressedMatrix) * bonesCount);
+		if (HalfPrecision)
+		{
+			// Encoding is done here so it is distributed between the threads which upload the bones
+			NHalfCompressedMatrix *dest = &HalfBonesBuffer[index];
+			for (mu_uint32 n = 0; n < bonesCount; ++n)
+			{
+				EncodeHalfMatrix(bones[n], dest[n]);
+			}
+		}
+		else
+		{
+			mu_memcpy(&BonesBuffer[index], bones, sizeof(NCompressedMatrix) * bonesCount);
+		}
 		return index;
 	}
+
+	NCompressedMatrix *AllocateBones(const mu_uint32 bonesCount)
+	{
+		const mu_uint32 index = BonesArenaCount.fetch_add(bonesCount);
+		mu_assert(index + bonesCount <= MaxBonesCount);
+		return &BonesArena[index];
+	}
+
+	void QueueJob(const NSkeletonJob &job)
+	{
+		const mu_uint32 index = JobsCount.fetch_add(1u);
+		mu_assert(index < MaxSkeletonJobs);
+		Jobs[index] = job;
+	}
+
+	void RunJobs()
+	{
+		const mu_uint32 jobsCount = JobsCount.exchange(0u);
+		if (jobsCount == 0) return;
+
+		MUThreadsManager::Run(
+			std::unique_ptr<NThreadExecutorBase>(
+				new (std::nothrow) NThreadExecutorIterator(
+					Jobs.begin(), Jobs.begin() + jobsCount,
+					[](NSkeletonJob &job) -> void {
+						if (job.Animate)
+						{
+							job.Instance->Animate(
+								job.Model,
+								job.Current,
+								job.Prior,
+								job.HeadAngle
+							);
+						}
+						*job.SkeletonOffset = job.Instance->Upload();
+					}
+				)
+			)
+		);
+	}
 };
\ No newline at end of file
@@ -4,26 +4,34 @@
 #pragma once
 
 struct NCompressedMatrix;
+struct NSkeletonJob;
 
 namespace MUSkeletonManager
 {
 	/*
 		2048x512 can handle around ~2600 characters with 200 bones per character.
 		This texture will consume 16MB of video memory, not much but enough.
+		With half precision bones enabled the texture uses RGBA16F and consumes 8MB.
 	*/
 	constexpr mu_uint32 BonesTextureWidth = 2048;
 	constexpr mu_uint32 BonesTextureHeight = 512;
 	constexpr mu_uint32 MaxBonesCount = (BonesTextureWidth * BonesTextureHeight) / 2u;
+	constexpr mu_uint32 MaxSkeletonJobs = 16384u;
 
 	const mu_boolean Initialize();
 	void Destroy();
 
 	Diligent::ITexture *GetTexture();
+	const mu_boolean IsHalfPrecision();
 
 	void Reset();
 	void Update();
 
 	const mu_uint32 UploadBones(const NCompressedMatrix *bones, const mu_uint32 bonesCount);
+	NCompressedMatrix *AllocateBones(const mu_uint32 bonesCount);
+
+	void QueueJob(const NSkeletonJob &job);
+	void RunJobs();
 }
 
 #endif
\ No newline at end of file
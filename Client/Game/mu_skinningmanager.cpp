@@ -0,0 +1,330 @@
+#include "stdafx.h"
+#include "mu_skinningmanager.h"
+#include "mu_skeletonmanager.h"
+#include "mu_capabilities.h"
+#include "mu_config.h"
+#include "mu_graphics.h"
+#include "mu_model.h"
+#include <MapHelper.hpp>
+#include <ShaderMacroHelper.hpp>
+
+#pragma pack(4)
+struct NSkinningSettings
+{
+	mu_uint32 InputOffset;
+	mu_uint32 OutputOffset;
+	mu_uint32 VerticesCount;
+	mu_uint32 BoneOffset;
+};
+#pragma pack()
+
+struct NSkinningJob
+{
+	NModel *Model;
+	mu_uint32 BoneOffset;
+	mu_uint32 OutputOffset;
+};
+
+struct NSkinningKey
+{
+	const NModel *Model;
+	mu_uint32 BoneOffset;
+
+	const mu_boolean operator==(const NSkinningKey &other) const
+	{
+		return Model == other.Model && BoneOffset == other.BoneOffset;
+	}
+};
+
+struct NSkinningKeyHash
+{
+	std::size_t operator()(const NSkinningKey &key) const
+	{
+		return std::hash<const void *>()(key.Model) ^ (static_cast<std::size_t>(key.BoneOffset) * 0x9E3779B97F4A7C15ull);
+	}
+};
+
+/*
+	Skins NMeshVertex (uncompressed layout) using the same bone format as the vertex shader,
+	position and normal are written in model space so the pre-skinned programs only apply BodyOrigin.
+*/
+static const mu_char *SkinningShaderSource = R"(
+cbuffer SkinningSettings
+{
+	uint InputOffset;
+	uint OutputOffset;
+	uint VerticesCount;
+	uint BoneOffset;
+};
+
+Texture2D<float4> g_SkeletonTexture;
+ByteAddressBuffer g_InputVertices;
+RWByteAddressBuffer g_OutputVertices;
+
+float4 LoadBoneTexel(uint index)
+{
+	return g_SkeletonTexture.Load(int3(index % SKELETON_TEXTURE_WIDTH, index / SKELETON_TEXTURE_WIDTH, 0));
+}
+
+float3 RotateVector(float4 q, float3 v)
+{
+	float3 t = 2.0 * cross(q.xyz, v);
+	return v + q.w * t + cross(q.xyz, t);
+}
+
+[numthreads(SKINNING_THREADS_COUNT, 1, 1)]
+void main(uint3 id : SV_DispatchThreadID)
+{
+	if (id.x >= VerticesCount) return;
+
+	uint input = (InputOffset + id.x) * VERTEX_STRIDE;
+	uint output = (OutputOffset + id.x) * VERTEX_STRIDE;
+
+	float3 position = asfloat(g_InputVertices.Load3(input));
+	float3 normal = asfloat(g_InputVertices.Load3(input + 12));
+	uint3 extra = g_InputVertices.Load3(input + 24);
+
+	uint positionTexel = (BoneOffset + (extra.z & 0xFF)) * 2;
+	uint normalTexel = (BoneOffset + ((extra.z >> 8) & 0xFF)) * 2;
+
+	float4 positionRotation = LoadBoneTexel(positionTexel).yzwx;
+	float4 positionScale = LoadBoneTexel(positionTexel + 1);
+	float4 normalRotation = LoadBoneTexel(normalTexel).yzwx;
+#if SKELETON_TEXTURE_HALF
+	positionRotation = normalize(positionRotation);
+	normalRotation = normalize(normalRotation);
+#endif
+
+	position = RotateVector(positionRotation, position * positionScale.w) + positionScale.xyz;
+	normal = RotateVector(normalRotation, normal);
+
+	g_OutputVertices.Store3(output, asuint(position));
+	g_OutputVertices.Store3(output + 12, asuint(normal));
+	g_OutputVertices.Store3(output + 24, extra);
+}
+)";
+
+namespace MUSkinningManager
+{
+	mu_boolean Enabled = false;
+	Diligent::RefCntAutoPtr<Diligent::IBuffer> SkinnedBuffer;
+	Diligent::RefCntAutoPtr<Diligent::IBuffer> SettingsUniform;
+	Diligent::RefCntAutoPtr<Diligent::IPipelineState> Pipeline;
+	Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding> Binding;
+
+	std::vector<NSkinningJob> Jobs;
+	std::unordered_map<NSkinningKey, mu_uint32, NSkinningKeyHash> JobsByKey;
+	mu_uint32 DispatchedJobs = 0;
+	mu_uint32 VerticesCount = 0;
+
+	const mu_boolean Initialize()
+	{
+		/*
+			Skinning cache requires raw buffers which aren't available with our OpenGL backend,
+			compressed meshes aren't supported by the skinning shader either.
+		*/
+		Enabled = (
+			NEXTMU_COMPRESSED_MESHS == 0 &&
+			MUConfig::GetComputeSkinning() &&
+			MUCapabilities::IsComputeShaderSupported() &&
+			MUCapabilities::IsRawBufferSupported()
+		);
+		if (Enabled == false) return true;
+
+		const auto device = MUGraphics::GetDevice();
+
+		Diligent::ShaderMacroHelper macros;
+		macros.AddShaderMacro("SKELETON_TEXTURE_WIDTH", MUSkeletonManager::BonesTextureWidth);
+		macros.AddShaderMacro("SKELETON_TEXTURE_HALF", MUSkeletonManager::IsHalfPrecision() ? 1 : 0);
+		macros.AddShaderMacro("SKINNING_THREADS_COUNT", SkinningThreadsCount);
+		macros.AddShaderMacro("VERTEX_STRIDE", static_cast<mu_uint32>(sizeof(NMeshVertex)));
+
+		Diligent::ShaderCreateInfo createInfo;
+#if NEXTMU_COMPILE_DEBUG == 1
+		createInfo.Desc.Name = "Skinning Shader";
+#endif
+		createInfo.SourceLanguage = Diligent::SHADER_SOURCE_LANGUAGE_HLSL;
+		createInfo.Desc.ShaderType = Diligent::SHADER_TYPE_COMPUTE;
+		createInfo.EntryPoint = "main";
+		createInfo.Source = SkinningShaderSource;
+		createInfo.Macros = macros;
+
+		Diligent::RefCntAutoPtr<Diligent::IShader> shader;
+		device->CreateShader(createInfo, &shader);
+		if (shader == nullptr)
+		{
+			return false;
+		}
+
+		// Skinned Vertex Buffer
+		{
+			Diligent::BufferDesc bufferDesc;
+#if NEXTMU_COMPILE_DEBUG == 1
+			bufferDesc.Name = "Skinned Vertex Buffer";
+#endif
+			bufferDesc.Usage = Diligent::USAGE_DEFAULT;
+			bufferDesc.BindFlags = Diligent::BIND_VERTEX_BUFFER | Diligent::BIND_UNORDERED_ACCESS;
+			bufferDesc.Mode = Diligent::BUFFER_MODE_RAW;
+			bufferDesc.Size = MaxSkinnedVertices * sizeof(NMeshVertex);
+
+			Diligent::RefCntAutoPtr<Diligent::IBuffer> buffer;
+			device->CreateBuffer(bufferDesc, nullptr, &buffer);
+			if (buffer == nullptr)
+			{
+				return false;
+			}
+
+			SkinnedBuffer = buffer;
+		}
+
+		// Skinning Settings
+		{
+			Diligent::BufferDesc bufferDesc;
+			bufferDesc.Usage = Diligent::USAGE_DYNAMIC;
+			bufferDesc.BindFlags = Diligent::BIND_UNIFORM_BUFFER;
+			bufferDesc.CPUAccessFlags = Diligent::CPU_ACCESS_WRITE;
+			bufferDesc.Size = sizeof(NSkinningSettings);
+
+			Diligent::RefCntAutoPtr<Diligent::IBuffer> buffer;
+			device->CreateBuffer(bufferDesc, nullptr, &buffer);
+			if (buffer == nullptr)
+			{
+				return false;
+			}
+
+			SettingsUniform = buffer;
+		}
+
+		Diligent::ShaderResourceVariableDesc variables[] = {
+			{ Diligent::SHADER_TYPE_COMPUTE, "g_InputVertices", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_DYNAMIC },
+		};
+
+		Diligent::ComputePipelineStateCreateInfo pipelineInfo;
+#if NEXTMU_COMPILE_DEBUG == 1
+		pipelineInfo.PSODesc.Name = "Skinning Pipeline";
+#endif
+		pipelineInfo.PSODesc.PipelineType = Diligent::PIPELINE_TYPE_COMPUTE;
+		pipelineInfo.PSODesc.ResourceLayout.DefaultVariableType = Diligent::SHADER_RESOURCE_VARIABLE_TYPE_STATIC;
+		pipelineInfo.PSODesc.ResourceLayout.Variables = variables;
+		pipelineInfo.PSODesc.ResourceLayout.NumVariables = mu_countof(variables);
+		pipelineInfo.pCS = shader;
+
+		Diligent::RefCntAutoPtr<Diligent::IPipelineState> pipeline;
+		device->CreateComputePipelineState(pipelineInfo, &pipeline);
+		if (pipeline == nullptr)
+		{
+			return false;
+		}
+
+		pipeline->GetStaticVariableByName(Diligent::SHADER_TYPE_COMPUTE, "SkinningSettings")->Set(SettingsUniform);
+		pipeline->GetStaticVariableByName(Diligent::SHADER_TYPE_COMPUTE, "g_SkeletonTexture")->Set(MUSkeletonManager::GetTexture()->GetDefaultView(Diligent::TEXTURE_VIEW_SHADER_RESOURCE));
+		pipeline->GetStaticVariableByName(Diligent::SHADER_TYPE_COMPUTE, "g_OutputVertices")->Set(SkinnedBuffer->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS));
+
+		Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding> binding;
+		pipeline->CreateShaderResourceBinding(&binding, true);
+		if (binding == nullptr)
+		{
+			return false;
+		}
+
+		Pipeline = pipeline;
+		Binding = binding;
+
+		return true;
+	}
+
+	void Destroy()
+	{
+		Binding.Release();
+		Pipeline.Release();
+		SettingsUniform.Release();
+		SkinnedBuffer.Release();
+		Jobs.clear();
+		JobsByKey.clear();
+	}
+
+	const mu_boolean IsEnabled()
+	{
+		return Enabled;
+	}
+
+	Diligent::IBuffer *GetVertexBuffer()
+	{
+		return SkinnedBuffer.RawPtr();
+	}
+
+	void Reset()
+	{
+		Jobs.clear();
+		JobsByKey.clear();
+		DispatchedJobs = 0;
+		VerticesCount = 0;
+	}
+
+	void Dispatch(Diligent::IDeviceContext *immediateContext)
+	{
+		const mu_uint32 jobsCount = static_cast<mu_uint32>(Jobs.size());
+		if (DispatchedJobs >= jobsCount) return;
+
+		std::vector<Diligent::StateTransitionDesc> barriers;
+		auto inputVariable = Binding->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "g_InputVertices");
+
+		immediateContext->SetPipelineState(Pipeline);
+		for (mu_uint32 n = DispatchedJobs; n < jobsCount; ++n)
+		{
+			const auto &job = Jobs[n];
+			const auto model = job.Model;
+
+			{
+				Diligent::MapHelper<NSkinningSettings> uniform(immediateContext, SettingsUniform, Diligent::MAP_WRITE, Diligent::MAP_FLAG_DISCARD);
+				uniform->InputOffset = 0;
+				uniform->OutputOffset = job.OutputOffset;
+				uniform->VerticesCount = model->VerticesCount;
+				uniform->BoneOffset = job.BoneOffset;
+			}
+
+			inputVariable->Set(model->VertexBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE));
+			immediateContext->CommitShaderResources(Binding, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+			immediateContext->DispatchCompute(
+				Diligent::DispatchComputeAttribs(
+					(model->VerticesCount + SkinningThreadsCount - 1) / SkinningThreadsCount,
+					1,
+					1
+				)
+			);
+
+			// Source vertex buffer is still used by the vertex shader skinning fallback
+			barriers.push_back(Diligent::StateTransitionDesc(model->VertexBuffer, Diligent::RESOURCE_STATE_UNKNOWN, Diligent::RESOURCE_STATE_VERTEX_BUFFER, Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE));
+		}
+
+		barriers.push_back(Diligent::StateTransitionDesc(SkinnedBuffer, Diligent::RESOURCE_STATE_UNKNOWN, Diligent::RESOURCE_STATE_VERTEX_BUFFER, Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE));
+		immediateContext->TransitionResourceStates(static_cast<mu_uint32>(barriers.size()), barriers.data());
+
+		DispatchedJobs = jobsCount;
+	}
+
+	const mu_uint32 RequestSkinning(NModel *model, const mu_uint32 boneOffset)
+	{
+		if (Enabled == false || boneOffset == NInvalidUInt32 || model->VerticesCount == 0) return NInvalidUInt32;
+
+		const NSkinningKey key = { .Model = model, .BoneOffset = boneOffset };
+		auto iter = JobsByKey.find(key);
+		if (iter != JobsByKey.end()) return iter->second;
+
+		if (VerticesCount + model->VerticesCount > MaxSkinnedVertices) return NInvalidUInt32;
+
+		const mu_uint32 outputOffset = VerticesCount;
+		VerticesCount += model->VerticesCount;
+
+		Jobs.push_back(
+			NSkinningJob{
+				.Model = model,
+				.BoneOffset = boneOffset,
+				.OutputOffset = outputOffset,
+			}
+		);
+		JobsByKey.insert(std::make_pair(key, outputOffset));
+
+		return outputOffset;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,31 @@
+#ifndef __MU_SKINNINGMANAGER_H__
+#define __MU_SKINNINGMANAGER_H__
+
+#pragma once
+
+class NModel;
+
+namespace MUSkinningManager
+{
+	/*
+		Pre-skinned vertices are shared by every pass which renders the same model with the same skeleton
+		(shadow cascades, normal pass and body parts), 512K vertices consume around 18MB of video memory.
+		They are only drawn with the mesh programs declared with "preskinned": true in resources.json, those shaders
+		must skip the bones transformation when PRESKINNED is 1 or the vertices would be skinned twice.
+	*/
+	constexpr mu_uint32 MaxSkinnedVertices = 512u * 1024u;
+	constexpr mu_uint32 SkinningThreadsCount = 64u;
+
+	const mu_boolean Initialize();
+	void Destroy();
+
+	const mu_boolean IsEnabled();
+	Diligent::IBuffer *GetVertexBuffer();
+
+	void Reset();
+	void Dispatch(Diligent::IDeviceContext *immediateContext);
+
+	const mu_uint32 RequestSkinning(NModel *model, const mu_uint32 boneOffset);
+}
+
+#endif
\ No newline at end of file
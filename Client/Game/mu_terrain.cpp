@@ -3,6 +3,7 @@
 #include "mu_config.h"
 #include "mu_graphics.h"
 #include "mu_textures.h"
+#include "mu_pixelformat.h"
 #include "mu_resourcesmanager.h"
 #include "mu_threadsmanager.h"
 #include "mu_state.h"
@@ -464,23 +465,12 @@ const mu_boolean NTerrain::LoadLightmap(mu_utf8string path, std::vector<Diligent
 		return false;
 	}
 
-	const mu_uint32 pitch = FreeImage_GetPitch(bitmap);
-	const mu_uint32 bpp = FreeImage_GetBPP(bitmap);
-	if (pitch != TerrainSize * 4 || bpp != 32)
+	bitmap = MUPixelFormat::ConvertBitmap(bitmap, false);
+	if (bitmap == nullptr)
 	{
-		FIBITMAP *newBitmap = FreeImage_ConvertTo32Bits(bitmap);
-		FreeImage_Unload(bitmap);
-
-		if (newBitmap == nullptr)
-		{
-			return false;
-		}
-
-		bitmap = newBitmap;
+		return false;
 	}
 
-	const mu_uint32 newPitch = FreeImage_GetPitch(bitmap);
-	const mu_uint32 newBPP = FreeImage_GetBPP(bitmap);
 	const mu_uint8 *bitmapBuffer = FreeImage_GetBits(bitmap);
 
 	if (!TerrainLight) TerrainLight.reset(new_nothrow glm::vec4[TerrainSize * TerrainSize]);
@@ -488,7 +478,7 @@ const mu_boolean NTerrain::LoadLightmap(mu_utf8string path, std::vector<Diligent
 	const glm::vec3 *normalBuffer = TerrainNormal.get();
 	for (mu_uint32 index = 0; index < TerrainSize * TerrainSize; ++index, bitmapBuffer += 4, ++normalBuffer)
 	{
-		glm::vec3 light(bitmapBuffer[FI_RGBA_RED] / 255.0f, bitmapBuffer[FI_RGBA_GREEN] / 255.0f, bitmapBuffer[FI_RGBA_BLUE] / 255.0f);
+		glm::vec3 light(bitmapBuffer[0] / 255.0f, bitmapBuffer[1] / 255.0f, bitmapBuffer[2] / 255.0f);
 		TerrainPrimaryLight[index] = TerrainLight[index] = glm::vec4(glm::vec3(light) * glm::clamp(glm::dot(*normalBuffer, Light) + 0.5f, 0.0f, 1.0f), 1.0f);
 	}
 	FreeImage_Unload(bitmap);
@@ -544,6 +534,44 @@ struct bitmap_delete { // default deleter for unique_ptr
 
 typedef std::unique_ptr<FIBITMAP, bitmap_delete> UniqueBitmap;
 
+// Generates the mip chain of every layer once they share their size, array subresources are ordered by layer and then by level
+void GenerateLayersMipmaps(
+	std::vector<UniqueBitmap> &bitmaps,
+	std::vector<TextureInfo> &infos,
+	const mu_uint32 width,
+	const mu_uint32 height,
+	const mu_float alphaReference,
+	std::vector<Diligent::TextureSubResData> &subresources
+)
+{
+	for (mu_size n = 0; n < bitmaps.size(); ++n)
+	{
+		FIBITMAP *bitmap = bitmaps[n].get();
+		TextureInfo &info = infos[n];
+		info.Width = static_cast<mu_uint16>(width);
+		info.Height = static_cast<mu_uint16>(height);
+		MUTextures::GenerateMipmaps(bitmap, info, alphaReference);
+
+		Diligent::TextureSubResData subresource;
+		subresource.pData = FreeImage_GetBits(bitmap);
+		subresource.Stride = width * sizeof(mu_uint8) * 4;
+		subresources.push_back(subresource);
+
+		const mu_uint8 *mipmapBuffer = info.Mipmaps.data();
+		for (mu_uint32 level = 1; level < info.MipLevels; ++level)
+		{
+			const mu_uint32 levelWidth = glm::max(width >> level, 1u);
+			const mu_uint32 levelHeight = glm::max(height >> level, 1u);
+
+			Diligent::TextureSubResData mipmap;
+			mipmap.pData = mipmapBuffer;
+			mipmap.Stride = levelWidth * sizeof(mu_uint8) * 4;
+			subresources.push_back(mipmap);
+			mipmapBuffer += static_cast<mu_size>(levelWidth) * levelHeight * 4;
+		}
+	}
+}
+
 const mu_boolean NTerrain::LoadTextures(
 	const mu_utf8string dir,
 	const nlohmann::json textures,
@@ -559,6 +587,7 @@ const mu_boolean NTerrain::LoadTextures(
 	mu_uint32 width = 0, height = 0;
 	std::vector<SettingFormat> settings;
 	std::vector<UniqueBitmap> bitmaps;
+	std::vector<TextureInfo> infos;
 
 	for (auto iter = textures.begin(); iter != textures.end(); ++iter)
 	{
@@ -596,6 +625,7 @@ const mu_boolean NTerrain::LoadTextures(
 
 		texturesMap.insert(std::pair(id, static_cast<mu_uint32>(bitmaps.size())));
 		bitmaps.push_back(UniqueBitmap(bitmap));
+		infos.push_back(std::move(info));
 	}
 
 	width = GetPowerOfTwoSize(width);
@@ -626,14 +656,7 @@ const mu_boolean NTerrain::LoadTextures(
 	// Textures
 	{
 		std::vector<Diligent::TextureSubResData> subresources;
-		for (auto iter = bitmaps.begin(); iter != bitmaps.end(); ++iter)
-		{
-			auto &bitmap = *iter;
-			Diligent::TextureSubResData subresource;
-			subresource.pData = FreeImage_GetBits(bitmap.get());
-			subresource.Stride = width * sizeof(mu_uint8) * 4;
-			subresources.push_back(subresource);
-		}
+		GenerateLayersMipmaps(bitmaps, infos, width, height, 0.0f, subresources);
 
 		Diligent::TextureDesc textureDesc;
 #if NEXTMU_COMPILE_DEBUG == 1
@@ -643,6 +666,7 @@ const mu_boolean NTerrain::LoadTextures(
 		textureDesc.Width = width;
 		textureDesc.Height = height;
 		textureDesc.ArraySize = numLayers;
+		textureDesc.MipLevels = infos.empty() ? 1u : infos[0].MipLevels;
 		textureDesc.Format = Diligent::TEX_FORMAT_RGBA8_UNORM;
 		textureDesc.Usage = Diligent::USAGE_IMMUTABLE;
 		textureDesc.BindFlags = Diligent::BIND_SHADER_RESOURCE;
@@ -714,6 +738,7 @@ const mu_boolean NTerrain::LoadGrassTextures(
 	mu_uint32 width = 0, height = 0;
 	std::vector<SettingFormat> settings;
 	std::vector<UniqueBitmap> bitmaps;
+	std::vector<TextureInfo> infos;
 
 	for (auto iter = textures.begin(); iter != textures.end(); ++iter)
 	{
@@ -740,6 +765,7 @@ const mu_boolean NTerrain::LoadGrassTextures(
 		settings.push_back(h * 2.0f);
 		texturesMap.insert(std::pair(id, static_cast<mu_uint32>(bitmaps.size())));
 		bitmaps.push_back(UniqueBitmap(bitmap));
+		infos.push_back(std::move(info));
 	}
 
 	width = GetPowerOfTwoSize(width);
@@ -770,14 +796,7 @@ const mu_boolean NTerrain::LoadGrassTextures(
 	// Textures
 	{
 		std::vector<Diligent::TextureSubResData> subresources;
-		for (auto iter = bitmaps.begin(); iter != bitmaps.end(); ++iter)
-		{
-			auto &bitmap = *iter;
-			Diligent::TextureSubResData subresource;
-			subresource.pData = FreeImage_GetBits(bitmap.get());
-			subresource.Stride = width * sizeof(mu_uint8) * 4;
-			subresources.push_back(subresource);
-		}
+		GenerateLayersMipmaps(bitmaps, infos, width, height, MUTextures::DefaultAlphaReference, subresources);
 
 		Diligent::TextureDesc textureDesc;
 #if NEXTMU_COMPILE_DEBUG == 1
@@ -787,6 +806,7 @@ const mu_boolean NTerrain::LoadGrassTextures(
 		textureDesc.Width = width;
 		textureDesc.Height = height;
 		textureDesc.ArraySize = numLayers;
+		textureDesc.MipLevels = infos.empty() ? 1u : infos[0].MipLevels;
 		textureDesc.Format = Diligent::TEX_FORMAT_RGBA8_UNORM;
 		textureDesc.Usage = Diligent::USAGE_IMMUTABLE;
 		textureDesc.BindFlags = Diligent::BIND_SHADER_RESOURCE;
@@ -0,0 +1,327 @@
+#include "stdafx.h"
+#include "mu_texture_compressor.h"
+#include <mutex>
+
+namespace MUTextureCompressor
+{
+	constexpr mu_uint32 ColorPaletteSize = 4u;
+	constexpr mu_uint32 AlphaPaletteSize = 8u;
+
+	std::mutex StatisticsMutex;
+	NStatistics Statistics;
+
+	NEXTMU_INLINE const mu_uint16 PackRGB565(const mu_uint8 *color)
+	{
+		return static_cast<mu_uint16>(((color[0] >> 3) << 11) | ((color[1] >> 2) << 5) | (color[2] >> 3));
+	}
+
+	NEXTMU_INLINE void UnpackRGB565(const mu_uint16 value, mu_uint8 *color)
+	{
+		const mu_uint32 r = (value >> 11) & 0x1F;
+		const mu_uint32 g = (value >> 5) & 0x3F;
+		const mu_uint32 b = value & 0x1F;
+		color[0] = static_cast<mu_uint8>((r << 3) | (r >> 2));
+		color[1] = static_cast<mu_uint8>((g << 2) | (g >> 4));
+		color[2] = static_cast<mu_uint8>((b << 3) | (b >> 2));
+		color[3] = 255u;
+	}
+
+	NEXTMU_INLINE void WriteUInt16(mu_uint8 *output, const mu_uint16 value)
+	{
+		output[0] = static_cast<mu_uint8>(value);
+		output[1] = static_cast<mu_uint8>(value >> 8);
+	}
+
+	NEXTMU_INLINE const mu_uint16 ReadUInt16(const mu_uint8 *input)
+	{
+		return static_cast<mu_uint16>(input[0] | (input[1] << 8));
+	}
+
+	void CalculateColorPalette(const mu_uint16 color0, const mu_uint16 color1, mu_uint8 (&palette)[ColorPaletteSize][4])
+	{
+		UnpackRGB565(color0, palette[0]);
+		UnpackRGB565(color1, palette[1]);
+
+		if (color0 > color1)
+		{
+			for (mu_uint32 c = 0; c < 3; ++c)
+			{
+				palette[2][c] = static_cast<mu_uint8>((2u * palette[0][c] + palette[1][c]) / 3u);
+				palette[3][c] = static_cast<mu_uint8>((palette[0][c] + 2u * palette[1][c]) / 3u);
+			}
+			palette[2][3] = palette[3][3] = 255u;
+		}
+		else
+		{
+			// Three colors mode, the encoder never generates it but the decoder has to support it
+			for (mu_uint32 c = 0; c < 3; ++c)
+			{
+				palette[2][c] = static_cast<mu_uint8>((palette[0][c] + palette[1][c]) / 2u);
+				palette[3][c] = 0u;
+			}
+			palette[2][3] = 255u;
+			palette[3][3] = 0u;
+		}
+	}
+
+	void CalculateAlphaPalette(const mu_uint8 alpha0, const mu_uint8 alpha1, mu_uint8 (&palette)[AlphaPaletteSize])
+	{
+		palette[0] = alpha0;
+		palette[1] = alpha1;
+
+		if (alpha0 > alpha1)
+		{
+			for (mu_uint32 n = 1; n < 7; ++n)
+			{
+				palette[n + 1] = static_cast<mu_uint8>(((7u - n) * alpha0 + n * alpha1) / 7u);
+			}
+		}
+		else
+		{
+			for (mu_uint32 n = 1; n < 5; ++n)
+			{
+				palette[n + 1] = static_cast<mu_uint8>(((5u - n) * alpha0 + n * alpha1) / 5u);
+			}
+			palette[6] = 0u;
+			palette[7] = 255u;
+		}
+	}
+
+	/*
+		Range fit: the endpoints are the corners of the colors bounding box inset by 1/16 of its size,
+		every pixel takes the nearest color of the palette.
+	*/
+	void EncodeColorBlock(const mu_uint8 *pixels, mu_uint8 *output)
+	{
+		mu_uint8 minColor[3] = { 255u, 255u, 255u };
+		mu_uint8 maxColor[3] = { 0u, 0u, 0u };
+		for (mu_uint32 n = 0; n < BlockPixels; ++n)
+		{
+			const mu_uint8 *pixel = pixels + n * 4u;
+			for (mu_uint32 c = 0; c < 3; ++c)
+			{
+				minColor[c] = glm::min(minColor[c], pixel[c]);
+				maxColor[c] = glm::max(maxColor[c], pixel[c]);
+			}
+		}
+
+		for (mu_uint32 c = 0; c < 3; ++c)
+		{
+			const mu_uint8 inset = static_cast<mu_uint8>((maxColor[c] - minColor[c]) >> 4);
+			minColor[c] = static_cast<mu_uint8>(minColor[c] + inset);
+			maxColor[c] = static_cast<mu_uint8>(maxColor[c] - inset);
+		}
+
+		mu_uint16 color0 = PackRGB565(maxColor);
+		mu_uint16 color1 = PackRGB565(minColor);
+		if (color0 < color1) std::swap(color0, color1);
+
+		mu_uint32 indices = 0u;
+		if (color0 != color1)
+		{
+			mu_uint8 palette[ColorPaletteSize][4];
+			CalculateColorPalette(color0, color1, palette);
+
+			for (mu_uint32 n = 0; n < BlockPixels; ++n)
+			{
+				const mu_uint8 *pixel = pixels + n * 4u;
+				mu_uint32 bestIndex = 0, bestDistance = NInvalidUInt32;
+				for (mu_uint32 p = 0; p < ColorPaletteSize; ++p)
+				{
+					mu_uint32 distance = 0;
+					for (mu_uint32 c = 0; c < 3; ++c)
+					{
+						const mu_int32 delta = static_cast<mu_int32>(pixel[c]) - static_cast<mu_int32>(palette[p][c]);
+						distance += static_cast<mu_uint32>(delta * delta);
+					}
+
+					if (distance < bestDistance)
+					{
+						bestDistance = distance;
+						bestIndex = p;
+					}
+				}
+
+				indices |= bestIndex << (n * 2u);
+			}
+		}
+
+		WriteUInt16(output + 0, color0);
+		WriteUInt16(output + 2, color1);
+		WriteUInt16(output + 4, static_cast<mu_uint16>(indices));
+		WriteUInt16(output + 6, static_cast<mu_uint16>(indices >> 16));
+	}
+
+	void EncodeAlphaBlock(const mu_uint8 *pixels, mu_uint8 *output)
+	{
+		mu_uint8 minAlpha = 255u, maxAlpha = 0u;
+		for (mu_uint32 n = 0; n < BlockPixels; ++n)
+		{
+			minAlpha = glm::min(minAlpha, pixels[n * 4u + 3u]);
+			maxAlpha = glm::max(maxAlpha, pixels[n * 4u + 3u]);
+		}
+
+		mu_uint64 indices = 0ull;
+		if (maxAlpha != minAlpha)
+		{
+			mu_uint8 palette[AlphaPaletteSize];
+			CalculateAlphaPalette(maxAlpha, minAlpha, palette);
+
+			for (mu_uint32 n = 0; n < BlockPixels; ++n)
+			{
+				const mu_int32 alpha = pixels[n * 4u + 3u];
+				mu_uint32 bestIndex = 0, bestDistance = NInvalidUInt32;
+				for (mu_uint32 p = 0; p < AlphaPaletteSize; ++p)
+				{
+					const mu_uint32 distance = static_cast<mu_uint32>(glm::abs(alpha - static_cast<mu_int32>(palette[p])));
+					if (distance < bestDistance)
+					{
+						bestDistance = distance;
+						bestIndex = p;
+					}
+				}
+
+				indices |= static_cast<mu_uint64>(bestIndex) << (n * 3u);
+			}
+		}
+
+		output[0] = maxAlpha;
+		output[1] = minAlpha;
+		for (mu_uint32 n = 0; n < 6; ++n)
+		{
+			output[2 + n] = static_cast<mu_uint8>(indices >> (n * 8u));
+		}
+	}
+
+	void DecodeColorBlock(const mu_uint8 *input, mu_uint8 *pixels)
+	{
+		mu_uint8 palette[ColorPaletteSize][4];
+		CalculateColorPalette(ReadUInt16(input + 0), ReadUInt16(input + 2), palette);
+
+		const mu_uint32 indices = static_cast<mu_uint32>(ReadUInt16(input + 4)) | (static_cast<mu_uint32>(ReadUInt16(input + 6)) << 16);
+		for (mu_uint32 n = 0; n < BlockPixels; ++n)
+		{
+			mu_memcpy(pixels + n * 4u, palette[(indices >> (n * 2u)) & 0x3], 4u);
+		}
+	}
+
+	void DecodeAlphaBlock(const mu_uint8 *input, mu_uint8 *pixels)
+	{
+		mu_uint8 palette[AlphaPaletteSize];
+		CalculateAlphaPalette(input[0], input[1], palette);
+
+		mu_uint64 indices = 0ull;
+		for (mu_uint32 n = 0; n < 6; ++n)
+		{
+			indices |= static_cast<mu_uint64>(input[2 + n]) << (n * 8u);
+		}
+
+		for (mu_uint32 n = 0; n < BlockPixels; ++n)
+		{
+			pixels[n * 4u + 3u] = palette[(indices >> (n * 3u)) & 0x7];
+		}
+	}
+
+	void EncodeBlock(const mu_uint8 *pixels, mu_uint8 *output, const ECompressedFormat format)
+	{
+		switch (format)
+		{
+		case ECompressedFormat::BC1:
+			{
+				EncodeColorBlock(pixels, output);
+			}
+			break;
+
+		case ECompressedFormat::BC3:
+			{
+				EncodeAlphaBlock(pixels, output);
+				EncodeColorBlock(pixels, output + 8);
+			}
+			break;
+
+		default: break;
+		}
+	}
+
+	void DecodeBlock(const mu_uint8 *input, mu_uint8 *pixels, const ECompressedFormat format)
+	{
+		switch (format)
+		{
+		case ECompressedFormat::BC1:
+			{
+				DecodeColorBlock(input, pixels);
+			}
+			break;
+
+		case ECompressedFormat::BC3:
+			{
+				DecodeColorBlock(input + 8, pixels);
+				DecodeAlphaBlock(input, pixels);
+			}
+			break;
+
+		default: break;
+		}
+	}
+
+	void CompressLevel(const mu_uint8 *pixels, const mu_uint32 width, const mu_uint32 height, const ECompressedFormat format, mu_uint8 *output, NStatistics &statistics)
+	{
+		const mu_uint32 blocksWidth = GetBlocksCount(width);
+		const mu_uint32 blocksHeight = GetBlocksCount(height);
+		const mu_uint32 blockBytes = GetBlockBytes(format);
+		const mu_uint32 channels = format == ECompressedFormat::BC1 ? 3u : 4u;
+
+		mu_double squaredError = 0.0;
+		mu_uint8 block[BlockPixels * 4u];
+		mu_uint8 decoded[BlockPixels * 4u];
+		for (mu_uint32 by = 0; by < blocksHeight; ++by)
+		{
+			for (mu_uint32 bx = 0; bx < blocksWidth; ++bx)
+			{
+				for (mu_uint32 y = 0; y < BlockSize; ++y)
+				{
+					const mu_uint32 sourceY = glm::min(by * BlockSize + y, height - 1u);
+					for (mu_uint32 x = 0; x < BlockSize; ++x)
+					{
+						const mu_uint32 sourceX = glm::min(bx * BlockSize + x, width - 1u);
+						mu_memcpy(block + (y * BlockSize + x) * 4u, pixels + (static_cast<mu_size>(sourceY) * width + sourceX) * 4u, 4u);
+					}
+				}
+
+				mu_uint8 *blockOutput = output + (static_cast<mu_size>(by) * blocksWidth + bx) * blockBytes;
+				EncodeBlock(block, blockOutput, format);
+				DecodeBlock(blockOutput, decoded, format);
+
+				for (mu_uint32 n = 0; n < BlockPixels; ++n)
+				{
+					for (mu_uint32 c = 0; c < channels; ++c)
+					{
+						const mu_double delta = static_cast<mu_double>(block[n * 4u + c]) - static_cast<mu_double>(decoded[n * 4u + c]);
+						squaredError += delta * delta;
+					}
+				}
+			}
+		}
+
+		statistics.SourceBytes += static_cast<mu_uint64>(width) * height * 4u;
+		statistics.CompressedBytes += static_cast<mu_uint64>(blocksWidth) * blocksHeight * blockBytes;
+		statistics.SquaredError += squaredError;
+		statistics.Samples += static_cast<mu_uint64>(blocksWidth) * blocksHeight * BlockPixels * channels;
+	}
+
+	void AccumulateStatistics(const NStatistics &statistics)
+	{
+		std::lock_guard lock(StatisticsMutex);
+		Statistics.Textures += statistics.Textures;
+		Statistics.SourceBytes += statistics.SourceBytes;
+		Statistics.CompressedBytes += statistics.CompressedBytes;
+		Statistics.SquaredError += statistics.SquaredError;
+		Statistics.Samples += statistics.Samples;
+	}
+
+	const NStatistics GetStatistics()
+	{
+		std::lock_guard lock(StatisticsMutex);
+		return Statistics;
+	}
+}
\ No newline at end of file
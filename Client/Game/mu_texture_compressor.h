@@ -0,0 +1,63 @@
+#ifndef __MU_TEXTURE_COMPRESSOR_H__
+#define __MU_TEXTURE_COMPRESSOR_H__
+
+#pragma once
+
+enum class ECompressedFormat : mu_uint32
+{
+	None,
+	BC1, // RGB, 4 bits per pixel
+	BC3, // RGBA with interpolated alpha, 8 bits per pixel
+};
+
+/*
+	Block compression of RGBA8 pixels, it only does CPU work so the quality of the encoders can be measured without a device.
+*/
+namespace MUTextureCompressor
+{
+	constexpr mu_uint32 BlockSize = 4u;
+	constexpr mu_uint32 BlockPixels = BlockSize * BlockSize;
+
+	struct NStatistics
+	{
+		mu_uint32 Textures = 0;
+		mu_uint64 SourceBytes = 0; // RGBA8 bytes of every level
+		mu_uint64 CompressedBytes = 0;
+		mu_double SquaredError = 0.0; // Sum of the squared error of every channel
+		mu_uint64 Samples = 0; // Channels compared
+
+		NEXTMU_INLINE const mu_double GetPSNR() const
+		{
+			if (Samples == 0 || SquaredError <= 0.0) return 0.0;
+			const mu_double meanSquaredError = SquaredError / static_cast<mu_double>(Samples);
+			return 10.0 * std::log10((255.0 * 255.0) / meanSquaredError);
+		}
+	};
+
+	NEXTMU_INLINE const mu_uint32 GetBlockBytes(const ECompressedFormat format)
+	{
+		return format == ECompressedFormat::BC1 ? 8u : 16u;
+	}
+
+	NEXTMU_INLINE const mu_uint32 GetBlocksCount(const mu_uint32 size)
+	{
+		return glm::max((size + BlockSize - 1u) / BlockSize, 1u);
+	}
+
+	NEXTMU_INLINE const mu_size CalculateLevelSize(const mu_uint32 width, const mu_uint32 height, const ECompressedFormat format)
+	{
+		return static_cast<mu_size>(GetBlocksCount(width)) * GetBlocksCount(height) * GetBlockBytes(format);
+	}
+
+	// Blocks store 16 RGBA8 pixels in rows
+	void EncodeBlock(const mu_uint8 *pixels, mu_uint8 *output, const ECompressedFormat format);
+	void DecodeBlock(const mu_uint8 *input, mu_uint8 *pixels, const ECompressedFormat format);
+
+	// Compresses a level, the blocks of the borders clamp the pixels, the error of the decoded blocks is added to the statistics
+	void CompressLevel(const mu_uint8 *pixels, const mu_uint32 width, const mu_uint32 height, const ECompressedFormat format, mu_uint8 *output, NStatistics &statistics);
+
+	void AccumulateStatistics(const NStatistics &statistics);
+	const NStatistics GetStatistics();
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,519 @@
+#include "stdafx.h"
+#include "mu_texture_containers.h"
+#include "mu_textures.h"
+
+namespace NDDS
+{
+	constexpr mu_uint32 MakeFourCC(const mu_char a, const mu_char b, const mu_char c, const mu_char d)
+	{
+		return static_cast<mu_uint32>(a) | (static_cast<mu_uint32>(b) << 8) | (static_cast<mu_uint32>(c) << 16) | (static_cast<mu_uint32>(d) << 24);
+	}
+
+	constexpr mu_uint32 Magic = MakeFourCC('D', 'D', 'S', ' ');
+	constexpr mu_uint32 FlagMipMapCount = 0x20000;
+	constexpr mu_uint32 PixelFlagAlphaPixels = 0x1;
+	constexpr mu_uint32 PixelFlagFourCC = 0x4;
+	constexpr mu_uint32 PixelFlagRGB = 0x40;
+	constexpr mu_uint32 Caps2Cubemap = 0x200;
+	constexpr mu_uint32 Caps2Volume = 0x200000;
+	constexpr mu_uint32 DimensionTexture2D = 3;
+	constexpr mu_uint32 MiscTextureCube = 0x4;
+
+	struct NPixelFormat
+	{
+		mu_uint32 Size;
+		mu_uint32 Flags;
+		mu_uint32 FourCC;
+		mu_uint32 RGBBitCount;
+		mu_uint32 RBitMask;
+		mu_uint32 GBitMask;
+		mu_uint32 BBitMask;
+		mu_uint32 ABitMask;
+	};
+
+	struct NHeader
+	{
+		mu_uint32 Size;
+		mu_uint32 Flags;
+		mu_uint32 Height;
+		mu_uint32 Width;
+		mu_uint32 PitchOrLinearSize;
+		mu_uint32 Depth;
+		mu_uint32 MipMapCount;
+		mu_uint32 Reserved1[11];
+		NPixelFormat PixelFormat;
+		mu_uint32 Caps;
+		mu_uint32 Caps2;
+		mu_uint32 Caps3;
+		mu_uint32 Caps4;
+		mu_uint32 Reserved2;
+	};
+	static_assert(sizeof(NHeader) == 124);
+
+	struct NHeaderDX10
+	{
+		mu_uint32 DXGIFormat;
+		mu_uint32 ResourceDimension;
+		mu_uint32 MiscFlag;
+		mu_uint32 ArraySize;
+		mu_uint32 MiscFlags2;
+	};
+	static_assert(sizeof(NHeaderDX10) == 20);
+}
+
+namespace NKTX2
+{
+	constexpr mu_uint8 Identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+	constexpr const mu_char *OrientationKey = "KTXorientation";
+
+#pragma pack(push, 4)
+	struct NHeader
+	{
+		mu_uint8 Identifier[12];
+		mu_uint32 VkFormat;
+		mu_uint32 TypeSize;
+		mu_uint32 PixelWidth;
+		mu_uint32 PixelHeight;
+		mu_uint32 PixelDepth;
+		mu_uint32 LayerCount;
+		mu_uint32 FaceCount;
+		mu_uint32 LevelCount;
+		mu_uint32 SupercompressionScheme;
+		mu_uint32 DfdByteOffset;
+		mu_uint32 DfdByteLength;
+		mu_uint32 KvdByteOffset;
+		mu_uint32 KvdByteLength;
+		mu_uint64 SgdByteOffset;
+		mu_uint64 SgdByteLength;
+	};
+
+	struct NLevel
+	{
+		mu_uint64 ByteOffset;
+		mu_uint64 ByteLength;
+		mu_uint64 UncompressedByteLength;
+	};
+#pragma pack(pop)
+	static_assert(sizeof(NHeader) == 80);
+	static_assert(sizeof(NLevel) == 24);
+}
+
+namespace MUTextureContainers
+{
+	// Layout of the rows inside a 4x4 block, the blocks which mix the rows in their modes can't be flipped
+	enum class EBlockRows : mu_uint32
+	{
+		None, // Uncompressed
+		Color, // BC1, a row of 2 bits indices per byte after the endpoints
+		ExplicitAlpha, // BC2, a row of 4 bits alpha per 2 bytes followed by a color block
+		InterpolatedAlpha, // BC3, an alpha block with 12 bits rows of 3 bits indices followed by a color block
+		Channel, // BC4, a single alpha-like block
+		Channels, // BC5, two alpha-like blocks
+		Unsupported, // BC6H and BC7
+	};
+
+	struct NFormat
+	{
+		mu_uint32 DXGIFormat; // Zero when it only exists in Vulkan
+		mu_uint32 VkFormat;
+		Diligent::TEXTURE_FORMAT Format;
+		mu_uint32 BlockBytes; // Bytes of a 4x4 block or of a pixel when uncompressed
+		mu_boolean Compressed;
+		mu_boolean Alpha;
+		EBlockRows Rows;
+	};
+
+	const std::array<NFormat, 20> Formats = { {
+		{ 28, 37, Diligent::TEX_FORMAT_RGBA8_UNORM, 4, false, true, EBlockRows::None },
+		{ 29, 43, Diligent::TEX_FORMAT_RGBA8_UNORM_SRGB, 4, false, true, EBlockRows::None },
+		{ 87, 44, Diligent::TEX_FORMAT_BGRA8_UNORM, 4, false, true, EBlockRows::None },
+		{ 91, 50, Diligent::TEX_FORMAT_BGRA8_UNORM_SRGB, 4, false, true, EBlockRows::None },
+		{ 71, 131, Diligent::TEX_FORMAT_BC1_UNORM, 8, true, false, EBlockRows::Color },
+		{ 72, 132, Diligent::TEX_FORMAT_BC1_UNORM_SRGB, 8, true, false, EBlockRows::Color },
+		{ 0, 133, Diligent::TEX_FORMAT_BC1_UNORM, 8, true, true, EBlockRows::Color },
+		{ 0, 134, Diligent::TEX_FORMAT_BC1_UNORM_SRGB, 8, true, true, EBlockRows::Color },
+		{ 74, 135, Diligent::TEX_FORMAT_BC2_UNORM, 16, true, true, EBlockRows::ExplicitAlpha },
+		{ 75, 136, Diligent::TEX_FORMAT_BC2_UNORM_SRGB, 16, true, true, EBlockRows::ExplicitAlpha },
+		{ 77, 137, Diligent::TEX_FORMAT_BC3_UNORM, 16, true, true, EBlockRows::InterpolatedAlpha },
+		{ 78, 138, Diligent::TEX_FORMAT_BC3_UNORM_SRGB, 16, true, true, EBlockRows::InterpolatedAlpha },
+		{ 80, 139, Diligent::TEX_FORMAT_BC4_UNORM, 8, true, false, EBlockRows::Channel },
+		{ 81, 140, Diligent::TEX_FORMAT_BC4_SNORM, 8, true, false, EBlockRows::Channel },
+		{ 83, 141, Diligent::TEX_FORMAT_BC5_UNORM, 16, true, false, EBlockRows::Channels },
+		{ 84, 142, Diligent::TEX_FORMAT_BC5_SNORM, 16, true, false, EBlockRows::Channels },
+		{ 95, 143, Diligent::TEX_FORMAT_BC6H_UF16, 16, true, false, EBlockRows::Unsupported },
+		{ 96, 144, Diligent::TEX_FORMAT_BC6H_SF16, 16, true, false, EBlockRows::Unsupported },
+		{ 98, 145, Diligent::TEX_FORMAT_BC7_UNORM, 16, true, true, EBlockRows::Unsupported },
+		{ 99, 146, Diligent::TEX_FORMAT_BC7_UNORM_SRGB, 16, true, true, EBlockRows::Unsupported },
+	} };
+
+	const NFormat *FindDXGIFormat(const mu_uint32 format)
+	{
+		for (const auto &f : Formats)
+		{
+			if (f.DXGIFormat == format) return &f;
+		}
+
+		return nullptr;
+	}
+
+	const NFormat *FindVkFormat(const mu_uint32 format)
+	{
+		for (const auto &f : Formats)
+		{
+			if (f.VkFormat == format) return &f;
+		}
+
+		return nullptr;
+	}
+
+	// Legacy DDS files describe their format with a FourCC or with the masks of the channels
+	const mu_uint32 GetLegacyDXGIFormat(const NDDS::NPixelFormat &pixelFormat)
+	{
+		if ((pixelFormat.Flags & NDDS::PixelFlagFourCC) != 0)
+		{
+			switch (pixelFormat.FourCC)
+			{
+			case NDDS::MakeFourCC('D', 'X', 'T', '1'): return 71;
+			case NDDS::MakeFourCC('D', 'X', 'T', '2'):
+			case NDDS::MakeFourCC('D', 'X', 'T', '3'): return 74;
+			case NDDS::MakeFourCC('D', 'X', 'T', '4'):
+			case NDDS::MakeFourCC('D', 'X', 'T', '5'): return 77;
+			case NDDS::MakeFourCC('A', 'T', 'I', '1'):
+			case NDDS::MakeFourCC('B', 'C', '4', 'U'): return 80;
+			case NDDS::MakeFourCC('A', 'T', 'I', '2'):
+			case NDDS::MakeFourCC('B', 'C', '5', 'U'): return 83;
+			default: return 0;
+			}
+		}
+
+		if ((pixelFormat.Flags & NDDS::PixelFlagRGB) != 0 && pixelFormat.RGBBitCount == 32)
+		{
+			if (pixelFormat.RBitMask == 0x000000FF && pixelFormat.GBitMask == 0x0000FF00 && pixelFormat.BBitMask == 0x00FF0000) return 28;
+			if (pixelFormat.RBitMask == 0x00FF0000 && pixelFormat.GBitMask == 0x0000FF00 && pixelFormat.BBitMask == 0x000000FF) return 87;
+		}
+
+		return 0;
+	}
+
+	NEXTMU_INLINE const mu_boolean IsInside(const mu_size size, const mu_uint64 offset, const mu_uint64 length)
+	{
+		return offset <= size && length <= size - offset;
+	}
+
+	NEXTMU_INLINE void CalculateLevelLayout(const NFormat &format, const mu_uint32 width, const mu_uint32 height, mu_uint32 &stride, mu_size &levelSize)
+	{
+		if (format.Compressed)
+		{
+			stride = MUTextureCompressor::GetBlocksCount(width) * format.BlockBytes;
+			levelSize = static_cast<mu_size>(stride) * MUTextureCompressor::GetBlocksCount(height);
+		}
+		else
+		{
+			stride = width * format.BlockBytes;
+			levelSize = static_cast<mu_size>(stride) * height;
+		}
+	}
+
+	const mu_boolean ValidateSize(const mu_uint32 width, const mu_uint32 height, const mu_uint32 mipLevels)
+	{
+		if (width == 0 || height == 0 || width > std::numeric_limits<mu_uint16>::max() || height > std::numeric_limits<mu_uint16>::max()) return false;
+
+		mu_uint32 maxLevels = 1u;
+		for (mu_uint32 size = glm::max(width, height); size > 1u; size >>= 1) ++maxLevels;
+
+		return mipLevels >= 1u && mipLevels <= maxLevels;
+	}
+
+	// Rows of the block below rows are padding, they are left where they are
+	void FlipColorBlock(mu_uint8 *block, const mu_uint32 rows)
+	{
+		for (mu_uint32 row = 0; row < rows / 2u; ++row)
+		{
+			std::swap(block[4u + row], block[4u + rows - 1u - row]);
+		}
+	}
+
+	void FlipExplicitAlphaBlock(mu_uint8 *block, const mu_uint32 rows)
+	{
+		for (mu_uint32 row = 0; row < rows / 2u; ++row)
+		{
+			std::swap(block[row * 2u], block[(rows - 1u - row) * 2u]);
+			std::swap(block[row * 2u + 1u], block[(rows - 1u - row) * 2u + 1u]);
+		}
+	}
+
+	void FlipInterpolatedAlphaBlock(mu_uint8 *block, const mu_uint32 rows)
+	{
+		mu_uint64 indices = 0;
+		for (mu_uint32 n = 0; n < 6u; ++n) indices |= static_cast<mu_uint64>(block[2u + n]) << (n * 8u);
+
+		mu_uint64 flipped = indices;
+		for (mu_uint32 row = 0; row < rows; ++row)
+		{
+			const mu_uint64 rowMask = 0xFFFull << (row * 12u);
+			const mu_uint64 rowIndices = (indices >> ((rows - 1u - row) * 12u)) & 0xFFFull;
+			flipped = (flipped & ~rowMask) | (rowIndices << (row * 12u));
+		}
+
+		for (mu_uint32 n = 0; n < 6u; ++n) block[2u + n] = static_cast<mu_uint8>(flipped >> (n * 8u));
+	}
+
+	void FlipBlock(const EBlockRows layout, mu_uint8 *block, const mu_uint32 rows)
+	{
+		switch (layout)
+		{
+		case EBlockRows::Color: FlipColorBlock(block, rows); break;
+		case EBlockRows::ExplicitAlpha: FlipExplicitAlphaBlock(block, rows); FlipColorBlock(block + 8u, rows); break;
+		case EBlockRows::InterpolatedAlpha: FlipInterpolatedAlphaBlock(block, rows); FlipColorBlock(block + 8u, rows); break;
+		case EBlockRows::Channel: FlipInterpolatedAlphaBlock(block, rows); break;
+		case EBlockRows::Channels: FlipInterpolatedAlphaBlock(block, rows); FlipInterpolatedAlphaBlock(block + 8u, rows); break;
+		default: break;
+		}
+	}
+
+	/*
+		Copies the rows of a level in the reverse order, block compressed levels reverse the rows of blocks and the rows inside every block.
+		The rows of a block can't move to another block, so levels taller than a block must be a multiple of the block size.
+	*/
+	const mu_boolean FlipLevel(const NFormat &format, const mu_uint8 *source, mu_uint8 *dest, const mu_uint32 stride, const mu_uint32 height)
+	{
+		if (format.Compressed == false)
+		{
+			for (mu_uint32 y = 0; y < height; ++y)
+			{
+				mu_memcpy(dest + static_cast<mu_size>(height - 1u - y) * stride, source + static_cast<mu_size>(y) * stride, stride);
+			}
+			return true;
+		}
+
+		if (format.Rows == EBlockRows::Unsupported) return false;
+		if (height > MUTextureCompressor::BlockSize && height % MUTextureCompressor::BlockSize != 0) return false;
+
+		const mu_uint32 blocksHeight = MUTextureCompressor::GetBlocksCount(height);
+		const mu_uint32 rows = glm::min(height, MUTextureCompressor::BlockSize);
+		for (mu_uint32 y = 0; y < blocksHeight; ++y)
+		{
+			mu_uint8 *destRow = dest + static_cast<mu_size>(blocksHeight - 1u - y) * stride;
+			mu_memcpy(destRow, source + static_cast<mu_size>(y) * stride, stride);
+			for (mu_uint32 offset = 0; offset < stride; offset += format.BlockBytes)
+			{
+				FlipBlock(format.Rows, destRow + offset, rows);
+			}
+		}
+
+		return true;
+	}
+
+	const mu_boolean FlipLevels(const NFormat &format, const mu_uint32 width, const mu_uint32 height, TextureInfo &info)
+	{
+		mu_size flippedSize = 0;
+		for (mu_uint32 level = 0; level < static_cast<mu_uint32>(info.Levels.size()); ++level)
+		{
+			mu_uint32 stride;
+			mu_size levelSize;
+			CalculateLevelLayout(format, glm::max(width >> level, 1u), glm::max(height >> level, 1u), stride, levelSize);
+			flippedSize += levelSize;
+		}
+
+		info.FlippedLevels.resize(flippedSize);
+		mu_uint8 *dest = info.FlippedLevels.data();
+		for (mu_uint32 level = 0; level < static_cast<mu_uint32>(info.Levels.size()); ++level)
+		{
+			mu_uint32 stride;
+			mu_size levelSize;
+			const mu_uint32 levelHeight = glm::max(height >> level, 1u);
+			CalculateLevelLayout(format, glm::max(width >> level, 1u), levelHeight, stride, levelSize);
+
+			auto &subresource = info.Levels[level];
+			if (FlipLevel(format, static_cast<const mu_uint8 *>(subresource.pData), dest, stride, levelHeight) == false)
+			{
+				info.FlippedLevels.clear();
+				return false;
+			}
+
+			subresource.pData = dest;
+			dest += levelSize;
+		}
+
+		return true;
+	}
+
+	void SetInfo(const NFormat &format, const mu_uint32 width, const mu_uint32 height, const mu_uint32 mipLevels, const mu_boolean alpha, TextureInfo &info)
+	{
+		info.Width = static_cast<mu_uint16>(width);
+		info.Height = static_cast<mu_uint16>(height);
+		info.Alpha = alpha;
+		info.MipLevels = mipLevels;
+		info.Format = format.Format;
+	}
+
+	const mu_boolean ParseDDS(const mu_uint8 *data, const mu_size size, TextureInfo &info)
+	{
+		mu_uint32 magic;
+		NDDS::NHeader header;
+		if (size < sizeof(magic) + sizeof(header)) return false;
+
+		mu_memcpy(&magic, data, sizeof(magic));
+		mu_memcpy(&header, data + sizeof(magic), sizeof(header));
+		if (
+			magic != NDDS::Magic ||
+			header.Size != sizeof(NDDS::NHeader) ||
+			header.PixelFormat.Size != sizeof(NDDS::NPixelFormat) ||
+			(header.Caps2 & (NDDS::Caps2Cubemap | NDDS::Caps2Volume)) != 0
+		)
+		{
+			return false;
+		}
+
+		mu_size offset = sizeof(magic) + sizeof(header);
+		mu_uint32 dxgiFormat = 0;
+		mu_boolean alpha = false;
+		if ((header.PixelFormat.Flags & NDDS::PixelFlagFourCC) != 0 && header.PixelFormat.FourCC == NDDS::MakeFourCC('D', 'X', '1', '0'))
+		{
+			NDDS::NHeaderDX10 extension;
+			if (size < offset + sizeof(extension)) return false;
+			mu_memcpy(&extension, data + offset, sizeof(extension));
+			offset += sizeof(extension);
+
+			if (
+				extension.ResourceDimension != NDDS::DimensionTexture2D ||
+				extension.ArraySize != 1 ||
+				(extension.MiscFlag & NDDS::MiscTextureCube) != 0
+			)
+			{
+				return false;
+			}
+
+			dxgiFormat = extension.DXGIFormat;
+		}
+		else
+		{
+			dxgiFormat = GetLegacyDXGIFormat(header.PixelFormat);
+		}
+
+		const NFormat *format = FindDXGIFormat(dxgiFormat);
+		if (format == nullptr) return false;
+
+		// Uncompressed textures only have alpha when the file says so, the channel is undefined otherwise
+		if (format->Compressed)
+			alpha = format->Alpha;
+		else
+			alpha = (header.PixelFormat.Flags & NDDS::PixelFlagAlphaPixels) != 0 || header.PixelFormat.FourCC == NDDS::MakeFourCC('D', 'X', '1', '0');
+
+		const mu_uint32 mipLevels = (header.Flags & NDDS::FlagMipMapCount) != 0 ? glm::max(header.MipMapCount, 1u) : 1u;
+		if (ValidateSize(header.Width, header.Height, mipLevels) == false) return false;
+
+		// Levels are stored one after the other from the largest one
+		info.Levels.clear();
+		for (mu_uint32 level = 0; level < mipLevels; ++level)
+		{
+			mu_uint32 stride;
+			mu_size levelSize;
+			CalculateLevelLayout(*format, glm::max(header.Width >> level, 1u), glm::max(header.Height >> level, 1u), stride, levelSize);
+			if (IsInside(size, offset, levelSize) == false) return false;
+
+			Diligent::TextureSubResData subresource;
+			subresource.pData = data + offset;
+			subresource.Stride = stride;
+			info.Levels.push_back(subresource);
+			offset += levelSize;
+		}
+
+		// DDS files have no orientation, they are always stored top-down
+		if (FlipLevels(*format, header.Width, header.Height, info) == false) return false;
+
+		SetInfo(*format, header.Width, header.Height, mipLevels, alpha, info);
+		return true;
+	}
+
+	// Rows are stored top-down ("rd") unless the key-value data says they go up
+	const mu_boolean IsKTX2TopDown(const mu_uint8 *data, const mu_size size, const NKTX2::NHeader &header)
+	{
+		if (IsInside(size, header.KvdByteOffset, header.KvdByteLength) == false) return true;
+
+		const mu_size keyLength = std::strlen(NKTX2::OrientationKey) + 1u;
+		const mu_uint8 *entries = data + header.KvdByteOffset;
+		mu_size offset = 0;
+		while (offset + sizeof(mu_uint32) <= header.KvdByteLength)
+		{
+			mu_uint32 entryLength;
+			mu_memcpy(&entryLength, entries + offset, sizeof(entryLength));
+			offset += sizeof(entryLength);
+			if (entryLength > header.KvdByteLength - offset) break;
+
+			const mu_char *entry = reinterpret_cast<const mu_char *>(entries + offset);
+			if (entryLength > keyLength && std::memcmp(entry, NKTX2::OrientationKey, keyLength) == 0)
+			{
+				return entryLength < keyLength + 2u || entry[keyLength + 1u] != 'u';
+			}
+
+			// Entries are padded to 4 bytes
+			offset += (static_cast<mu_size>(entryLength) + 3u) & ~static_cast<mu_size>(3u);
+		}
+
+		return true;
+	}
+
+	const mu_boolean ParseKTX2(const mu_uint8 *data, const mu_size size, TextureInfo &info)
+	{
+		NKTX2::NHeader header;
+		if (size < sizeof(header)) return false;
+
+		mu_memcpy(&header, data, sizeof(header));
+		if (
+			std::memcmp(header.Identifier, NKTX2::Identifier, sizeof(NKTX2::Identifier)) != 0 ||
+			header.PixelDepth != 0 ||
+			header.LayerCount > 1 ||
+			header.FaceCount != 1 ||
+			header.SupercompressionScheme != 0
+		)
+		{
+			return false;
+		}
+
+		const NFormat *format = FindVkFormat(header.VkFormat);
+		if (format == nullptr) return false;
+
+		// Zero levels asks the loader to generate them, the containers are expected to be complete
+		const mu_uint32 mipLevels = glm::max(header.LevelCount, 1u);
+		if (ValidateSize(header.PixelWidth, header.PixelHeight, mipLevels) == false) return false;
+		if (IsInside(size, sizeof(header), static_cast<mu_uint64>(mipLevels) * sizeof(NKTX2::NLevel)) == false) return false;
+
+		// The level index starts with the largest level, the data is stored from the smallest one
+		info.Levels.clear();
+		for (mu_uint32 level = 0; level < mipLevels; ++level)
+		{
+			NKTX2::NLevel levelIndex;
+			mu_memcpy(&levelIndex, data + sizeof(header) + level * sizeof(NKTX2::NLevel), sizeof(levelIndex));
+
+			mu_uint32 stride;
+			mu_size levelSize;
+			CalculateLevelLayout(*format, glm::max(header.PixelWidth >> level, 1u), glm::max(header.PixelHeight >> level, 1u), stride, levelSize);
+			if (levelIndex.ByteLength != levelSize || IsInside(size, levelIndex.ByteOffset, levelIndex.ByteLength) == false) return false;
+
+			Diligent::TextureSubResData subresource;
+			subresource.pData = data + levelIndex.ByteOffset;
+			subresource.Stride = stride;
+			info.Levels.push_back(subresource);
+		}
+
+		if (IsKTX2TopDown(data, size, header) == true && FlipLevels(*format, header.PixelWidth, header.PixelHeight, info) == false) return false;
+
+		SetInfo(*format, header.PixelWidth, header.PixelHeight, mipLevels, format->Alpha, info);
+		return true;
+	}
+
+	const mu_boolean Parse(const mu_utf8string &ext, const mu_uint8 *data, const mu_size size, TextureInfo &info)
+	{
+		if (ext == "dds")
+		{
+			return ParseDDS(data, size, info);
+		}
+		else if (ext == "ktx2")
+		{
+			return ParseKTX2(data, size, info);
+		}
+
+		return false;
+	}
+}
\ No newline at end of file
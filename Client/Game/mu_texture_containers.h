@@ -0,0 +1,25 @@
+#ifndef __MU_TEXTURE_CONTAINERS_H__
+#define __MU_TEXTURE_CONTAINERS_H__
+
+#pragma once
+
+struct TextureInfo;
+
+/*
+	Parsers of the DDS and KTX2 containers, their levels are already in the device format so they are handed to the device as they are.
+	Only 2D textures without supercompression are supported. Rows are used bottom-up like the bitmaps decoded with FreeImage,
+	DDS files and KTX2 files without a "ru" KTXorientation are top-down so their levels are flipped into a copy when parsed.
+	BC6H and BC7 blocks can't be flipped, those files must be stored bottom-up.
+*/
+namespace MUTextureContainers
+{
+	NEXTMU_INLINE const mu_boolean IsContainerExtension(const mu_utf8string &ext)
+	{
+		return ext == "dds" || ext == "ktx2";
+	}
+
+	// Fills the size, format and levels of the texture, the levels point into data (unless flipped) so it must outlive them
+	const mu_boolean Parse(const mu_utf8string &ext, const mu_uint8 *data, const mu_size size, TextureInfo &info);
+}
+
+#endif
\ No newline at end of file
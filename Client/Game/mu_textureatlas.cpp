@@ -0,0 +1,320 @@
+#include "stdafx.h"
+#include "mu_textureatlas.h"
+
+void NSkylinePacker::Reset(const mu_uint32 width, const mu_uint32 height)
+{
+	Nodes.clear();
+	Nodes.push_back(
+		NSkylineNode{
+			.X = 0,
+			.Y = 0,
+			.Width = width,
+		}
+	);
+	Width = width;
+	Height = height;
+	UsedWidth = 0;
+	UsedHeight = 0;
+	UsedArea = 0;
+}
+
+const mu_boolean NSkylinePacker::Fit(const mu_size index, const mu_uint32 width, const mu_uint32 height, mu_uint32 &y) const
+{
+	const auto &first = Nodes[index];
+	if (first.X + width > Width) return false;
+
+	// The rectangle rests on the highest segment it spans
+	y = first.Y;
+	mu_uint32 remaining = width;
+	for (mu_size n = index; remaining > 0; ++n)
+	{
+		const auto &node = Nodes[n];
+		y = glm::max(y, node.Y);
+		if (y + height > Height) return false;
+		if (node.Width >= remaining) break;
+		remaining -= node.Width;
+	}
+
+	return true;
+}
+
+const mu_boolean NSkylinePacker::Insert(const mu_uint32 width, const mu_uint32 height, mu_uint32 &x, mu_uint32 &y)
+{
+	if (width == 0 || height == 0) return false;
+
+	mu_size bestIndex = Nodes.size();
+	mu_uint32 bestY = 0;
+	mu_uint32 bestTop = NInvalidUInt32;
+	for (mu_size index = 0; index < Nodes.size(); ++index)
+	{
+		mu_uint32 nodeY;
+		if (Fit(index, width, height, nodeY) == false) continue;
+		if (nodeY + height < bestTop)
+		{
+			bestIndex = index;
+			bestY = nodeY;
+			bestTop = nodeY + height;
+		}
+	}
+
+	if (bestIndex == Nodes.size()) return false;
+
+	x = Nodes[bestIndex].X;
+	y = bestY;
+	Nodes.insert(
+		Nodes.begin() + bestIndex,
+		NSkylineNode{
+			.X = x,
+			.Y = bestTop,
+			.Width = width,
+		}
+	);
+
+	// Segments covered by the new one are removed or shortened
+	const mu_uint32 right = x + width;
+	for (mu_size index = bestIndex + 1; index < Nodes.size();)
+	{
+		auto &node = Nodes[index];
+		if (node.X >= right) break;
+
+		const mu_uint32 covered = right - node.X;
+		if (node.Width <= covered)
+		{
+			Nodes.erase(Nodes.begin() + index);
+			continue;
+		}
+
+		node.X += covered;
+		node.Width -= covered;
+		break;
+	}
+
+	for (mu_size index = 0; index + 1 < Nodes.size();)
+	{
+		if (Nodes[index].Y == Nodes[index + 1].Y)
+		{
+			Nodes[index].Width += Nodes[index + 1].Width;
+			Nodes.erase(Nodes.begin() + index + 1);
+			continue;
+		}
+		++index;
+	}
+
+	UsedWidth = glm::max(UsedWidth, right);
+	UsedHeight = glm::max(UsedHeight, bestTop);
+	UsedArea += static_cast<mu_uint64>(width) * height;
+
+	return true;
+}
+
+namespace MUTextureAtlas
+{
+	constexpr mu_uint32 BytesPerPixel = 4u;
+
+	NStatistics Statistics;
+
+	NEXTMU_INLINE const mu_uint32 AlignSize(const mu_uint32 size)
+	{
+		return (size + Padding - 1u) & ~(Padding - 1u);
+	}
+
+	NEXTMU_INLINE const mu_uint32 CalculatePageSize(const mu_uint32 used)
+	{
+		mu_uint32 size = 1u;
+		while (size < used) size <<= 1u;
+		return size;
+	}
+
+	void Pack(const std::vector<NPackSize> &sizes, const mu_uint32 pageSize, std::vector<NPackPlacement> &placements, std::vector<NPackPage> &pages)
+	{
+		placements.clear();
+		placements.resize(sizes.size());
+		pages.clear();
+
+		std::vector<mu_uint32> order(sizes.size());
+		for (mu_uint32 index = 0; index < static_cast<mu_uint32>(order.size()); ++index)
+		{
+			order[index] = index;
+		}
+
+		std::sort(
+			order.begin(),
+			order.end(),
+			[&sizes](const mu_uint32 lhs, const mu_uint32 rhs) -> bool {
+				if (sizes[lhs].Height != sizes[rhs].Height) return sizes[lhs].Height > sizes[rhs].Height;
+				if (sizes[lhs].Width != sizes[rhs].Width) return sizes[lhs].Width > sizes[rhs].Width;
+				return lhs < rhs;
+			}
+		);
+
+		std::vector<NSkylinePacker> packers;
+		for (const auto index : order)
+		{
+			const mu_uint32 width = AlignSize(sizes[index].Width + Padding * 2u);
+			const mu_uint32 height = AlignSize(sizes[index].Height + Padding * 2u);
+			if (width > pageSize || height > pageSize) continue;
+
+			auto &placement = placements[index];
+			mu_uint32 x = 0, y = 0;
+			for (mu_uint32 page = 0; page < static_cast<mu_uint32>(packers.size()); ++page)
+			{
+				if (packers[page].Insert(width, height, x, y))
+				{
+					placement.Page = page;
+					break;
+				}
+			}
+
+			if (placement.Page == NInvalidUInt32)
+			{
+				auto &packer = packers.emplace_back();
+				packer.Reset(pageSize, pageSize);
+				packer.Insert(width, height, x, y);
+				placement.Page = static_cast<mu_uint32>(packers.size() - 1);
+			}
+
+			placement.X = x + Padding;
+			placement.Y = y + Padding;
+		}
+
+		for (const auto &packer : packers)
+		{
+			pages.push_back(
+				NPackPage{
+					.Width = CalculatePageSize(packer.GetUsedWidth()),
+					.Height = CalculatePageSize(packer.GetUsedHeight()),
+					.UsedArea = packer.GetUsedArea(),
+				}
+			);
+		}
+	}
+
+	// Copies the texture inside its padding and extrudes its border pixels over the padding
+	void Blit(FIBITMAP *page, const NPackPlacement &placement, FIBITMAP *source, const mu_uint32 width, const mu_uint32 height)
+	{
+		const mu_uint32 pagePitch = FreeImage_GetPitch(page);
+		const mu_uint32 sourcePitch = FreeImage_GetPitch(source);
+		mu_uint8 *pageBits = FreeImage_GetBits(page);
+		const mu_uint8 *sourceBits = FreeImage_GetBits(source);
+
+		for (mu_uint32 y = 0; y < height + Padding * 2u; ++y)
+		{
+			const mu_uint32 sourceY = glm::min(y > Padding ? y - Padding : 0u, height - 1u);
+			const mu_uint8 *sourceRow = sourceBits + sourceY * sourcePitch;
+			mu_uint8 *pageRow = pageBits + (placement.Y - Padding + y) * pagePitch + (placement.X - Padding) * BytesPerPixel;
+
+			for (mu_uint32 x = 0; x < Padding; ++x)
+			{
+				mu_memcpy(pageRow + x * BytesPerPixel, sourceRow, BytesPerPixel);
+				mu_memcpy(pageRow + (Padding + width + x) * BytesPerPixel, sourceRow + (width - 1u) * BytesPerPixel, BytesPerPixel);
+			}
+			mu_memcpy(pageRow + Padding * BytesPerPixel, sourceRow, width * BytesPerPixel);
+		}
+	}
+
+	const mu_boolean Build(const mu_utf8string &name, std::vector<NAtlasTexture> &textures, const Diligent::SamplerDesc &samplerDesc)
+	{
+		std::vector<NPackSize> sizes;
+		sizes.reserve(textures.size());
+		for (const auto &texture : textures)
+		{
+			sizes.push_back(
+				NPackSize{
+					.Width = texture.Info.Width,
+					.Height = texture.Info.Height,
+				}
+			);
+		}
+
+		std::vector<NPackPlacement> placements;
+		std::vector<NPackPage> pages;
+		Pack(sizes, MaxPageSize, placements, pages);
+
+		mu_boolean succeed = true;
+		for (mu_uint32 pageIndex = 0; pageIndex < static_cast<mu_uint32>(pages.size()); ++pageIndex)
+		{
+			const auto &page = pages[pageIndex];
+			FIBITMAP *bitmap = FreeImage_Allocate(page.Width, page.Height, 32);
+			if (bitmap == nullptr)
+			{
+				succeed = false;
+				break;
+			}
+			mu_zeromem(FreeImage_GetBits(bitmap), static_cast<mu_size>(FreeImage_GetPitch(bitmap)) * page.Height);
+
+			TextureInfo info;
+			info.Width = static_cast<mu_uint16>(page.Width);
+			info.Height = static_cast<mu_uint16>(page.Height);
+			for (mu_uint32 index = 0; index < static_cast<mu_uint32>(textures.size()); ++index)
+			{
+				if (placements[index].Page != pageIndex) continue;
+				const auto &texture = textures[index];
+				Blit(bitmap, placements[index], texture.Bitmap, texture.Info.Width, texture.Info.Height);
+				info.Alpha |= texture.Info.Alpha;
+			}
+
+			// Effects are blended, the alpha coverage isn't preserved
+			MUTextures::GenerateMipmaps(bitmap, info, 0.0f);
+			if (info.MipLevels > MipLevels)
+			{
+				mu_size mipmapsSize = 0;
+				for (mu_uint32 level = 1; level < MipLevels; ++level)
+				{
+					mipmapsSize += static_cast<mu_size>(glm::max(page.Width >> level, 1u)) * glm::max(page.Height >> level, 1u) * BytesPerPixel;
+				}
+				info.MipLevels = MipLevels;
+				info.Mipmaps.resize(mipmapsSize);
+			}
+
+			auto pageTexture = MUTextures::Create(fmt::format("atlas {} {}", name, pageIndex), bitmap, info, samplerDesc);
+			if (!pageTexture)
+			{
+				mu_error("failed to create atlas page ({}, {})", name, pageIndex);
+				succeed = false;
+				break;
+			}
+
+			const glm::vec2 pageSize(static_cast<mu_float>(page.Width), static_cast<mu_float>(page.Height));
+			for (mu_uint32 index = 0; index < static_cast<mu_uint32>(textures.size()); ++index)
+			{
+				const auto &placement = placements[index];
+				if (placement.Page != pageIndex) continue;
+
+				auto &texture = textures[index];
+				const glm::vec2 position(static_cast<mu_float>(placement.X), static_cast<mu_float>(placement.Y));
+				const glm::vec2 size(static_cast<mu_float>(texture.Info.Width), static_cast<mu_float>(texture.Info.Height));
+				texture.Texture = std::make_unique<NGraphicsTexture>(
+					pageTexture->GetId(),
+					Diligent::RefCntAutoPtr<Diligent::ITexture>(pageTexture->GetTexture()),
+					texture.Info.Width,
+					texture.Info.Height,
+					texture.Info.Alpha
+				);
+				texture.Texture->SetUVRect(glm::vec4(position / pageSize, (position + size) / pageSize));
+				++Statistics.Regions;
+			}
+
+			++Statistics.Pages;
+			Statistics.PagesArea += static_cast<mu_uint64>(page.Width) * page.Height;
+			Statistics.UsedArea += page.UsedArea;
+		}
+
+		for (auto &texture : textures)
+		{
+			if (texture.Bitmap != nullptr) FreeImage_Unload(texture.Bitmap);
+			texture.Bitmap = nullptr;
+		}
+
+		return succeed;
+	}
+
+	void ClearStatistics()
+	{
+		Statistics = NStatistics();
+	}
+
+	const NStatistics GetStatistics()
+	{
+		return Statistics;
+	}
+}
\ No newline at end of file
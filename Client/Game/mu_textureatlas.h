@@ -0,0 +1,121 @@
+#ifndef __MU_TEXTUREATLAS_H__
+#define __MU_TEXTUREATLAS_H__
+
+#pragma once
+
+#include "mu_textures.h"
+
+/*
+	Skyline bottom-left packer, the skyline is kept as horizontal segments sorted by X and every rectangle is placed
+	where its top is the lowest, ties keep the leftmost position so the result only depends on the insertion order.
+*/
+class NSkylinePacker
+{
+public:
+	void Reset(const mu_uint32 width, const mu_uint32 height);
+	const mu_boolean Insert(const mu_uint32 width, const mu_uint32 height, mu_uint32 &x, mu_uint32 &y);
+
+	// Bounds of the placed rectangles
+	const mu_uint32 GetUsedWidth() const
+	{
+		return UsedWidth;
+	}
+
+	const mu_uint32 GetUsedHeight() const
+	{
+		return UsedHeight;
+	}
+
+	const mu_uint64 GetUsedArea() const
+	{
+		return UsedArea;
+	}
+
+private:
+	const mu_boolean Fit(const mu_size index, const mu_uint32 width, const mu_uint32 height, mu_uint32 &y) const;
+
+private:
+	struct NSkylineNode
+	{
+		mu_uint32 X;
+		mu_uint32 Y;
+		mu_uint32 Width;
+	};
+
+	std::vector<NSkylineNode> Nodes;
+	mu_uint32 Width = 0;
+	mu_uint32 Height = 0;
+	mu_uint32 UsedWidth = 0;
+	mu_uint32 UsedHeight = 0;
+	mu_uint64 UsedArea = 0;
+};
+
+/*
+	Small effect textures declared with "atlas" in resources.json are packed at load time into shared pages, every texture
+	becomes a region of its page which shares the page id, so the templates which use them resolve to the same shader binding
+	and their groups are merged into fewer draws. Regions keep the size of their source and are remapped with their UV rect.
+*/
+namespace MUTextureAtlas
+{
+	constexpr mu_uint32 MaxPageSize = 2048u;
+	constexpr mu_uint32 MaxRegionSize = 256u; // Larger textures gain nothing from the atlas and are loaded alone
+	constexpr mu_uint32 MipLevels = 3u;
+	// Regions are aligned to the texel of the last level and extruded by it, so the levels never mix two regions
+	constexpr mu_uint32 Padding = 1u << (MipLevels - 1u);
+
+	struct NPackSize
+	{
+		mu_uint32 Width;
+		mu_uint32 Height;
+	};
+
+	struct NPackPlacement
+	{
+		mu_uint32 Page = NInvalidUInt32;
+		mu_uint32 X = 0; // Position of the region inside the padding
+		mu_uint32 Y = 0;
+	};
+
+	struct NPackPage
+	{
+		mu_uint32 Width = 0;
+		mu_uint32 Height = 0;
+		mu_uint64 UsedArea = 0; // Area of the padded regions
+	};
+
+	/*
+		Places the regions of a group in pages, it doesn't require a device so the occupancy can be measured offline.
+		Regions are sorted by height, width and index so the placement is the same for the same sizes in any order of loading,
+		pages are trimmed to the power of two which holds their regions.
+	*/
+	void Pack(const std::vector<NPackSize> &sizes, const mu_uint32 pageSize, std::vector<NPackPlacement> &placements, std::vector<NPackPage> &pages);
+
+	struct NAtlasTexture
+	{
+		mu_utf8string Path;
+		FIBITMAP *Bitmap = nullptr; // RGBA8 decoded by LoadRaw, released by Build
+		TextureInfo Info;
+		std::unique_ptr<NGraphicsTexture> Texture; // Region created by Build
+	};
+
+	// Creates the pages of a group of textures, it must run on the main thread
+	const mu_boolean Build(const mu_utf8string &name, std::vector<NAtlasTexture> &textures, const Diligent::SamplerDesc &samplerDesc);
+
+	struct NStatistics
+	{
+		mu_uint32 Regions = 0;
+		mu_uint32 Pages = 0;
+		mu_uint64 PagesArea = 0;
+		mu_uint64 UsedArea = 0;
+
+		NEXTMU_INLINE const mu_double GetOccupancy() const
+		{
+			return PagesArea > 0 ? static_cast<mu_double>(UsedArea) / static_cast<mu_double>(PagesArea) : 0.0;
+		}
+	};
+
+	void ClearStatistics();
+	const NStatistics GetStatistics();
+}
+
+#endif
\ No newline at end of file
@@ -1,58 +1,151 @@
 #include "stdafx.h"
 #include "mu_textures.h"
 #include "mu_graphics.h"
+#include "mu_capabilities.h"
+#include "mu_config.h"
+#include "mu_hash.h"
+#include "mu_mappedfile.h"
+#include "mu_cachefiles.h"
+#include "mu_texture_containers.h"
+#include "mu_pixelformat.h"
+
+namespace NCompressedCache
+{
+	constexpr mu_uint32 Magic = 0x5845544E; // NTEX
+	constexpr mu_uint32 Version = 2u; // 1 chose BC1 by the extension and lost the alpha of PNG textures
+	constexpr const mu_char *Extension = ".ntex";
+
+#pragma pack(push, 4)
+	struct NHeader
+	{
+		mu_uint32 Magic;
+		mu_uint32 Version;
+		mu_uint64 SourceHash;
+		mu_uint32 Format;
+		mu_float AlphaReference;
+		mu_uint32 Width;
+		mu_uint32 Height;
+		mu_uint32 MipLevels;
+		mu_uint32 Alpha;
+		mu_uint32 DataSize;
+		mu_uint32 Reserved;
+
+		// Statistics of the compression, cached textures report them again
+		mu_double SquaredError;
+		mu_uint64 Samples;
+		mu_uint64 SourceBytes;
+	};
+#pragma pack(pop)
+}
 
 namespace MUTextures
 {
 	mu_atomic_uint32_t TextureIdGenerator = 0;
 
-	template <class T> void SwapValue(T& a, T& b) {
-		T tmp = a;
-		a = b;
-		b = tmp;
-	}
+	// Top-down containers are copied to flip them every time they are loaded, they are reported once so they can be stored bottom-up
+	std::mutex FlippedContainersMutex;
+	std::set<mu_utf8string> FlippedContainers;
 
-	const mu_boolean LoadRaw(mu_utf8string path, FIBITMAP **texture, TextureInfo &info)
+	NEXTMU_INLINE const mu_boolean IsAlphaExtension(const mu_utf8string &ext)
 	{
-		NormalizePath(path);
+		return ext == "ozt" || ext == "tga";
+	}
 
-		auto ext = path.substr(path.find_last_of('.') + 1);
+	const mu_utf8string GetExtension(const mu_utf8string &path)
+	{
+		mu_utf8string ext = path.substr(path.find_last_of('.') + 1);
 		std::transform(ext.begin(), ext.end(), ext.begin(), mu_utf8tolower);
+		return ext;
+	}
 
-		SDL_RWops *fp = nullptr;
-		if (mu_rwfromfile<EGameDirectoryType::eSupport>(&fp, path, "rb") == false)
+	// Opens the source and skips the header of the MU formats, the stream is positioned at the start of the image
+	const mu_boolean OpenSource(mu_utf8string &path, mu_utf8string &ext, SDL_RWops **fp, mu_isize &fileLength)
+	{
+		NormalizePath(path);
+		ext = GetExtension(path);
+
+		if (mu_rwfromfile<EGameDirectoryType::eSupport>(fp, path, "rb") == false)
 		{
 			mu_error("texture not found ({})", path);
 			return false;
 		}
 
-		mu_isize fileLength = static_cast<mu_isize>(SDL_RWsize(fp));
+		fileLength = static_cast<mu_isize>(SDL_RWsize(*fp));
 
 		if (ext == "ozj")
 		{
 			fileLength -= 24;
-			SDL_RWseek(fp, 24, RW_SEEK_CUR);
+			SDL_RWseek(*fp, 24, RW_SEEK_CUR);
 		}
 		else if (ext == "ozt")
 		{
 			fileLength -= 4;
-			SDL_RWseek(fp, 4, RW_SEEK_CUR);
+			SDL_RWseek(*fp, 4, RW_SEEK_CUR);
 		}
 
-		std::unique_ptr<mu_uint8[]> buffer(new_nothrow mu_uint8[fileLength]);
+		return true;
+	}
+
+	const mu_boolean ReadSource(mu_utf8string &path, mu_utf8string &ext, std::unique_ptr<mu_uint8[]> &buffer, mu_isize &fileLength)
+	{
+		SDL_RWops *fp = nullptr;
+		if (OpenSource(path, ext, &fp, fileLength) == false)
+		{
+			return false;
+		}
+
+		buffer.reset(new_nothrow mu_uint8[fileLength]);
 		SDL_RWread(fp, buffer.get(), fileLength, 1);
 		SDL_RWclose(fp);
 
-		mu_boolean alpha = false;
-		mu_int32 fflags = 0;
-		FREE_IMAGE_FORMAT format;
+		return true;
+	}
+
+	/*
+		FreeImage reads the source through the stream, positions are relative to the start of the image
+		so the header of the MU formats is invisible to it.
+	*/
+	struct NSourceStream
+	{
+		SDL_RWops *Stream;
+		Sint64 Start;
+	};
+
+	unsigned DLL_CALLCONV ReadStream(void *buffer, unsigned size, unsigned count, fi_handle handle)
+	{
+		auto *source = static_cast<NSourceStream *>(handle);
+		return static_cast<unsigned>(SDL_RWread(source->Stream, buffer, size, count));
+	}
+
+	unsigned DLL_CALLCONV WriteStream(void *buffer, unsigned size, unsigned count, fi_handle handle)
+	{
+		return 0u;
+	}
+
+	int DLL_CALLCONV SeekStream(fi_handle handle, long offset, int origin)
+	{
+		auto *source = static_cast<NSourceStream *>(handle);
+		const Sint64 position = origin == SEEK_SET
+			? SDL_RWseek(source->Stream, source->Start + offset, RW_SEEK_SET)
+			: SDL_RWseek(source->Stream, offset, origin == SEEK_CUR ? RW_SEEK_CUR : RW_SEEK_END);
+		return position < 0 ? -1 : 0;
+	}
+
+	long DLL_CALLCONV TellStream(fi_handle handle)
+	{
+		auto *source = static_cast<NSourceStream *>(handle);
+		return static_cast<long>(SDL_RWtell(source->Stream) - source->Start);
+	}
+
+	const mu_boolean GetSourceFormat(const mu_utf8string &ext, FREE_IMAGE_FORMAT &format, mu_int32 &fflags)
+	{
+		fflags = 0;
 		if (ext == "ozj" || ext == "jpg" || ext == "jpeg")
 		{
 			format = FREE_IMAGE_FORMAT::FIF_JPEG;
 		}
-		else if (ext == "ozt" || ext == "tga")
+		else if (IsAlphaExtension(ext))
 		{
-			alpha = true;
 			format = FREE_IMAGE_FORMAT::FIF_TARGA;
 		}
 		else if (ext == "png")
@@ -66,16 +159,34 @@ namespace MUTextures
 			return false;
 		}
 
+		return true;
+	}
+
+	FIBITMAP *LoadSource(const mu_utf8string &ext, std::unique_ptr<mu_uint8[]> &buffer, const mu_isize fileLength, const mu_int32 extraFlags)
+	{
+		mu_int32 fflags = 0;
+		FREE_IMAGE_FORMAT format;
+		if (GetSourceFormat(ext, format, fflags) == false)
+		{
+			return nullptr;
+		}
+
 		FIMEMORY *memory = FreeImage_OpenMemory(buffer.get(), static_cast<DWORD>(fileLength));
 		if (memory == nullptr)
 		{
-			return false;
+			return nullptr;
 		}
 
-		FIBITMAP *bitmap = FreeImage_LoadFromMemory(format, memory, fflags);
+		FIBITMAP *bitmap = FreeImage_LoadFromMemory(format, memory, fflags | extraFlags);
 		buffer.reset();
 		FreeImage_CloseMemory(memory);
 
+		return bitmap;
+	}
+
+	const mu_boolean DecodeSource(const mu_utf8string &ext, std::unique_ptr<mu_uint8[]> &buffer, const mu_isize fileLength, FIBITMAP **texture, TextureInfo &info)
+	{
+		FIBITMAP *bitmap = LoadSource(ext, buffer, fileLength, 0);
 		if (bitmap == nullptr)
 		{
 			return false;
@@ -88,67 +199,509 @@ namespace MUTextures
 			return false;
 		}
 
-		const mu_uint32 bpp = FreeImage_GetBPP(bitmap);
-		if (bpp != 32)
+		bitmap = MUPixelFormat::ConvertBitmap(bitmap, false);
+		if (bitmap == nullptr)
 		{
-			FIBITMAP *newBitmap = FreeImage_ConvertTo32Bits(bitmap);
-			FreeImage_Unload(bitmap);
+			return false;
+		}
+
+		info.Width = FreeImage_GetWidth(bitmap);
+		info.Height = FreeImage_GetHeight(bitmap);
+		info.Alpha = IsAlphaExtension(ext);
+		*texture = bitmap;
 
-			if (newBitmap == nullptr)
+		return true;
+	}
+
+	const mu_boolean LoadRaw(mu_utf8string path, FIBITMAP **texture, TextureInfo &info)
+	{
+		mu_utf8string ext;
+		std::unique_ptr<mu_uint8[]> buffer;
+		mu_isize fileLength = 0;
+		if (ReadSource(path, ext, buffer, fileLength) == false)
+		{
+			return false;
+		}
+
+		return DecodeSource(ext, buffer, fileLength, texture, info);
+	}
+
+	const mu_boolean ReadInfo(mu_utf8string path, TextureInfo &info)
+	{
+		NormalizePath(path);
+		const mu_utf8string containerExt = GetExtension(path);
+		if (MUTextureContainers::IsContainerExtension(containerExt))
+		{
+			NMappedFile container;
+			TextureInfo containerInfo;
+			if (container.Open(path) == false || MUTextureContainers::Parse(containerExt, container.GetData(), container.GetSize(), containerInfo) == false)
 			{
 				return false;
 			}
 
-			bitmap = newBitmap;
+			info.Width = containerInfo.Width;
+			info.Height = containerInfo.Height;
+			info.Alpha = containerInfo.Alpha;
+			return true;
 		}
 
-		constexpr mu_uint32 bitsPerPixel = 32u;
-		constexpr mu_uint32 bytesPerPixel = bitsPerPixel / 8u;
+		mu_utf8string ext;
+		SDL_RWops *fp = nullptr;
+		mu_isize fileLength = 0;
+		if (OpenSource(path, ext, &fp, fileLength) == false)
+		{
+			return false;
+		}
 
-#if FREEIMAGE_COLORORDER == FREEIMAGE_COLORORDER_BGR
+		mu_int32 fflags = 0;
+		FREE_IMAGE_FORMAT format;
+		if (GetSourceFormat(ext, format, fflags) == false)
 		{
-			const mu_uint32 width = FreeImage_GetWidth(bitmap);
-			const mu_uint32 height = FreeImage_GetHeight(bitmap);
-			for (mu_uint32 y = 0; y < height; y++) {
-				mu_uint8 *pixels = FreeImage_GetScanLine(bitmap, y);
-				for (mu_uint32 x = 0; x < width; x++) {
-					SwapValue(pixels[0], pixels[2]);
-					pixels += bytesPerPixel;
-				}
-			}
+			SDL_RWclose(fp);
+			return false;
+		}
+
+		// Only the header is read from the file, the pixels are decoded when the texture is streamed
+		FreeImageIO io = {
+			.read_proc = ReadStream,
+			.write_proc = WriteStream,
+			.seek_proc = SeekStream,
+			.tell_proc = TellStream,
+		};
+		NSourceStream source{
+			.Stream = fp,
+			.Start = SDL_RWtell(fp),
+		};
+		FIBITMAP *bitmap = FreeImage_LoadFromHandle(format, &io, &source, fflags | FIF_LOAD_NOPIXELS);
+		SDL_RWclose(fp);
+		if (bitmap == nullptr)
+		{
+			return false;
 		}
-#endif
 
 		info.Width = FreeImage_GetWidth(bitmap);
 		info.Height = FreeImage_GetHeight(bitmap);
-		info.Alpha = alpha;
-		*texture = bitmap;
+		info.Alpha = IsAlphaExtension(ext);
+		FreeImage_Unload(bitmap);
 
 		return true;
 	}
 
-	std::unique_ptr<NGraphicsTexture> Load(mu_utf8string path, const Diligent::SamplerDesc &samplerDesc)
+	constexpr mu_uint32 BytesPerPixel = 4u;
+	constexpr mu_uint32 CoverageIterations = 10u;
+	constexpr mu_float MaxCoverageScale = 4.0f;
+
+	const mu_uint32 CalculateMipLevels(const mu_uint32 width, const mu_uint32 height)
 	{
-		TextureInfo info;
-		FIBITMAP *bitmap = nullptr;
-		if (LoadRaw(path, &bitmap, info) == false)
+		mu_uint32 levels = 1u;
+		for (mu_uint32 size = glm::max(width, height); size > 1u; size >>= 1u)
 		{
-			return nullptr;
+			++levels;
 		}
+		return levels;
+	}
 
+	// Odd sizes clamp the last column and row, so every texel of the source contributes to the level
+	void DownsampleBox(const mu_uint8 *source, const mu_uint32 sourceWidth, const mu_uint32 sourceHeight, mu_uint8 *dest, const mu_uint32 width, const mu_uint32 height)
+	{
+		for (mu_uint32 y = 0; y < height; ++y)
+		{
+			const mu_uint8 *row0 = source + glm::min(y * 2u, sourceHeight - 1u) * sourceWidth * BytesPerPixel;
+			const mu_uint8 *row1 = source + glm::min(y * 2u + 1u, sourceHeight - 1u) * sourceWidth * BytesPerPixel;
+			mu_uint8 *output = dest + y * width * BytesPerPixel;
+			for (mu_uint32 x = 0; x < width; ++x)
+			{
+				const mu_uint32 x0 = glm::min(x * 2u, sourceWidth - 1u) * BytesPerPixel;
+				const mu_uint32 x1 = glm::min(x * 2u + 1u, sourceWidth - 1u) * BytesPerPixel;
+				for (mu_uint32 c = 0; c < BytesPerPixel; ++c)
+				{
+					const mu_uint32 sum = static_cast<mu_uint32>(row0[x0 + c]) + row0[x1 + c] + row1[x0 + c] + row1[x1 + c];
+					output[x * BytesPerPixel + c] = static_cast<mu_uint8>((sum + 2u) >> 2u);
+				}
+			}
+		}
+	}
+
+	const mu_float CalculateAlphaCoverage(const mu_uint8 *pixels, const mu_uint32 count, const mu_float reference, const mu_float scale)
+	{
+		const mu_float threshold = reference * 255.0f;
+		mu_uint32 covered = 0;
+		for (mu_uint32 n = 0; n < count; ++n)
+		{
+			if (static_cast<mu_float>(pixels[n * BytesPerPixel + 3]) * scale > threshold) ++covered;
+		}
+		return static_cast<mu_float>(covered) / static_cast<mu_float>(count);
+	}
+
+	// Searches the alpha scale which keeps the coverage of the first level, otherwise alpha tested textures fade with the distance
+	void ScaleAlphaToCoverage(mu_uint8 *pixels, const mu_uint32 count, const mu_float coverage, const mu_float reference)
+	{
+		mu_float minScale = 0.0f, maxScale = MaxCoverageScale, scale = 1.0f;
+		for (mu_uint32 n = 0; n < CoverageIterations; ++n)
+		{
+			const mu_float current = CalculateAlphaCoverage(pixels, count, reference, scale);
+			if (current < coverage) minScale = scale;
+			else if (current > coverage) maxScale = scale;
+			else break;
+			scale = (minScale + maxScale) * 0.5f;
+		}
+
+		for (mu_uint32 n = 0; n < count; ++n)
+		{
+			mu_uint8 &alpha = pixels[n * BytesPerPixel + 3];
+			alpha = static_cast<mu_uint8>(glm::min(static_cast<mu_float>(alpha) * scale + 0.5f, 255.0f));
+		}
+	}
+
+	void GenerateMipmaps(FIBITMAP *bitmap, TextureInfo &info, const mu_float alphaReference)
+	{
+		const mu_uint32 width = info.Width;
+		const mu_uint32 height = info.Height;
+		const mu_uint32 levels = CalculateMipLevels(width, height);
+
+		mu_size mipmapsSize = 0;
+		for (mu_uint32 level = 1; level < levels; ++level)
+		{
+			mipmapsSize += static_cast<mu_size>(glm::max(width >> level, 1u)) * glm::max(height >> level, 1u) * BytesPerPixel;
+		}
+
+		info.MipLevels = levels;
+		info.Mipmaps.resize(mipmapsSize);
+		if (levels == 1u) return;
+
+		const mu_uint8 *base = FreeImage_GetBits(bitmap);
+		const mu_boolean preserveCoverage = info.Alpha && alphaReference > 0.0f;
+		const mu_float coverage = preserveCoverage ? CalculateAlphaCoverage(base, width * height, alphaReference, 1.0f) : 0.0f;
+
+		// Levels are generated from the previous unscaled level, the alpha scale would accumulate otherwise
+		std::vector<mu_uint8> previous, current;
+		const mu_uint8 *source = base;
+		mu_uint32 sourceWidth = width, sourceHeight = height;
+		mu_uint8 *dest = info.Mipmaps.data();
+		for (mu_uint32 level = 1; level < levels; ++level)
+		{
+			const mu_uint32 levelWidth = glm::max(width >> level, 1u);
+			const mu_uint32 levelHeight = glm::max(height >> level, 1u);
+			const mu_uint32 levelPixels = levelWidth * levelHeight;
+
+			if (preserveCoverage)
+			{
+				current.resize(static_cast<mu_size>(levelPixels) * BytesPerPixel);
+				DownsampleBox(source, sourceWidth, sourceHeight, current.data(), levelWidth, levelHeight);
+				mu_memcpy(dest, current.data(), current.size());
+				ScaleAlphaToCoverage(dest, levelPixels, coverage, alphaReference);
+				previous.swap(current);
+				source = previous.data();
+			}
+			else
+			{
+				DownsampleBox(source, sourceWidth, sourceHeight, dest, levelWidth, levelHeight);
+				source = dest;
+			}
+
+			sourceWidth = levelWidth;
+			sourceHeight = levelHeight;
+			dest += static_cast<mu_size>(levelPixels) * BytesPerPixel;
+		}
+	}
+
+	const mu_boolean IsCompressionEnabled()
+	{
+		return MUConfig::GetTextureCompression() == true && MUCapabilities::IsTextureCompressionBCSupported() == true;
+	}
+
+	// The format depends on the decoded pixels, any source format (PNG included) can carry alpha
+	const ECompressedFormat GetCompressedFormat(FIBITMAP *bitmap, const TextureInfo &info)
+	{
+		const mu_uint8 *pixels = FreeImage_GetBits(bitmap);
+		const mu_size pixelsCount = static_cast<mu_size>(info.Width) * info.Height;
+		for (mu_size n = 0; n < pixelsCount; ++n)
+		{
+			if (pixels[n * BytesPerPixel + 3] < 255u) return ECompressedFormat::BC3;
+		}
+
+		return ECompressedFormat::BC1;
+	}
+
+	const Diligent::TEXTURE_FORMAT GetTextureFormat(const ECompressedFormat format)
+	{
+		switch (format)
+		{
+		case ECompressedFormat::BC1: return Diligent::TEX_FORMAT_BC1_UNORM;
+		case ECompressedFormat::BC3: return Diligent::TEX_FORMAT_BC3_UNORM;
+		default: return Diligent::TEX_FORMAT_RGBA8_UNORM;
+		}
+	}
+
+	const mu_boolean LoadCompressedCache(const mu_utf8string &path, const mu_uint64 hash, const mu_boolean mipmaps, const mu_float alphaReference, TextureInfo &info)
+	{
+		SDL_RWops *fp = nullptr;
+		if (mu_rwfromfile<EGameDirectoryType::eCache>(&fp, path, "rb") == false)
+		{
+			return false;
+		}
+
+		NCompressedCache::NHeader header;
+		const mu_isize fileLength = static_cast<mu_isize>(SDL_RWsize(fp));
+		if (
+			fileLength < static_cast<mu_isize>(sizeof(header)) ||
+			SDL_RWread(fp, &header, sizeof(header), 1) != 1 ||
+			header.Magic != NCompressedCache::Magic ||
+			header.Version != NCompressedCache::Version ||
+			header.SourceHash != hash ||
+			(header.Format != static_cast<mu_uint32>(ECompressedFormat::BC1) && header.Format != static_cast<mu_uint32>(ECompressedFormat::BC3)) ||
+			header.AlphaReference != alphaReference ||
+			header.MipLevels != (mipmaps ? CalculateMipLevels(header.Width, header.Height) : 1u) ||
+			static_cast<mu_isize>(sizeof(header)) + header.DataSize != fileLength
+		)
+		{
+			SDL_RWclose(fp);
+			return false;
+		}
+
+		const ECompressedFormat format = static_cast<ECompressedFormat>(header.Format);
+		mu_size expectedSize = 0;
+		for (mu_uint32 level = 0; level < header.MipLevels; ++level)
+		{
+			expectedSize += MUTextureCompressor::CalculateLevelSize(glm::max(header.Width >> level, 1u), glm::max(header.Height >> level, 1u), format);
+		}
+
+		if (expectedSize != header.DataSize)
+		{
+			SDL_RWclose(fp);
+			return false;
+		}
+
+		info.Blocks.resize(header.DataSize);
+		const mu_boolean loaded = SDL_RWread(fp, info.Blocks.data(), header.DataSize, 1) == 1;
+		SDL_RWclose(fp);
+		if (loaded == false)
+		{
+			info.Blocks.clear();
+			return false;
+		}
+
+		info.Width = static_cast<mu_uint16>(header.Width);
+		info.Height = static_cast<mu_uint16>(header.Height);
+		info.Alpha = header.Alpha != 0;
+		info.MipLevels = header.MipLevels;
+		info.Compression = format;
+		info.Format = GetTextureFormat(format);
+
+		MUTextureCompressor::NStatistics statistics;
+		statistics.Textures = 1;
+		statistics.SourceBytes = header.SourceBytes;
+		statistics.CompressedBytes = header.DataSize;
+		statistics.SquaredError = header.SquaredError;
+		statistics.Samples = header.Samples;
+		MUTextureCompressor::AccumulateStatistics(statistics);
+
+		return true;
+	}
+
+	// The cache is an optimization, when it isn't writable the texture is compressed again next time
+	void SaveCompressedCache(const mu_utf8string &path, const mu_uint64 hash, const mu_float alphaReference, const TextureInfo &info, const MUTextureCompressor::NStatistics &statistics)
+	{
+		NCompressedCache::NHeader header = {};
+		header.Magic = NCompressedCache::Magic;
+		header.Version = NCompressedCache::Version;
+		header.SourceHash = hash;
+		header.Format = static_cast<mu_uint32>(info.Compression);
+		header.AlphaReference = alphaReference;
+		header.Width = info.Width;
+		header.Height = info.Height;
+		header.MipLevels = info.MipLevels;
+		header.Alpha = info.Alpha ? 1u : 0u;
+		header.DataSize = static_cast<mu_uint32>(info.Blocks.size());
+		header.SquaredError = statistics.SquaredError;
+		header.Samples = statistics.Samples;
+		header.SourceBytes = statistics.SourceBytes;
+
+		MUCacheFiles::Write(path, { { &header, sizeof(header) }, { info.Blocks.data(), info.Blocks.size() } });
+	}
+
+	void Compress(FIBITMAP *bitmap, TextureInfo &info, const ECompressedFormat format, MUTextureCompressor::NStatistics &statistics)
+	{
+		const mu_uint32 width = info.Width;
+		const mu_uint32 height = info.Height;
+
+		mu_size blocksSize = 0;
+		for (mu_uint32 level = 0; level < info.MipLevels; ++level)
+		{
+			blocksSize += MUTextureCompressor::CalculateLevelSize(glm::max(width >> level, 1u), glm::max(height >> level, 1u), format);
+		}
+		info.Blocks.resize(blocksSize);
+
+		const mu_uint8 *source = FreeImage_GetBits(bitmap);
+		mu_uint8 *dest = info.Blocks.data();
+		for (mu_uint32 level = 0; level < info.MipLevels; ++level)
+		{
+			const mu_uint32 levelWidth = glm::max(width >> level, 1u);
+			const mu_uint32 levelHeight = glm::max(height >> level, 1u);
+			MUTextureCompressor::CompressLevel(source, levelWidth, levelHeight, format, dest, statistics);
+
+			source = level == 0 ? info.Mipmaps.data() : source + static_cast<mu_size>(levelWidth) * levelHeight * BytesPerPixel;
+			dest += MUTextureCompressor::CalculateLevelSize(levelWidth, levelHeight, format);
+		}
+
+		info.Compression = format;
+		info.Format = GetTextureFormat(format);
+		statistics.Textures += 1;
+	}
+
+	const mu_boolean LoadContainer(const mu_utf8string &path, const mu_utf8string &ext, TextureInfo &info, const mu_boolean mipmaps)
+	{
+		auto container = std::make_shared<NMappedFile>();
+		if (container->Open(path) == false)
+		{
+			mu_error("texture not found ({})", path);
+			return false;
+		}
+
+		if (MUTextureContainers::Parse(ext, container->GetData(), container->GetSize(), info) == false)
+		{
+			mu_error("invalid texture container ({})", path);
+			return false;
+		}
+
+		if (MUGraphics::GetDevice()->GetTextureFormatInfo(info.Format).Supported == false)
+		{
+			mu_error("texture format not supported by the device ({})", path);
+			return false;
+		}
+
+		if (info.FlippedLevels.empty() == false)
+		{
+			std::lock_guard lock(FlippedContainersMutex);
+			if (FlippedContainers.insert(path).second == true)
+			{
+				mu_info("texture container stored top-down, its levels are flipped into a copy at every load ({})", path);
+			}
+		}
+
+		// Textures without mipmaps (UI) only use the first level of the container
+		if (mipmaps == false)
+		{
+			info.MipLevels = 1u;
+			info.Levels.resize(1);
+		}
+
+		info.Container = std::move(container);
+		return true;
+	}
+
+	const mu_boolean Decode(mu_utf8string path, FIBITMAP **bitmap, TextureInfo &info, const mu_boolean mipmaps, const mu_float alphaReference)
+	{
+		NormalizePath(path);
+		const mu_utf8string containerExt = GetExtension(path);
+		if (MUTextureContainers::IsContainerExtension(containerExt))
+		{
+			*bitmap = nullptr;
+			return LoadContainer(path, containerExt, info, mipmaps);
+		}
+
+		mu_utf8string ext;
+		std::unique_ptr<mu_uint8[]> buffer;
+		mu_isize fileLength = 0;
+		if (ReadSource(path, ext, buffer, fileLength) == false)
+		{
+			return false;
+		}
+
+		// Compression only depends on the configuration, the cache stores the mip chain so it must match the request
+		const mu_boolean compress = IsCompressionEnabled();
+		const mu_utf8string cachePath = MUCacheFiles::GetPath(path, NCompressedCache::Extension);
+		const mu_uint64 hash = compress ? MUHash::Calculate64(buffer.get(), static_cast<mu_size>(fileLength)) : 0ull;
+		if (compress && LoadCompressedCache(cachePath, hash, mipmaps, alphaReference, info) == true)
+		{
+			*bitmap = nullptr;
+			return true;
+		}
+
+		if (DecodeSource(ext, buffer, fileLength, bitmap, info) == false)
+		{
+			return false;
+		}
+
+		if (mipmaps)
+		{
+			GenerateMipmaps(*bitmap, info, alphaReference);
+		}
+
+		// The first level of block compressed textures must be a multiple of the block size
+		if (
+			compress == false ||
+			info.Width % MUTextureCompressor::BlockSize != 0 ||
+			info.Height % MUTextureCompressor::BlockSize != 0
+		)
+		{
+			return true;
+		}
+
+		const ECompressedFormat format = GetCompressedFormat(*bitmap, info);
+		MUTextureCompressor::NStatistics statistics;
+		Compress(*bitmap, info, format, statistics);
+		SaveCompressedCache(cachePath, hash, alphaReference, info, statistics);
+		MUTextureCompressor::AccumulateStatistics(statistics);
+
+		FreeImage_Unload(*bitmap);
+		*bitmap = nullptr;
+		info.Mipmaps.clear();
+		info.Mipmaps.shrink_to_fit();
+
+		return true;
+	}
+
+	std::unique_ptr<NGraphicsTexture> Create(const mu_utf8string &path, FIBITMAP *bitmap, const TextureInfo &info, const Diligent::SamplerDesc &samplerDesc)
+	{
 		auto device = MUGraphics::GetDevice();
 
 		const mu_uint32 width = info.Width;
 		const mu_uint32 height = info.Height;
-		const mu_uint32 bpp = FreeImage_GetBPP(bitmap);
-		const mu_uint32 bitmapSize = width * height * (bpp / 8);
-		const mu_uint8 *bitmapBuffer = FreeImage_GetBits(bitmap);
 
 		std::vector<Diligent::TextureSubResData> subresources;
-		Diligent::TextureSubResData subresource;
-		subresource.pData = bitmapBuffer;
-		subresource.Stride = width * (bpp / 8);
-		subresources.push_back(subresource);
+		if (info.Container)
+		{
+			subresources = info.Levels;
+		}
+		else if (info.Compression != ECompressedFormat::None)
+		{
+			const mu_uint8 *blocksBuffer = info.Blocks.data();
+			for (mu_uint32 level = 0; level < info.MipLevels; ++level)
+			{
+				const mu_uint32 levelWidth = glm::max(width >> level, 1u);
+				const mu_uint32 levelHeight = glm::max(height >> level, 1u);
+
+				Diligent::TextureSubResData blocks;
+				blocks.pData = blocksBuffer;
+				blocks.Stride = MUTextureCompressor::GetBlocksCount(levelWidth) * MUTextureCompressor::GetBlockBytes(info.Compression);
+				subresources.push_back(blocks);
+				blocksBuffer += MUTextureCompressor::CalculateLevelSize(levelWidth, levelHeight, info.Compression);
+			}
+		}
+		else
+		{
+			const mu_uint32 bpp = FreeImage_GetBPP(bitmap);
+			const mu_uint8 *bitmapBuffer = FreeImage_GetBits(bitmap);
+
+			Diligent::TextureSubResData subresource;
+			subresource.pData = bitmapBuffer;
+			subresource.Stride = width * (bpp / 8);
+			subresources.push_back(subresource);
+
+			const mu_uint8 *mipmapBuffer = info.Mipmaps.data();
+			for (mu_uint32 level = 1; level < info.MipLevels; ++level)
+			{
+				const mu_uint32 levelWidth = glm::max(width >> level, 1u);
+				const mu_uint32 levelHeight = glm::max(height >> level, 1u);
+
+				Diligent::TextureSubResData mipmap;
+				mipmap.pData = mipmapBuffer;
+				mipmap.Stride = levelWidth * BytesPerPixel;
+				subresources.push_back(mipmap);
+				mipmapBuffer += static_cast<mu_size>(levelWidth) * levelHeight * BytesPerPixel;
+			}
+		}
 
 		Diligent::TextureDesc textureDesc;
 #if NEXTMU_COMPILE_DEBUG == 1
@@ -157,13 +710,15 @@ namespace MUTextures
 		textureDesc.Type = Diligent::RESOURCE_DIM_TEX_2D;
 		textureDesc.Width = width;
 		textureDesc.Height = height;
-		textureDesc.Format = Diligent::TEX_FORMAT_RGBA8_UNORM;
+		textureDesc.Format = info.Format;
+		textureDesc.MipLevels = info.MipLevels;
 		textureDesc.Usage = Diligent::USAGE_IMMUTABLE;
 		textureDesc.BindFlags = Diligent::BIND_SHADER_RESOURCE;
 
 		Diligent::TextureData textureData(subresources.data(), static_cast<mu_uint32>(subresources.size()));
 		Diligent::RefCntAutoPtr<Diligent::ITexture> texture;
 		device->CreateTexture(textureDesc, &textureData, &texture);
+		if (bitmap != nullptr) FreeImage_Unload(bitmap);
 		if (texture == nullptr)
 		{
 			return nullptr;
@@ -176,6 +731,18 @@ namespace MUTextures
 		return std::make_unique<NGraphicsTexture>(TextureIdGenerator++, texture, width, height, info.Alpha);
 	}
 
+	std::unique_ptr<NGraphicsTexture> Load(mu_utf8string path, const Diligent::SamplerDesc &samplerDesc, const mu_boolean mipmaps)
+	{
+		TextureInfo info;
+		FIBITMAP *bitmap = nullptr;
+		if (Decode(path, &bitmap, info, mipmaps) == false)
+		{
+			return nullptr;
+		}
+
+		return Create(path, bitmap, info, samplerDesc);
+	}
+
 	struct SamplerMode
 	{
 		const mu_utf8string name;
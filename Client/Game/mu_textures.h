@@ -3,19 +3,47 @@
 
 #pragma once
 
+#include "mu_texture_compressor.h"
+
 class NGraphicsTexture;
+class NMappedFile;
 
 struct TextureInfo
 {
 	mu_uint16 Width = 0u;
 	mu_uint16 Height = 0u;
 	mu_boolean Alpha = false;
+	mu_uint32 MipLevels = 1u;
+	std::vector<mu_uint8> Mipmaps; // RGBA8 levels after the first one, tightly packed
+	ECompressedFormat Compression = ECompressedFormat::None;
+	std::vector<mu_uint8> Blocks; // Every level when compressed, the bitmap isn't used then
+	Diligent::TEXTURE_FORMAT Format = Diligent::TEX_FORMAT_RGBA8_UNORM;
+	std::vector<Diligent::TextureSubResData> Levels; // Every level of textures read from containers, they point into the container
+	std::vector<mu_uint8> FlippedLevels; // Levels of top-down containers flipped to bottom-up, Levels point into it instead of the container then
+	std::shared_ptr<NMappedFile> Container;
 };
 
 namespace MUTextures
 {
+	constexpr mu_float DefaultAlphaReference = 0.25f; // Default alpha test of the meshes
+
 	const mu_boolean LoadRaw(mu_utf8string path, FIBITMAP **texture, TextureInfo &info);
-	std::unique_ptr<NGraphicsTexture> Load(mu_utf8string path, const Diligent::SamplerDesc &samplerDesc);
+	// Reads the size and alpha of a texture without decoding its pixels, streamed textures report them before they are loaded
+	const mu_boolean ReadInfo(mu_utf8string path, TextureInfo &info);
+	/*
+		Generates the mip chain of a bitmap decoded by LoadRaw with a box filter, it only does CPU work so it runs in the loader threads.
+		Alpha textures scale the alpha of every level to keep the coverage of alphaReference, zero disables it.
+	*/
+	void GenerateMipmaps(FIBITMAP *bitmap, TextureInfo &info, const mu_float alphaReference);
+	/*
+		CPU stage of a texture load, it decodes the texture and generates the mip chain (when requested), the result is block compressed
+		when enabled in the configuration and supported by the device. Compressed textures are cached by the hash of their source, the bitmap is null when compressed.
+		DDS and KTX2 containers skip every step, their file is mapped and the levels are handed to the device without conversion.
+	*/
+	const mu_boolean Decode(mu_utf8string path, FIBITMAP **bitmap, TextureInfo &info, const mu_boolean mipmaps, const mu_float alphaReference = DefaultAlphaReference);
+	// Creates the device texture from a bitmap decoded by LoadRaw or Decode, it must run on the main thread and releases the bitmap
+	std::unique_ptr<NGraphicsTexture> Create(const mu_utf8string &path, FIBITMAP *bitmap, const TextureInfo &info, const Diligent::SamplerDesc &samplerDesc);
+	std::unique_ptr<NGraphicsTexture> Load(mu_utf8string path, const Diligent::SamplerDesc &samplerDesc, const mu_boolean mipmaps = true);
 
 	const mu_boolean IsValidFilter(const mu_utf8string value);
 	const mu_boolean IsValidWrap(const mu_utf8string value);
@@ -0,0 +1,310 @@
+#include "stdafx.h"
+#include "mu_texturestreaming.h"
+#include "mu_config.h"
+#include "mu_graphics.h"
+#include "mu_mappedfile.h"
+#include "mu_textures.h"
+#include <thread>
+#include <condition_variable>
+
+enum class EStreamingState : mu_uint32
+{
+	Evicted,
+	Queued, // Owned by the loader until it is completed
+	Decoded,
+	Resident,
+	Failed,
+};
+
+struct NStreamedTexture
+{
+	mu_utf8string Path;
+	Diligent::SamplerDesc Sampler;
+	mu_boolean Mipmaps = true;
+	mu_float AlphaReference = MUTextures::DefaultAlphaReference;
+	std::unique_ptr<NGraphicsTexture> Handle;
+	EStreamingState State = EStreamingState::Evicted;
+	mu_uint64 Bytes = 0;
+
+	// Written by the loader
+	FIBITMAP *Bitmap = nullptr;
+	TextureInfo Info;
+	mu_boolean Decoded = false;
+};
+
+namespace MUTextureStreaming
+{
+	// Device textures created per frame, the rest waits for the next frames to avoid hitches
+	constexpr mu_uint32 MaxUploadsPerFrame = 8u;
+
+	mu_uint64 BudgetBytes = 0;
+	mu_uint32 Frame = 1u;
+	mu_uint64 ResidentBytes = 0;
+	NStatistics Statistics;
+
+	std::unique_ptr<NGraphicsTexture> Placeholder;
+	std::vector<std::unique_ptr<NStreamedTexture>> Textures;
+	std::map<NGraphicsTexture *, NStreamedTexture *> TexturesByHandle;
+
+	std::mutex Mutex;
+	std::condition_variable_any Condition;
+	std::deque<NStreamedTexture *> Pending;
+	std::deque<NStreamedTexture *> Completed;
+	std::jthread Loader;
+
+	void SelectEvictions(const std::vector<NResidencyEntry> &entries, const mu_uint64 residentBytes, const mu_uint64 budgetBytes, const mu_uint32 protectedFrame, std::vector<mu_uint32> &evictions)
+	{
+		evictions.clear();
+		if (residentBytes <= budgetBytes) return;
+
+		for (mu_uint32 index = 0; index < static_cast<mu_uint32>(entries.size()); ++index)
+		{
+			if (entries[index].LastUsedFrame < protectedFrame) evictions.push_back(index);
+		}
+
+		std::sort(
+			evictions.begin(),
+			evictions.end(),
+			[&entries](const mu_uint32 lhs, const mu_uint32 rhs) -> bool { return entries[lhs].LastUsedFrame < entries[rhs].LastUsedFrame; }
+		);
+
+		mu_uint64 bytes = residentBytes;
+		mu_uint32 count = 0;
+		for (; count < static_cast<mu_uint32>(evictions.size()) && bytes > budgetBytes; ++count)
+		{
+			bytes -= entries[evictions[count]].Bytes;
+		}
+		evictions.resize(count);
+	}
+
+	void LoaderWorker(std::stop_token stopToken)
+	{
+		while (true)
+		{
+			NStreamedTexture *texture = nullptr;
+			{
+				std::unique_lock lock(Mutex);
+				if (Condition.wait(lock, stopToken, [] { return Pending.empty() == false; }) == false) return;
+				texture = Pending.front();
+				Pending.pop_front();
+			}
+
+			texture->Decoded = MUTextures::Decode(texture->Path, &texture->Bitmap, texture->Info, texture->Mipmaps, texture->AlphaReference);
+
+			std::lock_guard lock(Mutex);
+			Completed.push_back(texture);
+		}
+	}
+
+	const mu_uint64 CalculateBytes(const TextureInfo &info)
+	{
+		if (info.Container) return info.Container->GetSize();
+		if (info.Blocks.empty() == false) return info.Blocks.size();
+		return static_cast<mu_uint64>(info.Width) * info.Height * 4u + info.Mipmaps.size();
+	}
+
+	const mu_boolean Initialize()
+	{
+		BudgetBytes = static_cast<mu_uint64>(MUConfig::GetTextureStreamingBudget()) * 1024u * 1024u;
+		if (BudgetBytes == 0) return true;
+
+		// Transparent black so the blended effects aren't visible until their texture is ready
+		TextureInfo info;
+		info.Width = 1u;
+		info.Height = 1u;
+		FIBITMAP *bitmap = FreeImage_Allocate(1, 1, 32);
+		if (bitmap == nullptr) return false;
+		mu_zeromem(FreeImage_GetBits(bitmap), 4u);
+
+		Placeholder = MUTextures::Create("Streaming Placeholder", bitmap, info, MUTextures::CalculateSamplerFlags("nearest", "repeat"));
+		if (!Placeholder) return false;
+
+		Loader = std::jthread(LoaderWorker);
+		return true;
+	}
+
+	void Destroy()
+	{
+		if (Loader.joinable())
+		{
+			Loader.request_stop();
+			Loader.join();
+		}
+
+		for (auto &texture : Textures)
+		{
+			if (texture->Bitmap != nullptr) FreeImage_Unload(texture->Bitmap);
+		}
+
+		Pending.clear();
+		Completed.clear();
+		TexturesByHandle.clear();
+		Textures.clear();
+		Placeholder.reset();
+		ResidentBytes = 0;
+		Statistics = NStatistics();
+	}
+
+	const mu_boolean IsEnabled()
+	{
+		return BudgetBytes > 0;
+	}
+
+	NGraphicsTexture *Register(const mu_utf8string &path, const Diligent::SamplerDesc &sampler, const mu_boolean mipmaps, const mu_float alphaReference)
+	{
+		// Particles and joints size their quads and culling from the texture when they are initialized, the handle reports the real size before the texture is loaded
+		TextureInfo info;
+		if (MUTextures::ReadInfo(path, info) == false)
+		{
+			mu_error("failed to read streamed texture ({})", path);
+			return nullptr;
+		}
+
+		auto texture = std::make_unique<NStreamedTexture>();
+		texture->Path = path;
+		texture->Sampler = sampler;
+		texture->Mipmaps = mipmaps;
+		texture->AlphaReference = alphaReference;
+		texture->Handle = std::make_unique<NGraphicsTexture>(Placeholder->GetId(), Diligent::RefCntAutoPtr<Diligent::ITexture>(Placeholder->GetTexture()), info.Width, info.Height, info.Alpha);
+
+		NGraphicsTexture *handle = texture->Handle.get();
+		TexturesByHandle.insert(std::pair(handle, texture.get()));
+		Textures.push_back(std::move(texture));
+		++Statistics.Registered;
+
+		return handle;
+	}
+
+	void Queue(NStreamedTexture *texture)
+	{
+		texture->State = EStreamingState::Queued;
+		{
+			std::lock_guard lock(Mutex);
+			Pending.push_back(texture);
+		}
+		Condition.notify_one();
+	}
+
+	void Prefetch(NGraphicsTexture *handle)
+	{
+		auto iter = TexturesByHandle.find(handle);
+		if (iter == TexturesByHandle.end()) return;
+
+		// Prefetched textures count as used so they aren't evicted before the map draws them
+		handle->Touch(Frame);
+		if (iter->second->State == EStreamingState::Evicted) Queue(iter->second);
+	}
+
+	void Upload(NStreamedTexture *texture)
+	{
+		auto created = texture->Decoded ? MUTextures::Create(texture->Path, texture->Bitmap, texture->Info, texture->Sampler) : nullptr;
+		texture->Bitmap = nullptr;
+
+		if (!created)
+		{
+			mu_error("failed to stream texture ({})", texture->Path);
+			texture->State = EStreamingState::Failed;
+			texture->Info = TextureInfo();
+			return;
+		}
+
+		texture->Bytes = CalculateBytes(texture->Info);
+		texture->Info = TextureInfo();
+		texture->Handle->Assign(created->GetId(), Diligent::RefCntAutoPtr<Diligent::ITexture>(created->GetTexture()), created->GetWidth(), created->GetHeight(), created->HasAlpha());
+		texture->Handle->Touch(Frame);
+		texture->State = EStreamingState::Resident;
+		ResidentBytes += texture->Bytes;
+		++Statistics.Loads;
+	}
+
+	void Evict(NStreamedTexture *texture)
+	{
+		auto handle = texture->Handle.get();
+
+		// Bindings which reference the texture would keep it alive
+		ShaderResourcesBindingManager.ReleaseShaderResourcesByResourceId(handle->GetId());
+		handle->Assign(Placeholder->GetId(), Diligent::RefCntAutoPtr<Diligent::ITexture>(Placeholder->GetTexture()), handle->GetWidth(), handle->GetHeight(), handle->HasAlpha());
+
+		ResidentBytes -= texture->Bytes;
+		texture->Bytes = 0;
+		texture->State = EStreamingState::Evicted;
+		++Statistics.Evictions;
+	}
+
+	void Update()
+	{
+		if (IsEnabled() == false) return;
+
+		const mu_uint32 previousFrame = Frame++;
+
+		std::vector<NStreamedTexture *> uploads;
+		{
+			std::lock_guard lock(Mutex);
+			while (Completed.empty() == false && uploads.size() < MaxUploadsPerFrame)
+			{
+				uploads.push_back(Completed.front());
+				Completed.pop_front();
+			}
+		}
+
+		for (auto texture : uploads)
+		{
+			Upload(texture);
+		}
+
+		std::vector<NStreamedTexture *> resident;
+		std::vector<NResidencyEntry> entries;
+		for (auto &texture : Textures)
+		{
+			switch (texture->State)
+			{
+			case EStreamingState::Evicted:
+				{
+					if (texture->Handle->GetLastUsedFrame() == previousFrame) Queue(texture.get());
+				}
+				break;
+
+			case EStreamingState::Resident:
+				{
+					resident.push_back(texture.get());
+					entries.push_back(
+						NResidencyEntry{
+							.Bytes = texture->Bytes,
+							.LastUsedFrame = texture->Handle->GetLastUsedFrame(),
+						}
+					);
+				}
+				break;
+
+			default: break;
+			}
+		}
+
+		std::vector<mu_uint32> evictions;
+		SelectEvictions(entries, ResidentBytes, BudgetBytes, previousFrame, evictions);
+		for (const auto index : evictions)
+		{
+			Evict(resident[index]);
+		}
+
+		Statistics.Resident = static_cast<mu_uint32>(resident.size() - evictions.size());
+	}
+
+	void Touch(NGraphicsTexture *texture)
+	{
+		texture->Touch(Frame);
+	}
+
+	const mu_uint32 GetFrame()
+	{
+		return Frame;
+	}
+
+	const NStatistics GetStatistics()
+	{
+		NStatistics statistics = Statistics;
+		statistics.ResidentBytes = ResidentBytes;
+		statistics.BudgetBytes = BudgetBytes;
+		return statistics;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+#ifndef __MU_TEXTURESTREAMING_H__
+#define __MU_TEXTURESTREAMING_H__
+
+#pragma once
+
+class NGraphicsTexture;
+
+/*
+	Streaming of the textures declared with "streaming" in resources.json, they are registered at startup and return a handle
+	which uses a placeholder until a loader thread decodes them and the main thread creates the device texture.
+	The handle reports the size and alpha read from the header of the texture, so users can size with it before it is loaded.
+	Resident textures are evicted by the last frame they were drawn in when they exceed the budget of the config.
+*/
+namespace MUTextureStreaming
+{
+	struct NStatistics
+	{
+		mu_uint32 Registered = 0;
+		mu_uint32 Resident = 0;
+		mu_uint32 Loads = 0;
+		mu_uint32 Evictions = 0;
+		mu_uint64 ResidentBytes = 0;
+		mu_uint64 BudgetBytes = 0;
+	};
+
+	struct NResidencyEntry
+	{
+		mu_uint64 Bytes = 0;
+		mu_uint32 LastUsedFrame = 0;
+	};
+
+	/*
+		Residency policy, it doesn't require a device so it can be simulated with any budget.
+		Selects the resident entries to evict, least recently used first, until the resident bytes fit the budget.
+		Entries used since protectedFrame are never evicted, the budget can be exceeded when they don't fit.
+	*/
+	void SelectEvictions(const std::vector<NResidencyEntry> &entries, const mu_uint64 residentBytes, const mu_uint64 budgetBytes, const mu_uint32 protectedFrame, std::vector<mu_uint32> &evictions);
+
+	const mu_boolean Initialize();
+	void Destroy();
+
+	// Streaming is disabled when the budget is zero, every texture is loaded at startup then
+	const mu_boolean IsEnabled();
+
+	NGraphicsTexture *Register(const mu_utf8string &path, const Diligent::SamplerDesc &sampler, const mu_boolean mipmaps, const mu_float alphaReference);
+	// Requests the texture before it is drawn, used by the map changes
+	void Prefetch(NGraphicsTexture *texture);
+	// Uploads the decoded textures, requests the textures drawn in the last frame and evicts, it must run on the main thread once per frame
+	void Update();
+
+	void Touch(NGraphicsTexture *texture);
+	const mu_uint32 GetFrame();
+	const NStatistics GetStatistics();
+}
+
+#endif
\ No newline at end of file
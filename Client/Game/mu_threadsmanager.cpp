@@ -1,5 +1,6 @@
 #include "stdafx.h"
 #include "mu_threadsmanager.h"
+#include "mu_random.h"
 #include <thread>
 #include <barrier>
 #include <xutility>
@@ -56,6 +57,7 @@ namespace MUThreadsManager
 	void Worker(const mu_uint32 index)
 	{
 		const mu_uint32 count = GetThreadsCount();
+		MURandom::SetThreadIndex(index);
 		while (true)
 		{
 			WakeBarrier->arrive_and_wait();
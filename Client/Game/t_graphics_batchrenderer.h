@@ -0,0 +1,277 @@
+#ifndef __T_GRAPHICS_BATCHRENDERER_H__
+#define __T_GRAPHICS_BATCHRENDERER_H__
+
+#pragma once
+
+#include "mu_graphics.h"
+#include "mu_renderstate.h"
+#include "mu_texturestreaming.h"
+
+/*
+	Describes how the groups of a template are drawn, every template only fills its descriptor and the batch
+	renderer resolves the pipeline state and the shader binding once instead of looking them up on every group.
+*/
+struct NBatchDescriptor
+{
+	NGraphicsTexture *Texture = nullptr;
+	NDynamicPipelineState DynamicPipelineState;
+	mu_boolean IsPremultipliedAlpha = false;
+	mu_boolean IsLinear = false;
+	NRenderClassify Classify = NRenderClassify::None;
+	mu_uint16 ListIndex = 0;
+};
+
+struct NBatchStatistics
+{
+	mu_uint32 Groups = 0; // Draws required by one draw per group
+	mu_uint32 Draws = 0; // Draws issued after merging the groups
+};
+
+struct NBatchBuffers
+{
+	Diligent::IBuffer *VertexBuffer;
+	Diligent::IBuffer *IndexBuffer;
+	Diligent::VALUE_TYPE IndexType;
+	// Streamed indices address the vertices directly, otherwise the index buffer holds the static quads pattern
+	mu_boolean StreamedIndices = false;
+};
+
+/*
+	Table driven renderer shared by the particles and joints, indexed by template type.
+	Pipelines and bindings are resolved at Prepare() and only resolved again if the fixed pipeline state changes,
+	adjacent groups which resolve to the same state are merged into a single draw.
+	Every draw still maps its settings because the render manager sorts the command lists, however the settings
+	are built once per descriptor and never allocated per frame.
+*/
+template<typename SettingsType>
+class NBatchRenderer
+{
+private:
+	struct NBatchState
+	{
+		mu_boolean Valid = false;
+		NBatchDescriptor Descriptor;
+		SettingsType Settings;
+		mu_uint32 StateId = NInvalidUInt32;
+		NPipelineState *Pipeline = nullptr;
+		NShaderResourcesBinding *Binding = nullptr;
+		mu_uint32 TextureId = NInvalidUInt32; // Streamed textures change their id when they become resident or evicted
+	};
+
+	struct NBatch
+	{
+		mu_uint32 State;
+		mu_uint32 Index;
+		mu_uint32 Count;
+	};
+
+public:
+	void Initialize(const mu_uint32 descriptorsCount, const mu_char *settingsName)
+	{
+		States.clear();
+		States.resize(descriptorsCount);
+		Batches.reserve(descriptorsCount);
+		SettingsName = settingsName;
+		PreparedHash = NInvalidUInt32;
+	}
+
+	void Destroy()
+	{
+		States.clear();
+		Batches.clear();
+		PreparedHash = NInvalidUInt32;
+	}
+
+	void SetDescriptor(const mu_uint32 index, const NBatchDescriptor &descriptor, const SettingsType &settings)
+	{
+		auto &state = States[index];
+		state.Valid = descriptor.Texture != nullptr;
+		state.Descriptor = descriptor;
+		state.Settings = settings;
+		state.Pipeline = nullptr;
+		state.Binding = nullptr;
+		PreparedHash = NInvalidUInt32;
+	}
+
+	const mu_boolean Prepare(const NFixedPipelineState &fixedState, Diligent::IBuffer *settingsUniform)
+	{
+		const auto hash = fixedState.GetHash();
+		if (hash == PreparedHash && AreTexturesPrepared()) return true;
+
+		for (auto &state : States)
+		{
+			state.Pipeline = nullptr;
+			state.Binding = nullptr;
+			if (state.Valid == false) continue;
+
+			auto pipelineState = GetPipelineState(fixedState, state.Descriptor.DynamicPipelineState);
+			if (pipelineState == nullptr) return false;
+
+			if (pipelineState->StaticInitialized == false)
+			{
+				pipelineState->Pipeline->GetStaticVariableByName(Diligent::SHADER_TYPE_VERTEX, "cbCameraAttribs")->Set(MURenderState::GetCameraUniform());
+				pipelineState->Pipeline->GetStaticVariableByName(Diligent::SHADER_TYPE_PIXEL, SettingsName)->Set(settingsUniform);
+				pipelineState->StaticInitialized = true;
+			}
+
+			auto texture = state.Descriptor.Texture;
+			state.TextureId = texture->GetId();
+			NResourceId resourceIds[1] = { texture->GetId() };
+			auto binding = ShaderResourcesBindingManager.GetShaderBinding(pipelineState->Id, pipelineState->Pipeline, mu_countof(resourceIds), resourceIds);
+			if (binding == nullptr) return false;
+
+			if (binding->Initialized == false)
+			{
+				binding->Binding->GetVariableByName(Diligent::SHADER_TYPE_PIXEL, "g_Texture")->Set(texture->GetTexture()->GetDefaultView(Diligent::TEXTURE_VIEW_SHADER_RESOURCE));
+				binding->Initialized = true;
+			}
+
+			state.Pipeline = pipelineState;
+			state.Binding = binding;
+		}
+
+		// Descriptors which resolve to the same state share the id of the first one so their groups can be merged
+		for (mu_uint32 n = 0; n < static_cast<mu_uint32>(States.size()); ++n)
+		{
+			auto &state = States[n];
+			state.StateId = n;
+			if (state.Pipeline == nullptr) continue;
+
+			for (mu_uint32 m = 0; m < n; ++m)
+			{
+				const auto &other = States[m];
+				if (
+					other.Pipeline == state.Pipeline &&
+					other.Binding == state.Binding &&
+					other.Descriptor.Classify == state.Descriptor.Classify &&
+					other.Descriptor.ListIndex == state.Descriptor.ListIndex &&
+					mu_memcmp(&other.Settings, &state.Settings, sizeof(SettingsType)) == 0
+				)
+				{
+					state.StateId = m;
+					break;
+				}
+			}
+		}
+
+		PreparedHash = hash;
+		return true;
+	}
+
+	void Push(const mu_uint32 type, const mu_uint32 index, const mu_uint32 count)
+	{
+		++Statistics.Groups;
+		if (count == 0 || type >= static_cast<mu_uint32>(States.size())) return;
+
+		const auto &state = States[type];
+		if (state.Pipeline == nullptr) return;
+
+		if (Batches.empty() == false)
+		{
+			auto &batch = Batches.back();
+			if (States[batch.State].StateId == state.StateId && batch.Index + batch.Count == index)
+			{
+				batch.Count += count;
+				return;
+			}
+		}
+
+		Batches.push_back(
+			NBatch{
+				.State = type,
+				.Index = index,
+				.Count = count,
+			}
+		);
+	}
+
+	void Flush(const NBatchBuffers &buffers, Diligent::IBuffer *settingsUniform)
+	{
+		auto renderManager = MUGraphics::GetRenderManager();
+
+		for (const auto &batch : Batches)
+		{
+			auto &state = States[batch.State];
+			MUTextureStreaming::Touch(state.Descriptor.Texture);
+
+			renderManager->UpdateBufferWithMap(
+				RUpdateBufferWithMap{
+					.ShouldReleaseMemory = false,
+					.Buffer = settingsUniform,
+					.Data = &state.Settings,
+					.Size = sizeof(SettingsType),
+					.MapType = Diligent::MAP_WRITE,
+					.MapFlags = Diligent::MAP_FLAG_DISCARD,
+				}
+			);
+
+			renderManager->SetPipelineState(state.Pipeline);
+			renderManager->SetVertexBuffer(
+				RSetVertexBuffer{
+					.StartSlot = 0,
+					.Buffer = buffers.VertexBuffer,
+					.Offset = 0,
+					.StateTransitionMode = Diligent::RESOURCE_STATE_TRANSITION_MODE_VERIFY,
+					.Flags = Diligent::SET_VERTEX_BUFFERS_FLAG_NONE,
+				}
+			);
+			renderManager->SetIndexBuffer(
+				RSetIndexBuffer{
+					.IndexBuffer = buffers.IndexBuffer,
+					.ByteOffset = 0,
+					.StateTransitionMode = Diligent::RESOURCE_STATE_TRANSITION_MODE_VERIFY,
+				}
+			);
+			renderManager->CommitShaderResources(
+				RCommitShaderResources{
+					.ShaderResourceBinding = state.Binding,
+				}
+			);
+
+			renderManager->DrawIndexed(
+				RDrawIndexed{
+					.Attribs = buffers.StreamedIndices == true
+						? Diligent::DrawIndexedAttribs(batch.Count * 6, buffers.IndexType, Diligent::DRAW_FLAG_VERIFY_ALL, 1, batch.Index * 6, 0)
+						: Diligent::DrawIndexedAttribs(batch.Count * 6, buffers.IndexType, Diligent::DRAW_FLAG_VERIFY_ALL, 1, 0, batch.Index * 4)
+				},
+				RCommandListInfo{
+					.Type = NDrawOrderType::Classifier,
+					.Classify = state.Descriptor.Classify,
+					.View = 0,
+					.Index = state.Descriptor.ListIndex,
+				}
+			);
+		}
+
+		Statistics.Draws = static_cast<mu_uint32>(Batches.size());
+		LastStatistics = Statistics;
+		Statistics = NBatchStatistics();
+		Batches.clear();
+	}
+
+	NEXTMU_INLINE const NBatchStatistics &GetStatistics() const
+	{
+		return LastStatistics;
+	}
+
+private:
+	const mu_boolean AreTexturesPrepared() const
+	{
+		for (const auto &state : States)
+		{
+			if (state.Valid && state.Descriptor.Texture->GetId() != state.TextureId) return false;
+		}
+
+		return true;
+	}
+
+private:
+	const mu_char *SettingsName = nullptr;
+	NFixedPipelineHash PreparedHash = NInvalidUInt32;
+	std::vector<NBatchState> States;
+	std::vector<NBatch> Batches;
+	NBatchStatistics Statistics;
+	NBatchStatistics LastStatistics;
+};
+
+#endif
\ No newline at end of file
@@ -361,6 +361,61 @@ void CreatePipelineResources()
 		Resources.insert(std::make_pair("particle", resource));
 	}
 
+	// GPU Particles
+	{
+		NPipelineResource resource;
+
+		resource.Variables.push_back(
+			Diligent::ShaderResourceVariableDesc(
+				Diligent::SHADER_TYPE_VERTEX,
+				"GPUParticlesCamera",
+				Diligent::SHADER_RESOURCE_VARIABLE_TYPE_STATIC
+			)
+		);
+
+		resource.Variables.push_back(
+			Diligent::ShaderResourceVariableDesc(
+				Diligent::SHADER_TYPE_VERTEX | Diligent::SHADER_TYPE_PIXEL,
+				"GPUParticlesDraw",
+				Diligent::SHADER_RESOURCE_VARIABLE_TYPE_STATIC
+			)
+		);
+
+		resource.Variables.push_back(
+			Diligent::ShaderResourceVariableDesc(
+				Diligent::SHADER_TYPE_VERTEX,
+				"g_Particles",
+				Diligent::SHADER_RESOURCE_VARIABLE_TYPE_STATIC
+			)
+		);
+
+		resource.Variables.push_back(
+			Diligent::ShaderResourceVariableDesc(
+				Diligent::SHADER_TYPE_VERTEX,
+				"g_AliveIndices",
+				Diligent::SHADER_RESOURCE_VARIABLE_TYPE_STATIC
+			)
+		);
+
+		resource.Variables.push_back(
+			Diligent::ShaderResourceVariableDesc(
+				Diligent::SHADER_TYPE_VERTEX,
+				"g_Behaviors",
+				Diligent::SHADER_RESOURCE_VARIABLE_TYPE_STATIC
+			)
+		);
+
+		resource.Variables.push_back(
+			Diligent::ShaderResourceVariableDesc(
+				Diligent::SHADER_TYPE_PIXEL,
+				"g_Texture",
+				Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE
+			)
+		);
+
+		Resources.insert(std::make_pair("gpuparticle", resource));
+	}
+
 	// Bounding Box
 	{
 		NPipelineResource resource;
@@ -0,0 +1,51 @@
+#include "stdafx.h"
+#include "t_graphics_quadindices.h"
+#include "mu_graphics.h"
+
+template<typename IndexType>
+void GenerateQuadIndices(IndexType *indices, const mu_uint32 quadsCount)
+{
+	for (mu_uint32 quad = 0; quad < quadsCount; ++quad)
+	{
+		const IndexType vertex = static_cast<IndexType>(quad * 4);
+		indices[0] = vertex + 0;
+		indices[1] = vertex + 1;
+		indices[2] = vertex + 2;
+		indices[3] = vertex + 0;
+		indices[4] = vertex + 2;
+		indices[5] = vertex + 3;
+		indices += 6;
+	}
+}
+
+Diligent::RefCntAutoPtr<Diligent::IBuffer> CreateQuadIndexBuffer(const mu_uint32 quadsCount, const Diligent::VALUE_TYPE valueType)
+{
+	const mu_uint32 indexSize = valueType == Diligent::VT_UINT16 ? sizeof(mu_uint16) : sizeof(mu_uint32);
+	const mu_uint32 bufferSize = indexSize * quadsCount * 6;
+
+	std::unique_ptr<mu_uint8[]> memory(new (std::nothrow) mu_uint8[bufferSize]);
+	if (!memory) return Diligent::RefCntAutoPtr<Diligent::IBuffer>();
+
+	if (valueType == Diligent::VT_UINT16)
+		GenerateQuadIndices(reinterpret_cast<mu_uint16 *>(memory.get()), quadsCount);
+	else
+		GenerateQuadIndices(reinterpret_cast<mu_uint32 *>(memory.get()), quadsCount);
+
+	Diligent::BufferDesc bufferDesc;
+	bufferDesc.Usage = Diligent::USAGE_IMMUTABLE;
+	bufferDesc.BindFlags = Diligent::BIND_INDEX_BUFFER;
+	bufferDesc.Size = bufferSize;
+
+	Diligent::BufferData bufferData;
+	bufferData.pData = memory.get();
+	bufferData.DataSize = bufferSize;
+
+	Diligent::RefCntAutoPtr<Diligent::IBuffer> buffer;
+	MUGraphics::GetDevice()->CreateBuffer(bufferDesc, &bufferData, &buffer);
+	if (buffer == nullptr) return buffer;
+
+	Diligent::StateTransitionDesc barrier(buffer, Diligent::RESOURCE_STATE_COPY_DEST, Diligent::RESOURCE_STATE_INDEX_BUFFER, Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE);
+	MUGraphics::GetImmediateContext()->TransitionResourceStates(1, &barrier);
+
+	return buffer;
+}
\ No newline at end of file
@@ -0,0 +1,28 @@
+#ifndef __T_GRAPHICS_QUADINDICES_H__
+#define __T_GRAPHICS_QUADINDICES_H__
+
+#pragma once
+
+/*
+	Quads are always drawn with the same indices pattern (0, 1, 2, 0, 2, 3 per quad), so a single immutable
+	index buffer is generated at initialization and only the vertices have to be streamed every frame.
+	16 bits indices are used when every vertex of MaxQuads can be addressed with them.
+*/
+template<mu_uint32 MaxQuads>
+struct NQuadIndices
+{
+	typedef std::conditional_t<MaxQuads * 4u <= 65536u, mu_uint16, mu_uint32> IndexType;
+	static constexpr Diligent::VALUE_TYPE ValueType = sizeof(IndexType) == sizeof(mu_uint16) ? Diligent::VT_UINT16 : Diligent::VT_UINT32;
+	static constexpr mu_uint32 IndicesCount = MaxQuads * 6u;
+	static constexpr mu_uint32 BufferSize = sizeof(IndexType) * IndicesCount;
+};
+
+Diligent::RefCntAutoPtr<Diligent::IBuffer> CreateQuadIndexBuffer(const mu_uint32 quadsCount, const Diligent::VALUE_TYPE valueType);
+
+template<mu_uint32 MaxQuads>
+NEXTMU_INLINE Diligent::RefCntAutoPtr<Diligent::IBuffer> CreateQuadIndexBuffer()
+{
+	return CreateQuadIndexBuffer(MaxQuads, NQuadIndices<MaxQuads>::ValueType);
+}
+
+#endif
\ No newline at end of file
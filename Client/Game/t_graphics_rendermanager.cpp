@@ -144,6 +144,18 @@ void NRenderManager::Execute(Diligent::IDeviceContext *immediateContext)
 					immediateContext->DrawIndexed(data.Attribs);
 				}
 				break;
+
+			case NRenderCommandType::DrawIndexedIndirect:
+				{
+					if (stateTransitions.empty() == false)
+					{
+						immediateContext->TransitionResourceStates(static_cast<mu_uint32>(stateTransitions.size()), stateTransitions.data());
+					}
+
+					auto &data = command.drawIndexedIndirect;
+					immediateContext->DrawIndexedIndirect(data.Attribs);
+				}
+				break;
 			}
 		}
 
@@ -286,6 +298,18 @@ void NRenderManager::DrawIndexed(const RDrawIndexed &data, const RCommandListInf
 	PushCommandList(info);
 }
 
+void NRenderManager::DrawIndexedIndirect(const RDrawIndexedIndirect &data, const RCommandListInfo &info)
+{
+	auto commandList = DraftCommandList;
+	commandList->Commands.push_back(
+		NRenderCommand{
+			.Type = NRenderCommandType::DrawIndexedIndirect,
+			.drawIndexedIndirect = data,
+		}
+	);
+	PushCommandList(info);
+}
+
 constexpr mu_uint64 TypeMask = 0x7; // 3 bits
 const mu_uint64 GetCommandListClassifiedHash(
 	const mu_uint64 view,
@@ -18,6 +18,7 @@ enum class NRenderCommandType : mu_uint32
 	CommitShaderResources,
 	Draw,
 	DrawIndexed,
+	DrawIndexedIndirect,
 };
 
 struct RUpdateBuffer
@@ -110,6 +111,11 @@ struct RDrawIndexed
 	Diligent::DrawIndexedAttribs Attribs;
 };
 
+struct RDrawIndexedIndirect
+{
+	Diligent::DrawIndexedIndirectAttribs Attribs;
+};
+
 struct NRenderCommand
 {
 	NRenderCommandType Type;
@@ -126,6 +132,7 @@ struct NRenderCommand
 		RCommitShaderResources commitShaderResources;
 		RDraw draw;
 		RDrawIndexed drawIndexed;
+		RDrawIndexedIndirect drawIndexedIndirect;
 	};
 };
 
@@ -175,6 +182,7 @@ public:
 	void CommitShaderResources(const RCommitShaderResources &data);
 	void Draw(const RDraw &data, const RCommandListInfo &info);
 	void DrawIndexed(const RDrawIndexed &data, const RCommandListInfo &info);
+	void DrawIndexedIndirect(const RDrawIndexedIndirect &data, const RCommandListInfo &info);
 
 private:
 	void PushCommandList(const RCommandListInfo &info);
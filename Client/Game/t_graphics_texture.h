@@ -47,12 +47,60 @@ public:
 		return Height;
 	}
 
+	/*
+		Streamed textures keep the same object for their whole life and replace its contents when they become resident
+		or evicted, the id changes too so the shader bindings cached by id are resolved again.
+	*/
+	void Assign(
+		const mu_uint32 id,
+		Diligent::RefCntAutoPtr<Diligent::ITexture> texture,
+		const mu_uint16 width,
+		const mu_uint16 height,
+		const mu_boolean alpha
+	)
+	{
+		Id = id;
+		Texture = texture;
+		Width = width;
+		Height = height;
+		Alpha = alpha;
+	}
+
+	// Renderers mark the textures they draw with so the streaming evicts the least recently used ones
+	void Touch(const mu_uint32 frame)
+	{
+		LastUsedFrame.store(frame, std::memory_order_relaxed);
+	}
+
+	const mu_uint32 GetLastUsedFrame() const
+	{
+		return LastUsedFrame.load(std::memory_order_relaxed);
+	}
+
+	// Textures packed in an atlas share the texture of their page, the rect (u0, v0, u1, v1) maps their coordinates into it
+	void SetUVRect(const glm::vec4 &rect)
+	{
+		UVRect = rect;
+	}
+
+	const glm::vec4 &GetUVRect() const
+	{
+		return UVRect;
+	}
+
+	const mu_boolean IsRegion() const
+	{
+		return UVRect != glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+	}
+
 private:
 	mu_uint32 Id;
 	Diligent::RefCntAutoPtr<Diligent::ITexture> Texture;
 	mu_uint16 Width;
 	mu_uint16 Height;
 	mu_boolean Alpha;
+	mu_atomic_uint32_t LastUsedFrame = 0;
+	glm::vec4 UVRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
 };
 
 #endif
\ No newline at end of file
@@ -27,4 +27,15 @@ namespace TJoint
 		if (iter == Template::Templates.end()) return nullptr;
 		return iter->second;
 	}
+
+	const mu_boolean IsTextureUsed(const mu_utf8string id)
+	{
+		for (auto iter = Template::Templates.begin(); iter != Template::Templates.end(); ++iter)
+		{
+			const mu_char *textureId = iter->second->GetTextureID();
+			if (textureId != nullptr && id == textureId) return true;
+		}
+
+		return false;
+	}
 }
\ No newline at end of file
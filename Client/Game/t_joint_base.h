@@ -21,6 +21,7 @@ namespace TJoint
 	void Initialize();
 	std::optional<JointType> GetTemplateType(const mu_utf8string id);
 	Template *GetTemplate(JointType type);
+	const mu_boolean IsTextureUsed(const mu_utf8string id);
 
 	class Template
 	{
@@ -30,12 +31,27 @@ namespace TJoint
 		virtual EnttIterator Move(EnttRegistry &registry, EnttView &view, EnttIterator iter, EnttIterator last) = 0;
 		virtual EnttIterator Action(EnttRegistry &registry, EnttView &view, EnttIterator iter, EnttIterator last) = 0;
 		virtual EnttIterator Render(EnttRegistry &registry, EnttView &view, EnttIterator iter, EnttIterator last, NRenderBuffer &renderBuffer) = 0;
-		virtual void RenderGroup(const NRenderGroup &renderGroup, NRenderBuffer &renderBuffer) = 0;
+
+	public:
+		NEXTMU_INLINE const NBatchDescriptor &GetRenderDescriptor() const
+		{
+			return RenderDescriptor;
+		}
+
+		NEXTMU_INLINE const mu_char *GetTextureID() const
+		{
+			return TextureID;
+		}
+
+	protected:
+		NBatchDescriptor RenderDescriptor;
+		const mu_char *TextureID = nullptr; // Resource id of the texture, known before the textures are loaded
 
 	protected:
 		friend void Initialize();
 		friend std::optional<JointType> GetTemplateType(const mu_utf8string id);
 		friend Template *GetTemplate(JointType type);
+		friend const mu_boolean IsTextureUsed(const mu_utf8string id);
 		static std::map<mu_utf8string, JointType> TemplateTypes;
 		static std::map<JointType, Template *> Templates;
 	};
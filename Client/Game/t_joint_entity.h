@@ -6,8 +6,6 @@
 #include "t_joint_enum.h"
 #include <boost/serialization/strong_typedef.hpp>
 
-constexpr mu_uint32 MaxTails = 50;
-
 namespace TJoint::Entity
 {
 	struct Info
@@ -36,18 +34,27 @@ namespace TJoint::Entity
 
 	using Light = glm::vec4;
 
-	typedef std::array<glm::vec3, 4> Tail;
+	/*
+		Tails only keep the transform which generated them, the four corners are expanded when rendering.
+		Every template declares the capacity it requires so joints don't reserve more tails than they use.
+	*/
+	template<mu_uint32 Capacity>
 	struct Tails
 	{
-		mu_int32 Begin;
-		mu_int32 Count;
-		mu_int32 MaxCount;
-		std::array<Tail, MaxTails> Tails;
+		static constexpr mu_int32 MaxCount = static_cast<mu_int32>(Capacity);
+
+		mu_int32 Begin = 0;
+		mu_int32 Count = 0;
+		std::array<glm::vec3, Capacity> Position;
+		std::array<mu_float, Capacity> Scale;
+		std::array<glm::quat, Capacity> Rotation;
 	};
 
 	BOOST_STRONG_TYPEDEF(mu_uint32, RenderGroup);
 	BOOST_STRONG_TYPEDEF(mu_uint32, RenderIndex);
 	BOOST_STRONG_TYPEDEF(mu_uint32, RenderCount);
+	BOOST_STRONG_TYPEDEF(mu_uint32, RenderVertexIndex);
+	BOOST_STRONG_TYPEDEF(mu_uint32, RenderVertexCount);
 }
 
 #endif
\ No newline at end of file
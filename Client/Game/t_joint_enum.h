@@ -8,7 +8,9 @@
 enum class JointType : mu_uint32
 {
 	Thunder01_V7,
+	Count,
 	Invalid = std::numeric_limits<mu_uint32>::max(),
 };
+constexpr mu_uint32 JointTypesCount = static_cast<mu_uint32>(JointType::Count);
 
 #endif
\ No newline at end of file
@@ -3,14 +3,21 @@
 
 #pragma once
 
-#include "mu_resizablequeue.h"
-#include <glm/gtc/random.hpp>
+#include "t_graphics_batchrenderer.h"
+#include "mu_random.h"
 #include <glm/gtc/packing.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
 namespace TJoint
 {
+	/*
+		Joints are drawn as ribbons, successive tails share their vertices so the indices are streamed with the
+		vertices instead of using the static quads pattern. Render counts are expressed in quads (6 indices).
+	*/
 	constexpr mu_uint32 MaxRenderCount = 5000 * 50;
+	constexpr mu_uint32 MaxRenderVertices = MaxRenderCount * 4;
+	typedef mu_uint32 IndexType;
+	constexpr Diligent::VALUE_TYPE IndexValueType = Diligent::VT_UINT32;
 
 #pragma pack(4)
 	struct NJointSettings
@@ -28,85 +35,82 @@ namespace TJoint
 
 	struct NRenderBuffer
 	{
-		std::array<NJointVertex, MaxRenderCount * 4> Vertices;
-		std::array<mu_uint32, MaxRenderCount * 6> Indices;
+		std::array<NJointVertex, MaxRenderVertices> Vertices;
+		std::array<IndexType, MaxRenderCount * 6> Indices;
 
 		std::vector<NRenderGroup> Groups;
 
 		mu_shader Program = NInvalidShader;
-		mu_boolean RequireTransition = false;
 		NFixedPipelineState FixedPipelineState;
 		Diligent::RefCntAutoPtr<Diligent::IBuffer> VertexBuffer;
 		Diligent::RefCntAutoPtr<Diligent::IBuffer> IndexBuffer;
 		Diligent::RefCntAutoPtr<Diligent::IBuffer> SettingsUniform;
-		NResizableQueue<NJointSettings> SettingsBuffer;
-		std::map<NPipelineStateId, Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding>> Bindings;
+		NBatchRenderer<NJointSettings> Batcher;
 	};
 
-	NEXTMU_INLINE void RenderTail(
-		NRenderBuffer &renderBuffer,
-		const mu_uint32 renderGroup,
-		const mu_uint32 renderIndex,
-		const glm::vec3 position[4],
-		const glm::vec4 &light,
-		const glm::vec4 &uv
-	)
-	{
-		auto &group = renderBuffer.Groups[renderGroup];
-		auto *vertices = renderBuffer.Vertices.data() + renderIndex * 4;
-		auto *indices = renderBuffer.Indices.data() + renderIndex * 6;
-
+	NEXTMU_INLINE void SetJointVertex(
+		NJointVertex *vertex,
+		const glm::vec3 &position,
 #if NEXTMU_COMPRESSED_JOINTS == 1
-		const auto packedLight = glm::packSnorm4x16(light);
-#endif
-
-		vertices->Position = position[0];
-#if NEXTMU_COMPRESSED_JOINTS == 1
-		vertices->Color = packedLight;
-		vertices->UV = glm::packSnorm2x16(glm::vec2(uv[0], uv[1]));
+		const mu_uint64 light,
 #else
-		vertices->Color = light;
-		vertices->UV = glm::vec2(uv[0], uv[1]);
+		const glm::vec4 &light,
 #endif
-		++vertices;
-
-		vertices->Position = position[1];
+		const glm::vec2 &uv
+	)
+	{
+		vertex->Position = position;
+		vertex->Color = light;
 #if NEXTMU_COMPRESSED_JOINTS == 1
-		vertices->Color = packedLight;
-		vertices->UV = glm::packSnorm2x16(glm::vec2(uv[0], uv[3]));
+		vertex->UV = glm::packSnorm2x16(uv);
 #else
-		vertices->Color = light;
-		vertices->UV = glm::vec2(uv[0], uv[3]);
+		vertex->UV = uv;
 #endif
-		++vertices;
+	}
 
-		vertices->Position = position[2];
+	/*
+		Ribbon edge, a ribbon of N segments is made of N + 1 edges written at consecutive vertices (2 vertices per edge),
+		uv contains the U of the edge and the V of both vertices.
+	*/
+	NEXTMU_INLINE void RenderRibbonEdge(
+		NRenderBuffer &renderBuffer,
+		const mu_uint32 vertexIndex,
+		const glm::vec3 &position1,
+		const glm::vec3 &position2,
+		const glm::vec4 &light,
+		const glm::vec3 &uv
+	)
+	{
+		auto *vertices = renderBuffer.Vertices.data() + vertexIndex;
 #if NEXTMU_COMPRESSED_JOINTS == 1
-		vertices->Color = packedLight;
-		vertices->UV = glm::packSnorm2x16(glm::vec2(uv[2], uv[3]));
+		const auto packedLight = glm::packSnorm4x16(light);
 #else
-		vertices->Color = light;
-		vertices->UV = glm::vec2(uv[2], uv[3]);
+		const auto &packedLight = light;
 #endif
-		++vertices;
 
-		vertices->Position = position[3];
-#if NEXTMU_COMPRESSED_JOINTS == 1
-		vertices->Color = packedLight;
-		vertices->UV = glm::packSnorm2x16(glm::vec2(uv[2], uv[1]));
-#else
-		vertices->Color = light;
-		vertices->UV = glm::vec2(uv[2], uv[1]);
-#endif
-		++vertices;
+		SetJointVertex(vertices + 0, position1, packedLight, glm::vec2(uv[0], uv[1]));
+		SetJointVertex(vertices + 1, position2, packedLight, glm::vec2(uv[0], uv[2]));
+	}
 
-		const mu_uint32 vertex = (renderIndex - group.Index) * 4;
-		*indices = vertex + 0; ++indices;
-		*indices = vertex + 1; ++indices;
-		*indices = vertex + 2; ++indices;
-		*indices = vertex + 0; ++indices;
-		*indices = vertex + 2; ++indices;
-		*indices = vertex + 3; ++indices;
+	// Indices of the ribbon segments, every segment shares its first edge with the previous one
+	NEXTMU_INLINE void RenderRibbonIndices(
+		NRenderBuffer &renderBuffer,
+		const mu_uint32 renderIndex,
+		const mu_uint32 vertexIndex,
+		const mu_uint32 segmentsCount
+	)
+	{
+		auto *indices = renderBuffer.Indices.data() + renderIndex * 6;
+		for (mu_uint32 n = 0; n < segmentsCount; ++n, indices += 6)
+		{
+			const IndexType base = vertexIndex + n * 2;
+			indices[0] = base + 0;
+			indices[1] = base + 1;
+			indices[2] = base + 3;
+			indices[3] = base + 0;
+			indices[4] = base + 3;
+			indices[5] = base + 2;
+		}
 	}
 }
 
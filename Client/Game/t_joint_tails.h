@@ -5,24 +5,59 @@
 
 #include "t_joint_entity.h"
 
-NEXTMU_INLINE mu_int16 CalculateBeginTails(const mu_int16 beginTails, const mu_int16 maxTails)
+namespace TJoint
+{
+	typedef std::array<glm::vec3, 4> TailCorners;
+}
+
+NEXTMU_INLINE mu_int32 CalculateBeginTails(const mu_int32 beginTails, const mu_int32 maxTails)
 {
 	if (beginTails == 0) return maxTails - 1;
 	return beginTails - 1;
 }
 
-NEXTMU_INLINE void CreateTail(TJoint::Entity::Tails &tails, const glm::vec3 &position, const glm::quat &rotation, mu_float scale)
+template<mu_uint32 Capacity>
+NEXTMU_INLINE void CreateTail(TJoint::Entity::Tails<Capacity> &tails, const glm::vec3 &position, const glm::quat &rotation, const mu_float scale)
 {
 	tails.Begin = CalculateBeginTails(tails.Begin, tails.MaxCount);
 	const auto begin = tails.Begin;
 	if (++tails.Count > tails.MaxCount - 1) tails.Count = tails.MaxCount - 1;
 
-	scale *= 0.5f;
-	auto &tail = tails.Tails[begin];
-	tail[0] = position + (glm::vec3(-scale, 0.0f, 0.0f) * rotation);
-	tail[1] = position + (glm::vec3(scale, 0.0f, 0.0f) * rotation);
-	tail[2] = position + (glm::vec3(0.0f, 0.0f, -scale) * rotation);
-	tail[3] = position + (glm::vec3(0.0f, 0.0f, scale) * rotation);
+	tails.Position[begin] = position;
+	tails.Scale[begin] = scale;
+	tails.Rotation[begin] = rotation;
+}
+
+/*
+	Expands count tails starting at the ring index first into the corners which used to be stored,
+	the corners are the X and Z axes of the inverse rotation (glm::vec3 * glm::quat) scaled by half the tail scale.
+*/
+template<mu_uint32 Capacity>
+NEXTMU_INLINE void ExpandTails(const TJoint::Entity::Tails<Capacity> &tails, const mu_int32 first, const mu_int32 count, TJoint::TailCorners *corners)
+{
+	for (mu_int32 n = 0, j = first % tails.MaxCount; n < count; ++n, j = (j + 1 == tails.MaxCount ? 0 : j + 1))
+	{
+		const auto &q = tails.Rotation[j];
+		const auto &p = tails.Position[j];
+		const mu_float s = tails.Scale[j] * 0.5f;
+
+		const glm::vec3 axisX = glm::vec3(
+			1.0f - 2.0f * (q.y * q.y + q.z * q.z),
+			2.0f * (q.x * q.y - q.w * q.z),
+			2.0f * (q.x * q.z + q.w * q.y)
+		) * s;
+		const glm::vec3 axisZ = glm::vec3(
+			2.0f * (q.x * q.z - q.w * q.y),
+			2.0f * (q.y * q.z + q.w * q.x),
+			1.0f - 2.0f * (q.x * q.x + q.y * q.y)
+		) * s;
+
+		auto &corner = corners[n];
+		corner[0] = p - axisX;
+		corner[1] = p + axisX;
+		corner[2] = p - axisZ;
+		corner[3] = p + axisZ;
+	}
 }
 
 #endif
\ No newline at end of file
@@ -2,10 +2,8 @@
 #include "t_joint_thunder01_v7.h"
 #include "t_joint_tails.h"
 #include "mu_resourcesmanager.h"
-#include "mu_graphics.h"
 #include "mu_renderstate.h"
 #include "mu_state.h"
-#include <MapHelper.hpp>
 
 using namespace TJoint;
 constexpr auto Type = JointType::Thunder01_V7;
@@ -16,6 +14,8 @@ static const mu_char *TextureID = "thunder01";
 
 // TO DO : Remove this and check why they decided to generate a beam with 5 tails
 constexpr mu_int32 tailOffset = 5;
+constexpr mu_uint32 TailsCount = 50;
+typedef TJoint::Entity::Tails<TailsCount> Tails;
 
 const NDynamicPipelineState DynamicPipelineState = {
 	.CullMode = Diligent::CULL_MODE_NONE,
@@ -34,11 +34,18 @@ static NGraphicsTexture* texture = nullptr;
 TJointThunder01V7::TJointThunder01V7()
 {
 	TJoint::Template::Templates.insert(std::make_pair(Type, this));
+
+	RenderDescriptor = NBatchDescriptor{
+		.DynamicPipelineState = DynamicPipelineState,
+		.IsPremultipliedAlpha = IsPremultipliedAlpha,
+	};
+	TextureID = ::TextureID;
 }
 
 void TJointThunder01V7::Initialize()
 {
 	texture = MUResourcesManager::GetTexture(TextureID);
+	RenderDescriptor.Texture = texture;
 }
 
 void TJointThunder01V7::Create(TJoint::EnttRegistry &registry, const NJointData &data)
@@ -61,8 +68,8 @@ void TJointThunder01V7::Create(TJoint::EnttRegistry &registry, const NJointData
 		Entity::Position{
 			.StartPosition = data.Position,
 			.Position = data.Position + glm::vec3(
-				glm::linearRand(-5.0f, 5.0f),
-				glm::linearRand(-5.0f, 5.0f),
+				MURandom::Linear(-5.0f, 5.0f),
+				MURandom::Linear(-5.0f, 5.0f),
 				1050.0f
 			),
 			.TargetPosition = data.TargetPosition,
@@ -75,18 +82,13 @@ void TJointThunder01V7::Create(TJoint::EnttRegistry &registry, const NJointData
 		glm::vec4(1.0f, 1.0f, 1.0f, 1.0f)
 	);
 
-	registry.emplace<Entity::Tails>(
-		entity,
-		Entity::Tails{
-			.Begin = 0,
-			.Count = 0,
-			.MaxCount = MaxTails,
-		}
-	);
+	registry.emplace<Tails>(entity);
 
 	registry.emplace<Entity::RenderGroup>(entity, NInvalidUInt32);
 	registry.emplace<Entity::RenderIndex>(entity, 0);
 	registry.emplace<Entity::RenderCount>(entity, 0);
+	registry.emplace<Entity::RenderVertexIndex>(entity, 0);
+	registry.emplace<Entity::RenderVertexCount>(entity, 0);
 }
 
 TJoint::EnttIterator TJointThunder01V7::Move(TJoint::EnttRegistry &registry, TJoint::EnttView &view, TJoint::EnttIterator iter, TJoint::EnttIterator last)
@@ -103,13 +105,15 @@ TJoint::EnttIterator TJointThunder01V7::Move(TJoint::EnttRegistry &registry, TJo
 				position,
 				light,
 				tails,
-				renderCount
+				renderCount,
+				renderVertexCount
 		] = registry.get<
 			Entity::LifeTime,
 				Entity::Position,
 				Entity::Light,
-				Entity::Tails,
-				Entity::RenderCount
+				Tails,
+				Entity::RenderCount,
+				Entity::RenderVertexCount
 		>(entity);
 
 		const auto rotation = glm::quat(glm::radians(position.Angle));
@@ -118,8 +122,8 @@ TJoint::EnttIterator TJointThunder01V7::Move(TJoint::EnttRegistry &registry, TJo
 		for (mu_int16 n = 0, maxTails = tails.MaxCount - 5; n < maxTails; ++n)
 		{
 			position.Position += glm::vec3(
-				glm::linearRand(-10.0f, 10.0f),
-				glm::linearRand(-10.0f, 10.0f),
+				MURandom::Linear(-10.0f, 10.0f),
+				MURandom::Linear(-10.0f, 10.0f),
 				-20.0f
 			);
 			CreateTail(tails, position.Position, rotation, position.Scale);
@@ -130,8 +134,8 @@ TJoint::EnttIterator TJointThunder01V7::Move(TJoint::EnttRegistry &registry, TJo
 		{
 			position.Position += direction;
 			position.Position += glm::vec3(
-				glm::linearRand(-10.0f, 10.0f),
-				glm::linearRand(-10.0f, 10.0f),
+				MURandom::Linear(-10.0f, 10.0f),
+				MURandom::Linear(-10.0f, 10.0f),
 				0.0f
 			);
 			CreateTail(tails, position.Position, rotation, position.Scale);
@@ -142,7 +146,10 @@ TJoint::EnttIterator TJointThunder01V7::Move(TJoint::EnttRegistry &registry, TJo
 
 		if (lifetime < 4) light *= LightDivisor;
 
-		renderCount = (tails.Count - tailOffset) * 2;
+		// Two crossed ribbons of (segments + 1) edges each
+		const mu_int32 segments = glm::max(tails.Count - tailOffset, 0);
+		renderCount = segments * 2;
+		renderVertexCount = segments > 0 ? (segments + 1) * 4 : 0;
 	}
 
 	return iter;
@@ -173,162 +180,34 @@ TJoint::EnttIterator TJointThunder01V7::Render(TJoint::EnttRegistry &registry, T
 		const auto &info = view.get<Entity::Info>(entity);
 		if (info.Type != Type) break;
 
-		const auto [light, tails, renderGroup, renderIndex] = registry.get<Entity::Light, Entity::Tails, Entity::RenderGroup, Entity::RenderIndex>(entity);
+		const auto [light, tails, renderGroup, renderIndex, renderVertexIndex] = registry.get<Entity::Light, Tails, Entity::RenderGroup, Entity::RenderIndex, Entity::RenderVertexIndex>(entity);
 		if (renderGroup.t == NInvalidUInt32) continue;
 
-		mu_uint32 rindex = renderIndex;
-		const auto maxTails = static_cast<mu_float>(tails.MaxCount - 1);
-		for (mu_int32 j1 = tails.Begin + tailOffset, j2 = (j1 + 1) % tails.MaxCount, n = tailOffset, count = tails.Count; n < count; j1 = j2, j2 = (j2 + 1) % tails.MaxCount, ++n)
-		{
-			const auto &tail1 = tails.Tails[j1];
-			const auto &tail2 = tails.Tails[j2];
-
-			constexpr mu_float V1 = 0.0f;
-			constexpr mu_float V2 = 1.0f;
-			mu_float L1 = static_cast<mu_float>(tails.Count - n) / maxTails;
-			mu_float L2 = static_cast<mu_float>(tails.Count - (n + 1)) / maxTails;
-
-			const glm::vec3 tp1[4] = {
-				tail1[2],
-				tail1[3],
-				tail2[3],
-				tail2[2]
-			};
-			RenderTail(
-				renderBuffer,
-				renderGroup,
-				rindex++,
-				tp1,
-				light,
-				glm::vec4(
-					L1,
-					V2,
-					L2,
-					V1
-				)
-			);
+		// Every edge is shared by the adjacent segments, so each tail is expanded once
+		const mu_int32 count = tails.Count;
+		if (count <= tailOffset) continue;
 
-			L1 *= scroll;
-			L2 *= scroll;
-
-			const glm::vec3 tp2[4] = {
-				tail1[0],
-				tail1[1],
-				tail2[1],
-				tail2[0]
-			};
-			RenderTail(
-				renderBuffer,
-				renderGroup,
-				rindex++,
-				tp2,
-				light,
-				glm::vec4(
-					L1,
-					V1,
-					L2,
-					V2
-				)
-			);
-		}
-	}
-
-	return iter;
-}
-
-void TJointThunder01V7::RenderGroup(const TJoint::NRenderGroup &renderGroup, TJoint::NRenderBuffer &renderBuffer)
-{
-	auto renderManager = MUGraphics::GetRenderManager();
-	auto immediateContext = MUGraphics::GetImmediateContext();
+		const mu_uint32 segments = static_cast<mu_uint32>(count - tailOffset);
+		std::array<TailCorners, TailsCount> corners;
+		ExpandTails(tails, tails.Begin + tailOffset, segments + 1, corners.data());
 
-	if (renderBuffer.RequireTransition == false)
-	{
-		Diligent::StateTransitionDesc updateBarriers[2] = {
-			Diligent::StateTransitionDesc(renderBuffer.VertexBuffer, Diligent::RESOURCE_STATE_VERTEX_BUFFER, Diligent::RESOURCE_STATE_COPY_DEST, Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE),
-			Diligent::StateTransitionDesc(renderBuffer.IndexBuffer, Diligent::RESOURCE_STATE_INDEX_BUFFER, Diligent::RESOURCE_STATE_COPY_DEST, Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE)
-		};
-		immediateContext->TransitionResourceStates(mu_countof(updateBarriers), updateBarriers);
-		renderBuffer.RequireTransition = true;
-	}
-
-	immediateContext->UpdateBuffer(
-		renderBuffer.VertexBuffer,
-		sizeof(NJointVertex) * renderGroup.Index * 4,
-		sizeof(NJointVertex) * renderGroup.Count * 4,
-		renderBuffer.Vertices.data() + renderGroup.Index * 4,
-		Diligent::RESOURCE_STATE_TRANSITION_MODE_NONE
-	);
-	immediateContext->UpdateBuffer(
-		renderBuffer.IndexBuffer,
-		sizeof(mu_uint32) * renderGroup.Index * 6,
-		sizeof(mu_uint32) * renderGroup.Count * 6,
-		renderBuffer.Indices.data() + renderGroup.Index * 6,
-		Diligent::RESOURCE_STATE_TRANSITION_MODE_NONE
-	);
-
-	// Update Model Settings
-	{
-		auto uniform = renderBuffer.SettingsBuffer.Allocate();
-		uniform->IsPremultipliedAlpha = IsPremultipliedAlpha;
-		renderManager->UpdateBufferWithMap(
-			RUpdateBufferWithMap{
-				.ShouldReleaseMemory = false,
-				.Buffer = renderBuffer.SettingsUniform,
-				.Data = uniform,
-				.Size = sizeof(NJointSettings),
-				.MapType = Diligent::MAP_WRITE,
-				.MapFlags = Diligent::MAP_FLAG_DISCARD,
-			}
-		);
-	}
+		constexpr mu_float V1 = 0.0f;
+		constexpr mu_float V2 = 1.0f;
+		const auto maxTails = static_cast<mu_float>(tails.MaxCount - 1);
+		const mu_uint32 vindex1 = renderVertexIndex;
+		const mu_uint32 vindex2 = vindex1 + (segments + 1) * 2;
 
-	auto pipelineState = GetPipelineState(renderBuffer.FixedPipelineState, DynamicPipelineState);
-	if (pipelineState->StaticInitialized == false)
-	{
-		pipelineState->Pipeline->GetStaticVariableByName(Diligent::SHADER_TYPE_VERTEX, "cbCameraAttribs")->Set(MURenderState::GetCameraUniform());
-		pipelineState->Pipeline->GetStaticVariableByName(Diligent::SHADER_TYPE_PIXEL, "JointSettings")->Set(renderBuffer.SettingsUniform);
-		pipelineState->StaticInitialized = true;
-	}
+		for (mu_uint32 k = 0; k <= segments; ++k)
+		{
+			const auto &corner = corners[k];
+			const mu_float L = static_cast<mu_float>(count - (tailOffset + static_cast<mu_int32>(k))) / maxTails;
+			RenderRibbonEdge(renderBuffer, vindex1 + k * 2, corner[2], corner[3], light, glm::vec3(L, V2, V1));
+			RenderRibbonEdge(renderBuffer, vindex2 + k * 2, corner[0], corner[1], light, glm::vec3(L * scroll, V1, V2));
+		}
 
-	NResourceId resourceIds[1] = { texture->GetId() };
-	auto binding = ShaderResourcesBindingManager.GetShaderBinding(pipelineState->Id, pipelineState->Pipeline, mu_countof(resourceIds), resourceIds);
-	if (binding->Initialized == false)
-	{
-		binding->Binding->GetVariableByName(Diligent::SHADER_TYPE_PIXEL, "g_Texture")->Set(texture->GetTexture()->GetDefaultView(Diligent::TEXTURE_VIEW_SHADER_RESOURCE));
-		binding->Initialized = true;
+		RenderRibbonIndices(renderBuffer, renderIndex, vindex1, segments);
+		RenderRibbonIndices(renderBuffer, renderIndex + segments, vindex2, segments);
 	}
 
-	renderManager->SetPipelineState(pipelineState);
-	renderManager->SetVertexBuffer(
-		RSetVertexBuffer{
-			.StartSlot = 0,
-			.Buffer = renderBuffer.VertexBuffer.RawPtr(),
-			.Offset = 0,
-			.StateTransitionMode = Diligent::RESOURCE_STATE_TRANSITION_MODE_VERIFY,
-			.Flags = Diligent::SET_VERTEX_BUFFERS_FLAG_NONE,
-		}
-	);
-	renderManager->SetIndexBuffer(
-		RSetIndexBuffer{
-			.IndexBuffer = renderBuffer.IndexBuffer,
-			.ByteOffset = 0,
-			.StateTransitionMode = Diligent::RESOURCE_STATE_TRANSITION_MODE_VERIFY,
-		}
-	);
-	renderManager->CommitShaderResources(
-		RCommitShaderResources{
-			.ShaderResourceBinding = binding,
-		}
-	);
-
-	renderManager->DrawIndexed(
-		RDrawIndexed{
-			.Attribs = Diligent::DrawIndexedAttribs(renderGroup.Count * 6, Diligent::VT_UINT32, Diligent::DRAW_FLAG_VERIFY_ALL, 1, renderGroup.Index * 6, renderGroup.Index * 4)
-		},
-		RCommandListInfo{
-			.Type = NDrawOrderType::Classifier,
-			.View = 0,
-			.Index = 0,
-		}
-	);
+	return iter;
 }
\ No newline at end of file
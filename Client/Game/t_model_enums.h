@@ -10,4 +10,12 @@ enum class NAnimationModifierType : mu_uint16
 	AttackSpeed,
 };
 
+enum class NBoneMaskType : mu_uint16
+{
+	UpperBody,
+	LowerBody,
+	Count,
+};
+constexpr mu_uint32 NBoneMaskTypeCount = static_cast<mu_uint32>(NBoneMaskType::Count);
+
 #endif
\ No newline at end of file
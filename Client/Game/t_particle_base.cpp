@@ -21,6 +21,30 @@ namespace TParticle
 		return iter->second;
 	}
 
+	/*
+		Reserves the slots of every run of particles with the same layer at once, particles which don't fit
+		in the pool are dropped.
+	*/
+	void Template::Spawn(NParticlePool &pool, const NParticleData *data, mu_uint32 count)
+	{
+		for (mu_uint32 n = 0; n < count;)
+		{
+			const mu_uint8 layer = data[n].Layer;
+			mu_uint32 end = n + 1;
+			for (; end < count && data[end].Layer == layer; ++end) {}
+
+			mu_uint32 allocated = end - n;
+			const mu_uint32 index = pool.Allocate(layer, allocated);
+			for (mu_uint32 k = 0; k < allocated; ++k)
+			{
+				Create(pool, index + k, data[n + k]);
+				pool.Scale[index + k] *= data[n + k].LodScale;
+			}
+
+			n = end;
+		}
+	}
+
 	Template* GetTemplate(ParticleType type)
 	{
 		auto iter = Template::Templates.find(type);
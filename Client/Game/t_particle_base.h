@@ -5,18 +5,13 @@
 
 #include "t_particle_config.h"
 #include "t_particle_enum.h"
-#include "t_particle_entity.h"
+#include "t_particle_pool.h"
+#include "t_particle_simulation.h"
 #include "t_particle_render.h"
 #include "t_particle_create.h"
 
 namespace TParticle
 {
-	template<typename... Other>
-	using EnttViewType = entt::view<entt::get_t<Other...>>;
-	typedef entt::registry EnttRegistry;
-	typedef EnttViewType<TParticle::Entity::Info> EnttView;
-	typedef EnttView::iterator EnttIterator;
-
 	class Template;
 	void Initialize();
 	std::optional<ParticleType> GetTemplateType(const mu_utf8string id);
@@ -26,11 +21,35 @@ namespace TParticle
 	{
 	public:
 		virtual void Initialize() = 0;
-		virtual void Create(EnttRegistry &registry, const NParticleData &data) = 0;
-		virtual EnttIterator Move(EnttRegistry &registry, EnttView &view, EnttIterator iter, EnttIterator last) = 0;
-		virtual EnttIterator Action(EnttRegistry &registry, EnttView &view, EnttIterator iter, EnttIterator last) = 0;
-		virtual EnttIterator Render(EnttRegistry &registry, EnttView &view, EnttIterator iter, EnttIterator last, NRenderBuffer &renderBuffer) = 0;
-		virtual void RenderGroup(const NRenderGroup &renderGroup, NRenderBuffer &renderBuffer) = 0;
+		// Initializes the particle at index, the slot was already reserved and has the default values
+		virtual void Create(NParticlePool &pool, const mu_uint32 index, const NParticleData &data) = 0;
+		// Custom behavior hook, executed before the behavior kernels, only required when the behavior can't describe the template
+		virtual void Move(NParticlePool &pool, const mu_uint32 begin, const mu_uint32 end) {}
+		// Generates the vertices of the visible particles, indices are the pool slots which survived the culling
+		virtual void Render(const NParticlePool &pool, const mu_uint32 *indices, const mu_uint32 count, const mu_uint32 renderIndex, NRenderBuffer &renderBuffer) = 0;
+
+	public:
+		void Spawn(NParticlePool &pool, const NParticleData *data, mu_uint32 count);
+
+		NEXTMU_INLINE const NParticleBehavior &GetBehavior() const
+		{
+			return Behavior;
+		}
+
+		NEXTMU_INLINE const NBatchDescriptor &GetRenderDescriptor() const
+		{
+			return RenderDescriptor;
+		}
+
+		NEXTMU_INLINE const NParticleGPUMode GetGPUMode() const
+		{
+			return GPUMode;
+		}
+
+	protected:
+		NParticleBehavior Behavior;
+		NBatchDescriptor RenderDescriptor;
+		NParticleGPUMode GPUMode = NParticleGPUMode::None;
 
 	protected:
 		friend void Initialize();
@@ -2,7 +2,6 @@
 #include "t_particle_bubble_v0.h"
 #include "t_particle_macros.h"
 #include "mu_resourcesmanager.h"
-#include "mu_graphics.h"
 #include "mu_renderstate.h"
 #include "mu_state.h"
 
@@ -25,8 +24,8 @@ const NDynamicPipelineState DynamicPipelineState = {
 	.SrcBlendAlpha = Diligent::BLEND_FACTOR_ONE,
 	.DestBlendAlpha = Diligent::BLEND_FACTOR_ONE,
 };
-constexpr mu_float IsPremultipliedAlpha = static_cast<mu_float>(true);
-constexpr mu_float IsLinear = static_cast<mu_float>(false);
+constexpr mu_boolean IsPremultipliedAlpha = true;
+constexpr mu_boolean IsLinear = false;
 
 static TParticleBubbleV0 Instance;
 static NGraphicsTexture* texture = nullptr;
@@ -35,210 +34,60 @@ TParticleBubbleV0::TParticleBubbleV0()
 {
 	TParticle::Template::TemplateTypes.insert(std::make_pair(ParticleID, Type));
 	TParticle::Template::Templates.insert(std::make_pair(Type, this));
+
+	Behavior = NParticleBehavior{
+		.FramesCount = 9u,
+	};
+
+	RenderDescriptor = NBatchDescriptor{
+		.DynamicPipelineState = DynamicPipelineState,
+		.IsPremultipliedAlpha = IsPremultipliedAlpha,
+		.IsLinear = IsLinear,
+	};
 }
 
 void TParticleBubbleV0::Initialize()
 {
 	texture = MUResourcesManager::GetTexture(TextureID);
+	RenderDescriptor.Texture = texture;
 }
 
-void TParticleBubbleV0::Create(entt::registry &registry, const NParticleData &data)
+void TParticleBubbleV0::Create(NParticlePool &pool, const mu_uint32 index, const NParticleData &data)
 {
-	using namespace TParticle;
-	const auto entity = registry.create();
-
-	registry.emplace<Entity::Info>(
-		entity,
-		Entity::Info{
-			.Layer = data.Layer,
-			.Type = Type,
-		}
-	);
-
-	registry.emplace<Entity::LifeTime>(entity, glm::linearRand(30, 40));
-
-	registry.emplace<Entity::Position>(
-		entity,
-		Entity::Position{
-			.StartPosition = data.Position,
-			.Position = data.Position,
-			.Scale = glm::linearRand(0.12f, 0.3f),
-		}
-	);
-
-	registry.emplace<Entity::Light>(
-		entity,
-		glm::vec4(1.0f, 1.0f, 1.0f, 1.0f)
-	);
-
-	registry.emplace<Entity::Frame>(
-		entity,
-		0
-	);
-
-	registry.emplace<Entity::RenderGroup>(entity, NInvalidUInt32);
-	registry.emplace<Entity::RenderIndex>(entity, 0);
-	registry.emplace<Entity::RenderCount>(entity, 1);
+	pool.LifeTime[index] = MURandom::Linear(30, 40);
+	pool.StartPosition[index] = data.Position;
+	pool.Position[index] = data.Position;
+	pool.Scale[index] = MURandom::Linear(0.12f, 0.3f);
+	pool.Light[index] = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+	pool.Frame[index] = 0;
 }
 
-EnttIterator TParticleBubbleV0::Move(EnttRegistry &registry, EnttView &view, EnttIterator iter, EnttIterator last)
+void TParticleBubbleV0::Move(NParticlePool &pool, const mu_uint32 begin, const mu_uint32 end)
 {
-	using namespace TParticle;
-
-	for (; iter != last; ++iter)
+	for (mu_uint32 index = begin; index < end; ++index)
 	{
-		const auto entity = *iter;
-		auto &info = view.get<Entity::Info>(entity);
-		if (info.Type != Type) break;
-
-		auto [position, frame] = registry.get<Entity::Position, Entity::Frame>(entity);
-		position.Position += glm::linearRand(glm::vec3(-25.0f, -25.0f, 25.0f), glm::vec3(25.0f, 25.0f, 75.0f)) * position.Scale;
-		frame = (frame + 1) % 9;
+		pool.Position[index] += MURandom::Linear(glm::vec3(-25.0f, -25.0f, 25.0f), glm::vec3(25.0f, 25.0f, 75.0f)) * pool.Scale[index];
 	}
-
-	return iter;
 }
 
-EnttIterator TParticleBubbleV0::Action(EnttRegistry &registry, EnttView &view, EnttIterator iter, EnttIterator last)
+void TParticleBubbleV0::Render(const NParticlePool &pool, const mu_uint32 *indices, const mu_uint32 count, const mu_uint32 renderIndex, NRenderBuffer &renderBuffer)
 {
-	using namespace TParticle;
-
-	for (; iter != last; ++iter)
-	{
-		const auto entity = *iter;
-		const auto &info = view.get<Entity::Info>(entity);
-		if (info.Type != Type) break;
-
-		// ACTION HERE
-	}
-
-	return iter;
-}
-
-EnttIterator TParticleBubbleV0::Render(EnttRegistry &registry, EnttView &view, EnttIterator iter, EnttIterator last, NRenderBuffer &renderBuffer)
-{
-	using namespace TParticle;
-
 	const mu_float textureWidth = static_cast<mu_float>(texture->GetWidth());
 	const mu_float textureHeight = static_cast<mu_float>(texture->GetHeight());
 
 	glm::mat4 gview = MURenderState::GetView();
 
-	for (; iter != last; ++iter)
+	for (mu_uint32 n = 0; n < count; ++n)
 	{
-		const auto entity = *iter;
-		const auto &info = view.get<Entity::Info>(entity);
-		if (info.Type != Type) break;
-
-		const auto [position, light, frame, renderGroup, renderIndex] = registry.get<Entity::Position, Entity::Light, Entity::Frame, Entity::RenderGroup, Entity::RenderIndex>(entity);
-		if (renderGroup.t == NInvalidUInt32) continue;
-
+		const mu_uint32 index = indices[n];
+		const auto frame = pool.Frame[index];
 		const auto uoffset = static_cast<mu_float>(frame % 3) * UVMultiplier + UVOffset;
 		const auto voffset = static_cast<mu_float>(frame / 3) * UVMultiplier + UVOffset;
 
-		const mu_float width = textureWidth * position.Scale * 0.5f;
-		const mu_float height = textureHeight * position.Scale * 0.5f;
+		const mu_float scale = pool.Scale[index];
+		const mu_float width = textureWidth * scale * 0.5f;
+		const mu_float height = textureHeight * scale * 0.5f;
 
-		RenderBillboardSprite(renderBuffer, renderGroup, renderIndex, gview, position.Position, width, height, light, glm::vec4(uoffset, voffset, uoffset + USize, voffset + VSize));
+		RenderBillboardSprite(renderBuffer, renderIndex + n, gview, pool.Position[index], width, height, pool.Light[index], glm::vec4(uoffset, voffset, uoffset + USize, voffset + VSize));
 	}
-
-	return iter;
-}
-
-void TParticleBubbleV0::RenderGroup(const NRenderGroup &renderGroup, NRenderBuffer &renderBuffer)
-{
-	auto renderManager = MUGraphics::GetRenderManager();
-	auto immediateContext = MUGraphics::GetImmediateContext();
-
-	if (renderBuffer.RequireTransition == false)
-	{
-		Diligent::StateTransitionDesc updateBarriers[2] = {
-			Diligent::StateTransitionDesc(renderBuffer.VertexBuffer, Diligent::RESOURCE_STATE_VERTEX_BUFFER, Diligent::RESOURCE_STATE_COPY_DEST, Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE),
-			Diligent::StateTransitionDesc(renderBuffer.IndexBuffer, Diligent::RESOURCE_STATE_INDEX_BUFFER, Diligent::RESOURCE_STATE_COPY_DEST, Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE)
-		};
-		immediateContext->TransitionResourceStates(mu_countof(updateBarriers), updateBarriers);
-		renderBuffer.RequireTransition = true;
-	}
-
-	immediateContext->UpdateBuffer(
-		renderBuffer.VertexBuffer,
-		sizeof(NParticleVertex) * renderGroup.Index * 4,
-		sizeof(NParticleVertex) * renderGroup.Count * 4,
-		renderBuffer.Vertices.data() + renderGroup.Index * 4,
-		Diligent::RESOURCE_STATE_TRANSITION_MODE_NONE
-	);
-	immediateContext->UpdateBuffer(
-		renderBuffer.IndexBuffer,
-		sizeof(mu_uint32) * renderGroup.Index * 6,
-		sizeof(mu_uint32) * renderGroup.Count * 6,
-		renderBuffer.Indices.data() + renderGroup.Index * 6,
-		Diligent::RESOURCE_STATE_TRANSITION_MODE_NONE
-	);
-
-	// Update Model Settings
-	{
-		auto uniform = renderBuffer.SettingsBuffer.Allocate();
-		uniform->IsPremultipliedAlpha = IsPremultipliedAlpha;
-		uniform->IsLinear = IsLinear;
-		renderManager->UpdateBufferWithMap(
-			RUpdateBufferWithMap{
-				.ShouldReleaseMemory = false,
-				.Buffer = renderBuffer.SettingsUniform,
-				.Data = uniform,
-				.Size = sizeof(NParticleSettings),
-				.MapType = Diligent::MAP_WRITE,
-				.MapFlags = Diligent::MAP_FLAG_DISCARD,
-			}
-		);
-	}
-
-	auto pipelineState = GetPipelineState(renderBuffer.FixedPipelineState, DynamicPipelineState);
-	if (pipelineState->StaticInitialized == false)
-	{
-		pipelineState->Pipeline->GetStaticVariableByName(Diligent::SHADER_TYPE_VERTEX, "cbCameraAttribs")->Set(MURenderState::GetCameraUniform());
-		pipelineState->Pipeline->GetStaticVariableByName(Diligent::SHADER_TYPE_PIXEL, "ParticleSettings")->Set(renderBuffer.SettingsUniform);
-		pipelineState->StaticInitialized = true;
-	}
-
-	NResourceId resourceIds[1] = { texture->GetId() };
-	auto binding = ShaderResourcesBindingManager.GetShaderBinding(pipelineState->Id, pipelineState->Pipeline, mu_countof(resourceIds), resourceIds);
-	if (binding->Initialized == false)
-	{
-		binding->Binding->GetVariableByName(Diligent::SHADER_TYPE_PIXEL, "g_Texture")->Set(texture->GetTexture()->GetDefaultView(Diligent::TEXTURE_VIEW_SHADER_RESOURCE));
-		binding->Initialized = true;
-	}
-
-	renderManager->SetPipelineState(pipelineState);
-	renderManager->SetVertexBuffer(
-		RSetVertexBuffer{
-			.StartSlot = 0,
-			.Buffer = renderBuffer.VertexBuffer.RawPtr(),
-			.Offset = 0,
-			.StateTransitionMode = Diligent::RESOURCE_STATE_TRANSITION_MODE_VERIFY,
-			.Flags = Diligent::SET_VERTEX_BUFFERS_FLAG_NONE,
-		}
-	);
-	renderManager->SetIndexBuffer(
-		RSetIndexBuffer{
-			.IndexBuffer = renderBuffer.IndexBuffer,
-			.ByteOffset = 0,
-			.StateTransitionMode = Diligent::RESOURCE_STATE_TRANSITION_MODE_VERIFY,
-		}
-	);
-	renderManager->CommitShaderResources(
-		RCommitShaderResources{
-			.ShaderResourceBinding = binding,
-		}
-	);
-
-	renderManager->DrawIndexed(
-		RDrawIndexed{
-			.Attribs = Diligent::DrawIndexedAttribs(renderGroup.Count * 6, Diligent::VT_UINT32, Diligent::DRAW_FLAG_VERIFY_ALL, 1, renderGroup.Index * 6, renderGroup.Index * 4)
-		},
-		RCommandListInfo{
-			.Type = NDrawOrderType::Classifier,
-			.View = 0,
-			.Index = 0,
-		}
-	);
-}
+}
\ No newline at end of file
@@ -5,5 +5,7 @@
 
 #define ENABLE_PARTICLE_UPDATE_MULTITHREAD (1)
 #define ENABLE_PARTICLE_RENDER_MULTITHREAD (1)
+#define ENABLE_PARTICLE_CULLING (1)
+#define ENABLE_PARTICLE_EMISSION_LOD (1)
 
 #endif
\ No newline at end of file
@@ -12,6 +12,7 @@ struct NParticleData
 	glm::vec3 Angle = glm::vec3(0.0f, 0.0f, 0.0f);
 	glm::vec3 Light = glm::vec3(1.0f, 1.0f, 1.0f);
 	mu_float Scale = 1.0f;
+	mu_float LodScale = 1.0f; // Filled by the emission LOD, compensates the particles dropped by far emitters
 };
 
 #endif
\ No newline at end of file
@@ -2,7 +2,6 @@
 #include "t_particle_effect_v0.h"
 #include "t_particle_macros.h"
 #include "mu_resourcesmanager.h"
-#include "mu_graphics.h"
 #include "mu_renderstate.h"
 #include "mu_state.h"
 
@@ -21,8 +20,8 @@ const NDynamicPipelineState DynamicPipelineState = {
 	.SrcBlendAlpha = Diligent::BLEND_FACTOR_ONE,
 	.DestBlendAlpha = Diligent::BLEND_FACTOR_ONE,
 };
-constexpr mu_float IsPremultipliedAlpha = static_cast<mu_float>(false);
-constexpr mu_float IsLinear = static_cast<mu_float>(false);
+constexpr mu_boolean IsPremultipliedAlpha = false;
+constexpr mu_boolean IsLinear = false;
 
 static TParticleEffectV0 Instance;
 static NGraphicsTexture* texture = nullptr;
@@ -31,207 +30,57 @@ TParticleEffectV0::TParticleEffectV0()
 {
 	TParticle::Template::TemplateTypes.insert(std::make_pair(ParticleID, Type));
 	TParticle::Template::Templates.insert(std::make_pair(Type, this));
-}
-
-void TParticleEffectV0::Initialize()
-{
-	texture = MUResourcesManager::GetTexture(TextureID);
-}
-
-void TParticleEffectV0::Create(entt::registry &registry, const NParticleData &data)
-{
-	using namespace TParticle;
-	const auto entity = registry.create();
-
-	registry.emplace<Entity::Info>(
-		entity,
-		Entity::Info{
-			.Layer = data.Layer,
-			.Type = Type,
-		}
-	);
 
-	registry.emplace<Entity::LifeTime>(entity, LifeTime + glm::linearRand(0, 2));
+	Behavior = NParticleBehavior{
+		.LightMode = NParticleLightMode::Pulse,
+		.LightThreshold = 10u,
+		.LightFactor = 1.16f,
+		.LightFadeFactor = 1.0f / 1.16f,
+	};
 
-	glm::vec3 position = glm::vec3(
-		data.Position.x + glm::linearRand(-25.0f, 25.0f),
-		data.Position.y + glm::linearRand(-25.0f, 25.0f),
-		data.Position.z + glm::linearRand(-100.0f, 100.0f) + 250.0f
-	);
-	registry.emplace<Entity::Position>(
-		entity,
-		Entity::Position{
-			.StartPosition = data.Position,
-			.Position = position,
-			.Angle = data.Angle,
-			.Scale = glm::linearRand(2.0f, 2.5f),
-		}
-	);
-
-	registry.emplace<Entity::Light>(
-		entity,
-		glm::vec4(data.Light, 1.0f)
-	);
+	RenderDescriptor = NBatchDescriptor{
+		.DynamicPipelineState = DynamicPipelineState,
+		.IsPremultipliedAlpha = IsPremultipliedAlpha,
+		.IsLinear = IsLinear,
+	};
 
-	registry.emplace<Entity::RenderGroup>(entity, NInvalidUInt32);
-	registry.emplace<Entity::RenderIndex>(entity, 0);
-	registry.emplace<Entity::RenderCount>(entity, 1);
+	GPUMode = NParticleGPUMode::Billboard;
 }
 
-EnttIterator TParticleEffectV0::Move(EnttRegistry &registry, EnttView &view, EnttIterator iter, EnttIterator last)
+void TParticleEffectV0::Initialize()
 {
-	using namespace TParticle;
-
-	for (; iter != last; ++iter)
-	{
-		const auto entity = *iter;
-		auto &info = view.get<Entity::Info>(entity);
-		if (info.Type != Type) break;
-
-		auto [lifetime, light] = registry.get<Entity::LifeTime, Entity::Light>(entity);
-		light *= lifetime.t >= 10u ? 1.16f : (1.0f / 1.16f);
-	}
-
-	return iter;
+	texture = MUResourcesManager::GetTexture(TextureID);
+	RenderDescriptor.Texture = texture;
 }
 
-EnttIterator TParticleEffectV0::Action(EnttRegistry &registry, EnttView &view, EnttIterator iter, EnttIterator last)
+void TParticleEffectV0::Create(NParticlePool &pool, const mu_uint32 index, const NParticleData &data)
 {
-	using namespace TParticle;
-
-	for (; iter != last; ++iter)
-	{
-		const auto entity = *iter;
-		const auto &info = view.get<Entity::Info>(entity);
-		if (info.Type != Type) break;
-
-		// ACTION HERE
-	}
-
-	return iter;
+	pool.LifeTime[index] = LifeTime + MURandom::Linear(0, 2);
+	pool.StartPosition[index] = data.Position;
+	pool.Position[index] = glm::vec3(
+		data.Position.x + MURandom::Linear(-25.0f, 25.0f),
+		data.Position.y + MURandom::Linear(-25.0f, 25.0f),
+		data.Position.z + MURandom::Linear(-100.0f, 100.0f) + 250.0f
+	);
+	pool.Angle[index] = data.Angle;
+	pool.Scale[index] = MURandom::Linear(2.0f, 2.5f);
+	pool.Light[index] = glm::vec4(data.Light, 1.0f);
 }
 
-EnttIterator TParticleEffectV0::Render(EnttRegistry &registry, EnttView &view, EnttIterator iter, EnttIterator last, NRenderBuffer &renderBuffer)
+void TParticleEffectV0::Render(const NParticlePool &pool, const mu_uint32 *indices, const mu_uint32 count, const mu_uint32 renderIndex, NRenderBuffer &renderBuffer)
 {
-	using namespace TParticle;
-
 	const mu_float textureWidth = static_cast<mu_float>(texture->GetWidth());
 	const mu_float textureHeight = static_cast<mu_float>(texture->GetHeight());
 
 	glm::mat4 gview = MURenderState::GetView();
 
-	for (; iter != last; ++iter)
+	for (mu_uint32 n = 0; n < count; ++n)
 	{
-		const auto entity = *iter;
-		const auto &info = view.get<Entity::Info>(entity);
-		if (info.Type != Type) break;
+		const mu_uint32 index = indices[n];
+		const mu_float scale = pool.Scale[index];
+		const mu_float width = textureWidth * scale * 0.5f;
+		const mu_float height = textureHeight * scale * 0.5f;
 
-		const auto [position, light, renderGroup, renderIndex] = registry.get<Entity::Position, Entity::Light, Entity::RenderGroup, Entity::RenderIndex>(entity);
-		if (renderGroup.t == NInvalidUInt32) continue;
-
-		const mu_float width = textureWidth * position.Scale * 0.5f;
-		const mu_float height = textureHeight * position.Scale * 0.5f;
-
-		RenderBillboardSprite(renderBuffer, renderGroup, renderIndex, gview, position.Position, width, height, light);
-	}
-
-	return iter;
-}
-
-void TParticleEffectV0::RenderGroup(const NRenderGroup &renderGroup, NRenderBuffer &renderBuffer)
-{
-	auto renderManager = MUGraphics::GetRenderManager();
-	auto immediateContext = MUGraphics::GetImmediateContext();
-
-	if (renderBuffer.RequireTransition == false)
-	{
-		Diligent::StateTransitionDesc updateBarriers[2] = {
-			Diligent::StateTransitionDesc(renderBuffer.VertexBuffer, Diligent::RESOURCE_STATE_VERTEX_BUFFER, Diligent::RESOURCE_STATE_COPY_DEST, Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE),
-			Diligent::StateTransitionDesc(renderBuffer.IndexBuffer, Diligent::RESOURCE_STATE_INDEX_BUFFER, Diligent::RESOURCE_STATE_COPY_DEST, Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE)
-		};
-		immediateContext->TransitionResourceStates(mu_countof(updateBarriers), updateBarriers);
-		renderBuffer.RequireTransition = true;
+		RenderBillboardSprite(renderBuffer, renderIndex + n, gview, pool.Position[index], width, height, pool.Light[index]);
 	}
-
-	immediateContext->UpdateBuffer(
-		renderBuffer.VertexBuffer,
-		sizeof(NParticleVertex) * renderGroup.Index * 4,
-		sizeof(NParticleVertex) * renderGroup.Count * 4,
-		renderBuffer.Vertices.data() + renderGroup.Index * 4,
-		Diligent::RESOURCE_STATE_TRANSITION_MODE_NONE
-	);
-	immediateContext->UpdateBuffer(
-		renderBuffer.IndexBuffer,
-		sizeof(mu_uint32) * renderGroup.Index * 6,
-		sizeof(mu_uint32) * renderGroup.Count * 6,
-		renderBuffer.Indices.data() + renderGroup.Index * 6,
-		Diligent::RESOURCE_STATE_TRANSITION_MODE_NONE
-	);
-
-	// Update Model Settings
-	{
-		auto uniform = renderBuffer.SettingsBuffer.Allocate();
-		uniform->IsPremultipliedAlpha = IsPremultipliedAlpha;
-		uniform->IsLinear = IsLinear;
-		renderManager->UpdateBufferWithMap(
-			RUpdateBufferWithMap{
-				.ShouldReleaseMemory = false,
-				.Buffer = renderBuffer.SettingsUniform,
-				.Data = uniform,
-				.Size = sizeof(NParticleSettings),
-				.MapType = Diligent::MAP_WRITE,
-				.MapFlags = Diligent::MAP_FLAG_DISCARD,
-			}
-		);
-	}
-
-	auto pipelineState = GetPipelineState(renderBuffer.FixedPipelineState, DynamicPipelineState);
-	if (pipelineState->StaticInitialized == false)
-	{
-		pipelineState->Pipeline->GetStaticVariableByName(Diligent::SHADER_TYPE_VERTEX, "cbCameraAttribs")->Set(MURenderState::GetCameraUniform());
-		pipelineState->Pipeline->GetStaticVariableByName(Diligent::SHADER_TYPE_PIXEL, "ParticleSettings")->Set(renderBuffer.SettingsUniform);
-		pipelineState->StaticInitialized = true;
-	}
-
-	NResourceId resourceIds[1] = { texture->GetId() };
-	auto binding = ShaderResourcesBindingManager.GetShaderBinding(pipelineState->Id, pipelineState->Pipeline, mu_countof(resourceIds), resourceIds);
-	if (binding->Initialized == false)
-	{
-		binding->Binding->GetVariableByName(Diligent::SHADER_TYPE_PIXEL, "g_Texture")->Set(texture->GetTexture()->GetDefaultView(Diligent::TEXTURE_VIEW_SHADER_RESOURCE));
-		binding->Initialized = true;
-	}
-
-	renderManager->SetPipelineState(pipelineState);
-	renderManager->SetVertexBuffer(
-		RSetVertexBuffer{
-			.StartSlot = 0,
-			.Buffer = renderBuffer.VertexBuffer.RawPtr(),
-			.Offset = 0,
-			.StateTransitionMode = Diligent::RESOURCE_STATE_TRANSITION_MODE_VERIFY,
-			.Flags = Diligent::SET_VERTEX_BUFFERS_FLAG_NONE,
-		}
-	);
-	renderManager->SetIndexBuffer(
-		RSetIndexBuffer{
-			.IndexBuffer = renderBuffer.IndexBuffer,
-			.ByteOffset = 0,
-			.StateTransitionMode = Diligent::RESOURCE_STATE_TRANSITION_MODE_VERIFY,
-		}
-	);
-	renderManager->CommitShaderResources(
-		RCommitShaderResources{
-			.ShaderResourceBinding = binding,
-		}
-	);
-
-	renderManager->DrawIndexed(
-		RDrawIndexed{
-			.Attribs = Diligent::DrawIndexedAttribs(renderGroup.Count * 6, Diligent::VT_UINT32, Diligent::DRAW_FLAG_VERIFY_ALL, 1, renderGroup.Index * 6, renderGroup.Index * 4)
-		},
-		RCommandListInfo{
-			.Type = NDrawOrderType::Classifier,
-			.View = 0,
-			.Index = 0,
-		}
-	);
 }
\ No newline at end of file
@@ -11,11 +11,8 @@ public:
 	TParticleEffectV3();
 public:
 	virtual void Initialize() override;
-	virtual void Create(TParticle::EnttRegistry &registry, const NParticleData &data) override;
-	virtual TParticle::EnttIterator Move(TParticle::EnttRegistry &registry, TParticle::EnttView &view, TParticle::EnttIterator iter, TParticle::EnttIterator last) override;
-	virtual TParticle::EnttIterator Action(TParticle::EnttRegistry &registry, TParticle::EnttView &view, TParticle::EnttIterator iter, TParticle::EnttIterator last) override;
-	virtual TParticle::EnttIterator Render(TParticle::EnttRegistry &registry, TParticle::EnttView &view, TParticle::EnttIterator iter, TParticle::EnttIterator last, TParticle::NRenderBuffer &renderBuffer) override;
-	virtual void RenderGroup(const TParticle::NRenderGroup &renderGroup, TParticle::NRenderBuffer &renderBuffer) override;
+	virtual void Create(TParticle::NParticlePool &pool, const mu_uint32 index, const NParticleData &data) override;
+	virtual void Render(const TParticle::NParticlePool &pool, const mu_uint32 *indices, const mu_uint32 count, const mu_uint32 renderIndex, TParticle::NRenderBuffer &renderBuffer) override;
 };
 
 #endif
\ No newline at end of file
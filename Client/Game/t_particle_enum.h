@@ -29,7 +29,9 @@ enum class ParticleType : mu_uint32
 	Smoke05_V1,
 	TrueFire_Red_V5,
 	Bubble_V0,
+	Count,
 	Invalid = std::numeric_limits<mu_uint32>::max(),
 };
+constexpr mu_uint32 ParticleTypesCount = static_cast<mu_uint32>(ParticleType::Count);
 
 #endif
\ No newline at end of file
@@ -2,7 +2,6 @@
 #include "t_particle_flower01_v1.h"
 #include "t_particle_macros.h"
 #include "mu_resourcesmanager.h"
-#include "mu_graphics.h"
 #include "mu_renderstate.h"
 #include "mu_state.h"
 
@@ -21,8 +20,8 @@ const NDynamicPipelineState DynamicPipelineState = {
 	.SrcBlendAlpha = Diligent::BLEND_FACTOR_SRC_ALPHA,
 	.DestBlendAlpha = Diligent::BLEND_FACTOR_INV_SRC_ALPHA,
 };
-constexpr mu_float IsPremultipliedAlpha = static_cast<mu_float>(false);
-constexpr mu_float IsLinear = static_cast<mu_float>(false);
+constexpr mu_boolean IsPremultipliedAlpha = false;
+constexpr mu_boolean IsLinear = false;
 
 static TParticleFlower01V1 Instance;
 static NGraphicsTexture* texture = nullptr;
@@ -31,232 +30,90 @@ TParticleFlower01V1::TParticleFlower01V1()
 {
 	TParticle::Template::TemplateTypes.insert(std::make_pair(ParticleID, Type));
 	TParticle::Template::Templates.insert(std::make_pair(Type, this));
+
+	Behavior = NParticleBehavior{
+		.RotationMin = 0.0f,
+		.RotationMax = 15.0f,
+		.LightMode = NParticleLightMode::Pulse,
+		.LightThreshold = 10u,
+		.LightFactor = 1.16f,
+		.LightFadeFactor = 1.0f / 1.16f,
+	};
+
+	RenderDescriptor = NBatchDescriptor{
+		.DynamicPipelineState = DynamicPipelineState,
+		.IsPremultipliedAlpha = IsPremultipliedAlpha,
+		.IsLinear = IsLinear,
+		.Classify = NRenderClassify::PostAlpha,
+		.ListIndex = 1,
+	};
 }
 
 void TParticleFlower01V1::Initialize()
 {
 	texture = MUResourcesManager::GetTexture(TextureID);
+	RenderDescriptor.Texture = texture;
 }
 
-void TParticleFlower01V1::Create(entt::registry &registry, const NParticleData &data)
+void TParticleFlower01V1::Create(NParticlePool &pool, const mu_uint32 index, const NParticleData &data)
 {
-	using namespace TParticle;
-	const auto entity = registry.create();
-
-	registry.emplace<Entity::Info>(
-		entity,
-		Entity::Info{
-			.Layer = data.Layer,
-			.Type = Type,
-		}
-	);
-
-	registry.emplace<Entity::LifeTime>(entity, LifeTime + glm::linearRand(0, 9));
-
-	registry.emplace<Entity::Position>(
-		entity,
-		Entity::Position{
-			.StartPosition = data.Position,
-			.Position = data.Position,
-			.Angle = data.Angle,
-			.Velocity = glm::vec3(
-				glm::linearRand(-1.6f, 1.6f),
-				glm::linearRand(-1.6f, 1.6f),
-				glm::linearRand(-3.2f, 0.0f)
-			),
-			.Scale = glm::linearRand(0.12f, 0.36f),
-		}
+	pool.LifeTime[index] = LifeTime + MURandom::Linear(0, 9);
+	pool.StartPosition[index] = data.Position;
+	pool.Position[index] = data.Position;
+	pool.Angle[index] = data.Angle;
+	pool.Velocity[index] = glm::vec3(
+		MURandom::Linear(-1.6f, 1.6f),
+		MURandom::Linear(-1.6f, 1.6f),
+		MURandom::Linear(-3.2f, 0.0f)
 	);
-
-	registry.emplace<Entity::Light>(
-		entity,
-		glm::vec4(1.0f, 1.0f, 1.0f, 1.0f)
-	);
-
-	registry.emplace<Entity::Rotation>(entity, 0.0f);
-	registry.emplace<Entity::Trigger>(entity, true);
-
-	registry.emplace<Entity::RenderGroup>(entity, NInvalidUInt32);
-	registry.emplace<Entity::RenderIndex>(entity, 0);
-	registry.emplace<Entity::RenderCount>(entity, 1);
+	pool.Scale[index] = MURandom::Linear(0.12f, 0.36f);
+	pool.Light[index] = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+	pool.Rotation[index] = 0.0f;
+	pool.Trigger[index] = true;
 }
 
-EnttIterator TParticleFlower01V1::Move(EnttRegistry &registry, EnttView &view, EnttIterator iter, EnttIterator last)
+void TParticleFlower01V1::Move(NParticlePool &pool, const mu_uint32 begin, const mu_uint32 end)
 {
-	using namespace TParticle;
-
 	const auto *terrain = MURenderState::GetTerrain();
 
-	for (; iter != last; ++iter)
+	for (mu_uint32 index = begin; index < end; ++index)
 	{
-		const auto entity = *iter;
-		auto &info = view.get<Entity::Info>(entity);
-		if (info.Type != Type) break;
+		auto &position = pool.Position[index];
+		auto &velocity = pool.Velocity[index];
+		position = MovePosition(position, pool.Angle[index], velocity);
+		if (pool.Trigger[index] == false) continue;
+
+		velocity += glm::vec3(
+			MURandom::Linear(-0.2f, 0.2f),
+			MURandom::Linear(-0.2f, 0.2f),
+			MURandom::Linear(-0.0025f, 0.0f)
+		);
+		position += velocity;
 
-		auto [lifetime, position, rotation, light, trigger] = registry.get<Entity::LifeTime, Entity::Position, Entity::Rotation, Entity::Light, Entity::Trigger>(entity);
-		position.Position = MovePosition(position.Position, position.Angle, position.Velocity);
-		if (trigger)
+		const auto height = terrain->RequestHeight(position.x, position.y);
+		if (position.z < height)
 		{
-			position.Velocity += glm::vec3(
-				glm::linearRand(-0.2f, 0.2f),
-				glm::linearRand(-0.2f, 0.2f),
-				glm::linearRand(-0.0025f, 0.0f)
-			);
-			position.Position += position.Velocity;
-
-			const auto height = terrain->RequestHeight(position.Position.x, position.Position.y);
-			if (position.Position.z < height)
-			{
-				position.Position.z = height;
-				position.Velocity = glm::vec3(0.0f, 0.0f, 0.0f);
-				trigger = false;
-			}
+			position.z = height;
+			velocity = glm::vec3(0.0f, 0.0f, 0.0f);
+			pool.Trigger[index] = false;
 		}
-		rotation += glm::linearRand(0.0f, 15.0f);
-		light *= lifetime.t >= 10u ? 1.16f : (1.0f / 1.16f);
 	}
-
-	return iter;
-}
-
-EnttIterator TParticleFlower01V1::Action(EnttRegistry &registry, EnttView &view, EnttIterator iter, EnttIterator last)
-{
-	using namespace TParticle;
-
-	for (; iter != last; ++iter)
-	{
-		const auto entity = *iter;
-		const auto &info = view.get<Entity::Info>(entity);
-		if (info.Type != Type) break;
-
-		// ACTION HERE
-	}
-
-	return iter;
 }
 
-EnttIterator TParticleFlower01V1::Render(EnttRegistry &registry, EnttView &view, EnttIterator iter, EnttIterator last, NRenderBuffer &renderBuffer)
+void TParticleFlower01V1::Render(const NParticlePool &pool, const mu_uint32 *indices, const mu_uint32 count, const mu_uint32 renderIndex, NRenderBuffer &renderBuffer)
 {
-	using namespace TParticle;
-
 	const mu_float textureWidth = static_cast<mu_float>(texture->GetWidth());
 	const mu_float textureHeight = static_cast<mu_float>(texture->GetHeight());
 
 	glm::mat4 gview = MURenderState::GetView();
 
-	for (; iter != last; ++iter)
-	{
-		const auto entity = *iter;
-		const auto &info = view.get<Entity::Info>(entity);
-		if (info.Type != Type) break;
-
-		const auto [position, rotation, light, renderGroup, renderIndex] = registry.get<Entity::Position, Entity::Rotation, Entity::Light, Entity::RenderGroup, Entity::RenderIndex>(entity);
-		if (renderGroup.t == NInvalidUInt32) continue;
-
-		const mu_float width = textureWidth * position.Scale * 0.5f;
-		const mu_float height = textureHeight * position.Scale * 0.5f;
-
-		RenderBillboardSpriteWithRotation(renderBuffer, renderGroup, renderIndex, gview, position.Position, rotation, width, height, light);
-	}
-
-	return iter;
-}
-
-void TParticleFlower01V1::RenderGroup(const NRenderGroup &renderGroup, NRenderBuffer &renderBuffer)
-{
-	auto renderManager = MUGraphics::GetRenderManager();
-	auto immediateContext = MUGraphics::GetImmediateContext();
-
-	if (renderBuffer.RequireTransition == false)
-	{
-		Diligent::StateTransitionDesc updateBarriers[2] = {
-			Diligent::StateTransitionDesc(renderBuffer.VertexBuffer, Diligent::RESOURCE_STATE_VERTEX_BUFFER, Diligent::RESOURCE_STATE_COPY_DEST, Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE),
-			Diligent::StateTransitionDesc(renderBuffer.IndexBuffer, Diligent::RESOURCE_STATE_INDEX_BUFFER, Diligent::RESOURCE_STATE_COPY_DEST, Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE)
-		};
-		immediateContext->TransitionResourceStates(mu_countof(updateBarriers), updateBarriers);
-		renderBuffer.RequireTransition = true;
-	}
-
-	immediateContext->UpdateBuffer(
-		renderBuffer.VertexBuffer,
-		sizeof(NParticleVertex) * renderGroup.Index * 4,
-		sizeof(NParticleVertex) * renderGroup.Count * 4,
-		renderBuffer.Vertices.data() + renderGroup.Index * 4,
-		Diligent::RESOURCE_STATE_TRANSITION_MODE_NONE
-	);
-	immediateContext->UpdateBuffer(
-		renderBuffer.IndexBuffer,
-		sizeof(mu_uint32) * renderGroup.Index * 6,
-		sizeof(mu_uint32) * renderGroup.Count * 6,
-		renderBuffer.Indices.data() + renderGroup.Index * 6,
-		Diligent::RESOURCE_STATE_TRANSITION_MODE_NONE
-	);
-
-	// Update Model Settings
-	{
-		auto uniform = renderBuffer.SettingsBuffer.Allocate();
-		uniform->IsPremultipliedAlpha = IsPremultipliedAlpha;
-		uniform->IsLinear = IsLinear;
-		renderManager->UpdateBufferWithMap(
-			RUpdateBufferWithMap{
-				.ShouldReleaseMemory = false,
-				.Buffer = renderBuffer.SettingsUniform,
-				.Data = uniform,
-				.Size = sizeof(NParticleSettings),
-				.MapType = Diligent::MAP_WRITE,
-				.MapFlags = Diligent::MAP_FLAG_DISCARD,
-			}
-		);
-	}
-
-	auto pipelineState = GetPipelineState(renderBuffer.FixedPipelineState, DynamicPipelineState);
-	if (pipelineState->StaticInitialized == false)
+	for (mu_uint32 n = 0; n < count; ++n)
 	{
-		pipelineState->Pipeline->GetStaticVariableByName(Diligent::SHADER_TYPE_VERTEX, "cbCameraAttribs")->Set(MURenderState::GetCameraUniform());
-		pipelineState->Pipeline->GetStaticVariableByName(Diligent::SHADER_TYPE_PIXEL, "ParticleSettings")->Set(renderBuffer.SettingsUniform);
-		pipelineState->StaticInitialized = true;
-	}
+		const mu_uint32 index = indices[n];
+		const mu_float scale = pool.Scale[index];
+		const mu_float width = textureWidth * scale * 0.5f;
+		const mu_float height = textureHeight * scale * 0.5f;
 
-	NResourceId resourceIds[1] = { texture->GetId() };
-	auto binding = ShaderResourcesBindingManager.GetShaderBinding(pipelineState->Id, pipelineState->Pipeline, mu_countof(resourceIds), resourceIds);
-	if (binding->Initialized == false)
-	{
-		binding->Binding->GetVariableByName(Diligent::SHADER_TYPE_PIXEL, "g_Texture")->Set(texture->GetTexture()->GetDefaultView(Diligent::TEXTURE_VIEW_SHADER_RESOURCE));
-		binding->Initialized = true;
+		RenderBillboardSpriteWithRotation(renderBuffer, renderIndex + n, gview, pool.Position[index], pool.Rotation[index], width, height, pool.Light[index]);
 	}
-
-	renderManager->SetPipelineState(pipelineState);
-	renderManager->SetVertexBuffer(
-		RSetVertexBuffer{
-			.StartSlot = 0,
-			.Buffer = renderBuffer.VertexBuffer.RawPtr(),
-			.Offset = 0,
-			.StateTransitionMode = Diligent::RESOURCE_STATE_TRANSITION_MODE_VERIFY,
-			.Flags = Diligent::SET_VERTEX_BUFFERS_FLAG_NONE,
-		}
-	);
-	renderManager->SetIndexBuffer(
-		RSetIndexBuffer{
-			.IndexBuffer = renderBuffer.IndexBuffer,
-			.ByteOffset = 0,
-			.StateTransitionMode = Diligent::RESOURCE_STATE_TRANSITION_MODE_VERIFY,
-		}
-	);
-	renderManager->CommitShaderResources(
-		RCommitShaderResources{
-			.ShaderResourceBinding = binding,
-		}
-	);
-
-	renderManager->DrawIndexed(
-		RDrawIndexed{
-			.Attribs = Diligent::DrawIndexedAttribs(renderGroup.Count * 6, Diligent::VT_UINT32, Diligent::DRAW_FLAG_VERIFY_ALL, 1, renderGroup.Index * 6, renderGroup.Index * 4)
-		},
-		RCommandListInfo{
-			.Type = NDrawOrderType::Classifier,
-			.Classify = NRenderClassify::PostAlpha,
-			.View = 0,
-			.Index = 1,
-		}
-	);
 }
\ No newline at end of file
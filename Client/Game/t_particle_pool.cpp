@@ -0,0 +1,112 @@
+#include "stdafx.h"
+#include "t_particle_pool.h"
+
+namespace TParticle
+{
+	void NParticlePool::Initialize(const mu_uint32 capacity)
+	{
+		Capacity = capacity;
+		Clear();
+
+		Layer.resize(capacity);
+		LifeTime.resize(capacity);
+		StartPosition.resize(capacity);
+		Position.resize(capacity);
+		Angle.resize(capacity);
+		Velocity.resize(capacity);
+		Scale.resize(capacity);
+		Rotation.resize(capacity);
+		Gravity.resize(capacity);
+		Light.resize(capacity);
+		Frame.resize(capacity);
+		Trigger.resize(capacity);
+	}
+
+	void NParticlePool::Clear()
+	{
+		Count = 0;
+		LayersCount = 0;
+		LayerOffsets.fill(0);
+	}
+
+	void NParticlePool::Move(const mu_uint32 from, const mu_uint32 to)
+	{
+		Layer[to] = Layer[from];
+		LifeTime[to] = LifeTime[from];
+		StartPosition[to] = StartPosition[from];
+		Position[to] = Position[from];
+		Angle[to] = Angle[from];
+		Velocity[to] = Velocity[from];
+		Scale[to] = Scale[from];
+		Rotation[to] = Rotation[from];
+		Gravity[to] = Gravity[from];
+		Light[to] = Light[from];
+		Frame[to] = Frame[from];
+		Trigger[to] = Trigger[from];
+	}
+
+	const mu_uint32 NParticlePool::Allocate(const mu_uint8 layer, mu_uint32 &count)
+	{
+		count = std::min(count, Capacity - Count);
+		if (count == 0) return Count;
+
+		for (; LayersCount <= layer; ++LayersCount)
+		{
+			LayerOffsets[LayersCount + 1] = Count;
+		}
+
+		// Shift the next layers by count, only the first count particles of every layer have to be moved
+		for (mu_uint32 l = LayersCount - 1; l > layer; --l)
+		{
+			const mu_uint32 begin = LayerOffsets[l];
+			const mu_uint32 end = LayerOffsets[l + 1];
+			const mu_uint32 moved = std::min(count, end - begin);
+			for (mu_uint32 n = 0, target = end + count - moved; n < moved; ++n)
+			{
+				Move(begin + n, target + n);
+			}
+			LayerOffsets[l + 1] += count;
+		}
+
+		const mu_uint32 index = LayerOffsets[layer + 1];
+		LayerOffsets[layer + 1] += count;
+		Count += count;
+
+		std::fill_n(Layer.begin() + index, count, layer);
+		std::fill_n(LifeTime.begin() + index, count, static_cast<mu_uint16>(0u));
+		std::fill_n(Angle.begin() + index, count, glm::vec3(0.0f, 0.0f, 0.0f));
+		std::fill_n(Velocity.begin() + index, count, glm::vec3(0.0f, 0.0f, 0.0f));
+		std::fill_n(Scale.begin() + index, count, 1.0f);
+		std::fill_n(Rotation.begin() + index, count, 0.0f);
+		std::fill_n(Gravity.begin() + index, count, 0.0f);
+		std::fill_n(Light.begin() + index, count, glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
+		std::fill_n(Frame.begin() + index, count, static_cast<mu_uint8>(0u));
+		std::fill_n(Trigger.begin() + index, count, static_cast<mu_uint8>(0u));
+
+		return index;
+	}
+
+	/*
+		The last particle of the layer fills the removed slot, then the last particle of every next layer
+		fills the slot left at the start of its bucket. Particles are only moved to slots at or after index,
+		so a forward iteration can keep removing at the same index.
+	*/
+	void NParticlePool::Remove(const mu_uint32 index)
+	{
+		const mu_uint32 layer = Layer[index];
+		mu_uint32 hole = LayerOffsets[layer + 1] - 1;
+		if (hole != index) Move(hole, index);
+		LayerOffsets[layer + 1] = hole;
+
+		for (mu_uint32 l = layer + 1; l < LayersCount; ++l)
+		{
+			const mu_uint32 last = LayerOffsets[l + 1] - 1;
+			if (last != hole) Move(last, hole);
+			hole = last;
+			LayerOffsets[l + 1] = last;
+		}
+
+		--Count;
+		while (LayersCount > 0 && LayerOffsets[LayersCount - 1] == LayerOffsets[LayersCount]) --LayersCount;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,88 @@
+#ifndef __T_PARTICLE_POOL_H__
+#define __T_PARTICLE_POOL_H__
+
+#pragma once
+
+#include "t_particle_enum.h"
+
+namespace TParticle
+{
+	/*
+		Contiguous range of particles of a single type and layer, used to split the pools into update and render jobs.
+	*/
+	struct NParticleRange
+	{
+		ParticleType Type;
+		mu_uint8 Layer;
+		mu_uint32 Begin;
+		mu_uint32 End;
+		mu_uint32 RenderIndex = 0;
+		mu_uint32 VisibleOffset = 0; // First slot of the range inside the visible indices
+		mu_uint32 VisibleCount = 0;
+	};
+
+	constexpr mu_uint32 MaxParticlesPerType = 8192u;
+	constexpr mu_uint32 MaxParticleLayers = 256u;
+
+	/*
+		Live particles of a single template type stored as a structure of arrays, the simulation kernels
+		iterate the arrays linearly instead of looking up every component of every entity.
+		Storage is allocated once with a fixed capacity and particles are bucketed by layer, every layer is
+		a contiguous range of the pool. Spawning and dying only move one particle per layer after the
+		modified one, so the buckets never have to be sorted.
+	*/
+	class NParticlePool
+	{
+	public:
+		void Initialize(const mu_uint32 capacity);
+		void Clear();
+
+		/*
+			Reserves up to count slots at the end of the layer bucket, returns the first reserved slot and
+			updates count with the amount of slots which could be reserved.
+		*/
+		const mu_uint32 Allocate(const mu_uint8 layer, mu_uint32 &count);
+		void Remove(const mu_uint32 index);
+
+		NEXTMU_INLINE const mu_uint32 GetLayersCount() const
+		{
+			return LayersCount;
+		}
+
+		NEXTMU_INLINE const mu_uint32 GetLayerBegin(const mu_uint32 layer) const
+		{
+			return layer < LayersCount ? LayerOffsets[layer] : Count;
+		}
+
+		NEXTMU_INLINE const mu_uint32 GetLayerEnd(const mu_uint32 layer) const
+		{
+			return layer < LayersCount ? LayerOffsets[layer + 1] : Count;
+		}
+
+	private:
+		void Move(const mu_uint32 from, const mu_uint32 to);
+
+	public:
+		mu_uint32 Count = 0;
+		mu_uint32 Capacity = 0;
+
+		std::vector<mu_uint8> Layer;
+		std::vector<mu_uint16> LifeTime;
+		std::vector<glm::vec3> StartPosition;
+		std::vector<glm::vec3> Position;
+		std::vector<glm::vec3> Angle;
+		std::vector<glm::vec3> Velocity;
+		std::vector<mu_float> Scale;
+		std::vector<mu_float> Rotation;
+		std::vector<mu_float> Gravity;
+		std::vector<glm::vec4> Light;
+		std::vector<mu_uint8> Frame;
+		std::vector<mu_uint8> Trigger; // Not a vector of booleans, workers write it concurrently
+
+	private:
+		mu_uint32 LayersCount = 0; // Highest used layer + 1, limits the buckets touched by every operation
+		std::array<mu_uint32, MaxParticleLayers + 1> LayerOffsets = {};
+	};
+}
+
+#endif
\ No newline at end of file
@@ -3,14 +3,16 @@
 
 #pragma once
 
-#include "mu_resizablequeue.h"
-#include <glm/gtc/random.hpp>
+#include "t_graphics_quadindices.h"
+#include "t_graphics_batchrenderer.h"
+#include "mu_random.h"
 #include <glm/gtc/packing.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
 namespace TParticle
 {
 	constexpr mu_uint32 MaxRenderCount = 10000;
+	typedef NQuadIndices<MaxRenderCount> QuadIndices;
 
 #pragma pack(4)
 	struct NParticleSettings
@@ -20,6 +22,17 @@ namespace TParticle
 	};
 #pragma pack()
 
+	/*
+		Templates which only depend on the behavior kernels and render a billboard of the texture size multiplied
+		by the particle scale can be simulated and rendered by the GPU particles backend.
+	*/
+	enum class NParticleGPUMode : mu_uint8
+	{
+		None,
+		Billboard,
+		RotatedBillboard,
+	};
+
 	struct NRenderGroup
 	{
 		ParticleType Type;
@@ -30,25 +43,20 @@ namespace TParticle
 	struct NRenderBuffer
 	{
 		std::array<NParticleVertex, MaxRenderCount * 4> Vertices;
-		std::array<mu_uint32, MaxRenderCount * 6> Indices;
 
 		std::vector<NRenderGroup> Groups;
 
 		mu_shader Program = NInvalidShader;
-		mu_boolean RequireTransition = false;
 		NFixedPipelineState FixedPipelineState;
 		Diligent::RefCntAutoPtr<Diligent::IBuffer> VertexBuffer;
 		Diligent::RefCntAutoPtr<Diligent::IBuffer> IndexBuffer;
 		Diligent::RefCntAutoPtr<Diligent::IBuffer> SettingsUniform;
-		NResizableQueue<NParticleSettings> SettingsBuffer;
-		std::map<NPipelineStateId, Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding>> Bindings;
+		NBatchRenderer<NParticleSettings> Batcher;
 	};
 
-	NEXTMU_INLINE void RenderSprite(NRenderBuffer &renderBuffer, const mu_uint32 renderGroup, const mu_uint32 renderIndex, const glm::vec3 position[4], const glm::vec4 &light, const glm::vec4 &uv)
+	NEXTMU_INLINE void RenderSprite(NRenderBuffer &renderBuffer, const mu_uint32 renderIndex, const glm::vec3 position[4], const glm::vec4 &light, const glm::vec4 &uv)
 	{
-		auto &group = renderBuffer.Groups[renderGroup];
 		auto *vertices = renderBuffer.Vertices.data() + renderIndex * 4;
-		auto *indices = renderBuffer.Indices.data() + renderIndex * 6;
 
 #if NEXTMU_COMPRESSED_PARTICLES == 1
 		const auto packedLight = glm::packSnorm4x16(light);
@@ -93,17 +101,25 @@ namespace TParticle
 		vertices->UV = glm::vec2(uv[0], uv[3]);
 #endif
 		++vertices;
+	}
 
-		const mu_uint32 vertex = (renderIndex - group.Index) * 4;
-		*indices = vertex + 0; ++indices;
-		*indices = vertex + 1; ++indices;
-		*indices = vertex + 2; ++indices;
-		*indices = vertex + 0; ++indices;
-		*indices = vertex + 2; ++indices;
-		*indices = vertex + 3; ++indices;
+	// Maps the coordinates of the sprites written by a template into the UV rect of its atlas region
+	NEXTMU_INLINE void RemapUVs(NRenderBuffer &renderBuffer, const mu_uint32 renderIndex, const mu_uint32 count, const glm::vec4 &rect)
+	{
+		const glm::vec2 offset(rect[0], rect[1]);
+		const glm::vec2 scale(rect[2] - rect[0], rect[3] - rect[1]);
+		auto *vertices = renderBuffer.Vertices.data() + renderIndex * 4;
+		for (mu_uint32 n = 0; n < count * 4; ++n, ++vertices)
+		{
+#if NEXTMU_COMPRESSED_PARTICLES == 1
+			vertices->UV = glm::packSnorm2x16(glm::unpackSnorm2x16(vertices->UV) * scale + offset);
+#else
+			vertices->UV = vertices->UV * scale + offset;
+#endif
+		}
 	}
 
-	NEXTMU_INLINE void RenderBillboardSprite(NRenderBuffer &renderBuffer, const mu_uint32 renderGroup, const mu_uint32 renderIndex, const glm::mat4 &view, const glm::vec3 &position, const mu_float width, const mu_float height, const glm::vec4 &light, const glm::vec4 &uv = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f))
+	NEXTMU_INLINE void RenderBillboardSprite(NRenderBuffer &renderBuffer, const mu_uint32 renderIndex, const glm::mat4 &view, const glm::vec3 &position, const mu_float width, const mu_float height, const glm::vec4 &light, const glm::vec4 &uv = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f))
 	{
 		glm::vec3 cposition = view * glm::vec4(position.x, position.z, position.y, 1.0f);
 
@@ -114,10 +130,10 @@ namespace TParticle
 			{ cposition[0] - width, cposition[1] + height, cposition[2] }
 		};
 
-		RenderSprite(renderBuffer, renderGroup, renderIndex, rposition, light, uv);
+		RenderSprite(renderBuffer, renderIndex, rposition, light, uv);
 	}
 
-	NEXTMU_INLINE void RenderBillboardSpriteWithRotation(NRenderBuffer &renderBuffer, const mu_uint32 renderGroup, const mu_uint32 renderIndex, const glm::mat4 &view, const glm::vec3 &position, const mu_float rotation, const mu_float width, const mu_float height, const glm::vec4 &light, const glm::vec4 &uv = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f))
+	NEXTMU_INLINE void RenderBillboardSpriteWithRotation(NRenderBuffer &renderBuffer, const mu_uint32 renderIndex, const glm::mat4 &view, const glm::vec3 &position, const mu_float rotation, const mu_float width, const mu_float height, const glm::vec4 &light, const glm::vec4 &uv = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f))
 	{
 		glm::vec3 cposition = view * glm::vec4(position.x, position.z, position.y, 1.0f);
 
@@ -139,7 +155,7 @@ namespace TParticle
 		rposition[2].x += cposition[0]; rposition[2].y += cposition[1];
 		rposition[3].x += cposition[0]; rposition[3].y += cposition[1];
 
-		RenderSprite(renderBuffer, renderGroup, renderIndex, rposition, light, uv);
+		RenderSprite(renderBuffer, renderIndex, rposition, light, uv);
 	}
 }
 
@@ -0,0 +1,179 @@
+#include "stdafx.h"
+#include "t_particle_simulation.h"
+#include "mu_renderstate.h"
+#include "mu_random.h"
+#include <glm/gtc/type_ptr.hpp>
+
+namespace TParticle
+{
+	/*
+		Kernels only touch the arrays they require, the loops are plain so the compiler can vectorize them.
+	*/
+	NEXTMU_INLINE void KernelGravity(const mu_float acceleration, mu_float *gravity, glm::vec3 *position, const mu_boolean apply, const mu_uint32 count)
+	{
+		if (acceleration != 0.0f)
+		{
+			for (mu_uint32 n = 0; n < count; ++n)
+			{
+				gravity[n] += acceleration;
+			}
+		}
+
+		if (apply)
+		{
+			for (mu_uint32 n = 0; n < count; ++n)
+			{
+				position[n].z += gravity[n];
+			}
+		}
+	}
+
+	NEXTMU_INLINE void KernelDamping(const glm::vec3 damping, glm::vec3 *velocity, const mu_uint32 count)
+	{
+		for (mu_uint32 n = 0; n < count; ++n)
+		{
+			velocity[n] *= damping;
+		}
+	}
+
+	NEXTMU_INLINE void KernelScale(const mu_float growth, const mu_boolean clamp, mu_float *scale, const mu_uint32 count)
+	{
+		if (clamp)
+		{
+			for (mu_uint32 n = 0; n < count; ++n)
+			{
+				scale[n] = glm::max(scale[n] + growth, 0.0f);
+			}
+		}
+		else
+		{
+			for (mu_uint32 n = 0; n < count; ++n)
+			{
+				scale[n] += growth;
+			}
+		}
+	}
+
+	NEXTMU_INLINE void KernelTerrain(const NTerrain *terrain, const mu_float offset, const mu_float *scale, glm::vec3 *position, const mu_uint32 count)
+	{
+		for (mu_uint32 n = 0; n < count; ++n)
+		{
+			auto &p = position[n];
+			p.z = terrain->RequestHeight(p.x, p.y) + offset * scale[n];
+		}
+	}
+
+	NEXTMU_INLINE void KernelRotation(const mu_float rotationMin, const mu_float rotationMax, mu_float *rotation, const mu_uint32 count)
+	{
+		constexpr mu_uint32 BatchCount = 256u;
+		mu_float random[BatchCount];
+		auto &generator = MURandom::GetGenerator();
+		for (mu_uint32 b = 0; b < count; b += BatchCount)
+		{
+			const mu_uint32 batchCount = glm::min(count - b, BatchCount);
+			generator.Fill(random, batchCount, rotationMin, rotationMax);
+			for (mu_uint32 n = 0; n < batchCount; ++n)
+			{
+				rotation[b + n] += random[n];
+			}
+		}
+	}
+
+	NEXTMU_INLINE void KernelLight(const NParticleBehavior &behavior, const mu_uint16 *lifetime, glm::vec4 *light, const mu_uint32 count)
+	{
+		switch (behavior.LightMode)
+		{
+		case NParticleLightMode::Multiply:
+			{
+				const mu_float factor = behavior.LightFactor;
+				mu_float *values = glm::value_ptr(light[0]);
+				for (mu_uint32 n = 0, c = count * 4; n < c; ++n)
+				{
+					values[n] *= factor;
+				}
+			}
+			break;
+
+		case NParticleLightMode::Pulse:
+			{
+				const mu_uint16 threshold = behavior.LightThreshold;
+				const mu_float factor = behavior.LightFactor;
+				const mu_float fade = behavior.LightFadeFactor;
+				for (mu_uint32 n = 0; n < count; ++n)
+				{
+					light[n] *= lifetime[n] >= threshold ? factor : fade;
+				}
+			}
+			break;
+
+		case NParticleLightMode::LifeTime:
+			{
+				const mu_float divisor = behavior.LightDivisor;
+				if (behavior.LightAlpha)
+				{
+					for (mu_uint32 n = 0; n < count; ++n)
+					{
+						light[n] = glm::vec4(static_cast<mu_float>(lifetime[n]) * divisor);
+					}
+				}
+				else
+				{
+					for (mu_uint32 n = 0; n < count; ++n)
+					{
+						const mu_float luminosity = static_cast<mu_float>(lifetime[n]) * divisor;
+						light[n] = glm::vec4(luminosity, luminosity, luminosity, 1.0f);
+					}
+				}
+			}
+			break;
+
+		default: break;
+		}
+	}
+
+	NEXTMU_INLINE void KernelFrame(const mu_uint8 framesCount, mu_uint8 *frame, const mu_uint32 count)
+	{
+		for (mu_uint32 n = 0; n < count; ++n)
+		{
+			frame[n] = (frame[n] + 1) % framesCount;
+		}
+	}
+
+	void Simulate(const NParticleBehavior &behavior, NParticlePool &pool, const mu_uint32 begin, const mu_uint32 end)
+	{
+		if (begin >= end) return;
+		const mu_uint32 count = end - begin;
+
+		if (behavior.GravityAcceleration != 0.0f || behavior.ApplyGravity)
+		{
+			KernelGravity(behavior.GravityAcceleration, pool.Gravity.data() + begin, pool.Position.data() + begin, behavior.ApplyGravity, count);
+		}
+
+		if (behavior.VelocityDamping != glm::vec3(1.0f, 1.0f, 1.0f))
+		{
+			KernelDamping(behavior.VelocityDamping, pool.Velocity.data() + begin, count);
+		}
+
+		if (behavior.ScaleGrowth != 0.0f || behavior.ClampScale)
+		{
+			KernelScale(behavior.ScaleGrowth, behavior.ClampScale, pool.Scale.data() + begin, count);
+		}
+
+		if (behavior.FollowTerrain)
+		{
+			KernelTerrain(MURenderState::GetTerrain(), behavior.TerrainOffset, pool.Scale.data() + begin, pool.Position.data() + begin, count);
+		}
+
+		if (behavior.RotationMin != 0.0f || behavior.RotationMax != 0.0f)
+		{
+			KernelRotation(behavior.RotationMin, behavior.RotationMax, pool.Rotation.data() + begin, count);
+		}
+
+		KernelLight(behavior, pool.LifeTime.data() + begin, pool.Light.data() + begin, count);
+
+		if (behavior.FramesCount > 0)
+		{
+			KernelFrame(behavior.FramesCount, pool.Frame.data() + begin, count);
+		}
+	}
+}
\ No newline at end of file
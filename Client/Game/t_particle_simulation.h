@@ -0,0 +1,46 @@
+#ifndef __T_PARTICLE_SIMULATION_H__
+#define __T_PARTICLE_SIMULATION_H__
+
+#pragma once
+
+#include "t_particle_pool.h"
+
+namespace TParticle
+{
+	enum class NParticleLightMode : mu_uint8
+	{
+		None,
+		Multiply, // light *= LightFactor
+		Pulse, // light *= lifetime >= LightThreshold ? LightFactor : LightFadeFactor
+		LifeTime, // light = lifetime * LightDivisor (alpha included if LightAlpha is enabled)
+	};
+
+	/*
+		Common particle behaviors described as parameters, the simulation kernels execute them over a whole
+		range of a pool after the template Move hook, templates only implement the hook for custom behaviors.
+		Kernels are executed in the same order as the fields are declared.
+	*/
+	struct NParticleBehavior
+	{
+		mu_float GravityAcceleration = 0.0f; // Added to the gravity every tick
+		mu_boolean ApplyGravity = false; // Moves the particle up by its gravity every tick
+		glm::vec3 VelocityDamping = glm::vec3(1.0f, 1.0f, 1.0f);
+		mu_float ScaleGrowth = 0.0f;
+		mu_boolean ClampScale = false; // Scale can't be lower than zero
+		mu_boolean FollowTerrain = false; // Position is placed over the terrain, TerrainOffset is multiplied by the scale
+		mu_float TerrainOffset = 0.0f;
+		mu_float RotationMin = 0.0f; // Random rotation added every tick
+		mu_float RotationMax = 0.0f;
+		NParticleLightMode LightMode = NParticleLightMode::None;
+		mu_uint16 LightThreshold = 0u;
+		mu_float LightFactor = 1.0f;
+		mu_float LightFadeFactor = 1.0f;
+		mu_float LightDivisor = 1.0f;
+		mu_boolean LightAlpha = false;
+		mu_uint8 FramesCount = 0u; // Frame animation, the frame loops every FramesCount ticks
+	};
+
+	void Simulate(const NParticleBehavior &behavior, NParticlePool &pool, const mu_uint32 begin, const mu_uint32 end);
+}
+
+#endif
\ No newline at end of file
@@ -3,16 +3,11 @@
 #include "ui_noesisgui_stream.h"
 #include "ui_noesisgui_consts.h"
 #include "mu_textures.h"
+#include "mu_pixelformat.h"
 
 #if NEXTMU_UI_LIBRARY == NEXTMU_UI_NOESISGUI
 namespace UINoesis
 {
-	template <class T> void SwapValue(T &a, T &b) {
-		T tmp = a;
-		a = b;
-		b = tmp;
-	}
-
 	// Thanks to STB library for this, since FreeImage doesn't have this functionality I decided to implement it using this from STB
 	static mu_float srgb_uchar_to_linear_float[256] = {
 		0.000000f, 0.000304f, 0.000607f, 0.000911f, 0.001214f, 0.001518f, 0.001821f, 0.002125f, 0.002428f, 0.002732f, 0.003035f,
@@ -181,68 +176,43 @@ namespace UINoesis
 		const auto components = MUTextures::CalculateComponentsCount(bitmap);
 		const auto pixels = width * height;
 
-		if (components != 4)
-		{
-			FIBITMAP *newBitmap = FreeImage_ConvertTo32Bits(bitmap);
-			FreeImage_Unload(bitmap);
-			if (newBitmap == nullptr)
-			{
-				return nullptr;
-			}
-			bitmap = newBitmap;
-		}
-
-		constexpr mu_uint32 bitsPerPixel = 32u;
-		constexpr mu_uint32 bytesPerPixel = bitsPerPixel / 8u;
-
-#if FREEIMAGE_COLORORDER == FREEIMAGE_COLORORDER_BGR
-		{
-			for (mu_uint32 y = 0; y < height; y++) {
-				mu_uint8 *pixels = FreeImage_GetScanLine(bitmap, y);
-				for (mu_uint32 x = 0; x < width; x++) {
-					SwapValue(pixels[0], pixels[2]);
-					pixels += bytesPerPixel;
-				}
-			}
-		}
-#endif
-
 		//     N=#comp     components
 		//       1           grey
 		//       2           grey, alpha
 		//       3           red, green, blue
 		//       4           red, green, blue, alpha
 		const mu_boolean hasAlpha = components == 2 || components == 4;
+		const mu_boolean linearRendering = device->GetCaps().linearRendering;
+
+		// Gamma space premultiplication is done while converting, linear rendering premultiplies in linear space below
+		bitmap = MUPixelFormat::ConvertBitmap(bitmap, hasAlpha && !linearRendering);
+		if (bitmap == nullptr)
+		{
+			return nullptr;
+		}
+
+		constexpr mu_uint32 bitsPerPixel = 32u;
+		constexpr mu_uint32 bytesPerPixel = bitsPerPixel / 8u;
 
 		// Premultiply alpha
-		if (hasAlpha)
+		if (hasAlpha && linearRendering)
 		{
 			constexpr mu_uint32 Red = 0;
 			constexpr mu_uint32 Green = 1;
 			constexpr mu_uint32 Blue = 2;
 			constexpr mu_uint32 Alpha = 3;
 
-			if (device->GetCaps().linearRendering)
-			{
-				for (mu_uint32 y = 0; y < height; y++)
-				{
-					mu_uint8 *pixels = FreeImage_GetScanLine(bitmap, y);
-					for (mu_uint32 x = 0; x < width; x++)
-					{
-						const mu_float a = static_cast<mu_float>(pixels[Alpha]) / 255.0f;
-						pixels[Red] = linear_to_srgb_uchar(srgb_uchar_to_linear_float[pixels[Red]] * a);
-						pixels[Green] = linear_to_srgb_uchar(srgb_uchar_to_linear_float[pixels[Green]] * a);
-						pixels[Blue] = linear_to_srgb_uchar(srgb_uchar_to_linear_float[pixels[Blue]] * a);
-
-						pixels += bytesPerPixel;
-					}
-				}
-			}
-			else
+			for (mu_uint32 y = 0; y < height; y++)
 			{
-				if (!FreeImage_PreMultiplyWithAlpha(bitmap))
+				mu_uint8 *pixels = FreeImage_GetScanLine(bitmap, y);
+				for (mu_uint32 x = 0; x < width; x++)
 				{
-					return nullptr;
+					const mu_float a = static_cast<mu_float>(pixels[Alpha]) / 255.0f;
+					pixels[Red] = linear_to_srgb_uchar(srgb_uchar_to_linear_float[pixels[Red]] * a);
+					pixels[Green] = linear_to_srgb_uchar(srgb_uchar_to_linear_float[pixels[Green]] * a);
+					pixels[Blue] = linear_to_srgb_uchar(srgb_uchar_to_linear_float[pixels[Blue]] * a);
+
+					pixels += bytesPerPixel;
 				}
 			}
 		}
@@ -0,0 +1,168 @@
+#include "stdafx.h"
+#include "mu_tests.h"
+#include "t_joint_tails.h"
+#include "mu_random.h"
+
+namespace
+{
+	constexpr mu_uint32 JointsCount = 5000u;
+	constexpr mu_uint32 TailsCount = 50u; // Capacity of the thunder joints
+	constexpr mu_int32 TailOffset = 5;
+	typedef TJoint::Entity::Tails<TailsCount> Tails;
+
+	// Layout before the ring of transforms, every tail stored its four corners
+	typedef std::array<glm::vec3, 4> LegacyTail;
+	struct LegacyTails
+	{
+		mu_int32 Begin = 0;
+		mu_int32 Count = 0;
+		mu_int32 MaxCount = static_cast<mu_int32>(TailsCount);
+		std::array<LegacyTail, TailsCount> Tails;
+	};
+
+	void CreateLegacyTail(LegacyTails &tails, const glm::vec3 &position, const glm::quat &rotation, mu_float scale)
+	{
+		tails.Begin = CalculateBeginTails(tails.Begin, tails.MaxCount);
+		const auto begin = tails.Begin;
+		if (++tails.Count > tails.MaxCount - 1) tails.Count = tails.MaxCount - 1;
+
+		scale *= 0.5f;
+		auto &tail = tails.Tails[begin];
+		tail[0] = position + (glm::vec3(-scale, 0.0f, 0.0f) * rotation);
+		tail[1] = position + (glm::vec3(scale, 0.0f, 0.0f) * rotation);
+		tail[2] = position + (glm::vec3(0.0f, 0.0f, -scale) * rotation);
+		tail[3] = position + (glm::vec3(0.0f, 0.0f, scale) * rotation);
+	}
+
+	struct NJointSetup
+	{
+		glm::vec3 Start;
+		glm::quat Rotation;
+		mu_float Scale;
+	};
+
+	// Random walks are precomputed so the benchmarks only measure the tails
+	struct NJointsScene
+	{
+		std::vector<NJointSetup> Joints;
+		std::array<glm::vec3, TailsCount> Steps;
+	};
+
+	const NJointsScene MakeScene()
+	{
+		MURandom::NGenerator generator;
+		generator.Seed(0x4A4F494Eu);
+
+		NJointsScene scene;
+		scene.Joints.resize(JointsCount);
+		for (auto &joint : scene.Joints)
+		{
+			joint.Start = glm::vec3(generator.NextFloat(), generator.NextFloat(), generator.NextFloat()) * 1000.0f;
+			joint.Rotation = glm::quat(glm::radians(glm::vec3(generator.NextFloat(), generator.NextFloat(), generator.NextFloat()) * 360.0f));
+			joint.Scale = 10.0f + generator.NextFloat() * 40.0f;
+		}
+
+		for (auto &step : scene.Steps)
+		{
+			step = glm::vec3(generator.NextFloat() * 20.0f - 10.0f, generator.NextFloat() * 20.0f - 10.0f, -20.0f);
+		}
+
+		return scene;
+	}
+
+	template<typename TailsType, typename CreateFunc>
+	void MoveJoint(const NJointsScene &scene, const NJointSetup &joint, TailsType &tails, CreateFunc create)
+	{
+		glm::vec3 position = joint.Start;
+		for (const auto &step : scene.Steps)
+		{
+			position += step;
+			create(tails, position, joint.Rotation, joint.Scale);
+		}
+	}
+
+	// Reads the corners of the rendered segments like RenderTail did, in ring order from the offset
+	const glm::vec3 RenderLegacy(const LegacyTails &tails)
+	{
+		glm::vec3 sum(0.0f);
+		const mu_int32 segments = glm::max(tails.Count - TailOffset, 0);
+		for (mu_int32 n = 0, j = (tails.Begin + TailOffset) % tails.MaxCount; n <= segments; ++n, j = (j + 1 == tails.MaxCount ? 0 : j + 1))
+		{
+			const auto &tail = tails.Tails[j];
+			sum += tail[0] + tail[1] + tail[2] + tail[3];
+		}
+		return sum;
+	}
+
+	const glm::vec3 RenderRing(const Tails &tails)
+	{
+		std::array<TJoint::TailCorners, TailsCount> corners;
+		const mu_int32 segments = glm::max(tails.Count - TailOffset, 0);
+		ExpandTails(tails, tails.Begin + TailOffset, segments + 1, corners.data());
+
+		glm::vec3 sum(0.0f);
+		for (mu_int32 n = 0; n <= segments; ++n)
+		{
+			sum += corners[n][0] + corners[n][1] + corners[n][2] + corners[n][3];
+		}
+		return sum;
+	}
+}
+
+NEXTMU_TEST(JointTailsMatchLegacyCorners)
+{
+	const auto scene = MakeScene();
+	for (mu_uint32 n = 0; n < 16u; ++n)
+	{
+		const auto &joint = scene.Joints[n];
+		LegacyTails legacy;
+		Tails ring;
+		MoveJoint(scene, joint, legacy, CreateLegacyTail);
+		MoveJoint(scene, joint, ring, CreateTail<TailsCount>);
+
+		NEXTMU_CHECK(legacy.Begin == ring.Begin && legacy.Count == ring.Count);
+
+		std::array<TJoint::TailCorners, TailsCount> corners;
+		ExpandTails(ring, ring.Begin, ring.Count, corners.data());
+		for (mu_int32 k = 0; k < ring.Count; ++k)
+		{
+			const auto &expected = legacy.Tails[(ring.Begin + k) % ring.MaxCount];
+			for (mu_uint32 c = 0; c < 4u; ++c)
+			{
+				NEXTMU_CHECK(glm::distance(corners[k][c], expected[c]) < 1e-2f);
+			}
+		}
+	}
+}
+
+NEXTMU_BENCHMARK(JointTailsThunder)
+{
+	constexpr mu_uint32 Iterations = 20u;
+	const auto scene = MakeScene();
+	glm::vec3 sink(0.0f);
+
+	{
+		std::vector<LegacyTails> tails(JointsCount);
+		MUTests::Measure("Legacy corners (5000 joints) move", Iterations, [&]() {
+			for (mu_uint32 n = 0; n < JointsCount; ++n) MoveJoint(scene, scene.Joints[n], tails[n], CreateLegacyTail);
+		});
+		MUTests::Measure("Legacy corners (5000 joints) render", Iterations, [&]() {
+			for (const auto &joint : tails) sink += RenderLegacy(joint);
+		});
+		fmt::print("  {:<40} {:>12} bytes/joint\n", "Legacy corners", sizeof(LegacyTails));
+	}
+
+	{
+		std::vector<Tails> tails(JointsCount);
+		MUTests::Measure("Transforms ring (5000 joints) move", Iterations, [&]() {
+			for (mu_uint32 n = 0; n < JointsCount; ++n) MoveJoint(scene, scene.Joints[n], tails[n], CreateTail<TailsCount>);
+		});
+		MUTests::Measure("Transforms ring (5000 joints) render", Iterations, [&]() {
+			for (const auto &joint : tails) sink += RenderRing(joint);
+		});
+		fmt::print("  {:<40} {:>12} bytes/joint\n", "Transforms ring", sizeof(Tails));
+	}
+
+	// Keeps the results alive so the loops aren't removed
+	NEXTMU_CHECK(glm::any(glm::isnan(sink)) == false);
+}
\ No newline at end of file
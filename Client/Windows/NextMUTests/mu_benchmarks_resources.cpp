@@ -0,0 +1,91 @@
+#include "stdafx.h"
+#include "mu_tests.h"
+#include "mu_config.h"
+#include "mu_threadsmanager.h"
+#include "mu_graphics.h"
+#include "mu_capabilities.h"
+#include "mu_skeletonmanager.h"
+#include "mu_skinningmanager.h"
+#include "mu_texturestreaming.h"
+#include "mu_resourcesmanager.h"
+
+namespace
+{
+	constexpr mu_uint32 Iterations = 3u;
+
+	// Same order as MURoot::Initialize without the window, the scripts and the physics
+	const mu_boolean InitializeHeadless()
+	{
+		if (SDL_Init(SDL_INIT_TIMER | SDL_INIT_EVENTS) < 0) return false;
+		if (MUConfig::Initialize() == false) return false;
+		if (MUThreadsManager::Initialize() == false) return false;
+		if (MUGraphics::InitializeHeadless() == false) return false;
+		if (MUCapabilities::Configure() == false) return false;
+		if (MUSkeletonManager::Initialize() == false) return false;
+		if (MUSkinningManager::Initialize() == false) return false;
+		if (MUTextureStreaming::Initialize() == false) return false;
+		return true;
+	}
+
+	void DestroyHeadless()
+	{
+		MUSkinningManager::Destroy();
+		MUSkeletonManager::Destroy();
+		MUResourcesManager::Destroy();
+		MUTextureStreaming::Destroy();
+		MUGraphics::Destroy();
+		MUThreadsManager::Destroy();
+		MUConfig::Destroy();
+		SDL_Quit();
+	}
+
+	void Accumulate(NLoadTimings &total, const NLoadTimings &timings)
+	{
+		total.Count = timings.Count;
+		total.Decode += timings.Decode;
+		total.Upload += timings.Upload;
+	}
+
+	void PrintTimings(const mu_char *type, const NLoadTimings &total)
+	{
+		const mu_double decode = total.Decode / static_cast<mu_double>(Iterations);
+		const mu_double upload = total.Upload / static_cast<mu_double>(Iterations);
+		fmt::print("  {:<12} {:>6} loaded in {:>10.2f} ms (decode {:>10.2f} ms, upload {:>10.2f} ms)\n", type, total.Count, decode + upload, decode, upload);
+	}
+}
+
+/*
+	Loads data/resources.json from the working directory on the software adapter, so the startup cost of every asset type
+	can be compared between machines without a window.
+*/
+NEXTMU_BENCHMARK(ResourcesLoad)
+{
+	const mu_boolean initialized = InitializeHeadless();
+	NEXTMU_CHECK(initialized == true);
+	if (initialized == false)
+	{
+		DestroyHeadless();
+		return;
+	}
+
+	NLoadStatistics total;
+	for (mu_uint32 n = 0; n < Iterations; ++n)
+	{
+		const mu_boolean loaded = MUResourcesManager::Load();
+		NEXTMU_CHECK(loaded == true);
+		if (loaded == false) break;
+
+		const auto &statistics = MUResourcesManager::GetLoadStatistics();
+		Accumulate(total.Programs, statistics.Programs);
+		Accumulate(total.Textures, statistics.Textures);
+		Accumulate(total.Models, statistics.Models);
+		MUResourcesManager::Destroy();
+	}
+
+	fmt::print("  Average of {} loads on {}\n", Iterations, MUGraphics::GetDevice()->GetAdapterInfo().Description);
+	PrintTimings("programs", total.Programs);
+	PrintTimings("textures", total.Textures);
+	PrintTimings("models", total.Models);
+
+	DestroyHeadless();
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#include "stdafx.h"
+#include "mu_tests.h"
+
+namespace MUTests
+{
+	mu_uint32 FailuresCount = 0;
+
+	std::vector<NTestCase> &GetTestCases()
+	{
+		static std::vector<NTestCase> testCases;
+		return testCases;
+	}
+
+	NTestRegistrar::NTestRegistrar(const mu_char *name, NTestFunction function, const mu_boolean benchmark)
+	{
+		GetTestCases().push_back(NTestCase{ .Name = name, .Function = function, .Benchmark = benchmark });
+	}
+
+	void ReportFailure(const mu_char *file, const mu_uint32 line, const mu_char *expression)
+	{
+		++FailuresCount;
+		fmt::print("  {}({}): check failed ({})\n", file, line, expression);
+	}
+
+	const mu_uint32 GetFailuresCount()
+	{
+		return FailuresCount;
+	}
+};
\ No newline at end of file
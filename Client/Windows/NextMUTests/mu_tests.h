@@ -0,0 +1,60 @@
+#ifndef __MU_TESTS_H__
+#define __MU_TESTS_H__
+
+#pragma once
+
+#include <chrono>
+
+/*
+	Minimal test and benchmark registry, every test file registers its cases with NEXTMU_TEST or NEXTMU_BENCHMARK.
+	Tests only use CPU code, so they run without a window or a device.
+*/
+namespace MUTests
+{
+	typedef void (*NTestFunction)();
+
+	struct NTestCase
+	{
+		const mu_char *Name;
+		NTestFunction Function;
+		mu_boolean Benchmark;
+	};
+
+	class NTestRegistrar
+	{
+	public:
+		NTestRegistrar(const mu_char *name, NTestFunction function, const mu_boolean benchmark);
+	};
+
+	std::vector<NTestCase> &GetTestCases();
+	void ReportFailure(const mu_char *file, const mu_uint32 line, const mu_char *expression);
+	const mu_uint32 GetFailuresCount();
+
+	// Runs the function the requested times and prints the average time of a call
+	template<typename F>
+	void Measure(const mu_char *name, const mu_uint32 iterations, F &&function)
+	{
+		const auto start = std::chrono::high_resolution_clock::now();
+		for (mu_uint32 n = 0; n < iterations; ++n)
+		{
+			function();
+		}
+		const auto end = std::chrono::high_resolution_clock::now();
+
+		const mu_double nanoseconds = static_cast<mu_double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+		fmt::print("  {:<40} {:>12.1f} ns/iteration\n", name, nanoseconds / static_cast<mu_double>(iterations));
+	}
+};
+
+#define NEXTMU_TEST_REGISTER(name, benchmark) \
+	static void name(); \
+	static MUTests::NTestRegistrar name##Registrar(#name, name, benchmark); \
+	static void name()
+
+#define NEXTMU_TEST(name) NEXTMU_TEST_REGISTER(name, false)
+#define NEXTMU_BENCHMARK(name) NEXTMU_TEST_REGISTER(name, true)
+
+#define NEXTMU_CHECK(expression) \
+	do { if (!(expression)) MUTests::ReportFailure(__FILE__, __LINE__, #expression); } while (0)
+
+#endif
\ No newline at end of file
@@ -0,0 +1,118 @@
+#include "stdafx.h"
+#include "mu_tests.h"
+#include "mu_model.h"
+
+namespace
+{
+	struct NAnimationSetup
+	{
+		mu_uint32 FramesCount;
+		mu_boolean Loop;
+		mu_boolean LockPositions;
+	};
+
+	constexpr NAnimationSetup Setups[] = {
+		{ 1u, false, false },
+		{ 2u, false, true },
+		{ 7u, false, false },
+		{ 7u, false, true },
+		{ 7u, true, false },
+		{ 7u, true, true },
+		{ 30u, false, true },
+		{ 30u, true, false },
+	};
+
+	// PlayAnimation before the timelines, it derived the limits from the keys on every call
+	const mu_boolean PlayAnimationReference(
+		const NAnimation &animation,
+		mu_uint16 &CurrentAction,
+		mu_uint16 &PriorAction,
+		mu_float &CurrentFrame,
+		mu_float &PriorFrame,
+		const mu_float PlaySpeed
+	)
+	{
+		if (glm::abs(PlaySpeed) < glm::epsilon<mu_float>()) return true;
+
+		const auto currentFramesCount = static_cast<mu_uint32>(animation.Keys.size());
+		if (currentFramesCount <= 1) return true;
+
+		const mu_float tmpFrame = CurrentFrame;
+		const mu_uint32 lastFrame = static_cast<mu_uint32>(glm::floor(CurrentFrame));
+		CurrentFrame += PlaySpeed;
+		const mu_uint32 newFrame = static_cast<mu_uint32>(glm::floor(CurrentFrame));
+
+		if (CurrentAction == PriorAction || lastFrame != newFrame)
+		{
+			PriorAction = CurrentAction;
+			PriorFrame = tmpFrame;
+		}
+
+		mu_boolean loop = true;
+		if (animation.Loop)
+		{
+			if (newFrame >= currentFramesCount)
+			{
+				CurrentFrame = static_cast<mu_float>(currentFramesCount) - 0.01f;
+				loop = false;
+			}
+		}
+		else
+		{
+			const auto maxFrames = currentFramesCount - static_cast<mu_uint32>(!!animation.LockPositions);
+			if (newFrame >= maxFrames)
+			{
+				CurrentFrame = glm::mod(CurrentFrame, static_cast<mu_float>(maxFrames));
+				loop = false;
+			}
+		}
+
+		return loop;
+	}
+}
+
+NEXTMU_TEST(AnimationTimelineMatchesPlayAnimation)
+{
+	constexpr mu_float Speeds[] = { 0.0f, 0.16f, 0.25f, 0.5f, 1.0f, 1.7f, 3.3f, 9.0f };
+	constexpr mu_uint32 Steps = 200u;
+
+	NModel model;
+	for (const auto &setup : Setups)
+	{
+		NAnimation animation;
+		animation.Loop = setup.Loop;
+		animation.LockPositions = setup.LockPositions;
+		animation.Keys = NSharedBlock<NAnimationKey>(std::make_shared<const std::vector<NAnimationKey>>(setup.FramesCount));
+		model.Animations.push_back(std::move(animation));
+	}
+	model.GenerateTimelines();
+
+	for (mu_uint16 action = 0; action < static_cast<mu_uint16>(model.Animations.size()); ++action)
+	{
+		for (const mu_float speed : Speeds)
+		{
+			// The prior action starts different so the blending state is covered too
+			mu_uint16 currentAction = action, priorAction = static_cast<mu_uint16>(action + 1u);
+			mu_float currentFrame = 0.0f, priorFrame = 0.0f;
+			mu_uint16 expectedCurrentAction = action, expectedPriorAction = static_cast<mu_uint16>(action + 1u);
+			mu_float expectedCurrentFrame = 0.0f, expectedPriorFrame = 0.0f;
+
+			for (mu_uint32 step = 0; step < Steps; ++step)
+			{
+				const mu_boolean loop = model.PlayAnimation(currentAction, priorAction, currentFrame, priorFrame, speed);
+				const mu_boolean expectedLoop = PlayAnimationReference(model.Animations[action], expectedCurrentAction, expectedPriorAction, expectedCurrentFrame, expectedPriorFrame, speed);
+
+				NEXTMU_CHECK(loop == expectedLoop);
+				NEXTMU_CHECK(currentAction == expectedCurrentAction && priorAction == expectedPriorAction);
+				NEXTMU_CHECK(currentFrame == expectedCurrentFrame && priorFrame == expectedPriorFrame);
+				if (currentFrame != expectedCurrentFrame) break;
+			}
+		}
+	}
+
+	// Actions without keys are ignored by both
+	mu_uint16 currentAction = static_cast<mu_uint16>(model.Animations.size()), priorAction = 0u;
+	mu_float currentFrame = 2.0f, priorFrame = 1.0f;
+	NEXTMU_CHECK(model.PlayAnimation(currentAction, priorAction, currentFrame, priorFrame, 1.0f));
+	NEXTMU_CHECK(currentFrame == 2.0f && priorFrame == 1.0f && priorAction == 0u);
+}
\ No newline at end of file
@@ -0,0 +1,114 @@
+#include "stdafx.h"
+#include "mu_tests.h"
+#include "mu_animationlibrary.h"
+
+namespace
+{
+	std::vector<NAnimationKey> MakeKeys(const mu_float x, const mu_uint32 framesCount = 5u, const mu_uint32 bonesCount = 10u)
+	{
+		std::vector<NAnimationKey> keys(framesCount);
+		for (mu_uint32 k = 0; k < framesCount; ++k)
+		{
+			keys[k].Bones.resize(bonesCount);
+			for (mu_uint32 n = 0; n < bonesCount; ++n)
+			{
+				keys[k].Bones[n].Position = glm::vec3(static_cast<mu_float>(n), static_cast<mu_float>(k), x);
+			}
+		}
+		return keys;
+	}
+
+	std::vector<NBoneInfo> MakeBones(const mu_uint32 count)
+	{
+		std::vector<NBoneInfo> bones(count);
+		for (mu_uint32 n = 0; n < count; ++n)
+		{
+			bones[n].Dummy = n % 3u == 2u;
+			bones[n].Parent = static_cast<mu_int16>(n) - 1;
+		}
+		return bones;
+	}
+}
+
+NEXTMU_TEST(AnimationLibrarySharesIdenticalKeys)
+{
+	MUAnimationLibrary::Clear();
+
+	const auto a = MUAnimationLibrary::ShareKeys(MakeKeys(1.0f));
+	const auto b = MUAnimationLibrary::ShareKeys(MakeKeys(1.0f));
+	const auto c = MUAnimationLibrary::ShareKeys(MakeKeys(2.0f));
+	const auto d = MUAnimationLibrary::ShareKeys(MakeKeys(1.0f, 5u, 11u));
+
+	NEXTMU_CHECK(a.size() == 5u && a[4].Bones.size() == 10u);
+	NEXTMU_CHECK(a.begin() == b.begin());
+	NEXTMU_CHECK(a.begin() != c.begin());
+	NEXTMU_CHECK(a.begin() != d.begin());
+	NEXTMU_CHECK(c[2].Bones[3].Position.z == 2.0f);
+
+	const auto statistics = MUAnimationLibrary::GetStatistics();
+	NEXTMU_CHECK(statistics.Blocks == 3u);
+	NEXTMU_CHECK(statistics.Shared == 1u);
+	NEXTMU_CHECK(statistics.SharedBytes == 5u * sizeof(NAnimationKey) + 50u * sizeof(NBone));
+
+	MUAnimationLibrary::Clear();
+}
+
+NEXTMU_TEST(AnimationLibraryComparesBits)
+{
+	MUAnimationLibrary::Clear();
+
+	// 0.0 and -0.0 compare equal as floats, blocks are compared by their bits like the hash
+	const auto positive = MUAnimationLibrary::ShareKeys(MakeKeys(0.0f));
+	const auto negative = MUAnimationLibrary::ShareKeys(MakeKeys(-0.0f));
+	NEXTMU_CHECK(positive.begin() != negative.begin());
+
+	auto rotated = MakeKeys(0.0f);
+	rotated[3].Bones[7].Rotation = glm::quat(0.0f, 1.0f, 0.0f, 0.0f);
+	const auto rotation = MUAnimationLibrary::ShareKeys(std::move(rotated));
+	NEXTMU_CHECK(positive.begin() != rotation.begin());
+	NEXTMU_CHECK(MUAnimationLibrary::GetStatistics().Shared == 0u);
+
+	MUAnimationLibrary::Clear();
+}
+
+NEXTMU_TEST(AnimationLibrarySharesBones)
+{
+	MUAnimationLibrary::Clear();
+
+	const auto a = MUAnimationLibrary::ShareBones(MakeBones(12u));
+	const auto b = MUAnimationLibrary::ShareBones(MakeBones(12u));
+	auto reparented = MakeBones(12u);
+	reparented[5].Parent = 0;
+	const auto c = MUAnimationLibrary::ShareBones(std::move(reparented));
+
+	NEXTMU_CHECK(a.begin() == b.begin());
+	NEXTMU_CHECK(a.begin() != c.begin());
+	NEXTMU_CHECK(c[5].Parent == 0 && a[5].Parent == 4);
+
+	const auto statistics = MUAnimationLibrary::GetStatistics();
+	NEXTMU_CHECK(statistics.Blocks == 2u && statistics.Shared == 1u);
+
+	MUAnimationLibrary::Clear();
+}
+
+NEXTMU_TEST(AnimationLibraryReleasesUnusedBlocks)
+{
+	MUAnimationLibrary::Clear();
+
+	NEXTMU_CHECK(MUAnimationLibrary::ShareKeys(std::vector<NAnimationKey>()).empty());
+	NEXTMU_CHECK(MUAnimationLibrary::GetStatistics().Blocks == 0u);
+
+	{
+		const auto a = MUAnimationLibrary::ShareKeys(MakeKeys(1.0f));
+		const auto b = MUAnimationLibrary::ShareKeys(MakeKeys(1.0f));
+		NEXTMU_CHECK(a.begin() == b.begin());
+	}
+
+	// The library only holds weak references, the block died with its last model
+	const auto c = MUAnimationLibrary::ShareKeys(MakeKeys(1.0f));
+	NEXTMU_CHECK(c.size() == 5u);
+	const auto statistics = MUAnimationLibrary::GetStatistics();
+	NEXTMU_CHECK(statistics.Blocks == 2u && statistics.Shared == 1u);
+
+	MUAnimationLibrary::Clear();
+}
\ No newline at end of file
@@ -0,0 +1,293 @@
+#include "stdafx.h"
+#include "mu_tests.h"
+#include "mu_model.h"
+#include "mu_random.h"
+#include <filesystem>
+
+namespace
+{
+	const mu_utf8string ModelDirectory = "tests/bakedmodel/";
+	const mu_utf8string ModelFilename = "model.bmd";
+
+	struct NBMDVertex
+	{
+		mu_int16 Node;
+		glm::vec3 Position;
+	};
+
+	struct NBMDMesh
+	{
+		std::vector<NBMDVertex> Vertices;
+		std::vector<glm::vec3> Normals;
+		std::vector<glm::vec2> TexCoords;
+		std::vector<std::array<mu_int16, 3>> Triangles; // Same index for the vertex, the normal and the texture coordinate
+		mu_utf8string Texture;
+	};
+
+	struct NBMDBone
+	{
+		mu_boolean Dummy;
+		mu_utf8string Name;
+		mu_int16 Parent;
+	};
+
+	class NBMDWriter
+	{
+	public:
+		template<typename T>
+		void Write(const T value)
+		{
+			const auto *bytes = reinterpret_cast<const mu_uint8 *>(&value);
+			Buffer.insert(Buffer.end(), bytes, bytes + sizeof(T));
+		}
+
+		void WriteName(const mu_utf8string &name)
+		{
+			std::array<mu_char, 32> bytes = {};
+			mu_memcpy(bytes.data(), name.c_str(), glm::min(name.size(), bytes.size() - 1));
+			Write(bytes);
+		}
+
+		void Skip(const mu_size count)
+		{
+			Buffer.insert(Buffer.end(), count, 0u);
+		}
+
+		std::vector<mu_uint8> Buffer;
+	};
+
+	/*
+		Unencrypted BMD (version 10) with a dummy bone between two real ones, a locked and a looped action,
+		shared corners to weld and a degenerate triangle which is dropped.
+	*/
+	const std::vector<mu_uint8> MakeBMD()
+	{
+		MURandom::NGenerator generator;
+		generator.Seed(42u);
+		const auto random = [&generator]() { return generator.NextFloat() * 200.0f - 100.0f; };
+
+		std::vector<NBMDMesh> meshes(2);
+		{
+			auto &quad = meshes[0];
+			quad.Vertices = { { 0, glm::vec3(0.0f, 0.0f, 0.0f) }, { 0, glm::vec3(10.0f, 0.0f, 0.0f) }, { 2, glm::vec3(10.0f, 10.0f, 0.0f) }, { 2, glm::vec3(0.0f, 10.0f, 0.0f) } };
+			quad.Normals.assign(4, glm::vec3(0.0f, 0.0f, 1.0f));
+			quad.TexCoords = { glm::vec2(0.0f, 0.0f), glm::vec2(1.0f, 0.0f), glm::vec2(1.0f, 1.0f), glm::vec2(0.0f, 1.0f) };
+			quad.Triangles = { { 0, 1, 2 }, { 0, 2, 3 }, { 1, 1, 2 } };
+			quad.Texture = "hide01.jpg";
+		}
+		{
+			auto &mesh = meshes[1];
+			for (mu_uint32 v = 0; v < 30u; ++v)
+			{
+				mesh.Vertices.push_back({ static_cast<mu_int16>(v % 2u == 0u ? 0 : 2), glm::vec3(random(), random(), random()) });
+				mesh.Normals.push_back(glm::normalize(glm::vec3(random(), random(), random())));
+				mesh.TexCoords.push_back(glm::vec2(generator.NextFloat(), generator.NextFloat()));
+			}
+			for (mu_uint32 t = 0; t < 40u; ++t)
+			{
+				mesh.Triangles.push_back({
+					static_cast<mu_int16>(generator.Next() % 30u),
+					static_cast<mu_int16>(generator.Next() % 30u),
+					static_cast<mu_int16>(generator.Next() % 30u),
+				});
+			}
+			mesh.Texture = "hide02.jpg";
+		}
+
+		const std::vector<NBMDBone> bones = {
+			{ false, "Bip01", -1 },
+			{ true, "", -1 },
+			{ false, "Bip01 Spine", 0 },
+		};
+		const std::array<mu_uint32, 2> actionKeys = { 3u, 2u };
+		const std::array<mu_boolean, 2> actionLocked = { true, false };
+
+		NBMDWriter writer;
+		writer.Write(std::array<mu_char, 3>{ 'B', 'M', 'D' });
+		writer.Write<mu_uint8>(10u);
+		writer.WriteName("roundtrip");
+		writer.Write(static_cast<mu_int16>(meshes.size()));
+		writer.Write(static_cast<mu_int16>(bones.size()));
+		writer.Write(static_cast<mu_int16>(actionKeys.size()));
+
+		for (mu_uint32 m = 0; m < meshes.size(); ++m)
+		{
+			const auto &mesh = meshes[m];
+			writer.Write(static_cast<mu_int16>(mesh.Vertices.size()));
+			writer.Write(static_cast<mu_int16>(mesh.Normals.size()));
+			writer.Write(static_cast<mu_int16>(mesh.TexCoords.size()));
+			writer.Write(static_cast<mu_int16>(mesh.Triangles.size()));
+			writer.Write(static_cast<mu_int16>(m));
+
+			for (const auto &vertex : mesh.Vertices)
+			{
+				writer.Write(vertex.Node);
+				writer.Skip(2);
+				writer.Write(vertex.Position);
+			}
+
+			for (mu_uint32 n = 0; n < mesh.Normals.size(); ++n)
+			{
+				writer.Write(mesh.Vertices[n].Node);
+				writer.Skip(2);
+				writer.Write(mesh.Normals[n]);
+				writer.Skip(4);
+			}
+
+			for (const auto &texCoord : mesh.TexCoords)
+			{
+				writer.Write(texCoord);
+			}
+
+			for (const auto &triangle : mesh.Triangles)
+			{
+				writer.Write<mu_uint8>(3u);
+				writer.Skip(1);
+				for (mu_uint32 n = 0; n < 3; ++n) writer.Write(triangle[n]); // Vertices
+				writer.Skip(2);
+				for (mu_uint32 n = 0; n < 3; ++n) writer.Write(triangle[n]); // Normals
+				writer.Skip(2);
+				for (mu_uint32 n = 0; n < 3; ++n) writer.Write(triangle[n]); // Texture coordinates
+				writer.Skip(40);
+			}
+
+			writer.WriteName(mesh.Texture);
+		}
+
+		for (mu_uint32 a = 0; a < actionKeys.size(); ++a)
+		{
+			writer.Write(static_cast<mu_int16>(actionKeys[a]));
+			writer.Write(actionLocked[a]);
+			if (actionLocked[a]) writer.Skip(sizeof(glm::vec3) * actionKeys[a]);
+		}
+
+		for (const auto &bone : bones)
+		{
+			writer.Write(bone.Dummy);
+			if (bone.Dummy) continue;
+
+			writer.WriteName(bone.Name);
+			writer.Write(bone.Parent);
+			for (const mu_uint32 keys : actionKeys)
+			{
+				for (mu_uint32 k = 0; k < keys; ++k) writer.Write(glm::vec3(random(), random(), random()));
+				for (mu_uint32 k = 0; k < keys; ++k) writer.Write(glm::vec3(generator.NextFloat(), generator.NextFloat(), generator.NextFloat()) * glm::pi<mu_float>());
+			}
+		}
+
+		return writer.Buffer;
+	}
+
+	void WriteFile(const mu_utf8string &filename, const void *data, const mu_size size)
+	{
+		SDL_RWops *fp = nullptr;
+		if (mu_rwfromfile<EGameDirectoryType::eSupport>(&fp, filename, "wb") == false) return;
+		SDL_RWwrite(fp, data, size, 1);
+		SDL_RWclose(fp);
+	}
+
+	void RemoveFiles()
+	{
+		std::error_code ec;
+		std::filesystem::remove_all(std::filesystem::path(ConvertToUnicodeString(SupportPathUTF8 + ModelDirectory)), ec);
+		const auto bakedPath = NBakedModel::GetPath(ModelDirectory + ModelFilename);
+		std::filesystem::remove(std::filesystem::path(ConvertToUnicodeString(CachePathUTF8 + bakedPath)), ec);
+	}
+
+	template<typename T>
+	const mu_boolean BitwiseEqual(const T &lhs, const T &rhs)
+	{
+		return mu_memcmp(&lhs, &rhs, sizeof(T)) == 0;
+	}
+}
+
+NEXTMU_TEST(BakedModelMatchesBMD)
+{
+	RemoveFiles();
+
+	std::error_code ec;
+	std::filesystem::create_directories(std::filesystem::path(ConvertToUnicodeString(SupportPathUTF8 + ModelDirectory)), ec);
+	const auto bmd = MakeBMD();
+	WriteFile(ModelDirectory + ModelFilename, bmd.data(), bmd.size());
+	const mu_utf8string json = "{ \"model\": \"" + ModelFilename + "\" }";
+	WriteFile(ModelDirectory + "model.json", json.data(), json.size());
+
+	// The first load parses the BMD and bakes it, the second one reads the baked model
+	NModel parsed, baked;
+	NEXTMU_CHECK(parsed.Prepare("parsed", ModelDirectory) == true);
+	SDL_RWops *fp = nullptr;
+	const mu_boolean bakedExists = mu_rwfromfile<EGameDirectoryType::eCache>(&fp, NBakedModel::GetPath(ModelDirectory + ModelFilename), "rb");
+	if (bakedExists) SDL_RWclose(fp);
+	NEXTMU_CHECK(bakedExists == true);
+	NEXTMU_CHECK(baked.Prepare("baked", ModelDirectory) == true);
+	RemoveFiles();
+
+	if (parsed.Pending == nullptr || baked.Pending == nullptr || parsed.Meshes.size() != 2u || baked.Meshes.size() != 2u)
+	{
+		NEXTMU_CHECK(false);
+		return;
+	}
+
+	// Only the BMD path keeps the source vertices, so this proves the second model didn't parse the BMD
+	NEXTMU_CHECK(parsed.Meshes[0].Vertices.empty() == false);
+	NEXTMU_CHECK(baked.Meshes[0].Vertices.empty() == true);
+
+	for (mu_uint32 m = 0; m < parsed.Meshes.size(); ++m)
+	{
+		const auto &lhs = parsed.Meshes[m], &rhs = baked.Meshes[m];
+		NEXTMU_CHECK(lhs.VertexBuffer.Offset == rhs.VertexBuffer.Offset);
+		NEXTMU_CHECK(lhs.VertexBuffer.Count == rhs.VertexBuffer.Count);
+		NEXTMU_CHECK(lhs.IndexBuffer.Offset == rhs.IndexBuffer.Offset);
+		NEXTMU_CHECK(lhs.IndexBuffer.Count == rhs.IndexBuffer.Count);
+		NEXTMU_CHECK(lhs.Texture.Filename == rhs.Texture.Filename);
+	}
+	// The degenerate triangle of the quad is dropped and its corners are welded
+	NEXTMU_CHECK(parsed.Meshes[0].IndexBuffer.Count == 6u);
+	NEXTMU_CHECK(parsed.Meshes[0].VertexBuffer.Count == 4u);
+
+	const auto &lhsPending = *parsed.Pending, &rhsPending = *baked.Pending;
+	NEXTMU_CHECK(lhsPending.Vertices.empty() == false);
+	NEXTMU_CHECK(lhsPending.Vertices.size() == rhsPending.Vertices.size());
+	NEXTMU_CHECK(
+		lhsPending.Vertices.size() == rhsPending.Vertices.size() &&
+		mu_memcmp(lhsPending.Vertices.data(), rhsPending.Vertices.data(), lhsPending.Vertices.size() * sizeof(NMeshVertex)) == 0
+	);
+	NEXTMU_CHECK(lhsPending.IndicesCount == rhsPending.IndicesCount);
+	NEXTMU_CHECK(lhsPending.IndexType == rhsPending.IndexType);
+	NEXTMU_CHECK(lhsPending.Indices == rhsPending.Indices);
+
+	NEXTMU_CHECK(parsed.BoneName == baked.BoneName);
+	NEXTMU_CHECK(parsed.BoneInfo.size() == 3u && baked.BoneInfo.size() == 3u);
+	for (mu_uint32 b = 0; b < glm::min(parsed.BoneInfo.size(), baked.BoneInfo.size()); ++b)
+	{
+		NEXTMU_CHECK(parsed.BoneInfo[b].Dummy == baked.BoneInfo[b].Dummy);
+		NEXTMU_CHECK(parsed.BoneInfo[b].Parent == baked.BoneInfo[b].Parent);
+	}
+
+	NEXTMU_CHECK(parsed.BoundingBoxes.size() == baked.BoundingBoxes.size());
+	for (mu_uint32 b = 0; b < glm::min(parsed.BoundingBoxes.size(), baked.BoundingBoxes.size()); ++b)
+	{
+		const auto &lhs = parsed.BoundingBoxes[b], &rhs = baked.BoundingBoxes[b];
+		NEXTMU_CHECK(lhs.Valid == rhs.Valid);
+		NEXTMU_CHECK(BitwiseEqual(lhs.Min, rhs.Min));
+		NEXTMU_CHECK(BitwiseEqual(lhs.Max, rhs.Max));
+	}
+
+	NEXTMU_CHECK(parsed.Animations.size() == 2u && baked.Animations.size() == 2u);
+	for (mu_uint32 a = 0; a < glm::min(parsed.Animations.size(), baked.Animations.size()); ++a)
+	{
+		const auto &lhs = parsed.Animations[a], &rhs = baked.Animations[a];
+		NEXTMU_CHECK(lhs.LockPositions == rhs.LockPositions);
+		NEXTMU_CHECK(lhs.Keys.size() == rhs.Keys.size());
+		for (mu_uint32 k = 0; k < glm::min(lhs.Keys.size(), rhs.Keys.size()); ++k)
+		{
+			const auto &lhsBones = lhs.Keys[k].Bones, &rhsBones = rhs.Keys[k].Bones;
+			NEXTMU_CHECK(lhsBones.size() == rhsBones.size());
+			for (mu_uint32 b = 0; b < glm::min(lhsBones.size(), rhsBones.size()); ++b)
+			{
+				NEXTMU_CHECK(BitwiseEqual(lhsBones[b].Position, rhsBones[b].Position));
+				NEXTMU_CHECK(BitwiseEqual(lhsBones[b].Rotation, rhsBones[b].Rotation));
+			}
+		}
+	}
+}
\ No newline at end of file
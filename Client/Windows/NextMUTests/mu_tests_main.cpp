@@ -0,0 +1,35 @@
+// mu_tests_main.cpp : Runs the tests, or the benchmarks with --benchmarks, a name filter can follow.
+//
+
+#include "stdafx.h"
+#include "mu_tests.h"
+
+int main(int argc, char *argv[])
+{
+	mu_boolean benchmarks = false;
+	mu_utf8string filter;
+	for (int n = 1; n < argc; ++n)
+	{
+		const mu_utf8string argument = argv[n];
+		if (argument == "--benchmarks")
+			benchmarks = true;
+		else
+			filter = argument;
+	}
+
+	mu_uint32 ran = 0, failed = 0;
+	for (const auto &testCase : MUTests::GetTestCases())
+	{
+		if (testCase.Benchmark != benchmarks) continue;
+		if (filter.empty() == false && mu_utf8string(testCase.Name).find(filter) == mu_utf8string::npos) continue;
+
+		fmt::print("[{}] {}\n", benchmarks ? "BENCH" : "TEST", testCase.Name);
+		const mu_uint32 failuresBefore = MUTests::GetFailuresCount();
+		testCase.Function();
+		++ran;
+		if (MUTests::GetFailuresCount() != failuresBefore) ++failed;
+	}
+
+	fmt::print("{} ran, {} failed\n", ran, failed);
+	return failed == 0 ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include "stdafx.h"
+#include "mu_tests.h"
+#include "mu_pixelformat.h"
+#include "mu_random.h"
+
+namespace
+{
+	constexpr EPixelLayout Layouts[] = { EPixelLayout::BGR8, EPixelLayout::BGRA8, EPixelLayout::RGB8, EPixelLayout::RGBA8 };
+
+	const mu_uint32 GetBytes(const EPixelLayout layout)
+	{
+		return layout == EPixelLayout::BGRA8 || layout == EPixelLayout::RGBA8 ? 4u : 3u;
+	}
+
+	// Straightforward per pixel conversion used as reference, independent from the library code
+	void ConvertReference(const mu_uint8 *source, const EPixelLayout layout, mu_uint8 *dest, const mu_uint32 count, const mu_boolean premultiply)
+	{
+		const mu_uint32 bytes = GetBytes(layout);
+		const mu_boolean swap = layout == EPixelLayout::BGR8 || layout == EPixelLayout::BGRA8;
+		for (mu_uint32 x = 0; x < count; ++x, source += bytes, dest += 4u)
+		{
+			const mu_uint32 a = bytes == 4u ? source[3] : 255u;
+			mu_uint32 rgb[3] = { source[swap ? 2 : 0], source[1], source[swap ? 0 : 2] };
+			for (mu_uint32 c = 0; c < 3u; ++c)
+			{
+				if (premultiply)
+				{
+					// round(v * a / 255)
+					rgb[c] = (rgb[c] * a * 2u + 255u) / 510u;
+				}
+				dest[c] = static_cast<mu_uint8>(rgb[c]);
+			}
+			dest[3] = static_cast<mu_uint8>(a);
+		}
+	}
+}
+
+NEXTMU_TEST(PixelFormatMatchesReference)
+{
+	// Widths cover the vectorized blocks and every scalar border length
+	constexpr mu_uint32 Height = 3u, MaxWidth = 37u, Padding = 5u;
+	MURandom::NGenerator generator;
+	generator.Seed(0x5049584Cu);
+
+	for (const EPixelLayout layout : Layouts)
+	{
+		const mu_uint32 bytes = GetBytes(layout);
+		for (mu_uint32 width = 1u; width <= MaxWidth; ++width)
+		{
+			for (mu_uint32 premultiply = 0; premultiply < 2u; ++premultiply)
+			{
+				// The source starts at an odd offset and the pitch isn't a multiple of the pixel size
+				const mu_uint32 sourcePitch = width * bytes + Padding;
+				std::vector<mu_uint8> source(1u + sourcePitch * Height);
+				for (auto &value : source) value = static_cast<mu_uint8>(generator.Next());
+
+				const mu_uint32 destPitch = width * 4u;
+				std::vector<mu_uint8> expected(destPitch * Height), result(destPitch * Height);
+				for (mu_uint32 y = 0; y < Height; ++y)
+				{
+					ConvertReference(source.data() + 1u + y * sourcePitch, layout, expected.data() + y * destPitch, width, premultiply != 0);
+				}
+
+				MUPixelFormat::ConvertRows(source.data() + 1u, sourcePitch, layout, result.data(), destPitch, width, Height, premultiply != 0);
+				NEXTMU_CHECK(result == expected);
+
+				if (bytes == 4u)
+				{
+					std::vector<mu_uint8> inplace(source.begin() + 1u, source.end());
+					MUPixelFormat::ConvertRows(inplace.data(), sourcePitch, layout, inplace.data(), sourcePitch, width, Height, premultiply != 0);
+					for (mu_uint32 y = 0; y < Height; ++y)
+					{
+						NEXTMU_CHECK(mu_memcmp(inplace.data() + y * sourcePitch, expected.data() + y * destPitch, destPitch) == 0);
+					}
+				}
+			}
+		}
+	}
+}
+
+NEXTMU_TEST(PixelFormatPremultiplyEdges)
+{
+	const mu_uint8 source[] = {
+		255, 255, 255, 0,
+		255, 255, 255, 255,
+		200, 100, 1, 128,
+		255, 0, 128, 1,
+	};
+	const mu_uint8 expected[] = {
+		0, 0, 0, 0,
+		255, 255, 255, 255,
+		100, 50, 1, 128,
+		1, 0, 1, 1,
+	};
+	mu_uint8 result[sizeof(source)] = {};
+
+	MUPixelFormat::ConvertRows(source, sizeof(source), EPixelLayout::RGBA8, result, sizeof(result), 4u, 1u, true);
+	NEXTMU_CHECK(mu_memcmp(result, expected, sizeof(expected)) == 0);
+}
\ No newline at end of file
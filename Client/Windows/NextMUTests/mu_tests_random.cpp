@@ -0,0 +1,119 @@
+#include "stdafx.h"
+#include "mu_tests.h"
+#include "mu_random.h"
+#include <thread>
+
+NEXTMU_TEST(RandomSeedIsReproducible)
+{
+	MURandom::NGenerator a, b, c;
+	a.Seed(1234u);
+	b.Seed(1234u);
+	c.Seed(1235u);
+
+	mu_uint32 differences = 0;
+	for (mu_uint32 n = 0; n < 1000u; ++n)
+	{
+		const mu_uint32 value = a.Next();
+		NEXTMU_CHECK(value == b.Next());
+		if (value != c.Next()) ++differences;
+	}
+	NEXTMU_CHECK(differences > 990u);
+}
+
+NEXTMU_TEST(RandomFloatsAreUniform)
+{
+	constexpr mu_uint32 Samples = 160000u, Buckets = 16u;
+	MURandom::NGenerator generator;
+	generator.Seed(42u);
+
+	mu_uint32 buckets[Buckets] = {};
+	mu_double sum = 0.0;
+	for (mu_uint32 n = 0; n < Samples; ++n)
+	{
+		const mu_float value = generator.NextFloat();
+		NEXTMU_CHECK(value >= 0.0f && value < 1.0f);
+		buckets[static_cast<mu_uint32>(value * Buckets)] += 1u;
+		sum += value;
+	}
+
+	NEXTMU_CHECK(glm::abs(sum / Samples - 0.5) < 0.01);
+
+	// 10000 samples expected per bucket, the standard deviation is close to 100
+	for (mu_uint32 n = 0; n < Buckets; ++n)
+	{
+		NEXTMU_CHECK(buckets[n] > 9500u && buckets[n] < 10500u);
+	}
+}
+
+NEXTMU_TEST(RandomFillMatchesRange)
+{
+	// 1003 values use the vectorized lanes and the scalar tail
+	constexpr mu_uint32 Count = 1003u;
+	std::vector<mu_float> values(Count), again(Count);
+
+	MURandom::NGenerator generator;
+	generator.Seed(7u);
+	generator.Fill(values.data(), Count, -2.0f, 6.0f);
+
+	mu_double sum = 0.0;
+	for (const mu_float value : values)
+	{
+		NEXTMU_CHECK(value >= -2.0f && value < 6.0f);
+		sum += value;
+	}
+	NEXTMU_CHECK(glm::abs(sum / Count - 2.0) < 0.25);
+
+	// The lanes are seeded from the generator, so the same seed fills the same values
+	MURandom::NGenerator other;
+	other.Seed(7u);
+	other.Fill(again.data(), Count, -2.0f, 6.0f);
+	NEXTMU_CHECK(values == again);
+
+	// Lanes must not repeat each other
+	mu_uint32 repeated = 0;
+	for (mu_uint32 n = 8u; n < Count; ++n)
+	{
+		if (values[n] == values[n - 1u]) ++repeated;
+	}
+	NEXTMU_CHECK(repeated < 4u);
+}
+
+NEXTMU_TEST(RandomLinearIntegersAreInclusive)
+{
+	MURandom::SetSeed(99u);
+
+	mu_uint32 hits[4] = {};
+	for (mu_uint32 n = 0; n < 4000u; ++n)
+	{
+		const mu_int32 value = MURandom::Linear(-1, 2);
+		NEXTMU_CHECK(value >= -1 && value <= 2);
+		if (value >= -1 && value <= 2) hits[value + 1] += 1u;
+	}
+
+	for (const mu_uint32 count : hits)
+	{
+		NEXTMU_CHECK(count > 800u);
+	}
+}
+
+NEXTMU_TEST(RandomThreadStreamsAreIndependent)
+{
+	// Workers with the same index and seed reproduce their stream, different indices get different streams
+	const auto sample = [](const mu_uint32 index) -> std::vector<mu_uint32> {
+		std::vector<mu_uint32> values;
+		std::thread worker([index, &values]() {
+			MURandom::SetThreadIndex(index);
+			for (mu_uint32 n = 0; n < 64u; ++n) values.push_back(MURandom::GetGenerator().Next());
+		});
+		worker.join();
+		return values;
+	};
+
+	MURandom::SetSeed(2024u);
+	const auto first = sample(0u);
+	const auto second = sample(1u);
+	const auto repeated = sample(0u);
+
+	NEXTMU_CHECK(first == repeated);
+	NEXTMU_CHECK(first != second);
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+#include "stdafx.h"
+#include "mu_tests.h"
+#include "mu_math.h"
+
+namespace
+{
+	/*
+		Maximum error accepted by the half precision encoding, positions are in model space so
+		half floats provide enough precision for them (around 0.25 units at 512 units).
+	*/
+	constexpr mu_float HalfRotationEpsilon = 0.002f;
+	constexpr mu_float HalfPositionEpsilon = 0.001f;
+
+	void CheckHalfRoundTrip(const glm::vec3 angle, const glm::vec3 position, const mu_float scale)
+	{
+		NCompressedMatrix source;
+		source.Set(angle, position, scale);
+
+		NHalfCompressedMatrix encoded;
+		EncodeHalfMatrix(source, encoded);
+		NCompressedMatrix decoded;
+		DecodeHalfMatrix(encoded, decoded);
+
+		const mu_float rotationError = 1.0f - glm::abs(glm::dot(source.Rotation, decoded.Rotation));
+		const glm::vec3 positionError = glm::abs(source.Position - decoded.Position) / glm::max(glm::abs(source.Position), glm::vec3(1.0f));
+		const mu_float scaleError = glm::abs(source.Scale - decoded.Scale);
+
+		NEXTMU_CHECK(rotationError <= HalfRotationEpsilon);
+		NEXTMU_CHECK(glm::all(glm::lessThanEqual(positionError, glm::vec3(HalfPositionEpsilon))));
+		NEXTMU_CHECK(scaleError <= HalfPositionEpsilon);
+	}
+}
+
+NEXTMU_TEST(SkeletonHalfMatrixRoundTrip)
+{
+	CheckHalfRoundTrip(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 0.0f), 1.0f);
+	CheckHalfRoundTrip(glm::vec3(90.0f, 45.0f, 0.0f), glm::vec3(1.5f, -12.25f, 80.0f), 1.25f);
+	CheckHalfRoundTrip(glm::vec3(-33.0f, 170.0f, 12.5f), glm::vec3(-150.0f, 35.75f, 210.0f), 1.5f);
+	CheckHalfRoundTrip(glm::vec3(180.0f, -90.0f, 270.0f), glm::vec3(400.0f, -300.0f, 512.0f), 1.75f);
+
+	// Spread of poses inside the range of the models
+	for (mu_uint32 n = 0; n < 256u; ++n)
+	{
+		const mu_float t = static_cast<mu_float>(n);
+		CheckHalfRoundTrip(
+			glm::vec3(t * 7.0f - 900.0f, t * 13.0f, 360.0f - t * 3.0f),
+			glm::vec3(glm::sin(t) * 500.0f, glm::cos(t * 0.5f) * 500.0f, t * 2.0f),
+			0.5f + t / 128.0f
+		);
+	}
+}
+
+NEXTMU_TEST(SkeletonHalfMatrixIdentityIsExact)
+{
+	// Dummy bones upload identity matrices, they must not drift after the encoding
+	NCompressedMatrix source;
+	source.SetIdentity();
+
+	NHalfCompressedMatrix encoded;
+	EncodeHalfMatrix(source, encoded);
+	NCompressedMatrix decoded;
+	DecodeHalfMatrix(encoded, decoded);
+
+	NEXTMU_CHECK(decoded.Rotation == source.Rotation);
+	NEXTMU_CHECK(decoded.Position == source.Position);
+	NEXTMU_CHECK(decoded.Scale == source.Scale);
+}
+
+NEXTMU_TEST(SkeletonHalfMatrixKeepsLayout)
+{
+	// Shaders read both formats the same way, so the encoded components follow the memory order of NCompressedMatrix
+	static_assert(sizeof(NCompressedMatrix) == sizeof(mu_float) * 8u);
+	static_assert(sizeof(NHalfCompressedMatrix) == sizeof(mu_uint16) * 8u);
+
+	NCompressedMatrix source;
+	source.Set(glm::vec3(30.0f, -60.0f, 10.0f), glm::vec3(3.0f, -5.0f, 7.0f), 2.0f);
+
+	NHalfCompressedMatrix encoded;
+	EncodeHalfMatrix(source, encoded);
+
+	mu_float components[8];
+	mu_memcpy(components, &source, sizeof(components));
+	const glm::vec4 rotation = glm::unpackHalf(encoded.Rotation);
+	const glm::vec4 positionScale = glm::unpackHalf(encoded.PositionScale);
+	for (mu_uint32 n = 0; n < 4u; ++n)
+	{
+		NEXTMU_CHECK(glm::abs(rotation[n] - components[n]) < 0.001f);
+		NEXTMU_CHECK(glm::abs(positionScale[n] - components[4u + n]) < 0.01f);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,163 @@
+#include "stdafx.h"
+#include "mu_tests.h"
+#include "mu_textureatlas.h"
+#include "mu_random.h"
+
+namespace
+{
+	constexpr mu_uint32 PageSize = MUTextureAtlas::MaxPageSize;
+
+	// Effect textures are mostly powers of two, a third of them have an odd width
+	std::vector<MUTextureAtlas::NPackSize> MakeSizes(const mu_uint32 count, const mu_uint32 seed)
+	{
+		constexpr mu_uint32 Sizes[] = { 16u, 32u, 64u, 128u, 256u };
+		MURandom::NGenerator generator;
+		generator.Seed(seed);
+
+		std::vector<MUTextureAtlas::NPackSize> sizes(count);
+		for (auto &size : sizes)
+		{
+			size.Width = Sizes[generator.Next() % mu_countof(Sizes)];
+			size.Height = Sizes[generator.Next() % mu_countof(Sizes)];
+			if (generator.Next() % 3u == 0u) size.Width = glm::min(size.Width + generator.Next() % 40u, MUTextureAtlas::MaxRegionSize);
+		}
+		return sizes;
+	}
+
+	// Rectangle of a region including its padding
+	struct NPaddedRect
+	{
+		mu_uint32 Page, X, Y, Width, Height;
+
+		const mu_boolean operator<(const NPaddedRect &other) const
+		{
+			return std::tie(Page, X, Y, Width, Height) < std::tie(other.Page, other.X, other.Y, other.Width, other.Height);
+		}
+
+		const mu_boolean operator==(const NPaddedRect &other) const
+		{
+			return std::tie(Page, X, Y, Width, Height) == std::tie(other.Page, other.X, other.Y, other.Width, other.Height);
+		}
+	};
+
+	std::vector<NPaddedRect> GetPaddedRects(const std::vector<MUTextureAtlas::NPackSize> &sizes, const std::vector<MUTextureAtlas::NPackPlacement> &placements)
+	{
+		std::vector<NPaddedRect> rects;
+		for (mu_size n = 0; n < sizes.size(); ++n)
+		{
+			rects.push_back(
+				NPaddedRect{
+					.Page = placements[n].Page,
+					.X = placements[n].X - MUTextureAtlas::Padding,
+					.Y = placements[n].Y - MUTextureAtlas::Padding,
+					.Width = sizes[n].Width + MUTextureAtlas::Padding * 2u,
+					.Height = sizes[n].Height + MUTextureAtlas::Padding * 2u,
+				}
+			);
+		}
+		return rects;
+	}
+}
+
+NEXTMU_TEST(TextureAtlasPlacementsDontOverlap)
+{
+	const auto sizes = MakeSizes(300u, 1u);
+	std::vector<MUTextureAtlas::NPackPlacement> placements;
+	std::vector<MUTextureAtlas::NPackPage> pages;
+	MUTextureAtlas::Pack(sizes, PageSize, placements, pages);
+
+	NEXTMU_CHECK(placements.size() == sizes.size());
+	const auto rects = GetPaddedRects(sizes, placements);
+	for (mu_size n = 0; n < rects.size(); ++n)
+	{
+		const auto &a = rects[n];
+		NEXTMU_CHECK(a.Page < pages.size());
+		if (a.Page >= pages.size()) continue;
+
+		// Regions start on the texel of the last mip level so the levels never mix two regions
+		NEXTMU_CHECK(placements[n].X % MUTextureAtlas::Padding == 0u && placements[n].Y % MUTextureAtlas::Padding == 0u);
+		NEXTMU_CHECK(placements[n].X >= MUTextureAtlas::Padding && placements[n].Y >= MUTextureAtlas::Padding);
+		NEXTMU_CHECK(a.X + a.Width <= pages[a.Page].Width && a.Y + a.Height <= pages[a.Page].Height);
+
+		for (mu_size m = 0; m < n; ++m)
+		{
+			const auto &b = rects[m];
+			if (a.Page != b.Page) continue;
+			const mu_boolean overlap = a.X < b.X + b.Width && b.X < a.X + a.Width && a.Y < b.Y + b.Height && b.Y < a.Y + a.Height;
+			NEXTMU_CHECK(overlap == false);
+		}
+	}
+}
+
+NEXTMU_TEST(TextureAtlasPackIsDeterministic)
+{
+	const auto sizes = MakeSizes(200u, 2u);
+	std::vector<MUTextureAtlas::NPackPlacement> placements;
+	std::vector<MUTextureAtlas::NPackPage> pages;
+	MUTextureAtlas::Pack(sizes, PageSize, placements, pages);
+	auto expected = GetPaddedRects(sizes, placements);
+	std::sort(expected.begin(), expected.end());
+
+	// Textures finish decoding in any order, the same sizes must produce the same pages
+	MURandom::NGenerator generator;
+	generator.Seed(3u);
+	for (mu_uint32 attempt = 0; attempt < 4u; ++attempt)
+	{
+		auto shuffled = sizes;
+		for (mu_size n = shuffled.size() - 1u; n > 0u; --n)
+		{
+			std::swap(shuffled[n], shuffled[generator.Next() % (n + 1u)]);
+		}
+
+		std::vector<MUTextureAtlas::NPackPlacement> shuffledPlacements;
+		std::vector<MUTextureAtlas::NPackPage> shuffledPages;
+		MUTextureAtlas::Pack(shuffled, PageSize, shuffledPlacements, shuffledPages);
+		auto rects = GetPaddedRects(shuffled, shuffledPlacements);
+		std::sort(rects.begin(), rects.end());
+
+		NEXTMU_CHECK(rects == expected);
+		NEXTMU_CHECK(shuffledPages.size() == pages.size());
+		for (mu_size n = 0; n < glm::min(pages.size(), shuffledPages.size()); ++n)
+		{
+			NEXTMU_CHECK(shuffledPages[n].Width == pages[n].Width && shuffledPages[n].Height == pages[n].Height);
+		}
+	}
+}
+
+NEXTMU_TEST(TextureAtlasOccupancy)
+{
+	const auto sizes = MakeSizes(300u, 1u);
+	std::vector<MUTextureAtlas::NPackPlacement> placements;
+	std::vector<MUTextureAtlas::NPackPage> pages;
+	MUTextureAtlas::Pack(sizes, PageSize, placements, pages);
+
+	mu_uint64 pagesArea = 0, usedArea = 0;
+	for (const auto &page : pages)
+	{
+		pagesArea += static_cast<mu_uint64>(page.Width) * page.Height;
+		usedArea += page.UsedArea;
+	}
+
+	const mu_double occupancy = static_cast<mu_double>(usedArea) / static_cast<mu_double>(pagesArea);
+	fmt::print("  occupancy {:.3f} in {} pages\n", occupancy, pages.size());
+	NEXTMU_CHECK(occupancy > 0.75);
+
+	// Pages are trimmed to the power of two which holds their regions, padded these are 64x64, 32x32 and 32x32
+	const MUTextureAtlas::NPackSize small[] = { { 56u, 56u }, { 24u, 24u }, { 24u, 24u } };
+	MUTextureAtlas::Pack(std::vector<MUTextureAtlas::NPackSize>(std::begin(small), std::end(small)), PageSize, placements, pages);
+	NEXTMU_CHECK(pages.size() == 1u);
+	NEXTMU_CHECK(pages[0].Width == 128u && pages[0].Height == 64u);
+	NEXTMU_CHECK(pages[0].UsedArea == 64u * 64u + 2u * 32u * 32u);
+}
+
+NEXTMU_TEST(TextureAtlasRejectsOversizedRegions)
+{
+	const std::vector<MUTextureAtlas::NPackSize> sizes = { { 64u, 64u }, { PageSize, 16u } };
+	std::vector<MUTextureAtlas::NPackPlacement> placements;
+	std::vector<MUTextureAtlas::NPackPage> pages;
+	MUTextureAtlas::Pack(sizes, PageSize, placements, pages);
+
+	NEXTMU_CHECK(placements[0].Page == 0u);
+	NEXTMU_CHECK(placements[1].Page == NInvalidUInt32);
+	NEXTMU_CHECK(pages.size() == 1u);
+}
\ No newline at end of file
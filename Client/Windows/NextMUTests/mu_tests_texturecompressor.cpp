@@ -0,0 +1,135 @@
+#include "stdafx.h"
+#include "mu_tests.h"
+#include "mu_texture_compressor.h"
+
+namespace
+{
+	std::vector<mu_uint8> GenerateGradient(const mu_uint32 width, const mu_uint32 height, const mu_boolean alpha)
+	{
+		std::vector<mu_uint8> pixels(static_cast<mu_size>(width) * height * 4);
+		for (mu_uint32 y = 0; y < height; ++y)
+		{
+			for (mu_uint32 x = 0; x < width; ++x)
+			{
+				mu_uint8 *pixel = &pixels[(static_cast<mu_size>(y) * width + x) * 4];
+				pixel[0] = static_cast<mu_uint8>(x * 255u / (width - 1u));
+				pixel[1] = static_cast<mu_uint8>(y * 255u / (height - 1u));
+				pixel[2] = static_cast<mu_uint8>((x + y) * 255u / (width + height - 2u));
+				pixel[3] = alpha ? static_cast<mu_uint8>(255u - x * 255u / (width - 1u)) : 255u;
+			}
+		}
+		return pixels;
+	}
+
+	const mu_uint32 CalculateMaxError(const mu_uint8 *a, const mu_uint8 *b, const mu_size count)
+	{
+		mu_uint32 maxError = 0;
+		for (mu_size n = 0; n < count; ++n)
+		{
+			maxError = glm::max(maxError, static_cast<mu_uint32>(glm::abs(static_cast<mu_int32>(a[n]) - static_cast<mu_int32>(b[n]))));
+		}
+		return maxError;
+	}
+}
+
+NEXTMU_TEST(TextureCompressorSolidBlocksAreExact)
+{
+	// Colors with every channel representable in 5:6:5 survive both formats without error
+	const mu_uint8 color[4] = { 255u, 0u, 255u, 255u };
+	mu_uint8 pixels[MUTextureCompressor::BlockPixels * 4];
+	for (mu_uint32 n = 0; n < MUTextureCompressor::BlockPixels; ++n)
+	{
+		mu_memcpy(&pixels[n * 4], color, sizeof(color));
+	}
+
+	for (const auto format : { ECompressedFormat::BC1, ECompressedFormat::BC3 })
+	{
+		mu_uint8 block[16] = {};
+		mu_uint8 decoded[MUTextureCompressor::BlockPixels * 4] = {};
+		MUTextureCompressor::EncodeBlock(pixels, block, format);
+		MUTextureCompressor::DecodeBlock(block, decoded, format);
+		NEXTMU_CHECK(mu_memcmp(pixels, decoded, sizeof(pixels)) == 0);
+	}
+}
+
+NEXTMU_TEST(TextureCompressorAlphaEndpointsAreExact)
+{
+	// BC3 interpolates alpha between the block extremes, the extremes themselves must be kept
+	mu_uint8 pixels[MUTextureCompressor::BlockPixels * 4];
+	for (mu_uint32 n = 0; n < MUTextureCompressor::BlockPixels; ++n)
+	{
+		pixels[n * 4 + 0] = 128u;
+		pixels[n * 4 + 1] = 128u;
+		pixels[n * 4 + 2] = 128u;
+		pixels[n * 4 + 3] = static_cast<mu_uint8>(n * 17u);
+	}
+
+	mu_uint8 block[16] = {};
+	mu_uint8 decoded[MUTextureCompressor::BlockPixels * 4] = {};
+	MUTextureCompressor::EncodeBlock(pixels, block, ECompressedFormat::BC3);
+	MUTextureCompressor::DecodeBlock(block, decoded, ECompressedFormat::BC3);
+
+	NEXTMU_CHECK(decoded[0 * 4 + 3] == 0u);
+	NEXTMU_CHECK(decoded[15 * 4 + 3] == 255u);
+	for (mu_uint32 n = 0; n < MUTextureCompressor::BlockPixels; ++n)
+	{
+		NEXTMU_CHECK(glm::abs(static_cast<mu_int32>(decoded[n * 4 + 3]) - static_cast<mu_int32>(pixels[n * 4 + 3])) <= 18);
+	}
+}
+
+NEXTMU_TEST(TextureCompressorGradientQuality)
+{
+	constexpr mu_uint32 Width = 64u, Height = 64u;
+	const auto opaque = GenerateGradient(Width, Height, false);
+	const auto translucent = GenerateGradient(Width, Height, true);
+
+	MUTextureCompressor::NStatistics bc1;
+	std::vector<mu_uint8> bc1Blocks(MUTextureCompressor::CalculateLevelSize(Width, Height, ECompressedFormat::BC1));
+	MUTextureCompressor::CompressLevel(opaque.data(), Width, Height, ECompressedFormat::BC1, bc1Blocks.data(), bc1);
+	NEXTMU_CHECK(bc1.CompressedBytes == bc1Blocks.size());
+	NEXTMU_CHECK(bc1.SourceBytes == bc1.CompressedBytes * 8u);
+	NEXTMU_CHECK(bc1.GetPSNR() > 35.0);
+
+	MUTextureCompressor::NStatistics bc3;
+	std::vector<mu_uint8> bc3Blocks(MUTextureCompressor::CalculateLevelSize(Width, Height, ECompressedFormat::BC3));
+	MUTextureCompressor::CompressLevel(translucent.data(), Width, Height, ECompressedFormat::BC3, bc3Blocks.data(), bc3);
+	NEXTMU_CHECK(bc3.SourceBytes == bc3.CompressedBytes * 4u);
+	NEXTMU_CHECK(bc3.GetPSNR() > 35.0);
+
+	// The decoded blocks match the error reported by the statistics
+	mu_uint32 maxError = 0;
+	for (mu_uint32 by = 0; by < Height / MUTextureCompressor::BlockSize; ++by)
+	{
+		for (mu_uint32 bx = 0; bx < Width / MUTextureCompressor::BlockSize; ++bx)
+		{
+			mu_uint8 decoded[MUTextureCompressor::BlockPixels * 4] = {};
+			const mu_size blockIndex = static_cast<mu_size>(by) * (Width / MUTextureCompressor::BlockSize) + bx;
+			MUTextureCompressor::DecodeBlock(&bc3Blocks[blockIndex * 16u], decoded, ECompressedFormat::BC3);
+
+			for (mu_uint32 row = 0; row < MUTextureCompressor::BlockSize; ++row)
+			{
+				const mu_size source = ((static_cast<mu_size>(by) * MUTextureCompressor::BlockSize + row) * Width + bx * MUTextureCompressor::BlockSize) * 4;
+				maxError = glm::max(maxError, CalculateMaxError(&translucent[source], &decoded[row * MUTextureCompressor::BlockSize * 4], MUTextureCompressor::BlockSize * 4));
+			}
+		}
+	}
+	NEXTMU_CHECK(maxError <= 16u);
+}
+
+NEXTMU_TEST(TextureCompressorClampsBorderBlocks)
+{
+	// Levels smaller than a block still produce one block, the mip tail of every texture depends on it
+	const mu_uint8 pixel[4] = { 255u, 255u, 0u, 255u };
+	for (const auto format : { ECompressedFormat::BC1, ECompressedFormat::BC3 })
+	{
+		MUTextureCompressor::NStatistics statistics;
+		std::vector<mu_uint8> blocks(MUTextureCompressor::CalculateLevelSize(1u, 1u, format));
+		NEXTMU_CHECK(blocks.size() == MUTextureCompressor::GetBlockBytes(format));
+		MUTextureCompressor::CompressLevel(pixel, 1u, 1u, format, blocks.data(), statistics);
+
+		mu_uint8 decoded[MUTextureCompressor::BlockPixels * 4] = {};
+		MUTextureCompressor::DecodeBlock(blocks.data(), decoded, format);
+		NEXTMU_CHECK(mu_memcmp(decoded, pixel, sizeof(pixel)) == 0);
+		NEXTMU_CHECK(statistics.SquaredError == 0.0);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,184 @@
+#include "stdafx.h"
+#include "mu_tests.h"
+#include "mu_textures.h"
+#include "mu_texture_containers.h"
+
+namespace
+{
+	constexpr mu_uint32 MakeFourCC(const mu_char a, const mu_char b, const mu_char c, const mu_char d)
+	{
+		return static_cast<mu_uint32>(a) | (static_cast<mu_uint32>(b) << 8) | (static_cast<mu_uint32>(c) << 16) | (static_cast<mu_uint32>(d) << 24);
+	}
+
+	// Words of the magic and the DDS header, the indices follow the layout of the header
+	std::vector<mu_uint8> BuildDDS(const mu_uint32 width, const mu_uint32 height, const mu_uint32 fourCC, const std::vector<mu_uint8> &payload)
+	{
+		mu_uint32 words[32] = {};
+		words[0] = MakeFourCC('D', 'D', 'S', ' ');
+		words[1] = 124u; // Size
+		words[2] = 0x1007u; // Caps, height, width and pixel format
+		words[3] = height;
+		words[4] = width;
+		words[19] = 32u; // Pixel format size
+		if (fourCC != 0)
+		{
+			words[20] = 0x4u; // FourCC
+			words[21] = fourCC;
+		}
+		else
+		{
+			words[20] = 0x40u | 0x1u; // RGB with alpha
+			words[22] = 32u;
+			words[23] = 0x000000FFu;
+			words[24] = 0x0000FF00u;
+			words[25] = 0x00FF0000u;
+			words[26] = 0xFF000000u;
+		}
+
+		std::vector<mu_uint8> file(sizeof(words));
+		mu_memcpy(file.data(), words, sizeof(words));
+		file.insert(file.end(), payload.begin(), payload.end());
+		return file;
+	}
+
+	std::vector<mu_uint8> BuildKTX2(const mu_uint32 width, const mu_uint32 height, const mu_uint32 vkFormat, const std::vector<mu_uint8> &payload, const mu_utf8string &orientation)
+	{
+		const mu_uint8 identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+		constexpr mu_uint32 HeaderSize = 80u, LevelIndexSize = 24u;
+
+		// Key-value data with a single KTXorientation entry
+		std::vector<mu_uint8> keyValues;
+		if (orientation.empty() == false)
+		{
+			const mu_utf8string entry = mu_utf8string("KTXorientation") + '\0' + orientation + '\0';
+			const mu_uint32 entryLength = static_cast<mu_uint32>(entry.size());
+			keyValues.resize(sizeof(entryLength));
+			mu_memcpy(keyValues.data(), &entryLength, sizeof(entryLength));
+			keyValues.insert(keyValues.end(), entry.begin(), entry.end());
+			keyValues.resize((keyValues.size() + 3u) & ~static_cast<mu_size>(3u));
+		}
+
+		const mu_uint32 keyValuesOffset = HeaderSize + LevelIndexSize;
+		const mu_uint64 dataOffset = keyValuesOffset + keyValues.size();
+
+		std::vector<mu_uint8> file(HeaderSize + LevelIndexSize);
+		mu_memcpy(file.data(), identifier, sizeof(identifier));
+		const mu_uint32 words[] = { vkFormat, 1u, width, height, 0u, 0u, 1u, 1u, 0u, 0u, 0u, keyValues.empty() ? 0u : keyValuesOffset, static_cast<mu_uint32>(keyValues.size()) };
+		mu_memcpy(file.data() + sizeof(identifier), words, sizeof(words));
+
+		const mu_uint64 level[3] = { dataOffset, payload.size(), payload.size() };
+		mu_memcpy(file.data() + HeaderSize, level, sizeof(level));
+
+		file.insert(file.end(), keyValues.begin(), keyValues.end());
+		file.insert(file.end(), payload.begin(), payload.end());
+		return file;
+	}
+
+	const mu_uint8 *GetLevel(const TextureInfo &info, const mu_uint32 level)
+	{
+		return static_cast<const mu_uint8 *>(info.Levels[level].pData);
+	}
+}
+
+NEXTMU_TEST(TextureContainersFlipUncompressedDDS)
+{
+	// 2x2 RGBA8 stored top-down, the first row must end up last
+	const std::vector<mu_uint8> payload = {
+		1, 1, 1, 1, 2, 2, 2, 2,
+		3, 3, 3, 3, 4, 4, 4, 4,
+	};
+	const auto file = BuildDDS(2u, 2u, 0u, payload);
+
+	TextureInfo info;
+	NEXTMU_CHECK(MUTextureContainers::Parse("dds", file.data(), file.size(), info) == true);
+	NEXTMU_CHECK(info.Width == 2u && info.Height == 2u && info.MipLevels == 1u);
+	NEXTMU_CHECK(info.Format == Diligent::TEX_FORMAT_RGBA8_UNORM);
+	NEXTMU_CHECK(info.Alpha == true);
+	NEXTMU_CHECK(info.FlippedLevels.empty() == false);
+
+	const mu_uint8 *level = GetLevel(info, 0);
+	NEXTMU_CHECK(level == info.FlippedLevels.data());
+	NEXTMU_CHECK(mu_memcmp(level, payload.data() + 8, 8) == 0);
+	NEXTMU_CHECK(mu_memcmp(level + 8, payload.data(), 8) == 0);
+}
+
+NEXTMU_TEST(TextureContainersFlipBC1Rows)
+{
+	// A single 4x4 block, the endpoints stay and the rows of indices are reversed
+	const std::vector<mu_uint8> payload = { 0x00, 0xF8, 0x1F, 0x00, 0x11, 0x22, 0x33, 0x44 };
+	const auto file = BuildDDS(4u, 4u, MakeFourCC('D', 'X', 'T', '1'), payload);
+
+	TextureInfo info;
+	NEXTMU_CHECK(MUTextureContainers::Parse("dds", file.data(), file.size(), info) == true);
+	NEXTMU_CHECK(info.Format == Diligent::TEX_FORMAT_BC1_UNORM);
+
+	const std::vector<mu_uint8> expected = { 0x00, 0xF8, 0x1F, 0x00, 0x44, 0x33, 0x22, 0x11 };
+	NEXTMU_CHECK(mu_memcmp(GetLevel(info, 0), expected.data(), expected.size()) == 0);
+}
+
+NEXTMU_TEST(TextureContainersFlipBC3Blocks)
+{
+	// 4x8 texture, the two rows of blocks swap and the 3 bits alpha indices of every row are reversed
+	std::vector<mu_uint8> payload(32u);
+	for (mu_uint32 block = 0; block < 2u; ++block)
+	{
+		mu_uint8 *data = &payload[block * 16u];
+		data[0] = static_cast<mu_uint8>(0x10u + block);
+		data[1] = 0x00u;
+
+		// Rows of alpha indices 0, 1, 2 and 3 packed in 12 bits each
+		const mu_uint64 indices = 0x000ull | (0x249ull << 12) | (0x492ull << 24) | (0x6DBull << 36);
+		for (mu_uint32 n = 0; n < 6u; ++n) data[2u + n] = static_cast<mu_uint8>(indices >> (n * 8u));
+
+		data[12] = 0x11u; data[13] = 0x22u; data[14] = 0x33u; data[15] = 0x44u;
+	}
+	const auto file = BuildDDS(4u, 8u, MakeFourCC('D', 'X', 'T', '5'), payload);
+
+	TextureInfo info;
+	NEXTMU_CHECK(MUTextureContainers::Parse("dds", file.data(), file.size(), info) == true);
+	NEXTMU_CHECK(info.Format == Diligent::TEX_FORMAT_BC3_UNORM);
+
+	const mu_uint8 *level = GetLevel(info, 0);
+	NEXTMU_CHECK(level[0] == 0x11u);
+	NEXTMU_CHECK(level[16] == 0x10u);
+
+	mu_uint64 flipped = 0;
+	for (mu_uint32 n = 0; n < 6u; ++n) flipped |= static_cast<mu_uint64>(level[2u + n]) << (n * 8u);
+	NEXTMU_CHECK(flipped == (0x6DBull | (0x492ull << 12) | (0x249ull << 24) | (0x000ull << 36)));
+	NEXTMU_CHECK(level[12] == 0x44u && level[15] == 0x11u);
+}
+
+NEXTMU_TEST(TextureContainersKeepBottomUpKTX2)
+{
+	const std::vector<mu_uint8> payload = {
+		1, 1, 1, 1, 2, 2, 2, 2,
+		3, 3, 3, 3, 4, 4, 4, 4,
+	};
+
+	// Files marked "ru" are already bottom-up, their level points into the file
+	const auto bottomUp = BuildKTX2(2u, 2u, 37u, payload, "ru");
+	TextureInfo info;
+	NEXTMU_CHECK(MUTextureContainers::Parse("ktx2", bottomUp.data(), bottomUp.size(), info) == true);
+	NEXTMU_CHECK(info.FlippedLevels.empty() == true);
+	NEXTMU_CHECK(GetLevel(info, 0) == bottomUp.data() + bottomUp.size() - payload.size());
+
+	// Files without orientation are top-down ("rd")
+	const auto topDown = BuildKTX2(2u, 2u, 37u, payload, "");
+	TextureInfo flippedInfo;
+	NEXTMU_CHECK(MUTextureContainers::Parse("ktx2", topDown.data(), topDown.size(), flippedInfo) == true);
+	NEXTMU_CHECK(flippedInfo.FlippedLevels.empty() == false);
+	NEXTMU_CHECK(mu_memcmp(GetLevel(flippedInfo, 0), payload.data() + 8, 8) == 0);
+}
+
+NEXTMU_TEST(TextureContainersRejectUnflippableBlocks)
+{
+	// BC7 blocks mix their rows in the mode bits, top-down files must be rejected instead of drawn upside down
+	const std::vector<mu_uint8> payload(16u, 0u);
+	const auto file = BuildKTX2(4u, 4u, 145u, payload, "rd");
+
+	TextureInfo info;
+	NEXTMU_CHECK(MUTextureContainers::Parse("ktx2", file.data(), file.size(), info) == false);
+
+	const auto bottomUp = BuildKTX2(4u, 4u, 145u, payload, "ru");
+	NEXTMU_CHECK(MUTextureContainers::Parse("ktx2", bottomUp.data(), bottomUp.size(), info) == true);
+}
\ No newline at end of file
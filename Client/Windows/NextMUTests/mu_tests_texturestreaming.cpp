@@ -0,0 +1,92 @@
+#include "stdafx.h"
+#include "mu_tests.h"
+#include "mu_texturestreaming.h"
+
+namespace
+{
+	using MUTextureStreaming::NResidencyEntry;
+
+	const mu_uint64 SumBytes(const std::vector<NResidencyEntry> &entries)
+	{
+		mu_uint64 bytes = 0;
+		for (const auto &entry : entries) bytes += entry.Bytes;
+		return bytes;
+	}
+}
+
+NEXTMU_TEST(StreamingKeepsTexturesWithinBudget)
+{
+	const std::vector<NResidencyEntry> entries = {
+		{ .Bytes = 100u, .LastUsedFrame = 1u },
+		{ .Bytes = 200u, .LastUsedFrame = 2u },
+	};
+	std::vector<mu_uint32> evictions = { 7u };
+
+	MUTextureStreaming::SelectEvictions(entries, SumBytes(entries), 300u, 10u, evictions);
+	NEXTMU_CHECK(evictions.empty());
+
+	MUTextureStreaming::SelectEvictions(entries, SumBytes(entries), 1000u, 10u, evictions);
+	NEXTMU_CHECK(evictions.empty());
+}
+
+NEXTMU_TEST(StreamingEvictsLeastRecentlyUsed)
+{
+	const std::vector<NResidencyEntry> entries = {
+		{ .Bytes = 100u, .LastUsedFrame = 5u },
+		{ .Bytes = 100u, .LastUsedFrame = 2u },
+		{ .Bytes = 100u, .LastUsedFrame = 8u },
+		{ .Bytes = 100u, .LastUsedFrame = 3u },
+		{ .Bytes = 100u, .LastUsedFrame = 1u },
+	};
+	std::vector<mu_uint32> evictions;
+
+	// 500 resident bytes for a budget of 250, the three oldest are evicted
+	MUTextureStreaming::SelectEvictions(entries, SumBytes(entries), 250u, 10u, evictions);
+	NEXTMU_CHECK((evictions == std::vector<mu_uint32>{ 4u, 1u, 3u }));
+
+	// Evictions stop as soon as the budget is met, a large texture can cover several small ones
+	const std::vector<NResidencyEntry> mixed = {
+		{ .Bytes = 50u, .LastUsedFrame = 4u },
+		{ .Bytes = 400u, .LastUsedFrame = 1u },
+		{ .Bytes = 50u, .LastUsedFrame = 2u },
+	};
+	MUTextureStreaming::SelectEvictions(mixed, SumBytes(mixed), 300u, 10u, evictions);
+	NEXTMU_CHECK((evictions == std::vector<mu_uint32>{ 1u }));
+}
+
+NEXTMU_TEST(StreamingProtectsLastFrame)
+{
+	const std::vector<NResidencyEntry> entries = {
+		{ .Bytes = 100u, .LastUsedFrame = 9u },
+		{ .Bytes = 100u, .LastUsedFrame = 10u },
+		{ .Bytes = 100u, .LastUsedFrame = 4u },
+		{ .Bytes = 100u, .LastUsedFrame = 11u },
+	};
+	std::vector<mu_uint32> evictions;
+
+	// Update protects the textures drawn in the last frame, they would be requested again right away
+	MUTextureStreaming::SelectEvictions(entries, SumBytes(entries), 100u, 10u, evictions);
+	NEXTMU_CHECK((evictions == std::vector<mu_uint32>{ 2u, 0u }));
+	for (const auto index : evictions)
+	{
+		NEXTMU_CHECK(entries[index].LastUsedFrame < 10u);
+	}
+}
+
+NEXTMU_TEST(StreamingExceedsUnmeetableBudget)
+{
+	const std::vector<NResidencyEntry> entries = {
+		{ .Bytes = 300u, .LastUsedFrame = 10u },
+		{ .Bytes = 100u, .LastUsedFrame = 3u },
+		{ .Bytes = 300u, .LastUsedFrame = 12u },
+	};
+	std::vector<mu_uint32> evictions;
+
+	// Everything unprotected is evicted, the protected textures stay over budget
+	MUTextureStreaming::SelectEvictions(entries, SumBytes(entries), 200u, 10u, evictions);
+	NEXTMU_CHECK((evictions == std::vector<mu_uint32>{ 1u }));
+
+	// A zero budget with nothing protected evicts every texture
+	MUTextureStreaming::SelectEvictions(entries, SumBytes(entries), 0u, 20u, evictions);
+	NEXTMU_CHECK(evictions.size() == entries.size());
+}
\ No newline at end of file
@@ -0,0 +1,11 @@
+#ifndef __STDAFX_H__
+#define __STDAFX_H__
+
+#pragma once
+
+// The tests define their own console entry point
+#define SDL_MAIN_HANDLED (1)
+#include <windows.h>
+#include "mu_precompiled.h"
+
+#endif
\ No newline at end of file